@@ -0,0 +1,741 @@
+import glimmer.vector;
+import glimmer.ray;
+import glimmer.ray_packet;
+import glimmer.aabb;
+import glimmer.sphere;
+import glimmer.plane;
+import glimmer.mesh;
+import glimmer.obj;
+import glimmer.transform;
+import glimmer.quaternion;
+import glimmer.scene_object;
+import glimmer.scene;
+import glimmer.camera;
+import glimmer.color;
+import glimmer.image;
+import glimmer.material;
+import glimmer.material_table;
+import glimmer.material_property.checkerboard;
+import glimmer.material_property.image;
+import glimmer.texture;
+import glimmer.bsdf;
+import glimmer.ppm;
+import glimmer.sampler;
+import glimmer.thread_pool;
+import glimmer.renderer_path_tracer;
+import glimmer.renderer_wavefront;
+import glimmer.aov;
+import glimmer.denoise;
+import glimmer.render_session;
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <numbers>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Micro-benchmarks for the intersection, I/O and rendering hot paths.
+//
+// Every benchmark uses fixed seeds and inputs, runs once to warm up, then `repetitions` timed runs. The median
+// throughput is reported together with the min/max spread. Results are written as JSON (stdout by default) so
+// they can be tracked over time; a human-readable summary goes to stderr.
+//
+// Usage: glimmer_bench [--quick] [--repetitions N] [--filter SUBSTRING] [--json PATH]
+//
+// The global allocation functions are replaced to count heap allocations; each result reports the allocations made
+// during its last timed repetition (after warm-up), which tracks how much per-run scratch still goes to the heap.
+
+namespace {
+    std::atomic<std::size_t> heap_allocations{0};
+
+    // Every replaced operator new and delete goes through this pair, so the plain, array, sized, aligned and
+    // nothrow forms stay interchangeable. They are kept out of line: once inlined, GCC would pair the malloc and
+    // free inside them with the operators of the caller and report -Wmismatched-new-delete.
+    [[gnu::noinline]] void* counted_alloc(std::size_t size, std::size_t align) noexcept {
+        heap_allocations.fetch_add(1, std::memory_order_relaxed);
+        if (size == 0) size = 1;
+        if (align <= alignof(std::max_align_t)) return std::malloc(size);
+        // aligned_alloc needs a multiple of the alignment; its blocks are released with free() like malloc's
+        return std::aligned_alloc(align, (size + align - 1) / align * align);
+    }
+
+    [[gnu::noinline]] void counted_free(void* p) noexcept { std::free(p); }
+
+    void* counted_new(std::size_t size, std::size_t align) {
+        if (void* p = counted_alloc(size, align)) return p;
+        throw std::bad_alloc{};
+    }
+
+    constexpr std::size_t default_align = alignof(std::max_align_t);
+}
+
+void* operator new(std::size_t size) { return counted_new(size, default_align); }
+void* operator new[](std::size_t size) { return counted_new(size, default_align); }
+void* operator new(std::size_t size, std::align_val_t align) { return counted_new(size, static_cast<std::size_t>(align)); }
+void* operator new[](std::size_t size, std::align_val_t align) { return counted_new(size, static_cast<std::size_t>(align)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, default_align); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, default_align); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, static_cast<std::size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(p); }
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps the optimizer from discarding benchmark results
+    template <class V>
+    inline void keep(const V& value) {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    struct Options {
+        bool quick{false};
+        std::size_t repetitions{5};
+        std::string filter{};
+        std::string json_path{};
+    };
+
+    struct Result {
+        std::string name;
+        std::string unit;
+        double median{};
+        double min{};
+        double max{};
+        double items{}; // work items per repetition
+        std::size_t repetitions{};
+        std::size_t allocations{}; // heap allocations in the last repetition
+    };
+
+    /**
+     * Runs body `repetitions` times (plus one warm-up) and converts the work it reports into throughput.
+     * body returns the amount of work done in units of `unit * scale` (e.g. rays, with scale 1e-6 for Mrays/s).
+     */
+    class Runner {
+    public:
+        explicit Runner(const Options& options) : options_{options} {}
+
+        void run(const std::string& name, const std::string& unit, double scale, const std::function<double()>& body) {
+            if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) return;
+            (void)body(); // warm-up
+            std::vector<double> rates;
+            rates.reserve(options_.repetitions);
+            double items = 0.0;
+            std::size_t allocations = 0;
+            for (std::size_t r = 0; r < options_.repetitions; ++r) {
+                const std::size_t a0 = heap_allocations.load(std::memory_order_relaxed);
+                const auto t0 = Clock::now();
+                items = body();
+                const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+                allocations = heap_allocations.load(std::memory_order_relaxed) - a0;
+                rates.push_back(items * scale / std::max(seconds, 1e-9));
+            }
+            std::sort(rates.begin(), rates.end());
+            Result res{name, unit, rates[rates.size() / 2], rates.front(), rates.back(), items, rates.size(),
+                       allocations};
+            std::fprintf(stderr, "%-36s %12.3f %-10s [%.3f .. %.3f] %zu allocs\n", name.c_str(), res.median,
+                         unit.c_str(), res.min, res.max, res.allocations);
+            results_.push_back(std::move(res));
+        }
+
+        [[nodiscard]] const std::vector<Result>& results() const noexcept { return results_; }
+        [[nodiscard]] const Options& options() const noexcept { return options_; }
+
+    private:
+        Options options_;
+        std::vector<Result> results_{};
+    };
+
+    template <class T>
+    constexpr const char* type_suffix() { return sizeof(T) == 4 ? "/f32" : "/f64"; }
+
+    // Rays from a shell of radius 4 towards jittered points near the origin: a mix of hits and misses
+    template <class T>
+    std::vector<glimmer::Ray<T>> make_rays(std::size_t count, std::uint64_t seed) {
+        glimmer::Pcg32 rng{seed};
+        std::vector<glimmer::Ray<T>> rays;
+        rays.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            const T z = T{2} * rng.uniform<T>() - T{1};
+            const T phi = T{2} * std::numbers::pi_v<T> * rng.uniform<T>();
+            const T r = std::sqrt(std::max(T{0}, T{1} - z * z));
+            const glimmer::Vector<T, 3> origin{T{4} * r * std::cos(phi), T{4} * r * std::sin(phi), T{4} * z};
+            const glimmer::Vector<T, 3> target{rng.uniform<T>() * T{3} - T{1.5}, rng.uniform<T>() * T{3} - T{1.5},
+                                               rng.uniform<T>() * T{3} - T{1.5}};
+            rays.emplace_back(origin, (target - origin).normalized());
+        }
+        return rays;
+    }
+
+    template <class T>
+    void bench_intersections(Runner& runner) {
+        using Vec3 = glimmer::Vector<T, 3>;
+        const std::size_t count = runner.options().quick ? 100'000 : 1'000'000;
+        const auto rays = make_rays<T>(count, 42);
+        const std::string sfx = type_suffix<T>();
+
+        const glimmer::AABB<T> box{Vec3{-1, -1, -1}, Vec3{1, 1, 1}};
+        runner.run("aabb.intersect" + sfx, "Mrays/s", 1e-6, [&] {
+            std::size_t hits = 0;
+            for (const auto& r : rays) hits += box.intersect(r).has_value();
+            keep(hits);
+            return static_cast<double>(rays.size());
+        });
+
+        const glimmer::Sphere<T> sphere{Vec3{0, 0, 0}, T{1}};
+        runner.run("sphere.intersect" + sfx, "Mrays/s", 1e-6, [&] {
+            std::size_t hits = 0;
+            for (const auto& r : rays) hits += sphere.intersect(r).has_value();
+            keep(hits);
+            return static_cast<double>(rays.size());
+        });
+
+        const glimmer::Plane<T> plane{Vec3{0, 0, 0}, Vec3{T{0.3}, T{1}, T{0.2}}};
+        runner.run("plane.intersect" + sfx, "Mrays/s", 1e-6, [&] {
+            std::size_t hits = 0;
+            for (const auto& r : rays) hits += plane.intersect(r).has_value();
+            keep(hits);
+            return static_cast<double>(rays.size());
+        });
+
+        const Vec3 p0{-1, -1, 0}, p1{1, -1, 0}, p2{0, 1, T{0.5}};
+        runner.run("intersect_triangle" + sfx, "Mrays/s", 1e-6, [&] {
+            std::size_t hits = 0;
+            for (const auto& r : rays) hits += glimmer::intersect_triangle(p0, p1, p2, r).has_value();
+            keep(hits);
+            return static_cast<double>(rays.size());
+        });
+
+        // Sphere behind a rotated, non-uniformly scaled transform
+        const auto xf = glimmer::Transform<T>::from_trs(
+            Vec3{T{0.2}, T{-0.1}, T{0.3}},
+            glimmer::Quaternion<T>::from_axis_angle(Vec3{1, 1, 0}.normalized(), T{0.7}), Vec3{T{1.2}, T{0.8}, T{1}});
+        const glimmer::SceneObject<T> object{std::make_shared<glimmer::Sphere<T>>(Vec3{0, 0, 0}, T{1}),
+                                             glimmer::Material<T>::lambertian(glimmer::Color<T, 3>{1, 1, 1}), xf};
+        runner.run("scene_object.intersect" + sfx, "Mrays/s", 1e-6, [&] {
+            std::size_t hits = 0;
+            for (const auto& r : rays) hits += object.intersect(r).has_value();
+            keep(hits);
+            return static_cast<double>(rays.size());
+        });
+
+        // Point transforms one at a time versus the batch kernel
+        std::vector<Vec3> points(count), moved(count);
+        for (std::size_t i = 0; i < count; ++i) points[i] = rays[i].origin();
+        runner.run("transform.apply_point" + sfx, "Mpoints/s", 1e-6, [&] {
+            for (std::size_t i = 0; i < count; ++i) moved[i] = xf.apply_point(points[i]);
+            keep(moved);
+            return static_cast<double>(count);
+        });
+        runner.run("transform.apply_points" + sfx, "Mpoints/s", 1e-6, [&] {
+            xf.apply_points(points, moved);
+            keep(moved);
+            return static_cast<double>(count);
+        });
+    }
+
+    // Regular grid of n x n quads with normals, written as OBJ text
+    std::string make_obj_text(std::size_t n) {
+        std::ostringstream out;
+        out << "# glimmer_bench grid " << n << "x" << n << "\n";
+        for (std::size_t j = 0; j <= n; ++j) {
+            for (std::size_t i = 0; i <= n; ++i) {
+                const double x = static_cast<double>(i) / static_cast<double>(n);
+                const double y = static_cast<double>(j) / static_cast<double>(n);
+                out << "v " << x << ' ' << y << ' ' << 0.1 * std::sin(10.0 * x) * std::cos(10.0 * y) << "\n";
+            }
+        }
+        out << "vn 0 0 1\n";
+        for (std::size_t j = 0; j < n; ++j) {
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::size_t a = j * (n + 1) + i + 1;
+                out << "f " << a << "//1 " << a + 1 << "//1 " << a + n + 2 << "//1 " << a + n + 1 << "//1\n";
+            }
+        }
+        return out.str();
+    }
+
+    void bench_obj(Runner& runner) {
+        const std::string text = make_obj_text(runner.options().quick ? 100 : 300);
+        runner.run("load_obj/f64", "MB/s", 1e-6, [&] {
+            std::istringstream in{text};
+            const auto mesh = glimmer::load_obj<double>(in);
+            keep(mesh);
+            return static_cast<double>(text.size());
+        });
+    }
+
+    // Closest-hit queries against a BVH'd grid mesh in the compact and precomputed layouts
+    void bench_mesh_layouts(Runner& runner) {
+        const auto text = make_obj_text(runner.options().quick ? 100 : 300);
+        auto mesh = glimmer::parse_obj<float>(text);
+        const auto rays = make_rays<float>(runner.options().quick ? 100'000 : 1'000'000, 9);
+        for (const auto layout : {glimmer::MeshLayout::compact, glimmer::MeshLayout::precomputed}) {
+            mesh.set_layout(layout);
+            const std::string name = layout == glimmer::MeshLayout::compact ? "compact" : "precomputed";
+            runner.run("mesh.intersect/" + name + "/f32", "Mrays/s", 1e-6, [&] {
+                std::size_t hits = 0;
+                for (const auto& r : rays) hits += mesh.intersect(r).has_value();
+                keep(hits);
+                return static_cast<double>(rays.size());
+            });
+        }
+    }
+
+    // Closest-hit queries against a grid of copies of one shared mesh, placed as SceneObjects versus compact instances
+    void bench_instances(Runner& runner) {
+        using Vec3 = glimmer::Vector<float, 3>;
+        auto mesh = std::make_shared<glimmer::Mesh<float>>(glimmer::parse_obj<float>(make_obj_text(20)));
+        const auto material = glimmer::Material<float>::lambertian(glimmer::Color3f{0.5f, 0.5f, 0.5f});
+        const int side = runner.options().quick ? 32 : 100;
+        glimmer::Scene<float> objects, instances;
+        const auto geometry = instances.add_geometry(mesh);
+        const auto material_id = instances.add_material(material);
+        for (int i = 0; i < side * side; ++i) {
+            const auto xf = glimmer::Transform<float>::from_trs(
+                Vec3{static_cast<float>(i % side) * 1.5f, static_cast<float>(i / side) * 1.5f, 0},
+                glimmer::Quaternion<float>::from_axis_angle(Vec3{0, 0, 1}, static_cast<float>(i) * 0.37f),
+                Vec3{1, 1, 1});
+            objects.add_object(glimmer::SceneObject<float>{mesh, material, xf});
+            instances.add_instance(geometry, material_id, xf);
+        }
+        objects.build_bvh();
+        instances.build_bvh();
+
+        glimmer::Pcg32 rng{13};
+        std::vector<glimmer::Ray<float>> rays(runner.options().quick ? 50'000 : 500'000);
+        const float extent = static_cast<float>(side) * 1.5f;
+        for (auto& r : rays) {
+            const Vec3 o{rng.uniform<float>() * extent, rng.uniform<float>() * extent, 5.0f};
+            const Vec3 d = Vec3{rng.uniform<float>() - 0.5f, rng.uniform<float>() - 0.5f, -1.0f}.normalized();
+            r = glimmer::Ray<float>{o, d};
+        }
+        for (const auto* scene : {&objects, &instances}) {
+            runner.run(std::string{"scene.intersect/"} + (scene == &objects ? "objects" : "instances") + "/f32",
+                       "Mrays/s", 1e-6, [&] {
+                std::size_t hits = 0;
+                for (const auto& r : rays) hits += scene->intersect(r).has_value();
+                keep(hits);
+                return static_cast<double>(rays.size());
+            });
+        }
+    }
+
+    // Per-frame scene preparation when a handful of objects move: incremental update versus full refit/rebuild
+    void bench_scene_update(Runner& runner) {
+        using Vec3 = glimmer::Vector<float, 3>;
+        const int side = runner.options().quick ? 50 : 100;
+        const auto sphere = std::make_shared<glimmer::Sphere<float>>(Vec3{0, 0, 0}, 0.4f);
+        const auto material = glimmer::Material<float>::lambertian(glimmer::Color3f{0.5f, 0.5f, 0.5f});
+        auto at = [](float x, float y) {
+            return glimmer::Transform<float>::from_trs(Vec3{x, y, 0}, glimmer::Quaternion<float>{}, Vec3{1, 1, 1});
+        };
+        glimmer::Scene<float> scene;
+        for (int i = 0; i < side * side; ++i)
+            scene.add_object(glimmer::SceneObject<float>{sphere, material, at(static_cast<float>(i % side),
+                                                                              static_cast<float>(i / side))});
+        scene.build_bvh();
+        const std::size_t frames = 200;
+        int frame = 0;
+        auto animate = [&] {
+            ++frame;
+            for (int k = 0; k < 8; ++k) {
+                const int i = (k * 997 + frame * 31) % (side * side);
+                const float wobble = 0.1f * std::sin(static_cast<float>(frame + k));
+                scene.set_object_transform(static_cast<std::size_t>(i), at(static_cast<float>(i % side) + wobble,
+                                                                           static_cast<float>(i / side)));
+            }
+        };
+        runner.run("scene.update/static/f32", "Mframes/s", 1e-6, [&] {
+            for (std::size_t f = 0; f < frames; ++f) keep(scene.update());
+            return static_cast<double>(frames);
+        });
+        runner.run("scene.update/8_moved/f32", "kframes/s", 1e-3, [&] {
+            for (std::size_t f = 0; f < frames; ++f) {
+                animate();
+                keep(scene.update());
+            }
+            return static_cast<double>(frames);
+        });
+        runner.run("scene.refit_bvh/8_moved/f32", "kframes/s", 1e-3, [&] {
+            for (std::size_t f = 0; f < frames; ++f) {
+                animate();
+                scene.refit_bvh();
+            }
+            return static_cast<double>(frames);
+        });
+        runner.run("scene.build_bvh/8_moved/f32", "kframes/s", 1e-3, [&] {
+            for (std::size_t f = 0; f < frames / 10; ++f) {
+                animate();
+                scene.build_bvh();
+            }
+            return static_cast<double>(frames / 10);
+        });
+    }
+
+    // Shading-term evaluation through the virtual Material properties versus the flat MaterialTable
+    void bench_materials(Runner& runner) {
+        using M = glimmer::Material<float>;
+        std::vector<M> mats{M::lambertian(glimmer::Color3f{0.8f, 0.3f, 0.2f}), M::metal(glimmer::Color3f{0.9f, 0.9f, 0.9f}, 0.2f),
+                            M::glass(glimmer::Color3f{1, 1, 1}, 0.0f, 1.0f), M::lambertian(glimmer::Color3f{1, 1, 1})};
+        mats.back().set_albedo_property(std::make_shared<glimmer::CheckerboardMaterialProperty<float, 3>>(
+            glimmer::Color3f{0.9f, 0.9f, 0.9f}, glimmer::Color3f{0.1f, 0.1f, 0.1f}));
+        glimmer::MaterialTable<float> table;
+        for (const auto& m : mats) table.add(m);
+
+        struct Query {
+            glimmer::MaterialId id;
+            glimmer::Vector<float, 2> uv;
+        };
+        glimmer::Pcg32 rng{11};
+        std::vector<Query> queries(runner.options().quick ? 100'000 : 1'000'000);
+        for (auto& q : queries) {
+            q.id = static_cast<glimmer::MaterialId>(rng.next_u32() % mats.size());
+            q.uv = glimmer::Vector<float, 2>{rng.uniform<float>(), rng.uniform<float>()};
+        }
+        runner.run("material.surface/virtual/f32", "Mevals/s", 1e-6, [&] {
+            float sum = 0.0f;
+            for (const auto& q : queries) sum += glimmer::surface_params(mats[q.id], q.uv).albedo[0];
+            keep(sum);
+            return static_cast<double>(queries.size());
+        });
+        runner.run("material.surface/table/f32", "Mevals/s", 1e-6, [&] {
+            float sum = 0.0f;
+            for (const auto& q : queries) sum += table.surface(q.id, q.uv).albedo[0];
+            keep(sum);
+            return static_cast<double>(queries.size());
+        });
+    }
+
+    // Incoherent texture lookups: nearest-neighbour Image property versus the tiled 8-bit Texture
+    void bench_textures(Runner& runner) {
+        const std::size_t n = runner.options().quick ? 512 : 2048;
+        glimmer::Image<float, 3> img{n, n};
+        glimmer::Pcg32 rng{13};
+        for (std::size_t y = 0; y < n; ++y)
+            for (std::size_t x = 0; x < n; ++x)
+                img(x, y) = glimmer::Color3f{rng.uniform<float>(), rng.uniform<float>(), rng.uniform<float>()};
+        std::vector<glimmer::Vector<float, 2>> uvs(runner.options().quick ? 100'000 : 1'000'000);
+        for (auto& uv : uvs) uv = glimmer::Vector<float, 2>{rng.uniform<float>(), rng.uniform<float>()};
+
+        const glimmer::ImageMaterialProperty<float, 3> image_property{img};
+        runner.run("texture.sample/image_nearest/f32", "Msamples/s", 1e-6, [&] {
+            float sum = 0.0f;
+            for (const auto& uv : uvs) sum += image_property.get(uv)[0];
+            keep(sum);
+            return static_cast<double>(uvs.size());
+        });
+        glimmer::Texture<float> texture{img, glimmer::TextureOptions{.format = glimmer::TexelFormat::srgb8}};
+        for (const auto filter : {glimmer::TextureFilter::nearest, glimmer::TextureFilter::bilinear,
+                                  glimmer::TextureFilter::trilinear}) {
+            texture.set_filter(filter);
+            const char* name = filter == glimmer::TextureFilter::nearest ? "nearest"
+                             : filter == glimmer::TextureFilter::bilinear ? "bilinear" : "trilinear";
+            // A footprint of a few texels, as for a distant or secondary hit
+            const float footprint = 3.0f / static_cast<float>(n);
+            runner.run(std::string{"texture.sample/srgb8_"} + name + "/f32", "Msamples/s", 1e-6, [&] {
+                float sum = 0.0f;
+                for (const auto& uv : uvs) sum += texture.sample(uv, footprint)[0];
+                keep(sum);
+                return static_cast<double>(uvs.size());
+            });
+        }
+    }
+
+    void bench_ppm(Runner& runner) {
+        const std::size_t w = runner.options().quick ? 256 : 1024;
+        const std::size_t h = w;
+        glimmer::Image<float, 3> img{w, h};
+        glimmer::Pcg32 rng{7};
+        for (std::size_t y = 0; y < h; ++y)
+            for (std::size_t x = 0; x < w; ++x)
+                img(x, y) = glimmer::Color3f{rng.uniform<float>(), rng.uniform<float>(), rng.uniform<float>()};
+        const auto path = (std::filesystem::temp_directory_path() / "glimmer_bench.ppm").string();
+        const double bytes = static_cast<double>(3 * w * h);
+
+        std::vector<unsigned char> encoded(3 * w * h);
+        const std::span<const float> channels{img.data()->data(), 3 * w * h};
+        for (const bool gamma : {false, true}) {
+            const glimmer::U8Encoder<float> encoder{glimmer::U8Encoding{gamma ? 2.2 : 1.0, false}};
+            runner.run(std::string{"encode_u8/"} + (gamma ? "gamma" : "linear") + "/f32", "Mvalues/s", 1e-6, [&] {
+                encoder.encode(channels, encoded);
+                keep(encoded);
+                return static_cast<double>(channels.size());
+            });
+        }
+
+        runner.run("save_ppm/f32", "MB/s", 1e-6, [&] {
+            if (!glimmer::save_ppm(img, path)) std::fprintf(stderr, "save_ppm failed: %s\n", path.c_str());
+            return bytes;
+        });
+        runner.run("load_ppm/f32", "MB/s", 1e-6, [&] {
+            const auto loaded = glimmer::load_ppm<float>(path);
+            keep(loaded);
+            return bytes;
+        });
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    // Canned scene: diffuse, glass and metal spheres on a large ground sphere under a sky background
+    template <class T>
+    glimmer::Scene<T> make_render_scene() {
+        using Vec3 = glimmer::Vector<T, 3>;
+        using C3 = glimmer::Color<T, 3>;
+        auto cam = glimmer::Camera<T>::from_look_at(Vec3{0, T{0.5}, 5}, Vec3{0, 0, 0}, Vec3{0, 1, 0},
+                                                    std::numbers::pi_v<T> / 4, T{1}, T{0.1}, T{100});
+        glimmer::Scene<T> scene{cam, C3{T{0.6}, T{0.7}, T{0.9}}};
+        auto add = [&](Vec3 c, T r, const glimmer::Material<T>& m) {
+            scene.add_object(glimmer::SceneObject<T>{std::make_shared<glimmer::Sphere<T>>(c, r), m,
+                                                     glimmer::Transform<T>{}});
+        };
+        add(Vec3{0, -100.6, 0}, T{100}, glimmer::Material<T>::lambertian(C3{T{0.5}, T{0.5}, T{0.5}}));
+        add(Vec3{-1.3, 0, 0}, T{0.6}, glimmer::Material<T>::lambertian(C3{T{0.8}, T{0.3}, T{0.2}}));
+        add(Vec3{0, 0, 0}, T{0.6}, glimmer::Material<T>::glass(C3{1, 1, 1}, T{0}, T{1}));
+        add(Vec3{1.3, 0, 0}, T{0.6}, glimmer::Material<T>::metal(C3{T{0.8}, T{0.8}, T{0.8}}, T{0.2}));
+        for (int i = 0; i < 16; ++i) {
+            const T a = static_cast<T>(i) * std::numbers::pi_v<T> / T{8};
+            add(Vec3{T{2.5} * std::cos(a), T{-0.45}, T{2.5} * std::sin(a) - T{1}}, T{0.15},
+                glimmer::Material<T>::lambertian(C3{T{0.2}, T{0.6}, T{0.3}}));
+        }
+        scene.build_bvh();
+        return scene;
+    }
+
+    // Camera rays for every pixel of a frame: per-ray Camera::generate_ray against the precomputed generator
+    template <class T>
+    void bench_camera(Runner& runner) {
+        const auto scene = make_render_scene<T>();
+        const auto& cam = scene.camera();
+        const std::size_t size = runner.options().quick ? 128 : 512;
+        const double rays = static_cast<double>(size * size);
+        const std::string sfx = type_suffix<T>();
+        constexpr std::size_t N = glimmer::default_packet_size;
+        glimmer::RayPacket<T, N> packet;
+        runner.run("camera.generate_ray" + sfx, "Mrays/s", 1e-6, [&] {
+            for (std::size_t y = 0; y < size; ++y)
+                for (std::size_t x0 = 0; x0 < size; x0 += N) {
+                    for (std::size_t i = 0; i < N; ++i)
+                        packet.set(i, cam.generate_ray(static_cast<T>(x0 + i), static_cast<T>(y), size, size));
+                    packet.count = N;
+                    keep(packet);
+                }
+            return rays;
+        });
+        runner.run("camera.ray_generator" + sfx, "Mrays/s", 1e-6, [&] {
+            const glimmer::CameraRayGenerator<T> gen{cam, size, size};
+            for (std::size_t y = 0; y < size; ++y)
+                for (std::size_t x0 = 0; x0 < size; x0 += N) {
+                    gen.row(packet, x0, y, N);
+                    keep(packet);
+                }
+            return rays;
+        });
+    }
+
+    template <class T>
+    void bench_render(Runner& runner) {
+        const auto scene = make_render_scene<T>();
+        const std::size_t size = runner.options().quick ? 48 : 128;
+        const std::size_t spp = runner.options().quick ? 4 : 16;
+        const double samples = static_cast<double>(size * size * spp);
+        glimmer::Image<T, 3> img{size, size};
+        const std::string sfx = type_suffix<T>();
+
+        glimmer::RendererPathTracer<T> pt{spp, 5, 1};
+        runner.run("path_tracer.render" + sfx, "Msamples/s", 1e-6, [&] {
+            pt.render(scene, img, size, size);
+            keep(img);
+            return samples;
+        });
+        glimmer::RendererWavefront<T> wf{spp, 5, 1};
+        runner.run("wavefront.render" + sfx, "Msamples/s", 1e-6, [&] {
+            wf.render(scene, img, size, size);
+            keep(img);
+            return samples;
+        });
+    }
+
+    void bench_denoise(Runner& runner) {
+        using T = float;
+        const auto scene = make_render_scene<T>();
+        const std::size_t size = runner.options().quick ? 64 : 256;
+        glimmer::Image<T,3> noisy;
+        glimmer::AovImages<T> aovs;
+        glimmer::RendererPathTracer<T>{4, 5, 1}.render(scene, noisy, aovs, size, size);
+        glimmer::Image<T,3> out;
+        const glimmer::AtrousDenoiser<T> denoiser;
+        runner.run("denoise.atrous/f32", "Mpixels/s", 1e-6, [&] {
+            denoiser.apply(noisy, aovs, out);
+            keep(out);
+            return static_cast<double>(size * size);
+        });
+    }
+
+    // A short camera move written to PPM files: one render() and save_ppm() per frame against a RenderSession,
+    // which writes frame N while frame N + 1 renders
+    void bench_session(Runner& runner) {
+        using T = float;
+        auto scene = make_render_scene<T>();
+        const auto cam = scene.camera();
+        const std::size_t size = runner.options().quick ? 96 : 256;
+        const std::size_t frames = 8;
+        const auto pattern = (std::filesystem::temp_directory_path() / "glimmer_bench_frame_#.ppm").string();
+        auto camera = [&](std::size_t f) {
+            const T x = T{0.05} * static_cast<T>(f);
+            return glimmer::Camera<T>::from_look_at(glimmer::Vector<T,3>{x, T{0.5}, 5}, glimmer::Vector<T,3>{0, 0, 0},
+                                                    glimmer::Vector<T,3>{0, 1, 0}, cam.fov_y(), cam.aspect(),
+                                                    cam.z_near(), cam.z_far());
+        };
+        const glimmer::RendererPathTracer<T> pt{2, 4, 1};
+
+        runner.run("frames.sequential/f32", "frames/s", 1.0, [&] {
+            glimmer::Image<T,3> img;
+            for (std::size_t f = 0; f < frames; ++f) {
+                scene.set_camera(camera(f));
+                pt.render(scene, img, size, size);
+                if (!glimmer::save_ppm(img, glimmer::frame_path(pattern, f))) std::fprintf(stderr, "save failed\n");
+            }
+            return static_cast<double>(frames);
+        });
+        runner.run("frames.session/f32", "frames/s", 1.0, [&] {
+            glimmer::RenderSession<T> session{scene, pt, size, size, glimmer::ppm_sequence_output<T>(pattern)};
+            for (std::size_t f = 0; f < frames; ++f) {
+                glimmer::FrameUpdate<T> update;
+                update.camera = camera(f);
+                session.render_frame(update);
+            }
+            if (!session.finish()) std::fprintf(stderr, "save failed\n");
+            return static_cast<double>(frames);
+        });
+        std::error_code ec;
+        for (std::size_t f = 0; f < frames; ++f) std::filesystem::remove(glimmer::frame_path(pattern, f), ec);
+    }
+
+    std::string json_escape(std::string_view s) {
+        std::string out;
+        for (const char c : s) {
+            if (c == '"' || c == '\\') out.push_back('\\');
+            out.push_back(c);
+        }
+        return out;
+    }
+
+    void write_json(std::ostream& out, const Runner& runner) {
+        const auto& o = runner.options();
+        out << "{\n  \"suite\": \"glimmer_bench\",\n  \"schema\": 1,\n";
+        out << "  \"config\": {\"quick\": " << (o.quick ? "true" : "false") << ", \"repetitions\": " << o.repetitions
+            << ", \"threads\": " << glimmer::ThreadPool::shared()->concurrency()
+            << ", \"simd_kernels\": " << (glimmer::simd_kernels_enabled ? "true" : "false") << "},\n";
+        out << "  \"results\": [";
+        const auto& results = runner.results();
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto& r = results[i];
+            out << (i ? ",\n" : "\n") << "    {\"name\": \"" << json_escape(r.name) << "\", \"unit\": \""
+                << json_escape(r.unit) << "\", \"value\": " << r.median << ", \"min\": " << r.min
+                << ", \"max\": " << r.max << ", \"items\": " << r.items << ", \"repetitions\": " << r.repetitions
+                << ", \"allocations\": " << r.allocations << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    bool parse_args(int argc, char** argv, Options& o) {
+        bool repetitions_given = false;
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg{argv[i]};
+            auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+            if (arg == "--quick") {
+                o.quick = true;
+            } else if (arg == "--repetitions") {
+                const char* v = value();
+                if (!v) return false;
+                const std::string_view text{v};
+                std::size_t n = 0;
+                const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), n);
+                if (ec != std::errc{} || ptr != text.data() + text.size()) return false;
+                o.repetitions = std::max<std::size_t>(1, n);
+                repetitions_given = true;
+            } else if (arg == "--filter") {
+                const char* v = value();
+                if (!v) return false;
+                o.filter = v;
+            } else if (arg == "--json") {
+                const char* v = value();
+                if (!v) return false;
+                o.json_path = v;
+            } else {
+                return false;
+            }
+        }
+        // --quick only lowers the default; an explicit --repetitions wins
+        if (o.quick && !repetitions_given) o.repetitions = 3;
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_args(argc, argv, options)) {
+        std::cerr << "usage: glimmer_bench [--quick] [--repetitions N] [--filter SUBSTRING] [--json PATH]\n";
+        return 2;
+    }
+
+    Runner runner{options};
+    bench_intersections<double>(runner);
+    bench_intersections<float>(runner);
+    bench_obj(runner);
+    bench_mesh_layouts(runner);
+    bench_instances(runner);
+    bench_scene_update(runner);
+    bench_materials(runner);
+    bench_textures(runner);
+    bench_ppm(runner);
+    bench_camera<double>(runner);
+    bench_camera<float>(runner);
+    bench_render<double>(runner);
+    bench_render<float>(runner);
+    bench_denoise(runner);
+    bench_session(runner);
+
+    if (options.json_path.empty()) {
+        write_json(std::cout, runner);
+    } else {
+        std::ofstream f{options.json_path};
+        if (!f) {
+            std::cerr << "cannot write " << options.json_path << "\n";
+            return 1;
+        }
+        write_json(f, runner);
+    }
+    return 0;
+}
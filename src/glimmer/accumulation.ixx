@@ -0,0 +1,167 @@
+module;
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+export module glimmer.accumulation;
+
+import glimmer.vector;
+import glimmer.color;
+import glimmer.image;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing a per-pixel sample accumulation buffer for progressive rendering.
+     */
+
+    /**
+     * @brief Running per-pixel sample sums with luminance statistics.
+     * @tparam T arithmetic scalar type (float/double recommended)
+     * @details For each pixel the buffer stores the sum of RGB samples, the sum and sum of squares of their
+     * luminance, and the sample count. This is enough to resolve the current estimate (mean) and to estimate its
+     * noise (standard error of the mean luminance), which drives adaptive sampling. Pixels are independent, so
+     * different threads may add samples to disjoint pixels concurrently.
+     */
+    export template <Arithmetic T>
+    class AccumulationBuffer {
+    public:
+        using Color3 = Color<T,3>;
+        using size_type = std::size_t;
+
+        /** @brief Constructs an empty buffer. */
+        AccumulationBuffer() = default;
+
+        /** @brief Constructs a zeroed buffer of the given dimensions. */
+        AccumulationBuffer(size_type w, size_type h) { resize(w, h); }
+
+        /** @brief Buffer width. */
+        [[nodiscard]] size_type width() const noexcept { return w_; }
+        /** @brief Buffer height. */
+        [[nodiscard]] size_type height() const noexcept { return h_; }
+        /** @brief Returns true if the buffer has no pixels. */
+        [[nodiscard]] bool empty() const noexcept { return count_.empty(); }
+
+        /** @brief Resizes the buffer and discards all samples. */
+        void resize(size_type w, size_type h) {
+            w_ = w; h_ = h;
+            sum_.assign(w * h, Color3{T{0},T{0},T{0}});
+            lum_sum_.assign(w * h, T{0});
+            lum_sq_sum_.assign(w * h, T{0});
+            count_.assign(w * h, 0);
+        }
+
+        /** @brief Discards all samples, keeping the dimensions. */
+        void clear() { resize(w_, h_); }
+
+        /** @brief Adds one radiance sample to pixel (x,y). */
+        void add_sample(size_type x, size_type y, const Color3& c) noexcept {
+            const size_type i = y * w_ + x;
+            const T l = luminance(c);
+            sum_[i] += c;
+            lum_sum_[i] += l;
+            lum_sq_sum_[i] += l * l;
+            ++count_[i];
+        }
+
+        /** @brief Raw statistics of one pixel, as kept by the buffer; see pixel_sums() and add_sums(). */
+        struct PixelSums {
+            Color3 sum{T{0},T{0},T{0}};
+            T lum_sum{0};
+            T lum_sq_sum{0};
+            std::uint32_t count{0};
+        };
+
+        /** @brief Statistics accumulated at pixel (x,y). */
+        [[nodiscard]] PixelSums pixel_sums(size_type x, size_type y) const noexcept {
+            const size_type i = y * w_ + x;
+            return PixelSums{sum_[i], lum_sum_[i], lum_sq_sum_[i], count_[i]};
+        }
+
+        /** @brief Adds statistics gathered elsewhere (another buffer, a file) to pixel (x,y). */
+        void add_sums(size_type x, size_type y, const PixelSums& p) noexcept {
+            const size_type i = y * w_ + x;
+            sum_[i] += p.sum;
+            lum_sum_[i] += p.lum_sum;
+            lum_sq_sum_[i] += p.lum_sq_sum;
+            count_[i] += p.count;
+        }
+
+        /**
+         * @brief Adds all samples of other to the region starting at pixel (x0,y0).
+         * @details Sums and counts add, so merging buffers that hold disjoint samples of the same pixels gives
+         * the buffer that would have received all of them (up to rounding).
+         * @throws std::out_of_range if other does not fit inside this buffer at (x0,y0)
+         */
+        void merge(const AccumulationBuffer& other, size_type x0 = 0, size_type y0 = 0) {
+            if (x0 > w_ || y0 > h_ || other.w_ > w_ - x0 || other.h_ > h_ - y0) {
+                throw std::out_of_range("AccumulationBuffer::merge region out of range");
+            }
+            for (size_type y = 0; y < other.h_; ++y)
+                for (size_type x = 0; x < other.w_; ++x) add_sums(x0 + x, y0 + y, other.pixel_sums(x, y));
+        }
+
+        /** @brief Number of samples accumulated at pixel (x,y). */
+        [[nodiscard]] std::uint32_t samples(size_type x, size_type y) const noexcept { return count_[y * w_ + x]; }
+
+        /** @brief Sum of sample counts over all pixels. */
+        [[nodiscard]] std::uint64_t total_samples() const noexcept {
+            std::uint64_t n = 0;
+            for (auto c : count_) n += c;
+            return n;
+        }
+
+        /** @brief Current estimate (sample mean) at pixel (x,y); black if no samples. */
+        [[nodiscard]] Color3 mean(size_type x, size_type y) const noexcept {
+            const size_type i = y * w_ + x;
+            if (count_[i] == 0) return Color3{T{0},T{0},T{0}};
+            return sum_[i] / static_cast<T>(count_[i]);
+        }
+
+        /**
+         * @brief Unbiased sample variance of the luminance at pixel (x,y).
+         * @return variance, or 0 with fewer than two samples
+         */
+        [[nodiscard]] T luminance_variance(size_type x, size_type y) const noexcept {
+            const size_type i = y * w_ + x;
+            const std::uint32_t n = count_[i];
+            if (n < 2) return T{0};
+            const T nt = static_cast<T>(n);
+            const T var = (lum_sq_sum_[i] - lum_sum_[i] * lum_sum_[i] / nt) / (nt - T{1});
+            return std::max<T>(var, T{0});
+        }
+
+        /**
+         * @brief Relative noise of the pixel estimate: standard error of the mean luminance over the mean.
+         * @details The mean is floored at 1e-3 so that near-black pixels are judged by absolute error. With fewer
+         * than two samples no estimate exists and 1 is returned.
+         */
+        [[nodiscard]] T relative_error(size_type x, size_type y) const noexcept {
+            const size_type i = y * w_ + x;
+            const std::uint32_t n = count_[i];
+            if (n < 2) return T{1};
+            const T nt = static_cast<T>(n);
+            const T std_err = static_cast<T>(std::sqrt(static_cast<double>(luminance_variance(x, y) / nt)));
+            const T m = std::max<T>(lum_sum_[i] / nt, static_cast<T>(1e-3));
+            return std_err / m;
+        }
+
+        /** @brief Writes the current estimate of every pixel to out (resizes if needed). */
+        void resolve(Image<T,3>& out) const {
+            if (out.width() != w_ || out.height() != h_) out.resize(w_, h_);
+            for (size_type y = 0; y < h_; ++y)
+                for (size_type x = 0; x < w_; ++x) out(x, y) = mean(x, y);
+        }
+
+    private:
+        size_type w_{0};
+        size_type h_{0};
+        std::vector<Color3> sum_{};
+        std::vector<T> lum_sum_{};
+        std::vector<T> lum_sq_sum_{};
+        std::vector<std::uint32_t> count_{};
+    };
+}
@@ -0,0 +1,278 @@
+module;
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+// Batch kernels for float use SSE/NEON unless GLIMMER_NO_SIMD is defined (same switch as glimmer.vector)
+#if !defined(GLIMMER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define GLIMMER_SIMD_SSE 1
+#include <immintrin.h>
+#elif !defined(GLIMMER_NO_SIMD) && defined(__ARM_NEON) && defined(__aarch64__)
+#define GLIMMER_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+export module glimmer.affine;
+
+import glimmer.vector;
+import glimmer.matrix;
+import glimmer.aabb;
+
+namespace glimmer
+{
+    /**
+     * @file
+     * @brief C++23 module providing a compact 3x4 affine matrix for instance transforms.
+     */
+
+    /**
+     * @brief Affine map x -> A x + t stored as the top three rows of a 4x4 matrix (12 scalars, row-major).
+     * @tparam T arithmetic scalar type
+     * @details Half the size of a Transform's 4x4 pair per matrix and without the homogeneous row, so applying it
+     * to a point or direction costs 9 multiplies. Used for instances, where millions of transforms are stored.
+     */
+    export template <Arithmetic T>
+    class Affine3
+    {
+    public:
+        /** @brief Identity map. */
+        constexpr Affine3() noexcept : m_{T{1}, T{0}, T{0}, T{0}, T{0}, T{1}, T{0}, T{0}, T{0}, T{0}, T{1}, T{0}} {}
+        /** @brief From the 12 entries of rows 0..2, row-major. */
+        explicit constexpr Affine3(const std::array<T, 12>& rows) noexcept : m_{rows} {}
+
+        /** @brief Top three rows of m (the last row is assumed to be 0 0 0 1). */
+        [[nodiscard]] static constexpr Affine3 from_matrix(const Matrix<T, 4, 4>& m) noexcept
+        {
+            Affine3 a;
+            for (std::size_t r = 0; r < 3; ++r)
+                for (std::size_t c = 0; c < 4; ++c) a(r, c) = m(r, c);
+            return a;
+        }
+
+        /** @brief Equivalent homogeneous 4x4 matrix. */
+        [[nodiscard]] constexpr Matrix<T, 4, 4> matrix() const noexcept
+        {
+            Matrix<T, 4, 4> m{};
+            for (std::size_t r = 0; r < 3; ++r)
+                for (std::size_t c = 0; c < 4; ++c) m(r, c) = (*this)(r, c);
+            m(3, 3) = T{1};
+            return m;
+        }
+
+        /** @brief Entry (r, c) with r < 3 and c < 4 (column 3 is the translation). */
+        [[nodiscard]] constexpr T operator()(std::size_t r, std::size_t c) const noexcept { return m_[r * 4 + c]; }
+        /** @brief Mutable entry (r, c). */
+        [[nodiscard]] constexpr T& operator()(std::size_t r, std::size_t c) noexcept { return m_[r * 4 + c]; }
+
+        /** @brief A p + t. */
+        [[nodiscard]] constexpr Vector<T, 3> apply_point(const Vector<T, 3>& p) const noexcept
+        {
+            Vector<T, 3> r{};
+            r[0] = m_[0] * p[0] + m_[1] * p[1] + m_[2] * p[2] + m_[3];
+            r[1] = m_[4] * p[0] + m_[5] * p[1] + m_[6] * p[2] + m_[7];
+            r[2] = m_[8] * p[0] + m_[9] * p[1] + m_[10] * p[2] + m_[11];
+            return r;
+        }
+
+        /** @brief A v (no translation). */
+        [[nodiscard]] constexpr Vector<T, 3> apply_direction(const Vector<T, 3>& v) const noexcept
+        {
+            Vector<T, 3> r{};
+            r[0] = m_[0] * v[0] + m_[1] * v[1] + m_[2] * v[2];
+            r[1] = m_[4] * v[0] + m_[5] * v[1] + m_[6] * v[2];
+            r[2] = m_[8] * v[0] + m_[9] * v[1] + m_[10] * v[2];
+            return r;
+        }
+
+        /**
+         * @brief A^T v.
+         * @details Applied with the inverse map, this transforms normals (inverse transpose) without storing a
+         * separate normal matrix.
+         */
+        [[nodiscard]] constexpr Vector<T, 3> apply_transposed(const Vector<T, 3>& v) const noexcept
+        {
+            Vector<T, 3> r{};
+            r[0] = m_[0] * v[0] + m_[4] * v[1] + m_[8] * v[2];
+            r[1] = m_[1] * v[0] + m_[5] * v[1] + m_[9] * v[2];
+            r[2] = m_[2] * v[0] + m_[6] * v[1] + m_[10] * v[2];
+            return r;
+        }
+
+        /**
+         * @brief Maps points in bulk: out[i] = A in[i] + t.
+         * @details in and out must have the same size and may be the same span. For float the points are
+         * processed four at a time with SSE/NEON (deinterleaved into x/y/z registers, nine
+         * multiply-adds, interleaved back); the remainder and other types use a scalar loop.
+         */
+        void apply_points(std::span<const Vector<T, 3>> in, std::span<Vector<T, 3>> out) const noexcept
+        {
+            apply_rest_<true>(in, out, apply_batch_<true>(in, out));
+        }
+
+        /** @brief Maps directions in bulk: out[i] = A in[i] (see apply_points()). */
+        void apply_directions(std::span<const Vector<T, 3>> in, std::span<Vector<T, 3>> out) const noexcept
+        {
+            apply_rest_<false>(in, out, apply_batch_<false>(in, out));
+        }
+
+        /** @brief Determinant of the linear part A. */
+        [[nodiscard]] constexpr T determinant() const noexcept
+        {
+            return m_[0] * (m_[5] * m_[10] - m_[6] * m_[9]) - m_[1] * (m_[4] * m_[10] - m_[6] * m_[8]) +
+                   m_[2] * (m_[4] * m_[9] - m_[5] * m_[8]);
+        }
+
+        /**
+         * @brief Closed-form inverse: A^-1 from the adjugate, translation -A^-1 t.
+         * @throws std::domain_error if A is singular
+         */
+        [[nodiscard]] Affine3 inverse() const
+        {
+            const T d = determinant();
+            if (d == T{}) throw std::domain_error("singular matrix");
+            const T s = T{1} / d;
+            Affine3 r;
+            r.m_[0] = (m_[5] * m_[10] - m_[6] * m_[9]) * s;
+            r.m_[1] = (m_[2] * m_[9] - m_[1] * m_[10]) * s;
+            r.m_[2] = (m_[1] * m_[6] - m_[2] * m_[5]) * s;
+            r.m_[4] = (m_[6] * m_[8] - m_[4] * m_[10]) * s;
+            r.m_[5] = (m_[0] * m_[10] - m_[2] * m_[8]) * s;
+            r.m_[6] = (m_[2] * m_[4] - m_[0] * m_[6]) * s;
+            r.m_[8] = (m_[4] * m_[9] - m_[5] * m_[8]) * s;
+            r.m_[9] = (m_[1] * m_[8] - m_[0] * m_[9]) * s;
+            r.m_[10] = (m_[0] * m_[5] - m_[1] * m_[4]) * s;
+            const Vector<T, 3> t = r.apply_direction(Vector<T, 3>{m_[3], m_[7], m_[11]});
+            r.m_[3] = -t[0];
+            r.m_[7] = -t[1];
+            r.m_[11] = -t[2];
+            return r;
+        }
+
+        /** @brief Composition: rhs first, then this. */
+        [[nodiscard]] constexpr Affine3 operator*(const Affine3& rhs) const noexcept
+        {
+            Affine3 r;
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                for (std::size_t j = 0; j < 4; ++j)
+                {
+                    T v = j == 3 ? (*this)(i, 3) : T{0};
+                    for (std::size_t k = 0; k < 3; ++k) v += (*this)(i, k) * rhs(k, j);
+                    r(i, j) = v;
+                }
+            }
+            return r;
+        }
+
+        /**
+         * @brief Bounds of a box mapped by this transform.
+         * @details Projects the box's half extents through |A| instead of transforming its eight corners.
+         */
+        [[nodiscard]] AABB<T> apply_bounds(const AABB<T>& box) const noexcept
+        {
+            if (box.empty()) return AABB<T>{};
+            const Vector<T, 3> c = apply_point((box.min() + box.max()) * static_cast<T>(0.5));
+            const Vector<T, 3> h = (box.max() - box.min()) * static_cast<T>(0.5);
+            Vector<T, 3> e{};
+            for (std::size_t r = 0; r < 3; ++r)
+            {
+                e[r] = std::abs(m_[r * 4]) * h[0] + std::abs(m_[r * 4 + 1]) * h[1] + std::abs(m_[r * 4 + 2]) * h[2];
+            }
+            return AABB<T>{c - e, c + e};
+        }
+
+        [[nodiscard]] friend constexpr bool operator==(const Affine3&, const Affine3&) noexcept = default;
+
+    private:
+        // Scalar part of the batch kernels from element first on, with the coefficients held in locals (out may
+        // alias in, so they would otherwise be reloaded after every store)
+        template <bool Translate>
+        void apply_rest_(std::span<const Vector<T, 3>> in, std::span<Vector<T, 3>> out, std::size_t first) const noexcept
+        {
+            const std::array<T, 12> m = m_;
+            const T tx = Translate ? m[3] : T{0}, ty = Translate ? m[7] : T{0}, tz = Translate ? m[11] : T{0};
+            for (std::size_t i = first; i < in.size(); ++i)
+            {
+                const T x = in[i][0], y = in[i][1], z = in[i][2];
+                Vector<T, 3>& r = out[i];
+                r[0] = m[0] * x + m[1] * y + m[2] * z + tx;
+                r[1] = m[4] * x + m[5] * y + m[6] * z + ty;
+                r[2] = m[8] * x + m[9] * y + m[10] * z + tz;
+            }
+        }
+
+        // SIMD part of the batch kernels; returns how many leading elements were written
+        template <bool Translate>
+        std::size_t apply_batch_(std::span<const Vector<T, 3>> in, std::span<Vector<T, 3>> out) const noexcept
+        {
+#if defined(GLIMMER_SIMD_SSE) || defined(GLIMMER_SIMD_NEON)
+            if constexpr (std::is_same_v<T, float> && sizeof(Vector<float, 3>) == 3 * sizeof(float))
+            {
+                if (in.empty()) return 0;
+                const std::size_t n = in.size() & ~std::size_t{3};
+                const float* src = in.data()->data();
+                float* dst = out.data()->data();
+#if defined(GLIMMER_SIMD_SSE)
+                __m128 m[12];
+                for (std::size_t k = 0; k < 12; ++k) m[k] = _mm_set1_ps(m_[k]);
+                for (std::size_t i = 0; i < n; i += 4, src += 12, dst += 12)
+                {
+                    // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+                    const __m128 a = _mm_loadu_ps(src);
+                    const __m128 b = _mm_loadu_ps(src + 4);
+                    const __m128 c = _mm_loadu_ps(src + 8);
+                    const __m128 x01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 3, 0));  // x0 x1 y1 z1
+                    const __m128 x23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 3, 2));  // x2 y2 z2 x3
+                    const __m128 yz01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1)); // y0 z0 y1 z1
+                    const __m128 yz23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 0, 3, 3)); // y2 y2 z2 y3
+                    const __m128 z23 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));  // z2 z2 z3 z3
+                    const __m128 x = _mm_shuffle_ps(x01, x23, _MM_SHUFFLE(3, 0, 1, 0));
+                    const __m128 y = _mm_shuffle_ps(yz01, yz23, _MM_SHUFFLE(3, 0, 2, 0));
+                    const __m128 z = _mm_shuffle_ps(yz01, z23, _MM_SHUFFLE(2, 0, 3, 1));
+                    __m128 r[3];
+                    for (std::size_t row = 0; row < 3; ++row)
+                    {
+                        __m128 v = _mm_add_ps(_mm_mul_ps(m[row * 4], x), _mm_mul_ps(m[row * 4 + 1], y));
+                        v = _mm_add_ps(v, _mm_mul_ps(m[row * 4 + 2], z));
+                        if constexpr (Translate) v = _mm_add_ps(v, m[row * 4 + 3]);
+                        r[row] = v;
+                    }
+                    const __m128 xy01 = _mm_unpacklo_ps(r[0], r[1]);                          // X0 Y0 X1 Y1
+                    const __m128 zx01 = _mm_shuffle_ps(r[2], r[0], _MM_SHUFFLE(1, 1, 0, 0));   // Z0 Z0 X1 X1
+                    const __m128 yz1 = _mm_shuffle_ps(r[1], r[2], _MM_SHUFFLE(1, 1, 1, 1));    // Y1 Y1 Z1 Z1
+                    const __m128 xy23 = _mm_unpackhi_ps(r[0], r[1]);                          // X2 Y2 X3 Y3
+                    const __m128 zx23 = _mm_shuffle_ps(r[2], r[0], _MM_SHUFFLE(3, 3, 2, 2));   // Z2 Z2 X3 X3
+                    const __m128 yz3 = _mm_shuffle_ps(r[1], r[2], _MM_SHUFFLE(3, 3, 3, 3));    // Y3 Y3 Z3 Z3
+                    _mm_storeu_ps(dst, _mm_shuffle_ps(xy01, zx01, _MM_SHUFFLE(2, 0, 1, 0)));
+                    _mm_storeu_ps(dst + 4, _mm_shuffle_ps(yz1, xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+                    _mm_storeu_ps(dst + 8, _mm_shuffle_ps(zx23, yz3, _MM_SHUFFLE(2, 0, 2, 0)));
+                }
+#else
+                for (std::size_t i = 0; i < n; i += 4, src += 12, dst += 12)
+                {
+                    const float32x4x3_t p = vld3q_f32(src);
+                    float32x4x3_t r;
+                    for (std::size_t row = 0; row < 3; ++row)
+                    {
+                        float32x4_t v = Translate ? vdupq_n_f32(m_[row * 4 + 3]) : vdupq_n_f32(0.0f);
+                        v = vfmaq_n_f32(v, p.val[0], m_[row * 4]);
+                        v = vfmaq_n_f32(v, p.val[1], m_[row * 4 + 1]);
+                        r.val[row] = vfmaq_n_f32(v, p.val[2], m_[row * 4 + 2]);
+                    }
+                    vst3q_f32(dst, r);
+                }
+#endif
+                return n;
+            }
+#endif
+            (void)in;
+            (void)out;
+            return 0;
+        }
+
+        std::array<T, 12> m_;
+    };
+}
@@ -0,0 +1,42 @@
+module;
+#include <cstddef>
+
+export module glimmer.aov;
+
+import glimmer.vector;
+import glimmer.color;
+import glimmer.image;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module defining the auxiliary output (AOV) images a renderer can write next to the beauty image.
+     */
+
+    /**
+     * @brief First-hit feature images of a render, averaged over each pixel's samples.
+     * @tparam T arithmetic scalar type (float/double recommended)
+     * @details albedo is the material albedo at the first hit, normal the world-space shading normal facing the
+     * camera, and depth the distance from the camera to the first hit. Pixels whose samples miss the scene are
+     * 0 in all three. Because the features are anti-aliased but carry no lighting noise, they guide edge-aware
+     * filters such as AtrousDenoiser.
+     */
+    export template <Arithmetic T>
+    struct AovImages {
+        Image<T,3> albedo{};
+        Image<T,3> normal{};
+        Image<T,1> depth{};
+
+        /** @brief Resizes all images to w x h and zeroes them. */
+        void resize(std::size_t w, std::size_t h) {
+            albedo.resize(w, h);
+            normal.resize(w, h);
+            depth.resize(w, h);
+        }
+
+        /** @brief Common width of the images. */
+        [[nodiscard]] std::size_t width() const noexcept { return albedo.width(); }
+        /** @brief Common height of the images. */
+        [[nodiscard]] std::size_t height() const noexcept { return albedo.height(); }
+    };
+}
@@ -0,0 +1,180 @@
+module;
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+export module glimmer.arena;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing bump-pointer arenas for short-lived scratch memory, with one arena per thread.
+     */
+
+    /**
+     * @brief Bump-pointer allocator over a list of reusable memory blocks.
+     * @details Allocation advances an offset within the current block and never frees individual allocations.
+     * Memory is reclaimed in bulk by rewinding to a mark() or by reset(); blocks are kept, so once an arena has
+     * grown to the peak size of a workload, repeating the workload performs no heap allocations.
+     *
+     * Objects placed in an arena are not destroyed by it. Use it for trivially destructible data or for
+     * containers whose destructors do not release memory (ArenaVector).
+     */
+    export class Arena {
+    public:
+        /** @brief Default size of newly reserved blocks. */
+        static constexpr std::size_t default_block_size = std::size_t{64} << 10;
+
+        /** @brief Position in an arena returned by mark() and accepted by rewind(). */
+        struct Marker {
+            std::size_t block{0};
+            std::size_t offset{0};
+        };
+
+        explicit Arena(std::size_t block_size = default_block_size) noexcept
+            : block_size_{std::max<std::size_t>(block_size, 64)} {}
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+        Arena(Arena&&) noexcept = default;
+        Arena& operator=(Arena&&) noexcept = default;
+
+        /**
+         * @brief Returns bytes of uninitialized memory aligned to align (a power of two).
+         * @throws std::bad_alloc if a new block cannot be reserved
+         */
+        [[nodiscard]] void* allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t)) {
+            while (block_ < blocks_.size()) {
+                Block& b = blocks_[block_];
+                const std::size_t start = align_up_(reinterpret_cast<std::uintptr_t>(b.data.get()) + offset_, align) -
+                                          reinterpret_cast<std::uintptr_t>(b.data.get());
+                if (start + bytes <= b.size) {
+                    offset_ = start + bytes;
+                    return b.data.get() + start;
+                }
+                // Reuse the next block if the request fits there; otherwise insert a big enough one
+                if (block_ + 1 < blocks_.size() && bytes + align <= blocks_[block_ + 1].size) {
+                    ++block_;
+                    offset_ = 0;
+                    continue;
+                }
+                break;
+            }
+            const std::size_t size = std::max(block_size_, bytes + align);
+            const std::size_t at = blocks_.empty() ? 0 : block_ + 1;
+            blocks_.insert(blocks_.begin() + static_cast<std::ptrdiff_t>(at),
+                           Block{std::unique_ptr<std::byte[]>{new std::byte[size]}, size});
+            reserved_ += size;
+            block_ = at;
+            offset_ = 0;
+            return allocate(bytes, align);
+        }
+
+        /** @brief Uninitialized storage for n objects of type E. */
+        template <class E>
+        [[nodiscard]] E* allocate_array(std::size_t n) {
+            return static_cast<E*>(allocate(n * sizeof(E), alignof(E)));
+        }
+
+        /** @brief Current position; pass to rewind() to release everything allocated afterwards. */
+        [[nodiscard]] Marker mark() const noexcept { return Marker{block_, offset_}; }
+
+        /** @brief Releases all allocations made after m (which must come from this arena). */
+        void rewind(const Marker& m) noexcept {
+            block_ = m.block;
+            offset_ = m.offset;
+        }
+
+        /** @brief Releases all allocations, keeping the blocks for reuse. */
+        void reset() noexcept { rewind(Marker{}); }
+
+        /** @brief Frees all blocks. */
+        void release() noexcept {
+            blocks_.clear();
+            reset();
+            reserved_ = 0;
+        }
+
+        /** @brief Bytes of heap memory held in blocks. */
+        [[nodiscard]] std::size_t bytes_reserved() const noexcept { return reserved_; }
+        /** @brief Number of blocks reserved from the heap. */
+        [[nodiscard]] std::size_t block_count() const noexcept { return blocks_.size(); }
+
+    private:
+        struct Block {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t size;
+        };
+
+        [[nodiscard]] static constexpr std::uintptr_t align_up_(std::uintptr_t p, std::size_t align) noexcept {
+            return (p + (align - 1)) & ~static_cast<std::uintptr_t>(align - 1);
+        }
+
+        std::vector<Block> blocks_{};
+        std::size_t block_{0};
+        std::size_t offset_{0};
+        std::size_t block_size_{default_block_size};
+        std::size_t reserved_{0};
+    };
+
+    /**
+     * @brief Arena owned by the calling thread.
+     * @details The render threads of a ThreadPool are persistent, so their arenas keep their blocks from one
+     * render to the next. Scratch users bracket their allocations with an ArenaScope.
+     */
+    export [[nodiscard]] inline Arena& thread_arena() noexcept {
+        thread_local Arena arena;
+        return arena;
+    }
+
+    /**
+     * @brief Rewinds an arena to its position at construction when destroyed.
+     * @details Scopes nest. A container allocated in an outer scope must not grow while an inner scope is
+     * active, since its new storage would be released by the inner scope; reserve capacity up front instead.
+     */
+    export class ArenaScope {
+    public:
+        explicit ArenaScope(Arena& arena = thread_arena()) noexcept : arena_{arena}, mark_{arena.mark()} {}
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+        ~ArenaScope() { arena_.rewind(mark_); }
+
+        [[nodiscard]] Arena& arena() const noexcept { return arena_; }
+
+    private:
+        Arena& arena_;
+        Arena::Marker mark_;
+    };
+
+    /**
+     * @brief Standard allocator drawing from an Arena; deallocation is a no-op.
+     * @tparam E element type
+     */
+    export template <class E>
+    class ArenaAllocator {
+    public:
+        using value_type = E;
+
+        ArenaAllocator(Arena& arena = thread_arena()) noexcept : arena_{&arena} {}
+        template <class U>
+        ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_{&other.arena()} {}
+
+        [[nodiscard]] E* allocate(std::size_t n) { return arena_->allocate_array<E>(n); }
+        void deallocate(E*, std::size_t) noexcept {}
+
+        [[nodiscard]] Arena& arena() const noexcept { return *arena_; }
+
+        template <class U>
+        [[nodiscard]] bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena_ == &other.arena(); }
+
+    private:
+        Arena* arena_;
+    };
+
+    /** @brief std::vector whose storage lives in an Arena (the calling thread's by default). */
+    export template <class E>
+    using ArenaVector = std::vector<E, ArenaAllocator<E>>;
+}
@@ -0,0 +1,283 @@
+module;
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <utility>
+
+export module glimmer.bsdf;
+
+import glimmer.vector;
+import glimmer.color;
+import glimmer.ray;
+import glimmer.material;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module with the surface scattering model shared by the path-tracing renderers.
+     * @details Contains the sampling helpers (reflection, refraction, Fresnel, cosine-weighted hemisphere) and a
+     * single scatter_surface() routine so that every integrator samples exactly the same BSDF.
+     */
+
+    /** @brief Mirror reflection of v about n. */
+    export template <Arithmetic T>
+    [[nodiscard]] inline Vector<T,3> reflect(const Vector<T,3>& v, const Vector<T,3>& n) noexcept {
+        return v - n * (T{2} * dot(v, n));
+    }
+
+    /**
+     * @brief Snell refraction.
+     * @param v incident direction (unit)
+     * @param n surface normal facing the incident side (unit)
+     * @param eta ratio n1/n2 of refractive indices
+     * @param out refracted direction
+     * @return false on total internal reflection
+     */
+    export template <Arithmetic T>
+    [[nodiscard]] inline bool refract(const Vector<T,3>& v, const Vector<T,3>& n, T eta, Vector<T,3>& out) noexcept {
+        const T cosi = std::clamp<T>(-dot(v, n), T{-1}, T{1});
+        const T k = T{1} - eta * eta * (T{1} - cosi * cosi);
+        if (k < T{0}) return false;
+        out = v * eta + n * (eta * cosi - static_cast<T>(std::sqrt(k)));
+        return true;
+    }
+
+    /** @brief Schlick's approximation of the Fresnel reflectance. */
+    export template <Arithmetic T>
+    [[nodiscard]] inline T schlick(T cos_theta, T eta_i, T eta_t) noexcept {
+        T r0 = (eta_i - eta_t) / (eta_i + eta_t);
+        r0 = r0 * r0;
+        const T m = T{1} - cos_theta;
+        const T m2 = m * m;
+        return r0 + (T{1} - r0) * (m2 * m2 * m);
+    }
+
+    /** @brief Cosine-weighted direction on the +Z hemisphere from two uniform numbers in [0,1). */
+    export template <Arithmetic T>
+    [[nodiscard]] inline Vector<T,3> cosine_sample_hemisphere(T u1, T u2) noexcept {
+        const T r = static_cast<T>(std::sqrt(u1));
+        const T theta = static_cast<T>(T{2} * std::numbers::pi_v<T> * u2);
+        const T x = r * static_cast<T>(std::cos(theta));
+        const T y = r * static_cast<T>(std::sin(theta));
+        const T z = static_cast<T>(std::sqrt(std::max<T>(T{0}, T{1} - u1)));
+        return {x, y, z};
+    }
+
+    /** @brief Builds an orthonormal basis (t, b, n) around the unit normal n. */
+    export template <Arithmetic T>
+    inline void build_ortho_basis(const Vector<T,3>& n, Vector<T,3>& t, Vector<T,3>& b) noexcept {
+        if (std::abs(n[2]) < static_cast<T>(0.999)) {
+            t = cross(Vector<T,3>{T{0}, T{0}, T{1}}, n).normalized();
+        } else {
+            t = cross(Vector<T,3>{T{1}, T{0}, T{0}}, n).normalized();
+        }
+        b = cross(n, t);
+    }
+
+    /** @brief Maps a direction from the local frame around n (n = +Z) to world space. */
+    export template <Arithmetic T>
+    [[nodiscard]] inline Vector<T,3> to_world(const Vector<T,3>& local, const Vector<T,3>& n) noexcept {
+        Vector<T,3> t, b;
+        build_ortho_basis(n, t, b);
+        return t * local[0] + b * local[1] + n * local[2];
+    }
+
+    /** @brief Component-wise product of two colors/vectors. */
+    export template <Arithmetic T>
+    [[nodiscard]] inline Vector<T,3> hadamard(const Vector<T,3>& a, const Vector<T,3>& b) noexcept {
+        return Vector<T,3>{a[0] * b[0], a[1] * b[1], a[2] * b[2]};
+    }
+
+    /**
+     * @brief Material terms evaluated at one surface point.
+     * @details Evaluating all properties at once keeps the virtual MaterialProperty lookups in one place, which
+     * lets wavefront integrators batch them per material.
+     */
+    export template <Arithmetic T>
+    struct SurfaceParams {
+        Color<T,3> emitted{};   // radiance * emission power
+        Color<T,3> albedo{};
+        T roughness{};
+        T transparency{};
+        T ior{T{1}};
+    };
+
+    /**
+     * @brief Shading behaviour a set of materials can produce, used to pick specialized integrator kernels.
+     * @details A default-constructed value allows everything. A feature that is off promises that no surface
+     * needs it: no transparency (dielectric), no roughness below 1 (specular), no emission (emission), and no
+     * properties that vary with UV (textured).
+     */
+    export struct ShadingFeatures {
+        bool dielectric{true};
+        bool specular{true};
+        bool emission{true};
+        bool textured{true};
+
+        /** @brief No features: opaque, fully rough, non-emissive, uniform surfaces. */
+        [[nodiscard]] static constexpr ShadingFeatures none() noexcept { return {false, false, false, false}; }
+
+        /** @brief Adds the features of other. */
+        constexpr ShadingFeatures& operator|=(const ShadingFeatures& other) noexcept {
+            dielectric = dielectric || other.dielectric;
+            specular = specular || other.specular;
+            emission = emission || other.emission;
+            textured = textured || other.textured;
+            return *this;
+        }
+
+        /** @brief True if every feature of other is also enabled here. */
+        [[nodiscard]] constexpr bool covers(const ShadingFeatures& other) const noexcept {
+            return (dielectric || !other.dielectric) && (specular || !other.specular) &&
+                   (emission || !other.emission) && (textured || !other.textured);
+        }
+
+        friend constexpr bool operator==(const ShadingFeatures&, const ShadingFeatures&) = default;
+    };
+
+    /** @brief Features needed by one set of material terms (never textured). */
+    export template <Arithmetic T>
+    [[nodiscard]] constexpr ShadingFeatures shading_features(const SurfaceParams<T>& s) noexcept {
+        return ShadingFeatures{s.transparency > T{0}, s.roughness < T{1},
+                               s.emitted[0] != T{0} || s.emitted[1] != T{0} || s.emitted[2] != T{0}, false};
+    }
+
+    /** @brief Evaluates the material terms used by scatter_surface() at the given UV. */
+    export template <Arithmetic T>
+    [[nodiscard]] SurfaceParams<T> surface_params(const Material<T>& m, const Vector<T,2>& uv) noexcept {
+        return SurfaceParams<T>{m.radiance(uv) * m.emission(uv), m.albedo(uv), m.roughness(uv), m.transparency(uv),
+                                m.refractive_index(uv)};
+    }
+
+    /**
+     * @brief Russian roulette on the path throughput.
+     * @param beta throughput; rescaled when the path survives
+     * @param u uniform number in [0,1)
+     * @return false if the path is terminated
+     */
+    export template <Arithmetic T>
+    [[nodiscard]] inline bool russian_roulette(Color<T,3>& beta, T u) noexcept {
+        T max_c = std::max({beta[0], beta[1], beta[2]});
+        max_c = std::clamp<T>(max_c, T{0}, T{1});
+        const T q = T{1} - max_c;
+        if (u < q) return false;
+        beta = beta / (T{1} - q);
+        return true;
+    }
+
+    /** @brief Continuation ray and throughput weight (BSDF * cos / pdf) of a scattering event. */
+    export template <Arithmetic T>
+    struct BsdfSample {
+        Ray<T> ray{};
+        Color<T,3> weight{};
+        T pdf{}; // solid-angle density of the direction; 0 for specular (delta) lobes
+    };
+
+    /** @brief Non-specular part of the BSDF for one pair of directions (see evaluate_surface()). */
+    export template <Arithmetic T>
+    struct BsdfEval {
+        Color<T,3> f_cos{}; // BSDF * |cos| towards the evaluated direction
+        T pdf{};            // density with which scatter_surface() samples that direction
+    };
+
+    /**
+     * @brief Samples the continuation of a path at a surface hit.
+     * @tparam F features the surface may have; lobes of disabled features are compiled out
+     * @param s material terms at the hit
+     * @param ray incoming ray (its range is reused for the continuation)
+     * @param p hit position
+     * @param n unit surface normal (not oriented towards the ray)
+     * @param uniform callable returning uniform numbers in [0,1); called 0-3 times depending on the lobe
+     * @details Transparent surfaces choose Fresnel reflection or refraction (reflection on total internal
+     * reflection). Opaque surfaces choose a perfect mirror lobe with probability 1 - roughness and a Lambertian
+     * lobe otherwise. The continuation ray starts slightly off the surface to avoid self-intersection.
+     *
+     * Without F.specular the lobe choice is skipped, but its uniform number is still drawn, so every
+     * specialization consumes the same numbers and gives the same result as the general one on surfaces it
+     * covers.
+     */
+    export template <ShadingFeatures F, Arithmetic T, class Uniform>
+    [[nodiscard]] BsdfSample<T> scatter_surface(const SurfaceParams<T>& s, const Ray<T>& ray, const Vector<T,3>& p,
+                                                const Vector<T,3>& n, Uniform&& uniform) noexcept {
+        using Vec3 = Vector<T,3>;
+        const T offset = static_cast<T>(1e-4);
+        auto spawn = [&](const Vec3& dir) { return Ray<T>{p + dir * offset, dir, ray.tmin(), ray.tmax()}; };
+
+        if constexpr (F.dielectric) {
+            if (s.transparency > T{0}) {
+                // Dielectric: sample Fresnel reflect vs refract
+                const bool entering = dot(ray.direction(), n) < T{0};
+                const Vec3 nl = entering ? n : -n; // oriented normal
+                const T eta_i = entering ? T{1} : s.ior;
+                const T eta_t = entering ? s.ior : T{1};
+                const T cos_theta_i = std::clamp<T>(-dot(ray.direction(), nl), T{0}, T{1});
+                const T R = schlick<T>(cos_theta_i, eta_i, eta_t);
+
+                Vec3 refr_dir;
+                if (!refract(ray.direction(), nl, eta_i / eta_t, refr_dir)) {
+                    // Total internal reflection: reflect with probability 1
+                    return {spawn(reflect(ray.direction(), nl).normalized()), s.albedo};
+                }
+                if (static_cast<T>(uniform()) < R) {
+                    return {spawn(reflect(ray.direction(), nl).normalized()), s.albedo / std::max<T>(R, static_cast<T>(1e-3))};
+                }
+                const T prob = std::max<T>(T{1} - R, static_cast<T>(1e-3));
+                return {spawn(refr_dir.normalized()), s.albedo * (s.transparency / prob)};
+            }
+        }
+
+        // Opaque surface: mix specular and diffuse by roughness
+        T prob_spec{0};
+        if constexpr (F.specular) {
+            prob_spec = std::clamp<T>(T{1} - s.roughness, T{0}, T{1});
+            if (static_cast<T>(uniform()) < prob_spec) {
+                return {spawn(reflect(ray.direction(), n).normalized()), s.albedo / std::max(prob_spec, static_cast<T>(1e-3))};
+            }
+        } else {
+            (void)uniform(); // keeps the numbers used below in place
+        }
+        // Lambert: cosine-weighted sampling, BRDF = albedo/pi, pdf = cos/pi => weight = albedo
+        const T u1 = static_cast<T>(uniform());
+        const T u2 = static_cast<T>(uniform());
+        const Vec3 dir = to_world(cosine_sample_hemisphere<T>(u1, u2), n).normalized();
+        return {spawn(dir), s.albedo / std::max<T>(T{1} - prob_spec, static_cast<T>(1e-3)),
+                (T{1} - prob_spec) * std::max<T>(dot(dir, n), T{0}) * std::numbers::inv_pi_v<T>};
+    }
+
+    /** @brief Samples the continuation of a path at a surface hit with every lobe enabled. */
+    export template <Arithmetic T, class Uniform>
+    [[nodiscard]] BsdfSample<T> scatter_surface(const SurfaceParams<T>& s, const Ray<T>& ray, const Vector<T,3>& p,
+                                                const Vector<T,3>& n, Uniform&& uniform) noexcept {
+        return scatter_surface<ShadingFeatures{}>(s, ray, p, n, std::forward<Uniform>(uniform));
+    }
+
+    /**
+     * @brief Evaluates the non-specular (Lambertian) lobe of scatter_surface() towards wi.
+     * @tparam F features the surface may have (see scatter_surface())
+     * @param s material terms at the hit
+     * @param n unit surface normal, as passed to scatter_surface()
+     * @param wi unit direction away from the surface
+     * @details Specular and dielectric lobes are deltas and contribute nothing. f_cos / pdf equals the
+     * throughput weight scatter_surface() returns when it samples wi, so light sampling and BSDF sampling can be
+     * combined with multiple importance sampling.
+     */
+    export template <ShadingFeatures F = ShadingFeatures{}, Arithmetic T>
+    [[nodiscard]] BsdfEval<T> evaluate_surface(const SurfaceParams<T>& s, const Vector<T,3>& n,
+                                               const Vector<T,3>& wi) noexcept {
+        if constexpr (F.dielectric) {
+            if (s.transparency > T{0}) return {};
+        }
+        const T cos_theta = dot(wi, n);
+        if constexpr (!F.specular) {
+            // Fully rough: the diffuse lobe is always chosen
+            if (!(cos_theta > T{0})) return {};
+            return {s.albedo * (cos_theta * std::numbers::inv_pi_v<T>), cos_theta * std::numbers::inv_pi_v<T>};
+        } else {
+            const T prob_diffuse = T{1} - std::clamp<T>(T{1} - s.roughness, T{0}, T{1});
+            if (!(prob_diffuse > T{0}) || !(cos_theta > T{0})) return {};
+            // BRDF albedo/pi, rescaled like the weight scatter_surface() applies to this lobe
+            const T scale = prob_diffuse / std::max<T>(prob_diffuse, static_cast<T>(1e-3));
+            return {s.albedo * (cos_theta * std::numbers::inv_pi_v<T> * scale), prob_diffuse * cos_theta * std::numbers::inv_pi_v<T>};
+        }
+    }
+}
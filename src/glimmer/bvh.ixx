@@ -0,0 +1,560 @@
+module;
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+export module glimmer.bvh;
+
+import glimmer.vector;
+import glimmer.ray;
+import glimmer.aabb;
+import glimmer.ray_packet;
+import glimmer.cow_array;
+import glimmer.arena;
+import glimmer.render_stats;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing a bounding volume hierarchy (BVH) over axis-aligned boxes.
+     */
+
+    /**
+     * @brief Flattened BVH node.
+     * @tparam T arithmetic scalar type
+     * @details Nodes are stored in depth-first order: the left child of an inner node is always the next node
+     * in the array, and `first` holds the index of the right child. For leaves, `first` is the offset into the
+     * primitive index list and `count` the number of primitives (count == 0 marks an inner node).
+     */
+    export template <Arithmetic T>
+    struct BvhNode {
+        AABB<T> bounds{};
+        std::uint32_t first{};
+        std::uint32_t count{};
+
+        /** @brief Returns true if this node is a leaf. */
+        [[nodiscard]] constexpr bool is_leaf() const noexcept { return count != 0; }
+    };
+
+    /**
+     * @brief Bounding volume hierarchy built with the binned surface area heuristic (SAH).
+     * @tparam T arithmetic scalar type (float/double recommended)
+     * @details The BVH does not own primitives; it is built from a list of primitive bounds and stores a
+     * permutation of primitive indices. Queries are driven by a caller-provided leaf callback, so the same
+     * structure serves scene objects (top level) and triangles (bottom level). A hierarchy can also borrow()
+     * node and index arrays stored elsewhere (e.g. a memory-mapped mesh cache) without copying them.
+     */
+    export template <Arithmetic T>
+    class Bvh {
+    public:
+        using Node = BvhNode<T>;
+
+        /** @brief Default maximum number of primitives per leaf. */
+        static constexpr std::size_t default_max_leaf_size = 4;
+        /**
+         * @brief Depth limit (the root has depth 0); bounds the traversal stack (each level pushes at most one
+         * deferred child). Trees passed to borrow() must respect it.
+         */
+        static constexpr std::size_t max_depth = 64;
+
+        /** @brief Constructs an empty hierarchy. */
+        Bvh() = default;
+
+        /**
+         * @brief Views prebuilt node and primitive index arrays (as returned by nodes()/primitive_indices())
+         * without copying; the memory must outlive the hierarchy and its copies. refit() copies them first.
+         */
+        [[nodiscard]] static Bvh borrow(std::span<const Node> nodes, std::span<const std::uint32_t> indices) noexcept {
+            Bvh bvh;
+            bvh.nodes_ = CowArray<Node>::borrow(nodes);
+            bvh.indices_ = CowArray<std::uint32_t>::borrow(indices);
+            bvh.update_cost_();
+            return bvh;
+        }
+
+        /**
+         * @brief Builds the hierarchy over the given primitive bounds, replacing any previous contents.
+         * @param prim_bounds world-space bounds per primitive; index i identifies primitive i
+         * @param max_leaf_size leaves are split while they hold more primitives than this (when possible)
+         */
+        void build(std::span<const AABB<T>> prim_bounds, std::size_t max_leaf_size = default_max_leaf_size) {
+            clear();
+            const std::size_t n = prim_bounds.size();
+            if (n == 0) return;
+            if (max_leaf_size == 0) max_leaf_size = 1;
+
+            // Build scratch lives in the thread's arena; nodes and indices become the hierarchy
+            const ArenaScope scratch;
+            std::vector<std::uint32_t> indices(n);
+            ArenaVector<Vector<T,3>> centroids(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                indices[i] = static_cast<std::uint32_t>(i);
+                centroids[i] = prim_bounds[i].empty() ? Vector<T,3>{} : prim_bounds[i].center();
+            }
+            std::vector<Node> nodes;
+            nodes.reserve(2 * n);
+
+            struct Task { std::uint32_t begin; std::uint32_t end; std::uint32_t parent; std::uint32_t depth; };
+            constexpr std::uint32_t no_parent = std::numeric_limits<std::uint32_t>::max();
+            ArenaVector<Task> stack;
+            stack.reserve(2 * static_cast<std::size_t>(max_depth) + 2);
+            stack.push_back({0, static_cast<std::uint32_t>(n), no_parent, 0});
+
+            while (!stack.empty()) {
+                const Task task = stack.back();
+                stack.pop_back();
+
+                const auto node_index = static_cast<std::uint32_t>(nodes.size());
+                nodes.push_back(Node{});
+                if (task.parent != no_parent) nodes[task.parent].first = node_index;
+
+                AABB<T> bounds;
+                AABB<T> centroid_bounds;
+                for (std::uint32_t i = task.begin; i < task.end; ++i) {
+                    bounds.expand(prim_bounds[indices[i]]);
+                    centroid_bounds.expand(centroids[indices[i]]);
+                }
+                nodes[node_index].bounds = bounds;
+
+                const std::uint32_t count = task.end - task.begin;
+                const bool can_split = count > 1 && task.depth < max_depth;
+                const std::uint32_t mid = can_split ? split_(indices, task.begin, task.end, bounds, centroid_bounds,
+                                                             prim_bounds, centroids, max_leaf_size)
+                                                    : task.begin;
+                if (mid == task.begin || mid == task.end) {
+                    nodes[node_index].first = task.begin;
+                    nodes[node_index].count = count;
+                    continue;
+                }
+                // Push right first so the left child is popped next and lands at node_index + 1.
+                stack.push_back({mid, task.end, node_index, task.depth + 1});
+                stack.push_back({task.begin, mid, no_parent, task.depth + 1});
+            }
+            nodes_ = CowArray<Node>{std::move(nodes)};
+            indices_ = CowArray<std::uint32_t>{std::move(indices)};
+            update_cost_();
+        }
+
+        /**
+         * @brief Recomputes node bounds bottom-up without changing the topology.
+         * @param prim_bounds updated bounds per primitive (same count and ordering as used for build)
+         * @details Cheap compared to build() and sufficient when primitives move moderately. Tree quality
+         * degrades for large motions, in which case a rebuild is preferable.
+         */
+        void refit(std::span<const AABB<T>> prim_bounds) {
+            nodes_.modify([&](std::vector<Node>& nodes) {
+                for (std::size_t i = nodes.size(); i-- > 0;) {
+                    Node& node = nodes[i];
+                    AABB<T> box;
+                    if (node.is_leaf()) {
+                        for (std::uint32_t k = 0; k < node.count; ++k) box.expand(prim_bounds[indices_[node.first + k]]);
+                    } else {
+                        box = nodes[i + 1].bounds.united(nodes[node.first].bounds);
+                    }
+                    node.bounds = box;
+                }
+            });
+            update_cost_();
+        }
+
+        /**
+         * @brief Refits only the leaves holding the changed primitives and their ancestors.
+         * @param changed primitives whose bounds changed (duplicates allowed)
+         * @param prim_bounds callable `AABB<T>(std::uint32_t prim)` returning the current bounds of a primitive
+         * @details Walks from each changed leaf towards the root and stops as soon as a node's bounds come out
+         * unchanged, so moving k of n primitives costs about O(k log n) instead of O(n). Parent links and the
+         * primitive-to-leaf map are built on first use and kept until the next build(). sah_cost() is updated
+         * incrementally.
+         */
+        template <class BoundsFn>
+        void refit(std::span<const std::uint32_t> changed, BoundsFn&& prim_bounds) {
+            if (nodes_.empty() || changed.empty()) return;
+            if (parents_.size() != nodes_.size()) link_nodes_();
+            nodes_.modify([&](std::vector<Node>& nodes) {
+                for (const std::uint32_t prim : changed) {
+                    std::uint32_t i = leaf_of_[prim];
+                    while (true) {
+                        Node& node = nodes[i];
+                        AABB<T> box;
+                        if (node.is_leaf()) {
+                            for (std::uint32_t k = 0; k < node.count; ++k) box.expand(prim_bounds(indices_[node.first + k]));
+                        } else {
+                            box = nodes[i + 1].bounds.united(nodes[node.first].bounds);
+                        }
+                        if (box == node.bounds) break;
+                        cost_sum_ += (box.surface_area() - node.bounds.surface_area()) * node_weight_(node);
+                        node.bounds = box;
+                        if (i == 0) break;
+                        i = parents_[i];
+                    }
+                }
+            });
+        }
+
+        /**
+         * @brief Expected cost of a random ray query under the SAH (unit traversal and intersection costs).
+         * @details Sum of the node areas weighted by their cost, divided by the root area. Refitting keeps the
+         * topology, so this grows as primitives move away from where they were at build(); comparing it with
+         * its value right after build() tells when a rebuild pays off.
+         */
+        [[nodiscard]] T sah_cost() const noexcept {
+            const T root = bounds().surface_area();
+            return root > T{0} ? cost_sum_ / root : T{0};
+        }
+
+        /** @brief Removes all nodes. */
+        void clear() noexcept {
+            nodes_.clear();
+            indices_.clear();
+            parents_.clear();
+            leaf_of_.clear();
+            cost_sum_ = T{0};
+        }
+
+        /** @brief Returns true if the hierarchy holds no nodes. */
+        [[nodiscard]] bool empty() const noexcept { return nodes_.empty(); }
+        /** @brief Number of primitives the hierarchy was built over. */
+        [[nodiscard]] std::size_t primitive_count() const noexcept { return indices_.size(); }
+        /** @brief Number of nodes. */
+        [[nodiscard]] std::size_t node_count() const noexcept { return nodes_.size(); }
+        /** @brief Flattened node array (depth-first order). */
+        [[nodiscard]] std::span<const Node> nodes() const noexcept { return nodes_.view(); }
+        /** @brief Primitive index permutation referenced by leaves. */
+        [[nodiscard]] std::span<const std::uint32_t> primitive_indices() const noexcept { return indices_.view(); }
+        /** @brief True if the arrays are borrowed (see borrow()). */
+        [[nodiscard]] bool borrowed() const noexcept { return nodes_.borrowed(); }
+        /** @brief Bounds of the root node (empty if the hierarchy is empty). */
+        [[nodiscard]] AABB<T> bounds() const noexcept { return nodes_.empty() ? AABB<T>{} : nodes_.front().bounds; }
+
+        /**
+         * @brief Closest-hit traversal.
+         * @param ray query ray; its [tmin, tmax] interval bounds the search
+         * @param leaf callback `bool(std::uint32_t prim, T& t_max)` that tests one primitive, and on a hit closer
+         * than t_max stores the hit distance into t_max and returns true
+         * @return true if any primitive reported a hit
+         * @details Children are visited near-first so that t_max shrinks early and far subtrees get culled.
+         *
+         * Every leaf callback may also take the primitive's position in primitive_indices() as an extra second
+         * parameter, e.g. `bool(std::uint32_t prim, std::uint32_t slot, T& t_max)`, so callers can keep
+         * per-primitive data in leaf order and read it sequentially.
+         */
+        template <class LeafFn>
+        bool intersect(const Ray<T>& ray, LeafFn&& leaf) const {
+            return intersect_leaves(ray, [&](std::uint32_t first, std::uint32_t count, T& t_max) {
+                bool hit = false;
+                for (std::uint32_t k = 0; k < count; ++k) {
+                    if (call_leaf_(leaf, first + k, t_max)) hit = true;
+                }
+                return hit;
+            });
+        }
+
+        /**
+         * @brief Closest-hit traversal that hands each leaf to the callback as one range of slots.
+         * @param ray query ray; its [tmin, tmax] interval bounds the search
+         * @param leaf callback `bool(std::uint32_t first_slot, std::uint32_t count, T& t_max)` that tests the
+         * primitives at positions [first_slot, first_slot + count) of primitive_indices(), stores the closest hit
+         * distance below t_max into t_max and returns true if there was one
+         * @return true if any leaf reported a hit
+         * @details For primitives whose data is stored in leaf order, so each leaf is one batched loop over
+         * contiguous arrays.
+         */
+        template <class RangeFn>
+        bool intersect_leaves(const Ray<T>& ray, RangeFn&& leaf) const {
+            if (nodes_.empty()) return false;
+            const SlabRay sr = make_slab_ray_(ray);
+            const T t_min = ray.tmin();
+            T t_max = ray.tmax();
+            bool hit = false;
+
+            StatTally boxes{StatCounter::aabb_tests};
+            StatTally prims{StatCounter::primitive_tests};
+            struct Entry { std::uint32_t node; T t_entry; };
+            std::array<Entry, max_depth + 2> stack{};
+            std::size_t sp = 0;
+            T t_root{};
+            boxes.add();
+            if (slab_(sr, nodes_[0].bounds, t_min, t_max, t_root)) stack[sp++] = Entry{0, t_root};
+            while (sp > 0) {
+                const Entry e = stack[--sp];
+                // Entries pushed earlier may lie beyond a hit found since.
+                if (e.t_entry > t_max) continue;
+                const Node& node = nodes_[e.node];
+                if (node.is_leaf()) {
+                    prims.add(node.count);
+                    if (leaf(node.first, node.count, t_max)) hit = true;
+                    continue;
+                }
+                boxes.add(2);
+                Entry near_e{e.node + 1, T{}};
+                Entry far_e{node.first, T{}};
+                const bool hit_near = slab_(sr, nodes_[near_e.node].bounds, t_min, t_max, near_e.t_entry);
+                const bool hit_far = slab_(sr, nodes_[far_e.node].bounds, t_min, t_max, far_e.t_entry);
+                if (hit_near && hit_far) {
+                    if (far_e.t_entry < near_e.t_entry) std::swap(near_e, far_e);
+                    stack[sp++] = far_e;
+                    stack[sp++] = near_e;
+                } else if (hit_near) {
+                    stack[sp++] = near_e;
+                } else if (hit_far) {
+                    stack[sp++] = far_e;
+                }
+            }
+            return hit;
+        }
+
+        /**
+         * @brief Any-hit traversal.
+         * @param ray query ray; its [tmin, tmax] interval bounds the search
+         * @param leaf callback `bool(std::uint32_t prim)` returning true if the primitive blocks the ray
+         * @return true as soon as any primitive reports a hit
+         */
+        template <class LeafFn>
+        bool occluded(const Ray<T>& ray, LeafFn&& leaf) const {
+            return occluded_leaves(ray, [&](std::uint32_t first, std::uint32_t count) {
+                for (std::uint32_t k = 0; k < count; ++k) {
+                    if (call_leaf_(leaf, first + k)) return true;
+                }
+                return false;
+            });
+        }
+
+        /**
+         * @brief Any-hit traversal that hands each leaf to the callback as one range of slots.
+         * @param ray query ray; its [tmin, tmax] interval bounds the search
+         * @param leaf callback `bool(std::uint32_t first_slot, std::uint32_t count)` returning true if any
+         * primitive at positions [first_slot, first_slot + count) of primitive_indices() blocks the ray
+         * @return true as soon as any leaf reports a hit
+         */
+        template <class RangeFn>
+        bool occluded_leaves(const Ray<T>& ray, RangeFn&& leaf) const {
+            if (nodes_.empty()) return false;
+            const SlabRay sr = make_slab_ray_(ray);
+            const T t_min = ray.tmin();
+            const T t_max = ray.tmax();
+
+            StatTally boxes{StatCounter::aabb_tests};
+            StatTally prims{StatCounter::primitive_tests};
+            std::array<std::uint32_t, max_depth + 2> stack{};
+            std::size_t sp = 0;
+            stack[sp++] = 0;
+            while (sp > 0) {
+                const std::uint32_t index = stack[--sp];
+                const Node& node = nodes_[index];
+                T t_entry{};
+                boxes.add();
+                if (!slab_(sr, node.bounds, t_min, t_max, t_entry)) continue;
+                if (node.is_leaf()) {
+                    prims.add(node.count);
+                    if (leaf(node.first, node.count)) return true;
+                    continue;
+                }
+                stack[sp++] = node.first;
+                stack[sp++] = index + 1;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Closest-hit traversal for a packet of rays sharing one walk through the tree.
+         * @param packet ray packet; only its active() lanes are traced
+         * @param t_max per-lane search bound, typically initialized from packet.tmax; the leaf callback shrinks it
+         * @param leaf callback `PacketMask(std::uint32_t prim, PacketMask lanes)` that tests one primitive against
+         * the given lanes, lowers t_max for lanes with a closer hit, and returns the mask of those lanes
+         * @return mask of lanes for which any primitive reported a hit
+         * @details A node is visited while at least one lane overlaps it, so coherent rays (camera rays) pay for one
+         * traversal instead of N. Children are ordered by the direction of the first live lane.
+         */
+        template <std::size_t N, class LeafFn>
+        PacketMask intersect_packet(const RayPacket<T,N>& packet, std::array<T,N>& t_max, LeafFn&& leaf) const {
+            PacketMask hit = 0;
+            if (nodes_.empty() || packet.active() == 0) return hit;
+
+            // Counted per live lane, so packet and single-ray traversal report comparable work
+            StatTally boxes{StatCounter::aabb_tests};
+            StatTally prims{StatCounter::primitive_tests};
+            struct Entry { std::uint32_t node; PacketMask lanes; };
+            std::array<Entry, max_depth + 2> stack{};
+            std::array<T,N> t_entry{};
+            std::size_t sp = 0;
+            stack[sp++] = Entry{0, packet.active()};
+            while (sp > 0) {
+                const Entry e = stack[--sp];
+                const Node& node = nodes_[e.node];
+                boxes.add(static_cast<std::uint64_t>(std::popcount(e.lanes)));
+                const PacketMask lanes = intersect_aabb(node.bounds, packet, t_max, t_entry, e.lanes);
+                if (lanes == 0) continue;
+                if (node.is_leaf()) {
+                    prims.add(std::uint64_t{node.count} * static_cast<std::uint64_t>(std::popcount(lanes)));
+                    for (std::uint32_t k = 0; k < node.count; ++k) hit |= call_leaf_(leaf, node.first + k, lanes);
+                    continue;
+                }
+                const auto lane = static_cast<std::size_t>(std::countr_zero(lanes));
+                const Vector<T,3> d{packet.dx[lane], packet.dy[lane], packet.dz[lane]};
+                const std::uint32_t left = e.node + 1;
+                const std::uint32_t right = node.first;
+                const bool right_first = dot(nodes_[left].bounds.center() - nodes_[right].bounds.center(), d) > T{0};
+                stack[sp++] = Entry{right_first ? left : right, lanes};
+                stack[sp++] = Entry{right_first ? right : left, lanes};
+            }
+            return hit;
+        }
+
+    private:
+        static constexpr std::size_t bin_count = 16;
+
+        // Invokes a leaf callback with (prim, slot, args...) if it accepts the slot, else with (prim, args...)
+        template <class LeafFn, class... Args>
+        decltype(auto) call_leaf_(LeafFn& leaf, std::uint32_t slot, Args&&... args) const {
+            if constexpr (std::is_invocable_v<LeafFn&, std::uint32_t, std::uint32_t, Args...>) {
+                return leaf(indices_[slot], slot, std::forward<Args>(args)...);
+            } else {
+                return leaf(indices_[slot], std::forward<Args>(args)...);
+            }
+        }
+
+        struct SlabRay {
+            Vector<T,3> origin{};
+            Vector<T,3> inv_dir{};
+        };
+
+        [[nodiscard]] static SlabRay make_slab_ray_(const Ray<T>& ray) noexcept {
+            SlabRay sr{ray.origin(), {}};
+            for (std::size_t i = 0; i < 3; ++i) {
+                const T d = ray.direction()[i];
+                sr.inv_dir[i] = d != T{0} ? T{1} / d : infinity_();
+            }
+            return sr;
+        }
+
+        /** @brief Slab test against [t0, t1]; on a hit stores the entry distance into t_entry. */
+        [[nodiscard]] static bool slab_(const SlabRay& sr, const AABB<T>& box, T t0, T t1, T& t_entry) noexcept {
+            for (std::size_t i = 0; i < 3; ++i) {
+                T ta = (box.min()[i] - sr.origin[i]) * sr.inv_dir[i];
+                T tb = (box.max()[i] - sr.origin[i]) * sr.inv_dir[i];
+                if (tb < ta) std::swap(ta, tb);
+                // Comparisons are written so NaNs (0 * inf on a slab plane) leave the interval unchanged.
+                if (ta > t0) t0 = ta;
+                if (tb < t1) t1 = tb;
+            }
+            t_entry = t0;
+            return t0 <= t1;
+        }
+
+        static constexpr T infinity_() noexcept {
+            if constexpr (std::is_floating_point_v<T>) return std::numeric_limits<T>::infinity();
+            else return std::numeric_limits<T>::max();
+        }
+
+        /**
+         * @brief Chooses a binned SAH split and partitions [begin, end) accordingly.
+         * @return partition point; equal to begin or end when the range should become a leaf
+         */
+        std::uint32_t split_(std::vector<std::uint32_t>& indices, std::uint32_t begin, std::uint32_t end,
+                             const AABB<T>& bounds, const AABB<T>& cbounds,
+                             std::span<const AABB<T>> prim_bounds, std::span<const Vector<T,3>> centroids,
+                             std::size_t max_leaf_size) {
+            const std::uint32_t count = end - begin;
+            const Vector<T,3> cext = cbounds.extent();
+
+            struct Bin { AABB<T> box{}; std::uint32_t count{}; };
+            T best_cost = std::numeric_limits<T>::max();
+            std::size_t best_axis = 3;
+            std::size_t best_bin = 0;
+            for (std::size_t axis = 0; axis < 3; ++axis) {
+                if (!(cext[axis] > T{0})) continue;
+                std::array<Bin, bin_count> bins{};
+                const T scale = static_cast<T>(bin_count) / cext[axis];
+                for (std::uint32_t i = begin; i < end; ++i) {
+                    const std::uint32_t p = indices[i];
+                    const std::size_t b = bin_of_(centroids[p][axis], cbounds.min()[axis], scale);
+                    bins[b].box.expand(prim_bounds[p]);
+                    ++bins[b].count;
+                }
+                // Sweep from the right to get suffix areas/counts, then from the left evaluating each plane.
+                std::array<T, bin_count> right_area{};
+                std::array<std::uint32_t, bin_count> right_count{};
+                AABB<T> acc;
+                std::uint32_t acc_n = 0;
+                for (std::size_t b = bin_count; b-- > 1;) {
+                    acc.expand(bins[b].box);
+                    acc_n += bins[b].count;
+                    right_area[b] = acc.surface_area();
+                    right_count[b] = acc_n;
+                }
+                acc.clear();
+                acc_n = 0;
+                for (std::size_t b = 1; b < bin_count; ++b) {
+                    acc.expand(bins[b - 1].box);
+                    acc_n += bins[b - 1].count;
+                    if (acc_n == 0 || right_count[b] == 0) continue;
+                    const T cost = acc.surface_area() * static_cast<T>(acc_n)
+                                 + right_area[b] * static_cast<T>(right_count[b]);
+                    if (cost < best_cost) { best_cost = cost; best_axis = axis; best_bin = b; }
+                }
+            }
+
+            const T area = bounds.surface_area();
+            if (best_axis == 3) {
+                // All centroids coincide: fall back to an index split for oversized leaves.
+                if (count <= max_leaf_size) return begin;
+                return begin + count / 2;
+            }
+            // SAH with unit intersection cost and unit traversal cost, relative to the parent area.
+            const T split_cost = T{1} + (area > T{0} ? best_cost / area : T{0});
+            if (count <= max_leaf_size && split_cost >= static_cast<T>(count)) return begin;
+
+            const T scale = static_cast<T>(bin_count) / cext[best_axis];
+            const T cmin = cbounds.min()[best_axis];
+            auto mid_it = std::partition(indices.begin() + begin, indices.begin() + end,
+                                         [&](std::uint32_t p) {
+                                             return bin_of_(centroids[p][best_axis], cmin, scale) < best_bin;
+                                         });
+            return static_cast<std::uint32_t>(mid_it - indices.begin());
+        }
+
+        [[nodiscard]] static T node_weight_(const Node& node) noexcept {
+            return node.is_leaf() ? static_cast<T>(node.count) : T{1};
+        }
+
+        void update_cost_() noexcept {
+            cost_sum_ = T{0};
+            for (const Node& node : nodes_.view()) cost_sum_ += node.bounds.surface_area() * node_weight_(node);
+        }
+
+        void link_nodes_() {
+            const auto nodes = nodes_.view();
+            parents_.assign(nodes.size(), 0);
+            leaf_of_.assign(indices_.size(), 0);
+            for (std::size_t i = 0; i < nodes.size(); ++i) {
+                const Node& node = nodes[i];
+                if (node.is_leaf()) {
+                    for (std::uint32_t k = 0; k < node.count; ++k) leaf_of_[indices_[node.first + k]] = static_cast<std::uint32_t>(i);
+                } else {
+                    parents_[i + 1] = static_cast<std::uint32_t>(i);
+                    parents_[node.first] = static_cast<std::uint32_t>(i);
+                }
+            }
+        }
+
+        [[nodiscard]] static std::size_t bin_of_(T c, T cmin, T scale) noexcept {
+            const T f = (c - cmin) * scale;
+            if (!(f > T{0})) return 0;
+            const auto b = static_cast<std::size_t>(f);
+            return b < bin_count ? b : bin_count - 1;
+        }
+
+        CowArray<Node> nodes_{};
+        CowArray<std::uint32_t> indices_{};
+        std::vector<std::uint32_t> parents_{}; // for partial refits, built on demand
+        std::vector<std::uint32_t> leaf_of_{};
+        T cost_sum_{};
+    };
+}
@@ -1,6 +1,9 @@
 module;
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <numbers>
+#include <span>
 #include <stdexcept>
 
 export module glimmer.camera;
@@ -9,19 +12,21 @@ import glimmer.vector;
 import glimmer.matrix;
 import glimmer.transform;
 import glimmer.ray;
+import glimmer.ray_packet;
 
 namespace glimmer {
     /**
      * @file
-     * @brief C++23 module defining a simple pinhole camera with ray generation.
+     * @brief C++23 module defining a perspective camera with an optional thin lens, and a precomputed ray generator.
      */
 
     /**
-     * @brief Pinhole camera with perspective/orthographic helpers and ray generation.
+     * @brief Perspective camera with view/projection helpers and ray generation.
      * @tparam T arithmetic scalar type (float/double recommended)
      * @details Stores a camera-to-world transform and perspective parameters. Provides
      * methods to obtain view/projection matrices and to generate primary rays for
-     * pixel coordinates.
+     * pixel coordinates. A thin lens (set_lens()) adds depth of field; renderers generate
+     * their rays through a CameraRayGenerator built from the camera once per frame.
      */
     export template <Arithmetic T>
     class Camera {
@@ -66,6 +71,31 @@ namespace glimmer {
         /** @brief Far plane distance. */
         [[nodiscard]] T z_far() const noexcept { return z_far_; }
 
+        /**
+         * @brief Turns the camera into a thin-lens camera (aperture_radius 0 restores the pinhole).
+         * @param aperture_radius lens radius in camera-space units (>= 0)
+         * @param focus_distance distance along the view axis of the plane in focus (> 0)
+         * @throws std::invalid_argument on a negative aperture or non-positive focus distance
+         */
+        void set_lens(T aperture_radius, T focus_distance) {
+            if (!(aperture_radius >= T{0})) throw std::invalid_argument("Camera: aperture radius must be >= 0");
+            if (!(focus_distance > T{0})) throw std::invalid_argument("Camera: focus distance must be > 0");
+            aperture_radius_ = aperture_radius;
+            focus_distance_ = focus_distance;
+        }
+        /** @brief Lens radius; 0 for a pinhole camera. */
+        [[nodiscard]] T aperture_radius() const noexcept { return aperture_radius_; }
+        /** @brief Distance of the plane in focus (only relevant with a lens). */
+        [[nodiscard]] T focus_distance() const noexcept { return focus_distance_; }
+
+        /**
+         * @brief Angle subtended by one pixel at the image center (radians), for an image of the given height.
+         * @details Integrators grow a ray cone by this angle to estimate texture footprints.
+         */
+        [[nodiscard]] T pixel_spread(std::size_t height) const noexcept {
+            return static_cast<T>(T{2} * std::tan(fov_y_ / T{2}) / static_cast<T>(height));
+        }
+
         /** @brief Returns the world-to-camera view matrix. */
         [[nodiscard]] Mat4 view_matrix() const noexcept { return c2w_.inverse_matrix(); }
         /** @brief Returns the perspective projection matrix (OpenGL style). */
@@ -83,6 +113,7 @@ namespace glimmer {
          * @details Right-handed convention: camera looks along -Z in its local space. The image plane is
          * at z = -1 with vertical extent determined by tan(fov_y/2), and horizontal extent by aspect.
          * Pixel centers are mapped to NDC via (x+0.5)/width and (y+0.5)/height with origin at top-left.
+         * The ray passes through the lens center; use CameraRayGenerator for lens samples and for many rays.
          */
         [[nodiscard]] Ray<T> generate_ray(T px, T py, std::size_t width, std::size_t height) const noexcept {
             // Map pixel center to NDC [0,1]
@@ -92,7 +123,7 @@ namespace glimmer {
             const T sx = nx * T{2} - T{1};
             const T sy = T{1} - ny * T{2};
             // Compute direction in camera space
-            const T tan_half = static_cast<T>(std::tan(static_cast<long double>(fov_y_) / 2.0L));
+            const T tan_half = static_cast<T>(std::tan(fov_y_ / T{2}));
             const T x_cam = sx * tan_half * aspect_;
             const T y_cam = sy * tan_half;
             Vec3 dir_cam{ x_cam, y_cam, static_cast<T>(-1) };
@@ -110,5 +141,146 @@ namespace glimmer {
         T aspect_{};
         T z_near_{};
         T z_far_{};
+        T aperture_radius_{0};
+        T focus_distance_{1};
+    };
+
+    /**
+     * @brief Primary-ray generator for one camera and image size, with all per-frame setup done up front.
+     * @tparam T arithmetic scalar type (float/double recommended)
+     * @details The camera basis, the image-plane scale factors, the world-space origin and the lens axes are
+     * computed once, so a ray costs a few multiply-adds and one normalization. Film positions use the
+     * convention of Camera::generate_ray(): (px, py) maps to the image-plane point of (px + 0.5, py + 0.5).
+     * Lens samples are points in [0,1)^2, mapped onto the aperture disk concentrically; they are ignored for
+     * pinhole cameras. The batch overloads write a RayPacket lane array by lane array.
+     */
+    export template <Arithmetic T>
+    class CameraRayGenerator {
+    public:
+        using Vec2 = Vector<T,2>;
+        using Vec3 = Vector<T,3>;
+
+        /** @brief Precomputes the rays of cam for an image of width x height pixels. */
+        CameraRayGenerator(const Camera<T>& cam, std::size_t width, std::size_t height) noexcept
+            : tmin_{cam.z_near()}, tmax_{cam.z_far()}, spread_{cam.pixel_spread(height)},
+              lens_{cam.aperture_radius() > T{0}}, focus_{cam.focus_distance()}
+        {
+            const auto& c2w = cam.cam_to_world();
+            const auto tan_half = static_cast<T>(std::tan(cam.fov_y() / T{2}));
+            const T half_w = tan_half * cam.aspect();
+            const Vec3 right = c2w.apply_direction(Vec3{T{1}, T{0}, T{0}});
+            const Vec3 up = c2w.apply_direction(Vec3{T{0}, T{1}, T{0}});
+            const Vec3 back = c2w.apply_direction(Vec3{T{0}, T{0}, T{1}});
+            // Camera-space direction (sx * half_w, sy * tan_half, -1) with sx, sy the screen coordinates of the
+            // film position, folded into d = dx * px + dy * py + d0
+            const T w = static_cast<T>(std::max<std::size_t>(width, 1));
+            const T h = static_cast<T>(std::max<std::size_t>(height, 1));
+            dx_ = right * (T{2} * half_w / w);
+            dy_ = up * (T{-2} * tan_half / h);
+            d0_ = dx_ * T{0.5} + dy_ * T{0.5} - right * half_w + up * tan_half - back;
+            origin_ = c2w.apply_point(Vec3{T{0}, T{0}, T{0}});
+            lens_u_ = right * cam.aperture_radius();
+            lens_v_ = up * cam.aperture_radius();
+        }
+
+        /** @brief True if rays start on a lens of non-zero radius. */
+        [[nodiscard]] bool has_lens() const noexcept { return lens_; }
+        /** @brief Camera::pixel_spread() for the image height. */
+        [[nodiscard]] T pixel_spread() const noexcept { return spread_; }
+        /** @brief World-space position of the lens center. */
+        [[nodiscard]] const Vec3& origin() const noexcept { return origin_; }
+
+        /** @brief Ray through the lens center and film position (px, py). */
+        [[nodiscard]] Ray<T> ray(T px, T py) const noexcept {
+            return Ray<T>{origin_, direction_(px, py).normalized(), tmin_, tmax_};
+        }
+
+        /** @brief Ray from lens sample lens (in [0,1)^2) through the focused image of film position (px, py). */
+        [[nodiscard]] Ray<T> ray(T px, T py, const Vec2& lens) const noexcept {
+            if (!lens_) return ray(px, py);
+            const Vec3 offset = lens_offset_(lens);
+            return Ray<T>{origin_ + offset, (direction_(px, py) * focus_ - offset).normalized(), tmin_, tmax_};
+        }
+
+        /**
+         * @brief Fills the first min(film.size(), N) lanes of packet with the rays of the given film positions.
+         * @param lens lens samples for the same lanes; may be empty for pinhole cameras
+         */
+        template <std::size_t N>
+        void rays(RayPacket<T,N>& packet, std::span<const Vec2> film, std::span<const Vec2> lens = {}) const noexcept {
+            const std::size_t n = std::min(film.size(), N);
+            for (std::size_t i = 0; i < n; ++i) {
+                const Vec3 d = direction_(film[i][0], film[i][1]);
+                packet.dx[i] = d[0]; packet.dy[i] = d[1]; packet.dz[i] = d[2];
+                packet.ox[i] = origin_[0]; packet.oy[i] = origin_[1]; packet.oz[i] = origin_[2];
+            }
+            if (lens_ && lens.size() >= n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    const Vec3 offset = lens_offset_(lens[i]);
+                    packet.ox[i] += offset[0]; packet.oy[i] += offset[1]; packet.oz[i] += offset[2];
+                    packet.dx[i] = packet.dx[i] * focus_ - offset[0];
+                    packet.dy[i] = packet.dy[i] * focus_ - offset[1];
+                    packet.dz[i] = packet.dz[i] * focus_ - offset[2];
+                }
+            }
+            finish_(packet, n);
+        }
+
+        /** @brief Fills packet with the pinhole rays through the centers of count pixels of row y from x0 on. */
+        template <std::size_t N>
+        void row(RayPacket<T,N>& packet, std::size_t x0, std::size_t y, std::size_t count) const noexcept {
+            const std::size_t n = std::min(count, N);
+            const Vec3 base = dy_ * static_cast<T>(y) + d0_;
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto px = static_cast<T>(x0 + i);
+                packet.dx[i] = dx_[0] * px + base[0];
+                packet.dy[i] = dx_[1] * px + base[1];
+                packet.dz[i] = dx_[2] * px + base[2];
+                packet.ox[i] = origin_[0]; packet.oy[i] = origin_[1]; packet.oz[i] = origin_[2];
+            }
+            finish_(packet, n);
+        }
+
+    private:
+        // Unnormalized direction through film position (px, py); its camera-space z component is -1
+        [[nodiscard]] Vec3 direction_(T px, T py) const noexcept { return dx_ * px + dy_ * py + d0_; }
+
+        // Concentric mapping (Shirley & Chiu) of a unit-square sample onto the aperture disk, in world space
+        [[nodiscard]] Vec3 lens_offset_(const Vec2& u) const noexcept {
+            const T a = T{2} * u[0] - T{1};
+            const T b = T{2} * u[1] - T{1};
+            if (a == T{0} && b == T{0}) return Vec3{T{0}, T{0}, T{0}};
+            constexpr T quarter_pi = std::numbers::pi_v<T> / T{4};
+            T r, phi;
+            if (std::abs(a) > std::abs(b)) { r = a; phi = quarter_pi * (b / a); }
+            else { r = b; phi = T{2} * quarter_pi - quarter_pi * (a / b); }
+            return lens_u_ * (r * static_cast<T>(std::cos(phi))) + lens_v_ * (r * static_cast<T>(std::sin(phi)));
+        }
+
+        // Normalizes the directions of lanes [0, n) and sets their ray range and reciprocals
+        template <std::size_t N>
+        void finish_(RayPacket<T,N>& packet, std::size_t n) const noexcept {
+            for (std::size_t i = 0; i < n; ++i) {
+                const T inv_len = T{1} / static_cast<T>(std::sqrt(packet.dx[i] * packet.dx[i] +
+                                                                   packet.dy[i] * packet.dy[i] +
+                                                                   packet.dz[i] * packet.dz[i]));
+                packet.dx[i] *= inv_len; packet.dy[i] *= inv_len; packet.dz[i] *= inv_len;
+                packet.tmin[i] = tmin_; packet.tmax[i] = tmax_;
+            }
+            packet.count = n;
+            packet.update_reciprocals();
+        }
+
+        Vec3 origin_{};
+        Vec3 dx_{};
+        Vec3 dy_{};
+        Vec3 d0_{};
+        Vec3 lens_u_{};
+        Vec3 lens_v_{};
+        T tmin_{};
+        T tmax_{};
+        T spread_{};
+        bool lens_{false};
+        T focus_{1};
     };
 }
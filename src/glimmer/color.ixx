@@ -65,7 +65,7 @@ namespace glimmer {
         for (std::size_t i=0;i<3;++i) {
             T c = lin[i];
             if (c <= static_cast<T>(0.0031308)) out[i] = static_cast<T>(12.92) * c;
-            else out[i] = static_cast<T>(1.055) * static_cast<T>(pow(static_cast<long double>(c), 1.0L/2.4L)) - static_cast<T>(0.055);
+            else out[i] = static_cast<T>(1.055) * static_cast<T>(pow(c, static_cast<T>(1.0 / 2.4))) - static_cast<T>(0.055);
         }
         return out;
     }
@@ -84,7 +84,7 @@ namespace glimmer {
         for (std::size_t i=0;i<3;++i) {
             T c = srgb[i];
             if (c <= static_cast<T>(0.04045)) out[i] = c / static_cast<T>(12.92);
-            else out[i] = static_cast<T>(pow(static_cast<long double>((c + static_cast<T>(0.055)) / static_cast<T>(1.055)), 2.4L));
+            else out[i] = static_cast<T>(pow((c + static_cast<T>(0.055)) / static_cast<T>(1.055), static_cast<T>(2.4)));
         }
         return out;
     }
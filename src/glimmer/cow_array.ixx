@@ -0,0 +1,103 @@
+module;
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+export module glimmer.cow_array;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing an array that either owns its elements or borrows them copy-on-write.
+     */
+
+    /**
+     * @brief Read-mostly array over owned or borrowed storage.
+     * @tparam E trivially copyable element type
+     * @details A CowArray either owns a std::vector or views memory owned elsewhere (for example a memory-mapped
+     * file, whose lifetime the user of the array guarantees). Reads always go through one span, so both cases
+     * cost the same. The first modification of a borrowed array copies the elements into owned storage.
+     */
+    export template <class E>
+    class CowArray {
+    public:
+        CowArray() = default;
+
+        /** @brief Takes ownership of the elements of v. */
+        CowArray(std::vector<E> v) noexcept : owned_{std::move(v)}, view_{owned_} {}
+
+        /** @brief Views memory owned elsewhere without copying; the memory must outlive all uses. */
+        [[nodiscard]] static CowArray borrow(std::span<const E> elements) noexcept {
+            CowArray a;
+            a.view_ = elements;
+            a.borrowed_ = true;
+            return a;
+        }
+
+        CowArray(const CowArray& other)
+            : owned_{other.owned_}, view_{other.borrowed_ ? other.view_ : std::span<const E>{owned_}},
+              borrowed_{other.borrowed_} {}
+
+        CowArray(CowArray&& other) noexcept
+            : owned_{std::move(other.owned_)}, view_{other.borrowed_ ? other.view_ : std::span<const E>{owned_}},
+              borrowed_{other.borrowed_} {
+            other.clear();
+        }
+
+        CowArray& operator=(CowArray other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        void swap(CowArray& other) noexcept {
+            // Spans into owned vectors follow their buffers, which std::vector::swap exchanges
+            owned_.swap(other.owned_);
+            std::swap(view_, other.view_);
+            std::swap(borrowed_, other.borrowed_);
+        }
+
+        /** @brief Elements as a read-only span. */
+        [[nodiscard]] std::span<const E> view() const noexcept { return view_; }
+        operator std::span<const E>() const noexcept { return view_; }
+
+        [[nodiscard]] std::size_t size() const noexcept { return view_.size(); }
+        [[nodiscard]] bool empty() const noexcept { return view_.empty(); }
+        [[nodiscard]] const E* data() const noexcept { return view_.data(); }
+        [[nodiscard]] const E& operator[](std::size_t i) const noexcept { return view_[i]; }
+        [[nodiscard]] const E& front() const noexcept { return view_.front(); }
+        [[nodiscard]] auto begin() const noexcept { return view_.begin(); }
+        [[nodiscard]] auto end() const noexcept { return view_.end(); }
+
+        /** @brief True if the elements are borrowed rather than owned. */
+        [[nodiscard]] bool borrowed() const noexcept { return borrowed_; }
+
+        /**
+         * @brief Runs fn(std::vector<E>&) on owned storage, copying borrowed elements first.
+         * @details The view is refreshed afterwards, so fn may resize the vector.
+         */
+        template <class Fn>
+        void modify(Fn&& fn) {
+            if (borrowed_) {
+                owned_.assign(view_.begin(), view_.end());
+                borrowed_ = false;
+            }
+            std::forward<Fn>(fn)(owned_);
+            view_ = owned_;
+        }
+
+        void push_back(const E& e) { modify([&](std::vector<E>& v) { v.push_back(e); }); }
+
+        /** @brief Removes all elements and releases any borrowed view. */
+        void clear() noexcept {
+            owned_.clear();
+            view_ = {};
+            borrowed_ = false;
+        }
+
+    private:
+        std::vector<E> owned_{};
+        std::span<const E> view_{};
+        bool borrowed_{false};
+    };
+}
@@ -0,0 +1,216 @@
+module;
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+export module glimmer.denoise;
+
+import glimmer.vector;
+import glimmer.color;
+import glimmer.image;
+import glimmer.aov;
+import glimmer.tile;
+import glimmer.thread_pool;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing an edge-avoiding à-trous wavelet denoiser guided by AOV images.
+     */
+
+    /**
+     * @brief Edge-avoiding à-trous filter (Dammertz et al. 2010) for low-sample renders.
+     * @tparam T arithmetic scalar type (float/double recommended)
+     * @details Each pass convolves the image with the 5x5 B3-spline kernel, with taps 2^i pixels apart in pass i,
+     * so five passes cover a 125-pixel footprint at 25 taps per pixel and pass. Every tap is weighted down by
+     * how much it differs from the center pixel in color (compared after x / (1 + x) compression, so HDR
+     * values do not dominate), albedo, normal and relative depth; the AOVs are noise-free, so geometric and
+     * texture edges survive while lighting noise is averaged away. The color tolerance halves with every pass.
+     *
+     * With demodulation (the default), the beauty image is divided by the first-hit albedo before filtering and
+     * multiplied back afterwards, so texture detail is not blurred with the lighting. Passes run tile by tile on
+     * thread_pool(); the result does not depend on the number of threads.
+     */
+    export template <Arithmetic T>
+    class AtrousDenoiser {
+    public:
+        using Color3 = Color<T,3>;
+
+        /** @brief Filter settings. */
+        struct Options {
+            /** @brief Number of passes; 0 leaves the image unchanged. */
+            std::size_t iterations{5};
+            /** @brief Color tolerance of the first pass, in compressed units; halved each pass. */
+            T sigma_color{static_cast<T>(0.6)};
+            /** @brief Albedo tolerance. */
+            T sigma_albedo{static_cast<T>(0.1)};
+            /** @brief Normal sharpness: a tap is weighted by exp(-normal_power * (1 - dot(n_p, n_q))). */
+            T normal_power{64};
+            /** @brief Tolerated depth difference relative to the center depth, per pixel of tap distance. */
+            T sigma_depth{static_cast<T>(0.1)};
+            /** @brief Divide by the albedo before filtering and multiply it back afterwards. */
+            bool demodulate_albedo{true};
+        };
+
+        AtrousDenoiser() = default;
+        explicit AtrousDenoiser(const Options& options) : options_{options} {}
+
+        /** @brief Current settings. */
+        [[nodiscard]] const Options& options() const noexcept { return options_; }
+        /** @brief Replaces the settings. */
+        void set_options(const Options& options) noexcept { options_ = options; }
+
+        /** @brief Uses a dedicated pool; nullptr restores the shared pool. */
+        void set_thread_pool(std::shared_ptr<ThreadPool> pool) noexcept { pool_ = std::move(pool); }
+        /** @brief Pool the passes run on (never null). */
+        [[nodiscard]] ThreadPool& thread_pool() const noexcept { return pool_ ? *pool_ : *ThreadPool::shared(); }
+
+        /**
+         * @brief Denoises image in place.
+         * @throws std::invalid_argument if the AOV images do not match the image size
+         */
+        void apply(Image<T,3>& image, const AovImages<T>& aovs) const { apply(image, aovs, image); }
+
+        /**
+         * @brief Writes the denoised input to out (resized if needed); out may alias in.
+         * @throws std::invalid_argument if the AOV images do not match the input size
+         */
+        void apply(const Image<T,3>& in, const AovImages<T>& aovs, Image<T,3>& out) const {
+            const std::size_t w = in.width();
+            const std::size_t h = in.height();
+            if (aovs.albedo.width() != w || aovs.albedo.height() != h || aovs.normal.width() != w ||
+                aovs.normal.height() != h || aovs.depth.width() != w || aovs.depth.height() != h) {
+                throw std::invalid_argument("AtrousDenoiser::apply: AOV size does not match the image");
+            }
+            Image<T,3> src{w, h};
+            for (std::size_t i = 0; i < in.size(); ++i) {
+                src.data()[i] = demodulate_(in.data()[i], aovs.albedo.data()[i]);
+            }
+            if (options_.iterations > 0 && w > 0 && h > 0) {
+                // Averaged normals are shorter than 1 where a pixel straddles an edge; compare directions only
+                Image<T,3> normals{w, h};
+                for (std::size_t i = 0; i < normals.size(); ++i) {
+                    const Vector<T,3>& n = aovs.normal.data()[i];
+                    const T len2 = dot(n, n);
+                    if (len2 > T{0}) normals.data()[i] = n / static_cast<T>(std::sqrt(len2));
+                }
+                Image<T,3> dst{w, h};
+                Image<T,3> compressed{w, h};
+                const TileGrid grid{w, h, TileGrid::default_tile_size};
+                T sigma_color = options_.sigma_color;
+                for (std::size_t pass = 0; pass < options_.iterations; ++pass) {
+                    const std::size_t step = std::size_t{1} << std::min<std::size_t>(pass, 30);
+                    const T inv_color = T{1} / std::max(sigma_color * sigma_color, tiny_);
+                    thread_pool().parallel_for(grid.count(), [&](std::size_t i, std::size_t) {
+                        compress_tile_(grid.tile(i), src, compressed);
+                    });
+                    thread_pool().parallel_for(grid.count(), [&](std::size_t i, std::size_t) {
+                        filter_tile_(grid.tile(i), step, inv_color, src, compressed, aovs, normals, dst);
+                    });
+                    std::swap(src, dst);
+                    sigma_color /= T{2};
+                }
+            }
+            if (out.width() != w || out.height() != h) out.resize(w, h);
+            for (std::size_t i = 0; i < src.size(); ++i) {
+                out.data()[i] = remodulate_(src.data()[i], aovs.albedo.data()[i]);
+            }
+        }
+
+    private:
+        // B3-spline taps for offsets -2..2
+        static constexpr std::array<T,5> kernel_{T{1} / T{16}, T{1} / T{4}, T{3} / T{8}, T{1} / T{4}, T{1} / T{16}};
+        // Albedo channels below this are left undivided (black or emissive surfaces)
+        static constexpr T albedo_floor_ = static_cast<T>(1e-3);
+        static constexpr T tiny_ = static_cast<T>(1e-12);
+
+        [[nodiscard]] Color3 demodulate_(const Color3& c, const Color3& albedo) const noexcept {
+            if (!options_.demodulate_albedo) return c;
+            Color3 r{};
+            for (std::size_t k = 0; k < 3; ++k) r[k] = albedo[k] > albedo_floor_ ? c[k] / albedo[k] : c[k];
+            return r;
+        }
+
+        [[nodiscard]] Color3 remodulate_(const Color3& c, const Color3& albedo) const noexcept {
+            if (!options_.demodulate_albedo) return c;
+            Color3 r{};
+            for (std::size_t k = 0; k < 3; ++k) r[k] = albedo[k] > albedo_floor_ ? c[k] * albedo[k] : c[k];
+            return r;
+        }
+
+        // Bounded color for the edge-stopping distance
+        [[nodiscard]] static Color3 compress_(const Color3& c) noexcept {
+            Color3 r{};
+            for (std::size_t k = 0; k < 3; ++k) {
+                const T v = std::max(c[k], T{0});
+                r[k] = v / (T{1} + v);
+            }
+            return r;
+        }
+
+        static void compress_tile_(const Tile& tile, const Image<T,3>& src, Image<T,3>& dst) noexcept {
+            for (std::size_t y = tile.y0; y < tile.y1; ++y)
+                for (std::size_t x = tile.x0; x < tile.x1; ++x) dst(x, y) = compress_(src(x, y));
+        }
+
+        [[nodiscard]] static T squared_distance_(const Color3& a, const Color3& b) noexcept {
+            const Color3 d = a - b;
+            return dot(d, d);
+        }
+
+        // One à-trous pass over the pixels of a tile; taps outside the image are skipped
+        void filter_tile_(const Tile& tile, std::size_t step, T inv_color, const Image<T,3>& src,
+                          const Image<T,3>& compressed, const AovImages<T>& aovs, const Image<T,3>& normals,
+                          Image<T,3>& dst) const noexcept {
+            const std::size_t w = src.width();
+            const std::size_t h = src.height();
+            const T inv_albedo = T{1} / std::max(options_.sigma_albedo * options_.sigma_albedo, tiny_);
+            const T depth_scale = T{1} / std::max(options_.sigma_depth * static_cast<T>(step), tiny_);
+            for (std::size_t y = tile.y0; y < tile.y1; ++y) {
+                for (std::size_t x = tile.x0; x < tile.x1; ++x) {
+                    const Color3& cp = compressed(x, y);
+                    const Color3& ap = aovs.albedo(x, y);
+                    const Vector<T,3>& np = normals(x, y);
+                    const bool p_miss = dot(np, np) == T{0};
+                    const T dp = aovs.depth(x, y)[0];
+                    const T inv_dp = depth_scale / std::max(dp, tiny_);
+                    Color3 sum{T{0}, T{0}, T{0}};
+                    T weight_sum{0};
+                    for (int j = -2; j <= 2; ++j) {
+                        const auto qy = static_cast<std::ptrdiff_t>(y) + j * static_cast<std::ptrdiff_t>(step);
+                        if (qy < 0 || qy >= static_cast<std::ptrdiff_t>(h)) continue;
+                        for (int i = -2; i <= 2; ++i) {
+                            const auto qx = static_cast<std::ptrdiff_t>(x) + i * static_cast<std::ptrdiff_t>(step);
+                            if (qx < 0 || qx >= static_cast<std::ptrdiff_t>(w)) continue;
+                            const auto ux = static_cast<std::size_t>(qx);
+                            const auto uy = static_cast<std::size_t>(qy);
+                            const Color3& cq = src(ux, uy);
+                            const Vector<T,3>& nq = normals(ux, uy);
+                            // Pixels that missed the scene only blend with each other
+                            const bool q_miss = dot(nq, nq) == T{0};
+                            if (p_miss != q_miss) continue;
+                            const T cos_n = std::clamp(dot(np, nq), T{-1}, T{1});
+                            const T n_term = p_miss ? T{0} : options_.normal_power * (T{1} - cos_n);
+                            const T d_term = std::abs(aovs.depth(ux, uy)[0] - dp) * inv_dp;
+                            const T e = squared_distance_(compressed(ux, uy), cp) * inv_color +
+                                        squared_distance_(aovs.albedo(ux, uy), ap) * inv_albedo + n_term + d_term;
+                            const T wgt = kernel_[static_cast<std::size_t>(i + 2)] *
+                                          kernel_[static_cast<std::size_t>(j + 2)] * static_cast<T>(std::exp(-e));
+                            sum += cq * wgt;
+                            weight_sum += wgt;
+                        }
+                    }
+                    // The center tap always contributes, so weight_sum > 0
+                    dst(x, y) = sum / weight_sum;
+                }
+            }
+        }
+
+        Options options_{};
+        std::shared_ptr<ThreadPool> pool_{};
+    };
+}
@@ -30,6 +30,15 @@ namespace glimmer {
             T t{};
             Vector<T, 3> normal{};
             Vector<T, 2> uv{};
+            T uv_scale{}; // UV units per unit length on the surface at the hit (0 if unknown); sizes texture footprints
+        };
+
+        /** @brief Point on the surface drawn by sample_surface(). */
+        struct SurfaceSample
+        {
+            Vector<T, 3> p{};
+            Vector<T, 3> normal{}; // unit geometric normal
+            Vector<T, 2> uv{}; // as reported by intersect() at p
         };
 
         virtual ~Geometry() = default;
@@ -37,5 +46,26 @@ namespace glimmer {
         [[nodiscard]] virtual AABB<T> aabb() const noexcept = 0;
         /** @brief Ray intersection returning nearest hit within [tmin, tmax], if any. */
         [[nodiscard]] virtual std::optional<Hit> intersect(const Ray<T>& ray) const noexcept = 0;
+        /**
+         * @brief Any-hit query: returns true if the ray hits the shape anywhere within [tmin, tmax].
+         * @details Intended for shadow rays. The default forwards to intersect(); shapes override it to skip
+         * the closest-hit search and normal/UV computation.
+         */
+        [[nodiscard]] virtual bool occluded(const Ray<T>& ray) const noexcept { return intersect(ray).has_value(); }
+
+        /**
+         * @brief Surface area in object space, or 0 if the shape cannot be sampled by area (e.g. unbounded shapes).
+         * @details Shapes with nonzero area can act as area lights (see Scene::lights()).
+         */
+        [[nodiscard]] virtual T area() const noexcept { return T{0}; }
+        /**
+         * @brief Draws a point uniformly by area (density 1 / area()) from two uniform numbers in [0,1).
+         * @details Only meaningful when area() is nonzero.
+         */
+        [[nodiscard]] virtual SurfaceSample sample_surface(const Vector<T, 2>& u) const noexcept
+        {
+            (void)u;
+            return SurfaceSample{};
+        }
     };
 }
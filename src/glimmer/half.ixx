@@ -0,0 +1,52 @@
+module;
+#include <bit>
+#include <cstdint>
+
+export module glimmer.half;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing IEEE 754 binary16 (half-precision) conversions for compact texel storage.
+     */
+
+    /**
+     * @brief Converts a float to the bits of the nearest half (round to nearest even).
+     * @details Values beyond the half range become infinity; NaN stays NaN; tiny values become subnormals or zero.
+     */
+    export [[nodiscard]] constexpr std::uint16_t float_to_half(float f) noexcept {
+        const std::uint32_t x = std::bit_cast<std::uint32_t>(f);
+        const auto sign = static_cast<std::uint16_t>((x >> 16) & 0x8000u);
+        const std::uint32_t a = x & 0x7fffffffu;
+        if (a >= 0x7f800000u) return static_cast<std::uint16_t>(sign | 0x7c00u | (a > 0x7f800000u ? 0x200u : 0u));
+        if (a >= 0x477ff000u) return static_cast<std::uint16_t>(sign | 0x7c00u); // rounds past 65504
+        auto round_shift = [](std::uint32_t m, std::uint32_t shift) {
+            const std::uint32_t h = m >> shift;
+            const std::uint32_t rem = m & ((1u << shift) - 1u);
+            const std::uint32_t halfway = 1u << (shift - 1u);
+            return h + ((rem > halfway || (rem == halfway && (h & 1u))) ? 1u : 0u);
+        };
+        if (a < 0x38800000u) {
+            // Subnormal half: value = m * 2^-24
+            if (a < 0x33000000u) return sign;
+            const std::uint32_t e = a >> 23;
+            const std::uint32_t m = (a & 0x7fffffu) | 0x800000u;
+            return static_cast<std::uint16_t>(sign | round_shift(m, 126u - e));
+        }
+        // Rebias the exponent; a mantissa carry correctly rolls into the exponent
+        return static_cast<std::uint16_t>(sign | round_shift(a - 0x38000000u, 13u));
+    }
+
+    /** @brief Converts the bits of a half to float (exact). */
+    export [[nodiscard]] constexpr float half_to_float(std::uint16_t h) noexcept {
+        const std::uint32_t sign = static_cast<std::uint32_t>(h & 0x8000u) << 16;
+        const std::uint32_t e = (h >> 10) & 0x1fu;
+        const std::uint32_t m = h & 0x3ffu;
+        if (e == 0) {
+            const float v = static_cast<float>(m) * 0x1p-24f;
+            return sign ? -v : v;
+        }
+        if (e == 31) return std::bit_cast<float>(sign | 0x7f800000u | (m << 13));
+        return std::bit_cast<float>(sign | ((e + 112u) << 23) | (m << 13));
+    }
+}
@@ -1,18 +1,22 @@
 module;
 #include <vector>
 #include <cstddef>
+#include <cstdint>
+#include <span>
 #include <stdexcept>
 #include <algorithm>
+#include <type_traits>
 
 export module glimmer.image;
 
 import glimmer.vector;
 import glimmer.color;
+import glimmer.half;
 
 namespace glimmer {
     /**
      * @file
-     * @brief C++23 module providing a simple Image class for 2D pixel buffers.
+     * @brief C++23 module providing a simple Image class for 2D pixel buffers and compact-storage variants.
      */
 
     /**
@@ -115,4 +119,145 @@ namespace glimmer {
         size_type h_{};
         std::vector<pixel_type> data_{};
     };
+
+    /** @brief Per-channel storage of a CompactImage. */
+    export enum class PixelFormat {
+        f32, ///< IEEE binary32 per channel
+        f16  ///< IEEE binary16 per channel (HDR, about 3 significant digits)
+    };
+
+    /**
+     * @brief 2D image that stores N channels as float or half and converts to Color<T,N> on access.
+     * @tparam T arithmetic scalar type of the pixels passed in and out
+     * @tparam N number of channels
+     * @tparam F storage format of every channel
+     * @details Keeps HDR framebuffers small: a double RGB pixel takes 24 bytes in Image<double,3>, 12 bytes
+     * with f32 storage and 6 bytes with f16. Channels are stored interleaved in a row-major buffer, so rows can
+     * be converted in bulk (read_row()/write_row()) and f32 rows written to files as they are. Pixels are
+     * returned by value; there are no references into the storage.
+     */
+    export template <Arithmetic T, std::size_t N, PixelFormat F = PixelFormat::f32>
+    class CompactImage {
+    public:
+        using value_type = T;
+        using pixel_type = Color<T, N>;
+        using size_type = std::size_t;
+        using storage_type = std::conditional_t<F == PixelFormat::f16, std::uint16_t, float>;
+
+        /** @brief Storage format of the channels. */
+        static constexpr PixelFormat format = F;
+        /** @brief Bytes of storage per pixel. */
+        static constexpr size_type bytes_per_pixel = N * sizeof(storage_type);
+
+        /** @brief Constructs an empty image with zero dimensions. */
+        CompactImage() noexcept = default;
+
+        /** @brief Constructs a zeroed image with the given dimensions. */
+        CompactImage(size_type w, size_type h) : w_{w}, h_{h}, data_(N * w * h, storage_type{}) {}
+
+        /** @brief Converts an image to compact storage (rounding to the storage format). */
+        explicit CompactImage(const Image<T, N>& img) : CompactImage(img.width(), img.height()) {
+            for (size_type y = 0; y < h_; ++y) write_row(0, y, std::span<const pixel_type>{img.data() + y * w_, w_});
+        }
+
+        /** @brief Image width. */
+        [[nodiscard]] constexpr size_type width() const noexcept { return w_; }
+        /** @brief Image height. */
+        [[nodiscard]] constexpr size_type height() const noexcept { return h_; }
+        /** @brief Total pixel count. */
+        [[nodiscard]] constexpr size_type size() const noexcept { return w_ * h_; }
+        /** @brief Returns true if image is empty (w==0 || h==0). */
+        [[nodiscard]] constexpr bool empty() const noexcept { return data_.empty(); }
+        /** @brief Size of the pixel storage in bytes. */
+        [[nodiscard]] constexpr size_type bytes() const noexcept { return data_.size() * sizeof(storage_type); }
+
+        /** @brief Interleaved channel storage (N per pixel, row-major). */
+        [[nodiscard]] std::span<storage_type> channels() noexcept { return data_; }
+        /** @brief Const interleaved channel storage (N per pixel, row-major). */
+        [[nodiscard]] std::span<const storage_type> channels() const noexcept { return data_; }
+
+        /** @brief Unchecked read of pixel (x,y). */
+        [[nodiscard]] pixel_type get(size_type x, size_type y) const noexcept {
+            const storage_type* s = data_.data() + N * index(x, y);
+            pixel_type p;
+            for (size_type c = 0; c < N; ++c) p[c] = decode_(s[c]);
+            return p;
+        }
+
+        /** @brief Unchecked write of pixel (x,y). */
+        void set(size_type x, size_type y, const pixel_type& p) noexcept {
+            storage_type* s = data_.data() + N * index(x, y);
+            for (size_type c = 0; c < N; ++c) s[c] = encode_(p[c]);
+        }
+
+        /** @brief Adds p to pixel (x,y), e.g. to accumulate samples into a float framebuffer. */
+        void add(size_type x, size_type y, const pixel_type& p) noexcept { set(x, y, get(x, y) + p); }
+
+        /**
+         * @brief Bounds-checked pixel read.
+         * @throws std::out_of_range for out-of-bounds coordinates
+         */
+        [[nodiscard]] pixel_type at(size_type x, size_type y) const {
+            if (x >= w_ || y >= h_) throw std::out_of_range("CompactImage::at out of range");
+            return get(x, y);
+        }
+
+        /** @brief Converts out.size() pixels of row y starting at column x0 into out. */
+        void read_row(size_type x0, size_type y, std::span<pixel_type> out) const noexcept {
+            if (out.empty()) return;
+            const storage_type* s = data_.data() + N * index(x0, y);
+            T* d = out.data()->data();
+            static_assert(sizeof(pixel_type) == N * sizeof(T));
+            for (size_type i = 0; i < N * out.size(); ++i) d[i] = decode_(s[i]);
+        }
+
+        /** @brief Stores in.size() pixels into row y starting at column x0. */
+        void write_row(size_type x0, size_type y, std::span<const pixel_type> in) noexcept {
+            if (in.empty()) return;
+            storage_type* d = data_.data() + N * index(x0, y);
+            const T* s = in.data()->data();
+            for (size_type i = 0; i < N * in.size(); ++i) d[i] = encode_(s[i]);
+        }
+
+        /** @brief Fills all pixels with the given color. */
+        void clear(const pixel_type& value) {
+            for (size_type i = 0; i < size(); ++i) {
+                for (size_type c = 0; c < N; ++c) data_[N * i + c] = encode_(value[c]);
+            }
+        }
+
+        /** @brief Resizes the image and zeroes all pixels. */
+        void resize(size_type w, size_type h) {
+            w_ = w; h_ = h; data_.assign(N * w * h, storage_type{});
+        }
+
+        /** @brief Returns true if (x,y) lies within image bounds. */
+        [[nodiscard]] constexpr bool in_bounds(size_type x, size_type y) const noexcept {
+            return x < w_ && y < h_;
+        }
+
+        /** @brief Converts back to an Image of the pixel type. */
+        [[nodiscard]] Image<T, N> to_image() const {
+            Image<T, N> img{w_, h_};
+            for (size_type y = 0; y < h_; ++y) read_row(0, y, std::span<pixel_type>{img.data() + y * w_, w_});
+            return img;
+        }
+
+    private:
+        [[nodiscard]] constexpr size_type index(size_type x, size_type y) const noexcept { return y * w_ + x; }
+
+        [[nodiscard]] static storage_type encode_(T v) noexcept {
+            if constexpr (F == PixelFormat::f16) return float_to_half(static_cast<float>(v));
+            else return static_cast<float>(v);
+        }
+
+        [[nodiscard]] static T decode_(storage_type s) noexcept {
+            if constexpr (F == PixelFormat::f16) return static_cast<T>(half_to_float(s));
+            else return static_cast<T>(s);
+        }
+
+        size_type w_{};
+        size_type h_{};
+        std::vector<storage_type> data_{};
+    };
 }
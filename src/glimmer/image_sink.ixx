@@ -0,0 +1,269 @@
+module;
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+export module glimmer.image_sink;
+
+import glimmer.vector;
+import glimmer.color;
+import glimmer.image;
+import glimmer.tile;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing destinations for rendered tiles, so images can be written while rendering.
+     */
+
+    /**
+     * @brief Destination for the finished tiles of a render.
+     * @tparam T arithmetic scalar type of the pixels
+     * @details A renderer calls begin() once, write_tile() for every tile in any order and possibly concurrently
+     * from several threads, and end() once after the last tile. Sinks that encode and write tiles as they arrive
+     * make the memory of a render independent of the image size.
+     */
+    export template <Arithmetic T>
+    class ImageSink {
+    public:
+        using Color3 = Color<T,3>;
+
+        virtual ~ImageSink() = default;
+
+        /** @brief Starts an image of width x height pixels. */
+        virtual void begin(std::size_t width, std::size_t height) = 0;
+        /**
+         * @brief Receives one finished tile.
+         * @param tile image region
+         * @param pixels tile.width() * tile.height() colors in row-major order
+         * @details Called concurrently for distinct tiles; implementations must be thread-safe.
+         */
+        virtual void write_tile(const Tile& tile, std::span<const Color3> pixels) = 0;
+        /** @brief Called after the last tile of the image. */
+        virtual void end() {}
+    };
+
+    /** @brief Sink that stores tiles in an in-memory Image (resized on begin()). */
+    export template <Arithmetic T>
+    class ImageTarget final : public ImageSink<T> {
+    public:
+        using Color3 = Color<T,3>;
+
+        explicit ImageTarget(Image<T,3>& image) noexcept : image_{image} {}
+
+        void begin(std::size_t width, std::size_t height) override {
+            if (image_.width() != width || image_.height() != height) {
+                image_.resize(width, height, Color3{T{0},T{0},T{0}});
+            }
+        }
+
+        void write_tile(const Tile& tile, std::span<const Color3> pixels) override {
+            // Tiles are disjoint, so concurrent calls write disjoint pixels
+            for (std::size_t y = tile.y0; y < tile.y1; ++y) {
+                const auto row = pixels.subspan((y - tile.y0) * tile.width(), tile.width());
+                std::copy(row.begin(), row.end(), &image_(tile.x0, y));
+            }
+        }
+
+    private:
+        Image<T,3>& image_;
+    };
+
+    /**
+     * @brief Sink that stores tiles in a CompactImage (resized on begin()).
+     * @details Keeps the framebuffer at float or half precision, e.g. for HDR output with save_pfm() or for
+     * renders too large for a full Image of T.
+     */
+    export template <Arithmetic T, PixelFormat F>
+    class CompactImageTarget final : public ImageSink<T> {
+    public:
+        using Color3 = Color<T,3>;
+
+        explicit CompactImageTarget(CompactImage<T,3,F>& image) noexcept : image_{image} {}
+
+        void begin(std::size_t width, std::size_t height) override {
+            if (image_.width() != width || image_.height() != height) image_.resize(width, height);
+        }
+
+        void write_tile(const Tile& tile, std::span<const Color3> pixels) override {
+            // Tiles are disjoint, so concurrent calls write disjoint pixels
+            for (std::size_t y = tile.y0; y < tile.y1; ++y) {
+                image_.write_row(tile.x0, y, pixels.subspan((y - tile.y0) * tile.width(), tile.width()));
+            }
+        }
+
+    private:
+        CompactImage<T,3,F>& image_;
+    };
+
+    /**
+     * @brief Writes an image file row by row as rows are completed, optionally on a background I/O thread.
+     * @details Building block for streaming sinks of row-ordered formats (such as PPM). Callers fill row buffers
+     * obtained from row() in any order and from any thread, and report filled bytes with commit(). Once a row
+     * and all rows above it are complete they are handed to the I/O thread (or written directly when not
+     * asynchronous) and their memory is released, so only rows that are in progress or waiting to be written
+     * are held. Writers block while more than max_pending_bytes() are queued for I/O.
+     */
+    export class StreamingRowWriter {
+    public:
+        /** @brief Default limit of bytes queued for the I/O thread before writers wait. */
+        static constexpr std::size_t default_max_pending_bytes = std::size_t{64} << 20;
+
+        StreamingRowWriter() = default;
+        StreamingRowWriter(const StreamingRowWriter&) = delete;
+        StreamingRowWriter& operator=(const StreamingRowWriter&) = delete;
+
+        ~StreamingRowWriter() { (void)close(); }
+
+        /**
+         * @brief Opens the output file and writes the header.
+         * @param path destination path
+         * @param header bytes written before the first row
+         * @param rows number of rows
+         * @param row_bytes size of every row in bytes
+         * @param async write on a background thread
+         * @return false if the file cannot be opened
+         */
+        [[nodiscard]] bool open(const std::string& path, std::string_view header, std::size_t rows,
+                                std::size_t row_bytes, bool async = true) {
+            (void)close();
+            out_.open(path, std::ios::binary | std::ios::trunc);
+            if (!out_) return false;
+            out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+            good_ = out_.good();
+            rows_.assign(rows, {});
+            filled_.assign(rows, 0);
+            row_bytes_ = row_bytes;
+            next_row_ = 0;
+            pending_bytes_ = 0;
+            closing_ = false;
+            if (async) io_thread_ = std::thread{[this] { io_loop_(); }};
+            return good_;
+        }
+
+        /** @brief Sets the limit of bytes queued for I/O before commit() waits. */
+        void set_max_pending_bytes(std::size_t bytes) noexcept { max_pending_bytes_ = std::max<std::size_t>(bytes, 1); }
+        /** @brief Limit of bytes queued for I/O before commit() waits. */
+        [[nodiscard]] std::size_t max_pending_bytes() const noexcept { return max_pending_bytes_; }
+
+        /**
+         * @brief Buffer for row y (allocated on first use); remains valid until the row is committed in full.
+         * @details Distinct callers must fill disjoint byte ranges.
+         */
+        [[nodiscard]] std::span<unsigned char> row(std::size_t y) {
+            std::lock_guard lock{mutex_};
+            auto& r = rows_[y];
+            if (r.empty()) r.resize(row_bytes_);
+            return r;
+        }
+
+        /** @brief Records that n more bytes of row y are filled; completed rows are queued in order. */
+        void commit(std::size_t y, std::size_t n) {
+            std::unique_lock lock{mutex_};
+            filled_[y] += n;
+            const bool async = io_thread_.joinable();
+            while (next_row_ < rows_.size() && filled_[next_row_] == row_bytes_) {
+                if (async && pending_bytes_ >= max_pending_bytes_ && good_) {
+                    // Another thread may flush this row while we wait, so re-check afterwards
+                    space_.wait(lock, [&] { return pending_bytes_ < max_pending_bytes_ || !good_; });
+                    continue;
+                }
+                auto bytes = std::move(rows_[next_row_]);
+                rows_[next_row_] = {};
+                ++next_row_;
+                if (!async) {
+                    write_(bytes);
+                    continue;
+                }
+                pending_bytes_ += bytes.size();
+                queue_.push_back(std::move(bytes));
+                work_.notify_one();
+            }
+        }
+
+        /** @brief Number of rows written or queued so far. */
+        [[nodiscard]] std::size_t rows_done() const {
+            std::lock_guard lock{mutex_};
+            return next_row_;
+        }
+
+        /**
+         * @brief Finishes writing and closes the file.
+         * @return true if every row was completed and all data was written successfully
+         */
+        [[nodiscard]] bool close() {
+            {
+                std::lock_guard lock{mutex_};
+                closing_ = true;
+            }
+            work_.notify_all();
+            if (io_thread_.joinable()) io_thread_.join();
+            if (!out_.is_open()) return good_;
+            const bool complete = next_row_ == rows_.size();
+            out_.close();
+            good_ = good_ && complete && !out_.fail();
+            rows_.clear();
+            filled_.clear();
+            return good_;
+        }
+
+        /** @brief False once a write failed. */
+        [[nodiscard]] bool good() const {
+            std::lock_guard lock{mutex_};
+            return good_;
+        }
+
+    private:
+        void write_(const std::vector<unsigned char>& bytes) {
+            if (!good_) return;
+            out_.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            good_ = out_.good();
+        }
+
+        void io_loop_() {
+            std::unique_lock lock{mutex_};
+            while (true) {
+                work_.wait(lock, [&] { return !queue_.empty() || closing_; });
+                if (queue_.empty()) return;
+                auto bytes = std::move(queue_.front());
+                queue_.pop_front();
+                const bool ok = good_;
+                lock.unlock();
+                // Only this thread touches the stream while it runs
+                bool wrote = ok;
+                if (ok) {
+                    out_.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+                    wrote = out_.good();
+                }
+                lock.lock();
+                good_ = good_ && wrote;
+                pending_bytes_ -= bytes.size();
+                space_.notify_all();
+            }
+        }
+
+        std::ofstream out_{};
+        std::vector<std::vector<unsigned char>> rows_{};
+        std::vector<std::size_t> filled_{};
+        std::size_t row_bytes_{0};
+        std::size_t next_row_{0};
+        std::deque<std::vector<unsigned char>> queue_{};
+        std::size_t pending_bytes_{0};
+        std::size_t max_pending_bytes_{default_max_pending_bytes};
+        bool good_{false};
+        bool closing_{false};
+        std::thread io_thread_{};
+        mutable std::mutex mutex_{};
+        std::condition_variable work_{};
+        std::condition_variable space_{};
+    };
+}
@@ -0,0 +1,36 @@
+module;
+#include <cstdint>
+
+export module glimmer.instance;
+
+import glimmer.vector;
+import glimmer.affine;
+import glimmer.material_table;
+
+namespace glimmer
+{
+    /**
+     * @file
+     * @brief C++23 module defining the compact instance record stored by Scene.
+     */
+
+    /** @brief Index of a shared geometry in Scene::geometries(). */
+    export using GeometryId = std::uint32_t;
+
+    /**
+     * @brief Placement of a shared geometry: both affine maps plus geometry and material ids.
+     * @tparam T arithmetic scalar type
+     * @details 24 scalars and two 32-bit ids (104 bytes for float), stored by value in a flat array. Unlike
+     * SceneObject it owns nothing: the geometry lives once in the scene and the material in its MaterialTable,
+     * so a million instances of a few meshes fit in about 100 MB. Rays are mapped with to_object only when
+     * traversal reaches the instance's bottom-level geometry, and normals with to_object's transpose.
+     */
+    export template <Arithmetic T>
+    struct Instance
+    {
+        Affine3<T> to_world{};
+        Affine3<T> to_object{};
+        GeometryId geometry{};
+        MaterialId material{invalid_material};
+    };
+}
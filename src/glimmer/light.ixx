@@ -0,0 +1,101 @@
+module;
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+export module glimmer.light;
+
+import glimmer.vector;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing the emitter list used for next-event estimation.
+     */
+
+    /** @brief Emissive scene object registered for direct light sampling. */
+    export template <Arithmetic T>
+    struct Light {
+        std::uint32_t object{}; // index into Scene::objects()
+        T area{};               // world-space surface area
+        T power{};              // emitted power estimate (pi * area * mean radiance), used to pick lights
+    };
+
+    /** @brief Light chosen by LightList::pick() with its selection probability. */
+    export template <Arithmetic T>
+    struct LightPick {
+        std::uint32_t light{};
+        T pmf{};
+    };
+
+    /**
+     * @brief List of emitters with a power-proportional selection distribution.
+     * @tparam T arithmetic scalar type
+     * @details Lights are picked with probability proportional to their power by binary search over the running
+     * power sums, so bright emitters receive most shadow rays. Objects are looked up by their scene index.
+     */
+    export template <Arithmetic T>
+    class LightList {
+    public:
+        /** @brief Marks objects that are not lights in find(). */
+        static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+        /** @brief Adds a light; entries with non-positive area or power are ignored. */
+        void add(const Light<T>& light) {
+            if (!(light.area > T{0}) || !(light.power > T{0})) return;
+            if (light.object >= index_.size()) index_.resize(static_cast<std::size_t>(light.object) + 1, npos);
+            index_[light.object] = static_cast<std::uint32_t>(lights_.size());
+            lights_.push_back(light);
+            cdf_.push_back(total_power() + light.power);
+        }
+
+        /** @brief Removes all lights. */
+        void clear() noexcept {
+            lights_.clear();
+            cdf_.clear();
+            index_.clear();
+        }
+
+        /** @brief Number of lights. */
+        [[nodiscard]] std::size_t size() const noexcept { return lights_.size(); }
+        /** @brief True if there are no lights. */
+        [[nodiscard]] bool empty() const noexcept { return lights_.empty(); }
+        /** @brief Light by index (unchecked). */
+        [[nodiscard]] const Light<T>& operator[](std::size_t i) const noexcept { return lights_[i]; }
+        /** @brief Sum of all light powers. */
+        [[nodiscard]] T total_power() const noexcept { return cdf_.empty() ? T{0} : cdf_.back(); }
+
+        /** @brief Index of the light for scene object object, or npos. */
+        [[nodiscard]] std::uint32_t find(std::size_t object) const noexcept {
+            return object < index_.size() ? index_[object] : npos;
+        }
+
+        /** @brief Probability that pick() selects light i. */
+        [[nodiscard]] T pmf(std::size_t i) const noexcept { return lights_[i].power / total_power(); }
+
+        /** @brief Selects a light proportionally to power from a uniform number in [0,1); requires !empty(). */
+        [[nodiscard]] LightPick<T> pick(T u) const noexcept {
+            const auto it = std::upper_bound(cdf_.begin(), cdf_.end(), u * total_power());
+            const auto i = std::min<std::size_t>(static_cast<std::size_t>(it - cdf_.begin()), lights_.size() - 1);
+            return LightPick<T>{static_cast<std::uint32_t>(i), pmf(i)};
+        }
+
+    private:
+        std::vector<Light<T>> lights_{};
+        std::vector<T> cdf_{};
+        std::vector<std::uint32_t> index_{};
+    };
+
+    /**
+     * @brief Power heuristic (beta = 2) weight of a strategy with density pdf_a against one with density pdf_b.
+     * @details Used to combine light sampling and BSDF sampling (multiple importance sampling).
+     */
+    export template <Arithmetic T>
+    [[nodiscard]] constexpr T power_heuristic(T pdf_a, T pdf_b) noexcept {
+        const T a = pdf_a * pdf_a;
+        const T b = pdf_b * pdf_b;
+        return a + b > T{0} ? a / (a + b) : T{0};
+    }
+}
@@ -0,0 +1,130 @@
+module;
+#include <cstddef>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GLIMMER_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+export module glimmer.mapped_file;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing read-only memory-mapped file access.
+     */
+
+    /**
+     * @brief Read-only view of a whole file, memory-mapped where the platform supports it.
+     * @details On POSIX systems the file is mapped with mmap() and pages are read lazily by the OS, so parsers can
+     * work directly on the file contents without copying them. Elsewhere the file is read into an owned buffer.
+     * Move-only; the view stays valid for the lifetime of the object.
+     */
+    export class MappedFile {
+    public:
+        MappedFile() = default;
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept
+            : data_{std::exchange(other.data_, nullptr)}, size_{std::exchange(other.size_, 0)},
+              mapped_{std::exchange(other.mapped_, false)}, buffer_{std::move(other.buffer_)} {}
+
+        MappedFile& operator=(MappedFile&& other) noexcept {
+            if (this != &other) {
+                release_();
+                data_ = std::exchange(other.data_, nullptr);
+                size_ = std::exchange(other.size_, 0);
+                mapped_ = std::exchange(other.mapped_, false);
+                buffer_ = std::move(other.buffer_);
+            }
+            return *this;
+        }
+
+        ~MappedFile() { release_(); }
+
+        /**
+         * @brief Opens a file for reading.
+         * @param path filesystem path
+         * @return the mapped file, or std::nullopt if it cannot be opened or mapped
+         */
+        [[nodiscard]] static std::optional<MappedFile> open(const std::string& path) {
+            MappedFile file;
+#if defined(GLIMMER_HAS_MMAP)
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return std::nullopt;
+            struct stat st{};
+            if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+                ::close(fd);
+                return std::nullopt;
+            }
+            file.size_ = static_cast<std::size_t>(st.st_size);
+            if (file.size_ > 0) {
+                void* p = ::mmap(nullptr, file.size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    ::close(fd);
+                    return std::nullopt;
+                }
+                ::madvise(p, file.size_, MADV_SEQUENTIAL);
+                file.data_ = static_cast<const char*>(p);
+                file.mapped_ = true;
+            }
+            ::close(fd);
+#else
+            std::ifstream f(path, std::ios::binary | std::ios::ate);
+            if (!f) return std::nullopt;
+            const auto end = f.tellg();
+            if (end < 0) return std::nullopt;
+            file.buffer_.resize(static_cast<std::size_t>(end));
+            f.seekg(0);
+            if (!file.buffer_.empty() && !f.read(file.buffer_.data(), static_cast<std::streamsize>(file.buffer_.size()))) {
+                return std::nullopt;
+            }
+            file.data_ = file.buffer_.data();
+            file.size_ = file.buffer_.size();
+#endif
+            return file;
+        }
+
+        /** @brief Pointer to the first byte (null for empty files). */
+        [[nodiscard]] const char* data() const noexcept { return data_; }
+        /** @brief File size in bytes. */
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+        /** @brief True if the file has no contents. */
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+        /** @brief True if the contents are memory-mapped rather than copied into a buffer. */
+        [[nodiscard]] bool mapped() const noexcept { return mapped_; }
+
+        /** @brief File contents as bytes. */
+        [[nodiscard]] std::span<const char> bytes() const noexcept { return {data_, size_}; }
+        /** @brief File contents as text. */
+        [[nodiscard]] std::string_view view() const noexcept { return {data_, size_}; }
+
+    private:
+        void release_() noexcept {
+#if defined(GLIMMER_HAS_MMAP)
+            if (mapped_ && data_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+            data_ = nullptr;
+            size_ = 0;
+            mapped_ = false;
+            buffer_.clear();
+        }
+
+        const char* data_{nullptr};
+        std::size_t size_{0};
+        bool mapped_{false};
+        std::vector<char> buffer_{};
+    };
+}
@@ -17,5 +17,15 @@ namespace glimmer
         using output_type = Out;
         virtual ~MaterialProperty() = default;
         [[nodiscard]] virtual Out get(const Vector<T, 2>& uv) const noexcept = 0;
+        /**
+         * @brief Samples the property over a UV-space footprint (the width covered by one sample).
+         * @details Filtered properties such as textures use the footprint to choose a mip level; the default
+         * ignores it.
+         */
+        [[nodiscard]] virtual Out sample(const Vector<T, 2>& uv, T footprint) const noexcept
+        {
+            (void)footprint;
+            return get(uv);
+        }
     };
 }
\ No newline at end of file
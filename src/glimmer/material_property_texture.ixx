@@ -0,0 +1,46 @@
+module;
+#include <memory>
+#include <utility>
+
+export module glimmer.material_property.texture;
+
+import glimmer.material_property;
+import glimmer.vector;
+import glimmer.color;
+import glimmer.texture;
+
+namespace glimmer
+{
+    /**
+     * @brief Material property sampled from a shared, mip-mapped Texture.
+     * @tparam T arithmetic scalar type
+     * @details Unlike ImageMaterialProperty, the property shares ownership of its texture. get() samples the
+     * finest mip level; sample() uses the footprint to filter across levels.
+     */
+    export template <Arithmetic T>
+    class TextureMaterialProperty final : public MaterialProperty<T, Color<T, 3>>
+    {
+    public:
+        using Out = Color<T, 3>;
+        using Vector2 = Vector<T, 2>;
+
+        explicit TextureMaterialProperty(std::shared_ptr<const Texture<T>> texture) noexcept
+            : texture_{std::move(texture)}
+        {
+        }
+
+        [[nodiscard]] Out get(const Vector2& uv) const noexcept override { return sample(uv, T{0}); }
+
+        [[nodiscard]] Out sample(const Vector2& uv, T footprint) const noexcept override
+        {
+            if (!texture_) return Out{};
+            return texture_->sample(uv, footprint);
+        }
+
+        /** @brief The sampled texture (may be null). */
+        [[nodiscard]] const std::shared_ptr<const Texture<T>>& texture() const noexcept { return texture_; }
+
+    private:
+        std::shared_ptr<const Texture<T>> texture_{};
+    };
+}
@@ -20,6 +20,9 @@ namespace glimmer
 
         [[nodiscard]] Out get(const Vector<T, 2>&) const noexcept override { return value_; }
 
+        /** @brief The constant value. */
+        [[nodiscard]] constexpr const Out& value() const noexcept { return value_; }
+
     private:
         Out value_{};
     };
@@ -0,0 +1,241 @@
+module;
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+export module glimmer.material_table;
+
+import glimmer.vector;
+import glimmer.color;
+import glimmer.material_property;
+import glimmer.material_property.uniform;
+import glimmer.material_property.image;
+import glimmer.material_property.checkerboard;
+import glimmer.material_property.texture;
+import glimmer.material;
+import glimmer.bsdf;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing a flat, scene-wide material table with devirtualized property evaluation.
+     */
+
+    /** @brief Index of a material in a MaterialTable. */
+    export using MaterialId = std::uint32_t;
+
+    /** @brief MaterialId of objects that have no table entry yet. */
+    export inline constexpr MaterialId invalid_material = ~MaterialId{0};
+
+    /**
+     * @brief One material property stored by value with tagged dispatch.
+     * @tparam T arithmetic scalar type
+     * @tparam Out property value type
+     * @details Uniform values are stored inline. Color properties may also hold a copy of a checkerboard, image or
+     * texture property, whose (final) members are called directly. Any other MaterialProperty implementation is
+     * called through its virtual interface; the owning MaterialTable keeps it alive.
+     */
+    export template <Arithmetic T, typename Out>
+    class PropertySlot {
+    public:
+        using Vector2 = Vector<T,2>;
+        using Custom = const MaterialProperty<T,Out>*;
+        static constexpr bool is_color = std::is_same_v<Out, Color<T,3>>;
+        using Storage = std::conditional_t<is_color,
+            std::variant<Out, CheckerboardMaterialProperty<T,3>, ImageMaterialProperty<T,3>,
+                         TextureMaterialProperty<T>, Custom>,
+            std::variant<Out, Custom>>;
+
+        PropertySlot() = default;
+        /** @brief Uniform slot holding v. */
+        explicit PropertySlot(const Out& v) noexcept : value_{v} {}
+
+        /**
+         * @brief Converts a property object, recognizing the uniform, checkerboard, image and texture implementations.
+         * @param p property (null yields a value-initialized uniform)
+         * @param keep_alive receives p if it has to be called through its virtual interface
+         */
+        [[nodiscard]] static PropertySlot from(const std::shared_ptr<MaterialProperty<T,Out>>& p,
+                                               std::vector<std::shared_ptr<const void>>& keep_alive) {
+            PropertySlot s;
+            if (!p) return s;
+            if (const auto* u = dynamic_cast<const UniformMaterialProperty<T,Out>*>(p.get())) {
+                s.value_ = u->value();
+                return s;
+            }
+            if constexpr (is_color) {
+                if (const auto* c = dynamic_cast<const CheckerboardMaterialProperty<T,3>*>(p.get())) {
+                    s.value_ = *c;
+                    return s;
+                }
+                if (const auto* i = dynamic_cast<const ImageMaterialProperty<T,3>*>(p.get())) {
+                    s.value_ = *i;
+                    return s;
+                }
+                if (const auto* t = dynamic_cast<const TextureMaterialProperty<T>*>(p.get())) {
+                    s.value_ = *t;
+                    return s;
+                }
+            }
+            keep_alive.push_back(p);
+            s.value_ = Custom{p.get()};
+            return s;
+        }
+
+        /** @brief True if the value does not depend on UV. */
+        [[nodiscard]] bool uniform() const noexcept { return value_.index() == 0; }
+
+        /** @brief Value at the given UV over a UV-space footprint (see MaterialProperty::sample). */
+        [[nodiscard]] Out get(const Vector2& uv, T footprint = T{0}) const noexcept {
+            if (const auto* v = std::get_if<0>(&value_)) return *v;
+            if constexpr (is_color) {
+                if (const auto* c = std::get_if<1>(&value_)) return c->get(uv);
+                if (const auto* i = std::get_if<2>(&value_)) return i->get(uv);
+                if (const auto* t = std::get_if<3>(&value_)) return t->sample(uv, footprint);
+            }
+            return (*std::get_if<Custom>(&value_))->sample(uv, footprint);
+        }
+
+    private:
+        Storage value_{};
+    };
+
+    /**
+     * @brief Scene-wide table of materials flattened for shading.
+     * @tparam T arithmetic scalar type
+     * @details Each entry stores the properties used by the integrators by value (see PropertySlot), so
+     * evaluating a material is one indexed load and, for materials whose properties are all uniform, no
+     * dispatch at all: their SurfaceParams are precomputed. Materials are added once and referenced by
+     * MaterialId. The tangent-space normal perturbation is not used by the integrators and is not stored.
+     */
+    export template <Arithmetic T>
+    class MaterialTable {
+    public:
+        using Color3 = Color<T,3>;
+        using Vector2 = Vector<T,2>;
+
+        /** @brief Adds a copy of m and returns its id. */
+        MaterialId add(const Material<T>& m) {
+            Entry e;
+            e.albedo = PropertySlot<T,Color3>::from(m.albedo_property(), keep_alive_);
+            e.radiance = PropertySlot<T,Color3>::from(m.radiance_property(), keep_alive_);
+            e.roughness = PropertySlot<T,T>::from(m.roughness_property(), keep_alive_);
+            e.transparency = PropertySlot<T,T>::from(m.transparency_property(), keep_alive_);
+            e.emission = PropertySlot<T,T>::from(m.emission_property(), keep_alive_);
+            e.ior = PropertySlot<T,T>::from(m.refractive_index_property(), keep_alive_);
+            e.uniform = e.albedo.uniform() && e.radiance.uniform() && e.roughness.uniform()
+                && e.transparency.uniform() && e.emission.uniform() && e.ior.uniform();
+            if (e.uniform) e.constant = evaluate_(e, Vector2{T{0}, T{0}}, T{0});
+            e.features = features_(e);
+            features_union_ |= e.features;
+            entries_.push_back(std::move(e));
+            return static_cast<MaterialId>(entries_.size() - 1);
+        }
+
+        /**
+         * @brief Returns the id of a shared material, adding it on first use.
+         * @details Materials are identified by address; the table holds a reference so the address stays unique.
+         */
+        MaterialId intern(const std::shared_ptr<const Material<T>>& m) {
+            if (!m) return invalid_material;
+            if (const auto it = interned_.find(m.get()); it != interned_.end()) return it->second;
+            const MaterialId id = add(*m);
+            interned_.emplace(m.get(), id);
+            keep_alive_.push_back(m);
+            return id;
+        }
+
+        /** @brief Number of materials. */
+        [[nodiscard]] std::size_t size() const noexcept { return entries_.size(); }
+        /** @brief True if the table has no materials. */
+        [[nodiscard]] bool empty() const noexcept { return entries_.empty(); }
+
+        /** @brief Removes all materials; previously returned ids become invalid. */
+        void clear() noexcept {
+            entries_.clear();
+            interned_.clear();
+            keep_alive_.clear();
+            features_union_ = ShadingFeatures::none();
+        }
+
+        /** @brief True if every property of material id is uniform. */
+        [[nodiscard]] bool uniform(MaterialId id) const noexcept { return entries_[id].uniform; }
+
+        /**
+         * @brief Shading features material id can produce.
+         * @details Exact for uniform properties; a property that varies with UV is assumed to take any value.
+         */
+        [[nodiscard]] ShadingFeatures features(MaterialId id) const noexcept { return entries_[id].features; }
+        /** @brief Union of the features of all materials, kept up to date by add(). */
+        [[nodiscard]] ShadingFeatures features() const noexcept { return features_union_; }
+
+        /**
+         * @brief Evaluates all shading terms of material id at the given UV in one call.
+         * @param footprint UV-space width of the sample, used by filtered (mip-mapped) properties
+         */
+        [[nodiscard]] SurfaceParams<T> surface(MaterialId id, const Vector2& uv, T footprint = T{0}) const noexcept {
+            const Entry& e = entries_[id];
+            if (e.uniform) return e.constant;
+            return evaluate_(e, uv, footprint);
+        }
+
+        /**
+         * @brief Emitted radiance of material id averaged over the unit UV square.
+         * @details Exact for uniform materials; textured entries are averaged over a 4x4 grid of UVs. Used to
+         * find and weight emitters.
+         */
+        [[nodiscard]] Color3 average_emitted(MaterialId id) const noexcept {
+            const Entry& e = entries_[id];
+            if (e.uniform) return e.constant.emitted;
+            Color3 sum{T{0}, T{0}, T{0}};
+            for (int y = 0; y < 4; ++y)
+                for (int x = 0; x < 4; ++x)
+                    sum += evaluate_(e, Vector2{(static_cast<T>(x) + T{0.5}) / T{4}, (static_cast<T>(y) + T{0.5}) / T{4}}, T{0}).emitted;
+            return sum / T{16};
+        }
+
+    private:
+        struct Entry {
+            PropertySlot<T,Color3> albedo{};
+            PropertySlot<T,Color3> radiance{};
+            PropertySlot<T,T> roughness{};
+            PropertySlot<T,T> transparency{};
+            PropertySlot<T,T> emission{};
+            PropertySlot<T,T> ior{T{1}};
+            bool uniform{true};
+            SurfaceParams<T> constant{};
+            ShadingFeatures features{};
+        };
+
+        // Same clamping as the Material accessors
+        static constexpr T clamp01_(T v) noexcept { return v < T{0} ? T{0} : (v > T{1} ? T{1} : v); }
+        static constexpr T clamp_nonneg_(T v) noexcept { return v < T{0} ? T{0} : v; }
+        static constexpr T clamp_min_one_(T v) noexcept { return v < T{1} ? T{1} : v; }
+
+        [[nodiscard]] static SurfaceParams<T> evaluate_(const Entry& e, const Vector2& uv, T fp) noexcept {
+            return SurfaceParams<T>{e.radiance.get(uv, fp) * clamp_nonneg_(e.emission.get(uv, fp)), e.albedo.get(uv, fp),
+                                    clamp01_(e.roughness.get(uv, fp)), clamp01_(e.transparency.get(uv, fp)),
+                                    clamp_min_one_(e.ior.get(uv, fp))};
+        }
+
+        [[nodiscard]] static ShadingFeatures features_(const Entry& e) noexcept {
+            if (e.uniform) return shading_features(e.constant);
+            ShadingFeatures f = shading_features(evaluate_(e, Vector2{T{0}, T{0}}, T{0}));
+            f.dielectric = f.dielectric || !e.transparency.uniform();
+            f.specular = f.specular || !e.roughness.uniform();
+            f.emission = f.emission || !e.radiance.uniform() || !e.emission.uniform();
+            f.textured = true;
+            return f;
+        }
+
+        std::vector<Entry> entries_{};
+        ShadingFeatures features_union_{ShadingFeatures::none()};
+        std::unordered_map<const Material<T>*, MaterialId> interned_{};
+        std::vector<std::shared_ptr<const void>> keep_alive_{};
+    };
+}
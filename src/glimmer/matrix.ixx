@@ -378,8 +378,8 @@ namespace glimmer
                  * @brief Inverse of a square matrix.
                  * @return A^{-1}
                  * @throws std::domain_error if the matrix is singular (non-invertible)
-                 * @details Uses closed forms for sizes 1..3, and a generic Gauss–Jordan
-                 * elimination with partial pivoting for size >= 4.
+                 * @details Uses closed forms for sizes 1..3 and for affine 4x4 matrices (last row 0 0 0 1), and a
+                 * generic Gauss–Jordan elimination with partial pivoting otherwise.
                  */
         [[nodiscard]] Matrix inverse() const
         {
@@ -418,6 +418,33 @@ namespace glimmer
                 adj(2, 2) = (*this)(0, 0) * (*this)(1, 1) - (*this)(0, 1) * (*this)(1, 0);
                 return (T{1} / d) * adj.transposed(); // inverse = adj(A)^T / det
             }
+            else if constexpr (R == 4)
+            {
+                // Affine fast path: [A t; 0 1]^-1 = [A^-1 -A^-1 t; 0 1], with A^-1 from the 3x3 adjugate
+                const auto& m = *this;
+                if (m(3, 0) != T{} || m(3, 1) != T{} || m(3, 2) != T{} || m(3, 3) != T{1})
+                    return detail::inverse_gauss_jordan_N<T, R>(*this);
+                const T c00 = m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1);
+                const T c01 = m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2);
+                const T c02 = m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0);
+                const T d = m(0, 0) * c00 + m(0, 1) * c01 + m(0, 2) * c02;
+                if (d == T{}) throw std::domain_error("singular matrix");
+                const T s = T{1} / d;
+                Matrix inv{};
+                inv(0, 0) = c00 * s;
+                inv(0, 1) = (m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2)) * s;
+                inv(0, 2) = (m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1)) * s;
+                inv(1, 0) = c01 * s;
+                inv(1, 1) = (m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0)) * s;
+                inv(1, 2) = (m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2)) * s;
+                inv(2, 0) = c02 * s;
+                inv(2, 1) = (m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1)) * s;
+                inv(2, 2) = (m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0)) * s;
+                for (size_type r = 0; r < 3; ++r)
+                    inv(r, 3) = -(inv(r, 0) * m(0, 3) + inv(r, 1) * m(1, 3) + inv(r, 2) * m(2, 3));
+                inv(3, 3) = T{1};
+                return inv;
+            }
             else
             {
                 return detail::inverse_gauss_jordan_N<T, R>(*this);
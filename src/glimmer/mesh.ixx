@@ -1,32 +1,261 @@
 module;
 #include <vector>
 #include <array>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <algorithm>
 #include <limits>
 #include <type_traits>
+#include <memory>
 #include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
 
 export module glimmer.mesh;
 
 import glimmer.vector;
 import glimmer.ray;
 import glimmer.aabb;
+import glimmer.ray_packet;
+import glimmer.bvh;
 import glimmer.geometry;
+import glimmer.cow_array;
 
 namespace glimmer {
+    /** @brief Mesh storage layout: trades memory for triangle intersection speed. */
+    export enum class MeshLayout {
+        compact,    ///< positions and 32-bit indices only; edges and normals are computed per triangle test
+        precomputed ///< additionally caches each triangle's first vertex, edges and unit normal
+    };
+
+    /** @brief Ray-triangle hit: distance, barycentrics and unit geometric normal. */
+    export template <Arithmetic T>
+    struct TriHit { T t{}; T u{}; T v{}; Vector<T,3> normal{}; };
+
+    /**
+     * @brief Per-triangle data precomputed for intersection tests.
+     * @details Holds everything the Möller–Trumbore kernel derives from the three vertices (4 * 3 scalars).
+     */
+    export template <Arithmetic T>
+    struct TriangleEdges {
+        Vector<T,3> p0{};
+        Vector<T,3> e1{};
+        Vector<T,3> e2{};
+        Vector<T,3> normal{};
+    };
+
+    namespace mesh_detail {
+        // Unit geometric normal cross(e1, e2); +z for degenerate triangles
+        template <Arithmetic T>
+        [[nodiscard]] Vector<T,3> triangle_normal(const Vector<T,3>& e1, const Vector<T,3>& e2) noexcept {
+            const Vector<T,3> n = cross(e1, e2);
+            const auto nn = n.norm();
+            if (nn == T{0}) return Vector<T,3>{T{0},T{0},T{1}};
+            if constexpr (std::is_floating_point_v<T>) return n / nn;
+            else return Vector<T,3>{ static_cast<T>(n[0]/nn), static_cast<T>(n[1]/nn), static_cast<T>(n[2]/nn) };
+        }
+
+        template <Arithmetic T>
+        [[nodiscard]] TriangleEdges<T> make_edges(const Vector<T,3>& p0, const Vector<T,3>& p1,
+                                                  const Vector<T,3>& p2) noexcept {
+            const Vector<T,3> e1 = p1 - p0;
+            const Vector<T,3> e2 = p2 - p0;
+            return TriangleEdges<T>{p0, e1, e2, triangle_normal(e1, e2)};
+        }
+    }
+
     /**
-     * @brief Triangle mesh holding positions and triangle indices.
+     * @brief Triangle mesh holding positions and triangle indices, with optional normals and texture coordinates.
      * @tparam T arithmetic scalar type
+     * @details Ray queries are brute force until build_bvh() is called, after which a bottom-level BVH over the
+     * triangles is used. Adding triangles invalidates the BVH. load_obj() builds it automatically.
+     *
+     * Normals and texture coordinates are indexed per triangle corner, independently of the positions (as in
+     * OBJ files). When a hit triangle has all three normal indices, the hit normal is the interpolated shading
+     * normal; when it has all three texture coordinate indices, the hit uv is interpolated as well.
+     *
+     * Triangles use 32-bit vertex indices. With MeshLayout::precomputed the mesh also caches TriangleEdges per
+     * triangle (rebuilt by build_bvh()), which removes the edge and normal computation from every triangle test
+     * at the cost of 12 extra scalars per triangle; MeshLayout::compact keeps only positions and indices.
+     *
+     * build_bvh() also tabulates the triangle areas, which lets the mesh be sampled by area (e.g. as an area
+     * light); until then area() is 0.
+     *
+     * A mesh can borrow() its arrays from memory it does not own (see glimmer.mesh_cache), in which case they are
+     * copied only if the mesh is modified.
      */
     export template <Arithmetic T>
     class Mesh : public Geometry<T> {
     public:
-        struct Triangle { std::size_t i0{}, i1{}, i2{}; };
+        /** @brief Triangle as three 32-bit vertex indices. */
+        struct Triangle { std::uint32_t i0{}, i1{}, i2{}; };
+
+        /** @brief Marks a missing normal or texture coordinate index. */
+        static constexpr std::uint32_t no_attribute = std::numeric_limits<std::uint32_t>::max();
+
+        /** @brief Per-corner normal and texture coordinate indices of a triangle. */
+        struct TriangleAttributes {
+            std::array<std::uint32_t,3> normal{no_attribute, no_attribute, no_attribute};
+            std::array<std::uint32_t,3> texcoord{no_attribute, no_attribute, no_attribute};
+        };
+
+        Mesh() = default;
+
+        /** @brief Constructs a mesh from vertex positions and triangles (no BVH yet). */
+        Mesh(std::vector<Vector<T,3>> vertices, std::vector<Triangle> triangles)
+            : vertices_{std::move(vertices)}, tris_{std::move(triangles)} {}
+
+        /** @brief Read-only views of all mesh arrays, including the BVH (empty spans for absent data). */
+        struct Arrays {
+            std::span<const Vector<T,3>> vertices{};
+            std::span<const Triangle> triangles{};
+            std::span<const Vector<T,3>> normals{};
+            std::span<const Vector<T,2>> texcoords{};
+            std::span<const TriangleAttributes> attributes{};
+            std::span<const BvhNode<T>> bvh_nodes{};
+            std::span<const std::uint32_t> bvh_indices{};
+        };
+
+        /** @brief Views of the mesh arrays, e.g. for serialization. */
+        [[nodiscard]] Arrays arrays() const noexcept {
+            return Arrays{vertices_.view(), tris_.view(), normals_.view(), texcoords_.view(), attrs_.view(),
+                          bvh_.nodes(), bvh_.primitive_indices()};
+        }
+
+        /**
+         * @brief Creates a mesh that views the given arrays without copying them.
+         * @param arrays mesh arrays; attributes must be empty or hold one entry per triangle, and the BVH arrays
+         * empty or built over exactly these triangles
+         * @param backing owner of the viewed memory, kept alive as long as the mesh or any copy of it
+         */
+        [[nodiscard]] static Mesh borrow(const Arrays& arrays, std::shared_ptr<const void> backing) {
+            Mesh m;
+            m.vertices_ = CowArray<Vector<T,3>>::borrow(arrays.vertices);
+            m.tris_ = CowArray<Triangle>::borrow(arrays.triangles);
+            m.normals_ = CowArray<Vector<T,3>>::borrow(arrays.normals);
+            m.texcoords_ = CowArray<Vector<T,2>>::borrow(arrays.texcoords);
+            m.attrs_ = CowArray<TriangleAttributes>::borrow(arrays.attributes);
+            if (!arrays.bvh_nodes.empty()) m.bvh_ = Bvh<T>::borrow(arrays.bvh_nodes, arrays.bvh_indices);
+            m.backing_ = std::move(backing);
+            return m;
+        }
+
+        /** @brief True if the vertex positions are viewed from borrowed memory. */
+        [[nodiscard]] bool borrowed() const noexcept { return vertices_.borrowed(); }
+
+        /** @brief Largest number of vertices, normals or texture coordinates: indices are stored in 32 bits. */
+        static constexpr std::size_t max_elements = std::numeric_limits<std::uint32_t>::max();
+
+        /**
+         * @brief Adds a vertex position and returns its index.
+         * @throws std::length_error if the mesh already has max_elements vertices
+         */
+        std::size_t add_vertex(const Vector<T,3>& p) {
+            if (vertices_.size() >= max_elements) throw std::length_error("Mesh::add_vertex: too many vertices");
+            vertices_.push_back(p);
+            return vertices_.size()-1;
+        }
+        /**
+         * @brief Adds a triangle by vertex indices (invalidates the BVH and precomputed triangle data).
+         * @throws std::out_of_range if an index does not fit the 32-bit triangle storage
+         */
+        void add_triangle(std::size_t i0, std::size_t i1, std::size_t i2) {
+            if (i0 >= max_elements || i1 >= max_elements || i2 >= max_elements)
+                throw std::out_of_range("Mesh::add_triangle: vertex index exceeds 32 bits");
+            tris_.push_back({static_cast<std::uint32_t>(i0), static_cast<std::uint32_t>(i1), static_cast<std::uint32_t>(i2)});
+            bvh_.clear();
+            edges_.clear();
+            area_cdf_.clear();
+        }
+
+        /** @brief Reserves storage for the given number of vertices and triangles. */
+        void reserve(std::size_t vertices, std::size_t triangles) {
+            vertices_.modify([&](auto& v) { v.reserve(vertices); });
+            tris_.modify([&](auto& t) { t.reserve(triangles); });
+        }
+
+        /**
+         * @brief Adds a shading normal and returns its index.
+         * @throws std::length_error if the mesh already has max_elements normals
+         */
+        std::size_t add_normal(const Vector<T,3>& n) {
+            if (normals_.size() >= max_elements) throw std::length_error("Mesh::add_normal: too many normals");
+            normals_.push_back(n);
+            return normals_.size()-1;
+        }
+        /**
+         * @brief Adds a texture coordinate and returns its index.
+         * @throws std::length_error if the mesh already has max_elements texture coordinates
+         */
+        std::size_t add_texcoord(const Vector<T,2>& uv) {
+            if (texcoords_.size() >= max_elements) throw std::length_error("Mesh::add_texcoord: too many texture coordinates");
+            texcoords_.push_back(uv);
+            return texcoords_.size()-1;
+        }
+        /** @brief Sets the normal/texture coordinate indices of triangle tri. */
+        void set_triangle_attributes(std::size_t tri, const TriangleAttributes& a) {
+            attrs_.modify([&](std::vector<TriangleAttributes>& attrs) {
+                if (attrs.size() < tris_.size()) attrs.resize(tris_.size());
+                attrs[tri] = a;
+            });
+        }
+        /**
+         * @brief Replaces all normals, texture coordinates and per-triangle attribute indices.
+         * @param attributes one entry per triangle, or empty for none
+         */
+        void set_attributes(std::vector<Vector<T,3>> normals, std::vector<Vector<T,2>> texcoords,
+                            std::vector<TriangleAttributes> attributes) {
+            normals_ = std::move(normals);
+            texcoords_ = std::move(texcoords);
+            attrs_ = std::move(attributes);
+        }
+
+        /**
+         * @brief Builds the bottom-level BVH over all triangles (binned SAH).
+         * @param max_leaf_size maximum triangles per leaf
+         */
+        void build_bvh(std::size_t max_leaf_size = Bvh<T>::default_max_leaf_size) {
+            std::vector<AABB<T>> bounds;
+            bounds.reserve(tris_.size());
+            for (const auto& tri : tris_) {
+                AABB<T> box;
+                box.expand(vertices_[tri.i0]);
+                box.expand(vertices_[tri.i1]);
+                box.expand(vertices_[tri.i2]);
+                bounds.push_back(box);
+            }
+            bvh_.build(bounds, max_leaf_size);
+            update_edges_();
+            update_area_cdf_();
+        }
+
+        /**
+         * @brief Selects the storage layout; switching to MeshLayout::precomputed builds the triangle data now.
+         */
+        void set_layout(MeshLayout layout) {
+            layout_ = layout;
+            update_edges_();
+        }
+        /** @brief Current storage layout. */
+        [[nodiscard]] MeshLayout layout() const noexcept { return layout_; }
+        /** @brief True if precomputed triangle data is present and covers all triangles. */
+        [[nodiscard]] bool has_precomputed() const noexcept { return !tris_.empty() && edges_.size() == tris_.size(); }
+
+        /** @brief Bytes of geometry, attribute, BVH and precomputed data (owned or borrowed). */
+        [[nodiscard]] std::size_t memory_bytes() const noexcept {
+            return vertices_.size() * sizeof(Vector<T,3>) + tris_.size() * sizeof(Triangle) +
+                   normals_.size() * sizeof(Vector<T,3>) + texcoords_.size() * sizeof(Vector<T,2>) +
+                   attrs_.size() * sizeof(TriangleAttributes) + bvh_.nodes().size() * sizeof(BvhNode<T>) +
+                   bvh_.primitive_indices().size() * sizeof(std::uint32_t) + edges_.size() * sizeof(TriangleEdges<T>) +
+                   area_cdf_.size() * sizeof(T);
+        }
 
-        /** @brief Adds a vertex position and returns its index. */
-        std::size_t add_vertex(const Vector<T,3>& p) { vertices_.push_back(p); return vertices_.size()-1; }
-        /** @brief Adds a triangle by vertex indices. */
-        void add_triangle(std::size_t i0, std::size_t i1, std::size_t i2) { tris_.push_back({i0,i1,i2}); }
+        /** @brief Returns true if the BVH is built and covers all triangles. */
+        [[nodiscard]] bool has_bvh() const noexcept { return !tris_.empty() && bvh_.primitive_count() == tris_.size(); }
+        /** @brief Access the bottom-level BVH (empty until build_bvh()). */
+        [[nodiscard]] const Bvh<T>& bvh() const noexcept { return bvh_; }
 
         /** @brief Number of vertices. */
         [[nodiscard]] std::size_t vertex_count() const noexcept { return vertices_.size(); }
@@ -38,6 +267,19 @@ namespace glimmer {
         /** @brief Access triangle by index (unchecked). */
         [[nodiscard]] const Triangle& triangle(std::size_t i) const noexcept { return tris_[i]; }
 
+        /** @brief Number of shading normals. */
+        [[nodiscard]] std::size_t normal_count() const noexcept { return normals_.size(); }
+        /** @brief Number of texture coordinates. */
+        [[nodiscard]] std::size_t texcoord_count() const noexcept { return texcoords_.size(); }
+        /** @brief Access shading normal by index (unchecked). */
+        [[nodiscard]] const Vector<T,3>& normal(std::size_t i) const noexcept { return normals_[i]; }
+        /** @brief Access texture coordinate by index (unchecked). */
+        [[nodiscard]] const Vector<T,2>& texcoord(std::size_t i) const noexcept { return texcoords_[i]; }
+        /** @brief Normal/texture coordinate indices of triangle i (all no_attribute if it has none). */
+        [[nodiscard]] TriangleAttributes triangle_attributes(std::size_t i) const noexcept {
+            return i < attrs_.size() ? attrs_[i] : TriangleAttributes{};
+        }
+
         /**
          * @brief Computes the axis-aligned bounding box over all vertices.
          * @return AABB spanning all vertex positions; empty if the mesh has no vertices.
@@ -48,39 +290,248 @@ namespace glimmer {
             return box;
         }
 
+        /** @brief Total triangle area, or 0 until build_bvh() has tabulated it. */
+        [[nodiscard]] T area() const noexcept override {
+            return !tris_.empty() && area_cdf_.size() == tris_.size() ? area_cdf_.back() : T{0};
+        }
+
         /**
-         * @brief Ray-mesh intersection (brute-force over triangles, two-sided).
+         * @brief Uniform point on the mesh: picks a triangle by area with u[0] (reused within the triangle) and
+         * samples it uniformly.
+         * @details Returns the geometric normal and, when the triangle has texture coordinates, the interpolated uv.
+         */
+        [[nodiscard]] typename Geometry<T>::SurfaceSample sample_surface(const Vector<T,2>& u) const noexcept override {
+            const T total = area();
+            if (total <= T{0}) return {};
+            const T x = u[0] * total;
+            const auto it = std::upper_bound(area_cdf_.begin(), area_cdf_.end(), x);
+            const std::size_t k = std::min<std::size_t>(static_cast<std::size_t>(it - area_cdf_.begin()), tris_.size() - 1);
+            const T lo = k ? area_cdf_[k - 1] : T{0};
+            const T width = area_cdf_[k] - lo;
+            const T u0 = width > T{0} ? std::clamp((x - lo) / width, T{0}, T{1}) : T{0};
+            const T su = static_cast<T>(std::sqrt(u0));
+            const T bu = su * (T{1} - u[1]);
+            const T bv = su * u[1];
+            const Triangle& tri = tris_[k];
+            const Vector<T,3>& p0 = vertices_[tri.i0];
+            const Vector<T,3> e1 = vertices_[tri.i1] - p0;
+            const Vector<T,3> e2 = vertices_[tri.i2] - p0;
+            typename Geometry<T>::SurfaceSample s{p0 + e1 * bu + e2 * bv, mesh_detail::triangle_normal(e1, e2), {}};
+            if (k < attrs_.size()) {
+                const auto& a = attrs_[k].texcoord;
+                if (a[0] < texcoords_.size() && a[1] < texcoords_.size() && a[2] < texcoords_.size())
+                    s.uv = texcoords_[a[0]] * (T{1} - bu - bv) + texcoords_[a[1]] * bu + texcoords_[a[2]] * bv;
+            }
+            return s;
+        }
+
+        /**
+         * @brief Ray-mesh intersection (two-sided).
          * @param ray input ray with parameter range
          * @return optional nearest hit information if any triangle is hit within range
+         * @details Traverses the BVH when built; otherwise tests every triangle. Either way the search range
+         * shrinks to the closest hit found so far.
          */
         [[nodiscard]] std::optional<typename Geometry<T>::Hit> intersect(const Ray<T>& ray) const noexcept override {
             bool hit_any = false;
-            T best_t = ray.tmax();
             typename Geometry<T>::Hit best{};
-            for (std::size_t idx=0; idx<tris_.size(); ++idx) {
-                const auto& tri = tris_[idx];
-                const auto& p0 = vertices_[tri.i0];
-                const auto& p1 = vertices_[tri.i1];
-                const auto& p2 = vertices_[tri.i2];
-                if (auto ih = intersect_triangle(p0,p1,p2, ray)) {
-                    const auto& h = *ih;
-                    if (h.t >= ray.tmin() && h.t <= best_t) {
-                        hit_any = true;
-                        best_t = h.t;
-                        best.t = h.t;
-                        best.normal = h.normal;
-                    }
+            std::size_t best_tri = 0;
+            T best_u{}, best_v{};
+            const bool pre = has_precomputed();
+            auto test = [&](std::size_t idx, std::size_t slot, T& best_t) noexcept {
+                const Ray<T> clipped{ray.origin(), ray.direction(), ray.tmin(), best_t};
+                std::optional<TriHit<T>> ih;
+                if (pre) ih = intersect_triangle(edges_[slot], clipped);
+                else {
+                    const auto& tri = tris_[idx];
+                    ih = intersect_triangle(vertices_[tri.i0], vertices_[tri.i1], vertices_[tri.i2], clipped);
                 }
+                if (!ih) return false;
+                hit_any = true;
+                best_t = ih->t;
+                best.t = ih->t;
+                best.normal = ih->normal;
+                best_tri = idx;
+                best_u = ih->u;
+                best_v = ih->v;
+                return true;
+            };
+            if (has_bvh()) {
+                bvh_.intersect(ray, [&](std::uint32_t prim, std::uint32_t slot, T& best_t) noexcept {
+                    return test(prim, slot, best_t);
+                });
+            } else {
+                T best_t = ray.tmax();
+                for (std::size_t idx=0; idx<tris_.size(); ++idx) test(idx, idx, best_t);
+            }
+            if (!hit_any) return std::nullopt;
+            if (best_tri < attrs_.size()) apply_attributes_(attrs_[best_tri], tris_[best_tri], best_u, best_v, best);
+            return best;
+        }
+
+        /**
+         * @brief Hit record for a ray that reached triangle tri at distance t with barycentrics (u, v).
+         * @details Gives the same normal, uv and uv_scale as intersect() for that triangle, so packet queries
+         * only need to report the triangle and its barycentrics.
+         */
+        [[nodiscard]] typename Geometry<T>::Hit hit_at(std::size_t tri, T t, T u, T v) const noexcept {
+            const auto& idx = tris_[tri];
+            typename Geometry<T>::Hit hit{};
+            hit.t = t;
+            hit.normal = mesh_detail::triangle_normal(vertices_[idx.i1] - vertices_[idx.i0], vertices_[idx.i2] - vertices_[idx.i0]);
+            if (tri < attrs_.size()) apply_attributes_(attrs_[tri], idx, u, v, hit);
+            return hit;
+        }
+
+        /**
+         * @brief Any-hit test: stops at the first triangle hit in range and skips normal computation.
+         */
+        [[nodiscard]] bool occluded(const Ray<T>& ray) const noexcept override {
+            const bool pre = has_precomputed();
+            auto test = [&](std::size_t idx, std::size_t slot) noexcept {
+                if (pre) return occludes_triangle(edges_[slot], ray);
+                const auto& tri = tris_[idx];
+                return occludes_triangle(vertices_[tri.i0], vertices_[tri.i1], vertices_[tri.i2], ray);
+            };
+            if (has_bvh()) {
+                return bvh_.occluded(ray, [&](std::uint32_t prim, std::uint32_t slot) noexcept { return test(prim, slot); });
             }
-            if (hit_any) return best;
-            return std::nullopt;
+            for (std::size_t idx=0; idx<tris_.size(); ++idx) if (test(idx, idx)) return true;
+            return false;
+        }
+
+        /**
+         * @brief Closest-hit query for a packet of object-space rays.
+         * @param packet ray packet; only active() lanes are traced
+         * @param t_max per-lane search bound (initialize from packet.tmax); lowered to the hit distance on hits
+         * @param triangle receives the index of the closest triangle for lanes that hit
+         * @return mask of lanes that hit a triangle
+         * @details Uses packet BVH traversal and the packet Möller–Trumbore kernel when the BVH is built, and the
+         * packet kernel over all triangles otherwise.
+         */
+        template <std::size_t N>
+        PacketMask intersect_packet(const RayPacket<T,N>& packet, std::array<T,N>& t_max,
+                                    std::array<std::uint32_t,N>& triangle) const noexcept {
+            std::array<T,N> u{}, v{};
+            return intersect_packet(packet, t_max, triangle, u, v);
+        }
+
+        /**
+         * @brief Closest-hit query for a packet that also reports barycentrics, e.g. to build hits with hit_at().
+         * @param u receives barycentric u of the closest triangle for lanes that hit
+         * @param v receives barycentric v of the closest triangle for lanes that hit
+         * @details See the overload above for the remaining parameters and the result.
+         */
+        template <std::size_t N>
+        PacketMask intersect_packet(const RayPacket<T,N>& packet, std::array<T,N>& t_max,
+                                    std::array<std::uint32_t,N>& triangle, std::array<T,N>& u,
+                                    std::array<T,N>& v) const noexcept {
+            const bool pre = has_precomputed();
+            auto test = [&](std::uint32_t idx, std::uint32_t slot, PacketMask lanes) noexcept {
+                PacketMask m;
+                if (pre) {
+                    const auto& e = edges_[slot];
+                    m = intersect_triangle_edges(e.p0, e.e1, e.e2, packet, t_max, u, v, lanes);
+                } else {
+                    const auto& tri = tris_[idx];
+                    m = glimmer::intersect_triangle(vertices_[tri.i0], vertices_[tri.i1], vertices_[tri.i2],
+                                                    packet, t_max, u, v, lanes);
+                }
+                for (std::size_t i = 0; i < N; ++i) triangle[i] = ((m >> i) & 1u) ? idx : triangle[i];
+                return m;
+            };
+            if (has_bvh()) return bvh_.intersect_packet(packet, t_max, test);
+            PacketMask hit = 0;
+            for (std::uint32_t idx = 0; idx < tris_.size(); ++idx) hit |= test(idx, idx, packet.active());
+            return hit;
         }
 
     private:
-        std::vector<Vector<T,3>> vertices_{};
-        std::vector<Triangle> tris_{};
+        void update_edges_() {
+            edges_.clear();
+            if (layout_ != MeshLayout::precomputed) {
+                edges_.shrink_to_fit();
+                return;
+            }
+            // In BVH leaf order when the BVH is built, so leaves read their triangles sequentially
+            const auto order = bvh_.primitive_indices();
+            const bool leaf_order = has_bvh();
+            edges_.reserve(tris_.size());
+            for (std::size_t slot = 0; slot < tris_.size(); ++slot) {
+                const auto& tri = tris_[leaf_order ? order[slot] : slot];
+                edges_.push_back(mesh_detail::make_edges(vertices_[tri.i0], vertices_[tri.i1], vertices_[tri.i2]));
+            }
+        }
+
+        // Prefix sums of the triangle areas, for sampling by area
+        void update_area_cdf_() {
+            area_cdf_.clear();
+            area_cdf_.reserve(tris_.size());
+            T sum{0};
+            for (const auto& tri : tris_) {
+                sum += cross(vertices_[tri.i1] - vertices_[tri.i0], vertices_[tri.i2] - vertices_[tri.i0]).norm() / T{2};
+                area_cdf_.push_back(sum);
+            }
+        }
+
+        // Interpolates shading normal and uv at barycentrics (u, v) where the triangle provides them
+        void apply_attributes_(const TriangleAttributes& a, const Triangle& tri, T u, T v,
+                               typename Geometry<T>::Hit& hit) const noexcept {
+            const T w = T{1} - u - v;
+            auto valid = [](const std::array<std::uint32_t,3>& idx, std::size_t count) {
+                return idx[0] < count && idx[1] < count && idx[2] < count;
+            };
+            if (valid(a.normal, normals_.size())) {
+                const Vector<T,3> n = normals_[a.normal[0]] * w + normals_[a.normal[1]] * u + normals_[a.normal[2]] * v;
+                const T len = n.norm();
+                if (len > T{0}) hit.normal = n / len;
+            }
+            if (valid(a.texcoord, texcoords_.size())) {
+                const auto& t0 = texcoords_[a.texcoord[0]];
+                const auto& t1 = texcoords_[a.texcoord[1]];
+                const auto& t2 = texcoords_[a.texcoord[2]];
+                hit.uv = t0 * w + t1 * u + t2 * v;
+                // Texture density: square root of the UV-space over the object-space triangle area
+                const Vector<T,2> d1 = t1 - t0, d2 = t2 - t0;
+                const T uv_area = std::abs(d1[0] * d2[1] - d1[1] * d2[0]);
+                const T area = cross(vertices_[tri.i1] - vertices_[tri.i0], vertices_[tri.i2] - vertices_[tri.i0]).norm();
+                if (area > T{0}) hit.uv_scale = static_cast<T>(std::sqrt(static_cast<double>(uv_area / area)));
+            }
+        }
+
+        CowArray<Vector<T,3>> vertices_{};
+        CowArray<Triangle> tris_{};
+        CowArray<Vector<T,3>> normals_{};
+        CowArray<Vector<T,2>> texcoords_{};
+        CowArray<TriangleAttributes> attrs_{};
+        Bvh<T> bvh_{};
+        MeshLayout layout_{MeshLayout::compact};
+        std::vector<TriangleEdges<T>> edges_{}; // per BVH slot (or triangle without BVH) when precomputed
+        std::vector<T> area_cdf_{}; // running triangle area sums (built by build_bvh())
+        std::shared_ptr<const void> backing_{}; // keeps borrowed arrays alive
     };
 
+    namespace mesh_detail {
+        // Möller–Trumbore core on a triangle given by its first vertex and edges
+        template <Arithmetic T>
+        [[nodiscard]] bool moller_trumbore(const Vector<T,3>& p0, const Vector<T,3>& e1, const Vector<T,3>& e2,
+                                           const Ray<T>& ray, T& t, T& u, T& v) noexcept {
+            const Vector<T,3> pvec = cross(ray.direction(), e2);
+            const T det = dot(e1, pvec);
+            const T eps = static_cast<T>(1e-8);
+            if (det <= eps && det >= -eps) return false;
+            const T inv_det = T{1} / det;
+            const Vector<T,3> tvec = ray.origin() - p0;
+            u = dot(tvec, pvec) * inv_det;
+            if (u < T{0} || u > T{1}) return false;
+            const Vector<T,3> qvec = cross(tvec, e1);
+            v = dot(ray.direction(), qvec) * inv_det;
+            if (v < T{0} || u + v > T{1}) return false;
+            t = dot(e2, qvec) * inv_det;
+            return t >= ray.tmin() && t <= ray.tmax();
+        }
+    }
+
     /**
      * @brief Two-sided Möller–Trumbore ray-triangle intersection.
      * @param p0 triangle vertex 0
@@ -90,35 +541,38 @@ namespace glimmer {
      * @return optional hit with t,u,v and outward unit normal; empty if no intersection in range
      */
     export template <Arithmetic T>
-    struct TriHit { T t{}; T u{}; T v{}; Vector<T,3> normal{}; };
-
-    export template <Arithmetic T>
-    [[nodiscard]] std::optional<TriHit<T>> intersect_triangle(const Vector<T,3>& p0, const Vector<T,3>& p1, const Vector<T,3>& p2,
-                                          const Ray<T>& ray) noexcept {
+    [[nodiscard]] std::optional<TriHit<T>> intersect_triangle(const Vector<T,3>& p0, const Vector<T,3>& p1,
+                                                              const Vector<T,3>& p2, const Ray<T>& ray) noexcept {
         const Vector<T,3> e1 = p1 - p0;
         const Vector<T,3> e2 = p2 - p0;
-        const Vector<T,3> pvec = cross(ray.direction(), e2);
-        const T det = dot(e1, pvec);
-        const T eps = static_cast<T>(1e-8);
-        T inv_det{};
-        if (det > eps || det < -eps) inv_det = T{1} / det; else {
-            return std::nullopt;
-        }
-        const Vector<T,3> tvec = ray.origin() - p0;
-        const T u = dot(tvec, pvec) * inv_det;
-        if (u < T{0} || u > T{1}) return std::nullopt;
-        const Vector<T,3> qvec = cross(tvec, e1);
-        const T v = dot(ray.direction(), qvec) * inv_det;
-        if (v < T{0} || u + v > T{1}) return std::nullopt;
-        const T t = dot(e2, qvec) * inv_det;
-        if (t < ray.tmin() || t > ray.tmax()) return std::nullopt;
-        Vector<T,3> n = cross(e1, e2);
-        auto nn = n.norm();
-        Vector<T,3> normal{};
-        if (nn != T{0}) {
-            if constexpr (std::is_floating_point_v<T>) normal = n / nn;
-            else normal = Vector<T,3>{ static_cast<T>(n[0]/nn), static_cast<T>(n[1]/nn), static_cast<T>(n[2]/nn) };
-        } else normal = Vector<T,3>{T{0},T{0},T{1}};
-        return TriHit<T>{t, u, v, normal};
+        T t{}, u{}, v{};
+        if (!mesh_detail::moller_trumbore(p0, e1, e2, ray, t, u, v)) return std::nullopt;
+        return TriHit<T>{t, u, v, mesh_detail::triangle_normal(e1, e2)};
+    }
+
+    /** @brief Ray-triangle intersection using precomputed edges and normal (same results as above). */
+    export template <Arithmetic T>
+    [[nodiscard]] std::optional<TriHit<T>> intersect_triangle(const TriangleEdges<T>& tri, const Ray<T>& ray) noexcept {
+        T t{}, u{}, v{};
+        if (!mesh_detail::moller_trumbore(tri.p0, tri.e1, tri.e2, ray, t, u, v)) return std::nullopt;
+        return TriHit<T>{t, u, v, tri.normal};
+    }
+
+    /**
+     * @brief Two-sided Möller–Trumbore any-hit test (no normal or barycentric output).
+     * @return true if the ray hits the triangle within [tmin, tmax]
+     */
+    export template <Arithmetic T>
+    [[nodiscard]] bool occludes_triangle(const Vector<T,3>& p0, const Vector<T,3>& p1, const Vector<T,3>& p2,
+                                         const Ray<T>& ray) noexcept {
+        T t{}, u{}, v{};
+        return mesh_detail::moller_trumbore(p0, p1 - p0, p2 - p0, ray, t, u, v);
+    }
+
+    /** @brief Any-hit test using precomputed edges. */
+    export template <Arithmetic T>
+    [[nodiscard]] bool occludes_triangle(const TriangleEdges<T>& tri, const Ray<T>& ray) noexcept {
+        T t{}, u{}, v{};
+        return mesh_detail::moller_trumbore(tri.p0, tri.e1, tri.e2, ray, t, u, v);
     }
 }
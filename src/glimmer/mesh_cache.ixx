@@ -0,0 +1,306 @@
+module;
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+export module glimmer.mesh_cache;
+
+import glimmer.vector;
+import glimmer.bvh;
+import glimmer.mesh;
+import glimmer.mapped_file;
+import glimmer.obj;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing a compact binary mesh cache that loads without parsing.
+     *
+     * File layout (native byte order, all offsets in bytes from the start of the file):
+     *  - 64-byte header: magic "GLIMMESH", format version, endianness tag, scalar size, triangle index size,
+     *    section count and total file size.
+     *  - Section table: one 32-byte entry per array with kind, element size, offset and element count.
+     *  - Section data, each section starting on a 64-byte boundary.
+     *
+     * Sections hold vertex positions, triangles, and optionally normals, texture coordinates, per-triangle
+     * attribute indices and the prebuilt triangle BVH. Loading memory-maps the file and lets the mesh view the
+     * sections in place, so startup cost is independent of mesh size apart from validation.
+     */
+
+    namespace mesh_cache_detail {
+        inline constexpr char magic[8] = {'G', 'L', 'I', 'M', 'M', 'E', 'S', 'H'};
+        inline constexpr std::uint32_t endian_tag = 0x01020304u;
+        inline constexpr std::uint64_t alignment = 64;
+
+        enum class Kind : std::uint32_t {
+            vertices = 1, triangles = 2, normals = 3, texcoords = 4, attributes = 5, bvh_nodes = 6, bvh_indices = 7
+        };
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t endian;
+            std::uint32_t scalar_size;
+            std::uint32_t index_size;
+            std::uint32_t section_count;
+            std::uint32_t reserved0;
+            std::uint64_t file_size;
+            std::uint8_t reserved[24];
+        };
+        static_assert(sizeof(Header) == 64);
+
+        struct Section {
+            Kind kind;
+            std::uint32_t element_size;
+            std::uint64_t offset;
+            std::uint64_t count;
+            std::uint64_t reserved;
+        };
+        static_assert(sizeof(Section) == 32);
+
+        [[nodiscard]] constexpr std::uint64_t align_up(std::uint64_t n) noexcept {
+            return (n + alignment - 1) / alignment * alignment;
+        }
+
+        // Finds a section and checks its element size and bounds; empty span if absent or malformed
+        template <class E>
+        [[nodiscard]] bool section_view(const MappedFile& file, std::span<const Section> table, Kind kind,
+                                        std::span<const E>& out, bool& present) noexcept {
+            static_assert(std::is_trivially_copyable_v<E>);
+            out = {};
+            present = false;
+            for (const auto& s : table) {
+                if (s.kind != kind) continue;
+                present = true;
+                if (s.element_size != sizeof(E) || s.offset % alignof(E) != 0) return false;
+                if (s.offset > file.size() || s.count > (file.size() - s.offset) / sizeof(E)) return false;
+                const char* p = file.data() + s.offset;
+                if (reinterpret_cast<std::uintptr_t>(p) % alignof(E) != 0) return false;
+                out = {reinterpret_cast<const E*>(p), static_cast<std::size_t>(s.count)};
+                return true;
+            }
+            return true;
+        }
+
+        template <class E>
+        [[nodiscard]] bool optional_section(const MappedFile& file, std::span<const Section> table, Kind kind,
+                                            std::span<const E>& out) noexcept {
+            bool present = false;
+            return section_view(file, table, kind, out, present);
+        }
+
+        template <class E>
+        [[nodiscard]] bool required_section(const MappedFile& file, std::span<const Section> table, Kind kind,
+                                            std::span<const E>& out) noexcept {
+            bool present = false;
+            return section_view(file, table, kind, out, present) && present;
+        }
+
+        [[nodiscard]] inline bool valid_attribute(const std::array<std::uint32_t,3>& idx, std::size_t count,
+                                                  std::uint32_t none) noexcept {
+            const bool all_none = idx[0] == none && idx[1] == none && idx[2] == none;
+            return all_none || (idx[0] < count && idx[1] < count && idx[2] < count);
+        }
+
+        // Checks that every index in a loaded mesh is in range and that the BVH nodes form a tree no deeper than
+        // Bvh::max_depth, so traversal cannot read out of bounds or overflow its fixed-size stack
+        template <Arithmetic T>
+        [[nodiscard]] bool validate(const typename Mesh<T>::Arrays& a) {
+            const std::size_t nv = a.vertices.size();
+            for (const auto& t : a.triangles) {
+                if (t.i0 >= nv || t.i1 >= nv || t.i2 >= nv) return false;
+            }
+            if (!a.attributes.empty()) {
+                if (a.attributes.size() != a.triangles.size()) return false;
+                for (const auto& at : a.attributes) {
+                    if (!valid_attribute(at.normal, a.normals.size(), Mesh<T>::no_attribute)) return false;
+                    if (!valid_attribute(at.texcoord, a.texcoords.size(), Mesh<T>::no_attribute)) return false;
+                }
+            }
+            if (a.bvh_nodes.empty()) return a.bvh_indices.empty();
+            if (a.bvh_indices.size() != a.triangles.size()) return false;
+            for (const auto i : a.bvh_indices) {
+                if (i >= a.triangles.size()) return false;
+            }
+            // Walk the tree from the root: every node must be reached exactly once (no shared or orphaned
+            // children) and within the depth limit
+            struct Visit { std::size_t node; std::size_t depth; };
+            std::vector<std::uint8_t> seen(a.bvh_nodes.size(), 0);
+            std::vector<Visit> stack{{0, 0}};
+            std::size_t reached = 0;
+            while (!stack.empty()) {
+                const Visit v = stack.back();
+                stack.pop_back();
+                if (seen[v.node]) return false;
+                seen[v.node] = 1;
+                ++reached;
+                const auto& node = a.bvh_nodes[v.node];
+                if (node.is_leaf()) {
+                    if (node.first > a.bvh_indices.size() || node.count > a.bvh_indices.size() - node.first) return false;
+                    continue;
+                }
+                // Children follow their parent (depth-first order)
+                if (node.first <= v.node + 1 || node.first >= a.bvh_nodes.size()) return false;
+                if (v.depth + 1 > Bvh<T>::max_depth) return false;
+                stack.push_back({v.node + 1, v.depth + 1});
+                stack.push_back({node.first, v.depth + 1});
+            }
+            return reached == a.bvh_nodes.size();
+        }
+    }
+
+    /** @brief Current mesh cache format version; files with another version are rejected. */
+    export inline constexpr std::uint32_t mesh_cache_version = 1;
+
+    /**
+     * @brief Writes a mesh, including its BVH if built, to a binary cache file.
+     * @param mesh mesh to store
+     * @param path destination path; the file is written under a temporary name and renamed into place
+     * @return true on success
+     */
+    export template <Arithmetic T>
+    [[nodiscard]] bool save_mesh_cache(const Mesh<T>& mesh, const std::string& path) {
+        using namespace mesh_cache_detail;
+        using Tri = typename Mesh<T>::Triangle;
+        const auto a = mesh.arrays();
+
+        struct Blob { Kind kind; std::uint32_t element_size; const void* data; std::uint64_t count; };
+        std::vector<Blob> blobs{
+            {Kind::vertices, sizeof(Vector<T,3>), a.vertices.data(), a.vertices.size()},
+            {Kind::triangles, sizeof(Tri), a.triangles.data(), a.triangles.size()},
+        };
+        auto add = [&](Kind kind, auto span) {
+            if (!span.empty()) blobs.push_back({kind, sizeof(span[0]), span.data(), span.size()});
+        };
+        add(Kind::normals, a.normals);
+        add(Kind::texcoords, a.texcoords);
+        add(Kind::attributes, a.attributes);
+        if (mesh.has_bvh()) {
+            add(Kind::bvh_nodes, a.bvh_nodes);
+            add(Kind::bvh_indices, a.bvh_indices);
+        }
+
+        Header header{};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = mesh_cache_version;
+        header.endian = endian_tag;
+        header.scalar_size = sizeof(T);
+        header.index_size = sizeof(Tri{}.i0);
+        header.section_count = static_cast<std::uint32_t>(blobs.size());
+
+        std::vector<Section> table;
+        std::uint64_t offset = align_up(sizeof(Header) + blobs.size() * sizeof(Section));
+        for (const auto& b : blobs) {
+            table.push_back({b.kind, b.element_size, offset, b.count, 0});
+            offset = align_up(offset + b.count * b.element_size);
+        }
+        header.file_size = offset;
+
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) return false;
+            std::uint64_t pos = 0;
+            auto write = [&](const void* data, std::uint64_t bytes) {
+                out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+                pos += bytes;
+            };
+            auto pad_to = [&](std::uint64_t target) {
+                static constexpr char zeros[alignment]{};
+                while (pos < target) write(zeros, std::min<std::uint64_t>(target - pos, alignment));
+            };
+            write(&header, sizeof(header));
+            write(table.data(), table.size() * sizeof(Section));
+            for (std::size_t i = 0; i < blobs.size(); ++i) {
+                pad_to(table[i].offset);
+                write(blobs[i].data, blobs[i].count * blobs[i].element_size);
+            }
+            pad_to(header.file_size);
+            if (!out.flush()) return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) std::filesystem::remove(tmp, ec);
+        return !ec;
+    }
+
+    /**
+     * @brief Loads a mesh from a binary cache file.
+     * @param path cache file path
+     * @param validate check all indices before use; disable only for caches this process wrote itself
+     * @return the mesh, or std::nullopt if the file is missing, malformed, from another format version, or
+     * written with a different scalar type or byte order
+     * @details The file is memory-mapped and the mesh borrows its arrays from the mapping, which stays alive
+     * as long as the mesh or any copy of it.
+     */
+    export template <Arithmetic T>
+    [[nodiscard]] std::optional<Mesh<T>> load_mesh_cache(const std::string& path, bool validate = true) {
+        using namespace mesh_cache_detail;
+        using Index = decltype(typename Mesh<T>::Triangle{}.i0);
+
+        auto file = MappedFile::open(path);
+        if (!file || file->size() < sizeof(Header)) return std::nullopt;
+        const auto backing = std::make_shared<const MappedFile>(std::move(*file));
+        const MappedFile& f = *backing;
+
+        Header header;
+        std::memcpy(&header, f.data(), sizeof(header));
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != mesh_cache_version ||
+            header.endian != endian_tag || header.scalar_size != sizeof(T) || header.index_size != sizeof(Index) ||
+            header.file_size != f.size()) {
+            return std::nullopt;
+        }
+        if (header.section_count > (f.size() - sizeof(Header)) / sizeof(Section)) return std::nullopt;
+        const std::span<const Section> table{reinterpret_cast<const Section*>(f.data() + sizeof(Header)),
+                                             header.section_count};
+
+        typename Mesh<T>::Arrays a;
+        const bool ok = required_section(f, table, Kind::vertices, a.vertices)
+                && required_section(f, table, Kind::triangles, a.triangles)
+                && optional_section(f, table, Kind::normals, a.normals)
+                && optional_section(f, table, Kind::texcoords, a.texcoords)
+                && optional_section(f, table, Kind::attributes, a.attributes)
+                && optional_section(f, table, Kind::bvh_nodes, a.bvh_nodes)
+                && optional_section(f, table, Kind::bvh_indices, a.bvh_indices);
+        if (!ok || (validate && !mesh_cache_detail::validate<T>(a))) return std::nullopt;
+
+        Mesh<T> mesh = Mesh<T>::borrow(a, backing);
+        if (!mesh.has_bvh() && mesh.triangle_count() > 0) mesh.build_bvh();
+        return mesh;
+    }
+
+    /**
+     * @brief Loads an OBJ mesh through a binary cache.
+     * @param obj_path OBJ source file
+     * @param cache_path cache file; defaults to obj_path + ".glmesh"
+     * @return the mesh with its BVH built
+     * @details Uses the cache if it is valid and not older than the OBJ file. Otherwise the OBJ is parsed and
+     * the cache rewritten (failure to write it is not an error).
+     * @throws std::runtime_error if the cache is unusable and the OBJ file cannot be opened
+     */
+    export template <Arithmetic T>
+    [[nodiscard]] Mesh<T> load_mesh(const std::string& obj_path, std::string cache_path = {}) {
+        namespace fs = std::filesystem;
+        if (cache_path.empty()) cache_path = obj_path + ".glmesh";
+        std::error_code ec_obj, ec_cache;
+        const auto obj_time = fs::last_write_time(obj_path, ec_obj);
+        const auto cache_time = fs::last_write_time(cache_path, ec_cache);
+        if (!ec_cache && (ec_obj || cache_time >= obj_time)) {
+            if (auto cached = load_mesh_cache<T>(cache_path)) return std::move(*cached);
+        }
+        Mesh<T> mesh = load_obj<T>(obj_path);
+        (void)save_mesh_cache(mesh, cache_path);
+        return mesh;
+    }
+}
@@ -1,103 +1,349 @@
 module;
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <istream>
-#include <fstream>
-#include <sstream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
 #include <vector>
-#include <cctype>
-#include <optional>
 
 export module glimmer.obj;
 
 import glimmer.vector;
 import glimmer.mesh;
+import glimmer.mapped_file;
+import glimmer.thread_pool;
+import glimmer.arena;
 
 namespace glimmer {
     namespace obj_detail {
-        inline void ltrim(std::string& s){
-            size_t i=0; while(i<s.size() && std::isspace(static_cast<unsigned char>(s[i]))) ++i; s.erase(0,i);
+        // Inputs smaller than this are parsed as a single chunk
+        inline constexpr std::size_t min_chunk_bytes = std::size_t{1} << 20;
+
+        enum class Tag { other, v, vt, vn, f };
+
+        [[nodiscard]] inline bool is_blank(char c) noexcept {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+        }
+
+        [[nodiscard]] inline const char* skip_blanks(const char* p, const char* end) noexcept {
+            while (p < end && is_blank(*p)) ++p;
+            return p;
         }
-        inline void rtrim(std::string& s){
-            if (s.empty()) return; size_t i=s.size(); while(i>0 && std::isspace(static_cast<unsigned char>(s[i-1]))) --i; s.erase(i);
+
+        [[nodiscard]] inline const char* find_line_end(const char* p, const char* end) noexcept {
+            const void* nl = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+            return nl ? static_cast<const char*>(nl) : end;
         }
-        inline void trim(std::string& s){ ltrim(s); rtrim(s); }
-        inline void strip_comment(std::string& s){ if (auto pos = s.find('#'); pos != std::string::npos) s.erase(pos); }
 
-        template <Arithmetic T>
-        inline void parse_vertex_record(std::istringstream& ls, Mesh<T>& mesh){
-            T x{}, y{}, z{}; ls >> x >> y >> z; if (!ls.fail()) mesh.add_vertex(Vector<T,3>{x,y,z});
+        // End of the record part of a line, i.e. before any '#' comment
+        [[nodiscard]] inline const char* find_record_end(const char* p, const char* line_end) noexcept {
+            const void* hash = std::memchr(p, '#', static_cast<std::size_t>(line_end - p));
+            return hash ? static_cast<const char*>(hash) : line_end;
         }
 
-        inline std::optional<std::size_t> parse_position_index_token(const std::string& token, std::size_t vertex_count){
-            if (token.empty()) return std::nullopt;
-            std::string idxs = token;
-            auto slash = idxs.find('/');
-            if (slash != std::string::npos) idxs.erase(slash);
-            if (idxs.empty()) return std::nullopt;
-            long long idx_val = 0;
-            try {
-                idx_val = std::stoll(idxs);
-            } catch (...) {
-                return std::nullopt;
+        // Classifies the record starting at p (leading blanks skipped) and advances p past the tag
+        [[nodiscard]] inline Tag read_tag(const char*& p, const char* end) noexcept {
+            p = skip_blanks(p, end);
+            auto tag_end = [&](std::size_t n) { return p + n == end || is_blank(p[n]); };
+            if (p < end && *p == 'v') {
+                if (tag_end(1)) { p += 1; return Tag::v; }
+                if (p + 1 < end && p[1] == 't' && tag_end(2)) { p += 2; return Tag::vt; }
+                if (p + 1 < end && p[1] == 'n' && tag_end(2)) { p += 2; return Tag::vn; }
+            } else if (p < end && *p == 'f' && tag_end(1)) {
+                p += 1;
+                return Tag::f;
             }
-            const long long n = static_cast<long long>(vertex_count);
-            long long vi = 0;
-            if (idx_val > 0) vi = idx_val - 1; // 1-based
-            else if (idx_val < 0) vi = n + idx_val; // negative relative
-            else return std::nullopt; // 0 invalid in OBJ
-            if (vi < 0 || vi >= n) return std::nullopt;
-            return static_cast<std::size_t>(vi);
+            return Tag::other;
         }
 
+        // Parses one real number; T without a std::from_chars overload goes through double
         template <Arithmetic T>
-        inline void triangulate_and_add(Mesh<T>& mesh, const std::vector<std::size_t>& idxs){
-            if (idxs.size() < 3) return;
-            for (std::size_t i = 2; i < idxs.size(); ++i) mesh.add_triangle(idxs[0], idxs[i-1], idxs[i]);
+        [[nodiscard]] inline bool parse_real(const char*& p, const char* end, T& out) noexcept {
+            p = skip_blanks(p, end);
+            if (p < end && *p == '+') ++p;
+            using Parse = std::conditional_t<std::is_same_v<T, float> || std::is_same_v<T, double>, T, double>;
+            Parse value{};
+            const auto [ptr, ec] = std::from_chars(p, end, value);
+            if (ec != std::errc{}) return false;
+            p = ptr;
+            out = static_cast<T>(value);
+            return true;
+        }
+
+        // Resolves a 1-based or negative (relative) OBJ index against the number of records seen so far
+        [[nodiscard]] inline std::optional<std::size_t> resolve_index(long long idx, std::size_t count) noexcept {
+            const long long n = static_cast<long long>(count);
+            long long i = 0;
+            if (idx > 0) i = idx - 1;
+            else if (idx < 0) i = n + idx;
+            else return std::nullopt;
+            if (i < 0 || i >= n) return std::nullopt;
+            return static_cast<std::size_t>(i);
         }
 
+        // Parses an optional index at p; returns false if there is no valid integer
+        [[nodiscard]] inline bool parse_index(const char*& p, const char* end, long long& out) noexcept {
+            if (p < end && *p == '+') ++p;
+            const auto [ptr, ec] = std::from_chars(p, end, out);
+            if (ec != std::errc{}) return false;
+            p = ptr;
+            return true;
+        }
+
+        /** Record counts of one chunk (triangles is an upper bound: faces with bad indices produce fewer). */
+        struct Counts {
+            std::size_t v{}, vt{}, vn{}, triangles{};
+        };
+
+        [[nodiscard]] inline Counts count_records(const char* p, const char* end) noexcept {
+            Counts c;
+            while (p < end) {
+                const char* eol = find_line_end(p, end);
+                const char* rec_end = find_record_end(p, eol);
+                switch (read_tag(p, rec_end)) {
+                case Tag::v: ++c.v; break;
+                case Tag::vt: ++c.vt; break;
+                case Tag::vn: ++c.vn; break;
+                case Tag::f: {
+                    std::size_t corners = 0;
+                    while (true) {
+                        p = skip_blanks(p, rec_end);
+                        if (p == rec_end) break;
+                        ++corners;
+                        while (p < rec_end && !is_blank(*p)) ++p;
+                    }
+                    if (corners >= 3) c.triangles += corners - 2;
+                    break;
+                }
+                case Tag::other: break;
+                }
+                p = eol < end ? eol + 1 : end;
+            }
+            return c;
+        }
+
+        template <Arithmetic T>
+        struct Output {
+            Vector<T,3>* vertices{};
+            Vector<T,2>* texcoords{};
+            Vector<T,3>* normals{};
+            typename Mesh<T>::Triangle* triangles{};
+            typename Mesh<T>::TriangleAttributes* attributes{}; // null when the file has no vt/vn records
+        };
+
+        /**
+         * Parses the records of one chunk into preallocated storage.
+         * @param base record counts of all preceding chunks (write offsets and the base for relative indices)
+         * @return number of triangles written
+         */
         template <Arithmetic T>
-        inline void parse_face_record(std::istringstream& ls, Mesh<T>& mesh){
-            std::vector<std::size_t> face_indices; face_indices.reserve(8);
-            std::string vert;
-            while (ls >> vert) {
-                if (auto oi = parse_position_index_token(vert, mesh.vertex_count())) face_indices.push_back(*oi);
+        std::size_t parse_chunk(const char* p, const char* end, const Counts& base, const Output<T>& out) {
+            using Tri = typename Mesh<T>::Triangle;
+            using Attr = typename Mesh<T>::TriangleAttributes;
+            Counts n = base;
+            std::size_t written = 0;
+            struct Corner { std::uint32_t v, vt, vn; };
+            const ArenaScope scratch;
+            ArenaVector<Corner> corners;
+            corners.reserve(8);
+
+            while (p < end) {
+                const char* eol = find_line_end(p, end);
+                const char* rec_end = find_record_end(p, eol);
+                switch (read_tag(p, rec_end)) {
+                case Tag::v: {
+                    // Missing components read as 0; an optional w is ignored
+                    Vector<T,3> pos{};
+                    for (std::size_t k = 0; k < 3 && parse_real(p, rec_end, pos[k]); ++k) {}
+                    out.vertices[n.v++] = pos;
+                    break;
+                }
+                case Tag::vt: {
+                    Vector<T,2> uv{};
+                    for (std::size_t k = 0; k < 2 && parse_real(p, rec_end, uv[k]); ++k) {}
+                    out.texcoords[n.vt++] = uv;
+                    break;
+                }
+                case Tag::vn: {
+                    Vector<T,3> nrm{};
+                    for (std::size_t k = 0; k < 3 && parse_real(p, rec_end, nrm[k]); ++k) {}
+                    out.normals[n.vn++] = nrm;
+                    break;
+                }
+                case Tag::f: {
+                    corners.clear();
+                    while (true) {
+                        p = skip_blanks(p, rec_end);
+                        if (p == rec_end) break;
+                        const char* token_end = p;
+                        while (token_end < rec_end && !is_blank(*token_end)) ++token_end;
+                        // i, i/t, i//n or i/t/n; corners with an invalid position index are dropped
+                        long long iv = 0, it = 0, in = 0;
+                        std::optional<std::size_t> v, t, nn;
+                        if (parse_index(p, token_end, iv)) v = resolve_index(iv, n.v);
+                        if (p < token_end && *p == '/') {
+                            ++p;
+                            if (parse_index(p, token_end, it)) t = resolve_index(it, n.vt);
+                            if (p < token_end && *p == '/') {
+                                ++p;
+                                if (parse_index(p, token_end, in)) nn = resolve_index(in, n.vn);
+                            }
+                        }
+                        if (v) {
+                            corners.push_back({static_cast<std::uint32_t>(*v),
+                                               t ? static_cast<std::uint32_t>(*t) : Mesh<T>::no_attribute,
+                                               nn ? static_cast<std::uint32_t>(*nn) : Mesh<T>::no_attribute});
+                        }
+                        p = token_end;
+                    }
+                    // Fan triangulation
+                    for (std::size_t k = 2; k < corners.size(); ++k) {
+                        const Corner& a = corners[0];
+                        const Corner& b = corners[k - 1];
+                        const Corner& c = corners[k];
+                        out.triangles[base.triangles + written] = Tri{a.v, b.v, c.v};
+                        if (out.attributes) {
+                            Attr attr;
+                            attr.normal = {a.vn, b.vn, c.vn};
+                            attr.texcoord = {a.vt, b.vt, c.vt};
+                            out.attributes[base.triangles + written] = attr;
+                        }
+                        ++written;
+                    }
+                    break;
+                }
+                case Tag::other: break;
+                }
+                p = eol < end ? eol + 1 : end;
             }
-            triangulate_and_add(mesh, face_indices);
+            return written;
         }
     }
 
     /**
-     * @brief Minimal Wavefront OBJ loader.
+     * @brief Parses Wavefront OBJ text into a mesh.
+     * @param text complete OBJ file contents
+     * @param pool thread pool used to parse chunks in parallel
      * @details Supports:
-     *  - Vertex positions: lines starting with 'v' (three components)
-     *  - Faces: lines starting with 'f' (triangles/quads/ngons). Triangulates using a fan.
-     *  - Indices can be absolute (1-based) or negative (relative to current vertex count).
-     *  - Per-vertex formats i, i/tex, i//n, i/tex/n — only the position index is used.
+     *  - Vertex positions ('v'), texture coordinates ('vt') and normals ('vn'). Missing components read as 0.
+     *  - Faces ('f'): triangles/quads/ngons, triangulated as a fan. Corners may be i, i/t, i//n or i/t/n.
+     *  - Indices can be absolute (1-based) or negative (relative to the records read so far). Corners with an
+     *    invalid position index are dropped; invalid normal/texture indices leave that attribute unset.
      *  - Comments (#) and blank lines are ignored. Other record types are skipped.
+     *
+     * The text is split into line-aligned chunks. A first parallel pass counts the records of each chunk, so all
+     * mesh storage is allocated once and every chunk knows its write offsets and the index base for relative
+     * indices. A second parallel pass parses numbers with std::from_chars directly into that storage. The
+     * returned mesh has its triangle BVH built.
+     * @throws std::length_error if there are more than Mesh::max_elements vertices, normals or texture coordinates
      */
     export template <Arithmetic T>
-    [[nodiscard]] Mesh<T> load_obj(std::istream& in) {
+    [[nodiscard]] Mesh<T> parse_obj(std::string_view text, ThreadPool& pool) {
         using namespace obj_detail;
-        Mesh<T> mesh;
-        std::string line;
-        while (std::getline(in, line)) {
-            strip_comment(line);
-            trim(line);
-            if (line.empty()) continue;
-            std::istringstream ls(line);
-            std::string tag; ls >> tag;
-            if (tag == "v") { parse_vertex_record(ls, mesh); continue; }
-            if (tag == "f") { parse_face_record(ls, mesh); continue; }
-            // skip other tags
+        using Tri = typename Mesh<T>::Triangle;
+        using Attr = typename Mesh<T>::TriangleAttributes;
+        const char* const begin = text.data();
+        const char* const end = begin + text.size();
+
+        // Split at line boundaries
+        const std::size_t target = std::max<std::size_t>(1, std::min(text.size() / min_chunk_bytes,
+                                                                     pool.concurrency() * 8));
+        std::vector<const char*> bounds{begin};
+        for (std::size_t k = 1; k < target; ++k) {
+            const char* p = std::max(bounds.back(), begin + text.size() * k / target);
+            if (p >= end) break;
+            p = find_line_end(p, end);
+            if (p >= end) break;
+            bounds.push_back(p + 1);
+        }
+        bounds.push_back(end);
+        const std::size_t chunks = bounds.size() - 1;
+
+        // Pass 1: count records per chunk, then prefix sums give each chunk's offsets
+        std::vector<Counts> counts(chunks + 1);
+        pool.parallel_for(chunks, [&](std::size_t k, std::size_t) { counts[k + 1] = count_records(bounds[k], bounds[k + 1]); });
+        for (std::size_t k = 1; k <= chunks; ++k) {
+            counts[k].v += counts[k - 1].v;
+            counts[k].vt += counts[k - 1].vt;
+            counts[k].vn += counts[k - 1].vn;
+            counts[k].triangles += counts[k - 1].triangles;
+        }
+        const Counts& total = counts[chunks];
+        // Every valid index is below its record count, so in range counts keep all indices within 32 bits
+        if (total.v > Mesh<T>::max_elements || total.vt > Mesh<T>::max_elements || total.vn > Mesh<T>::max_elements) {
+            throw std::length_error("parse_obj: more vertices, normals or texture coordinates than 32-bit indices can address");
+        }
+
+        std::vector<Vector<T,3>> vertices(total.v);
+        std::vector<Vector<T,2>> texcoords(total.vt);
+        std::vector<Vector<T,3>> normals(total.vn);
+        std::vector<Tri> triangles(total.triangles);
+        std::vector<Attr> attributes(total.vt + total.vn > 0 ? total.triangles : 0);
+        const Output<T> out{vertices.data(), texcoords.data(), normals.data(), triangles.data(),
+                            attributes.empty() ? nullptr : attributes.data()};
+
+        // Pass 2: parse every chunk into its slice
+        std::vector<std::size_t> written(chunks);
+        pool.parallel_for(chunks, [&](std::size_t k, std::size_t) {
+            written[k] = parse_chunk<T>(bounds[k], bounds[k + 1], counts[k], out);
+        });
+
+        // Close the gaps left by faces that dropped corners
+        std::size_t tri_count = 0;
+        for (std::size_t k = 0; k < chunks; ++k) {
+            const std::size_t from = counts[k].triangles;
+            if (from != tri_count) {
+                std::copy(triangles.begin() + static_cast<std::ptrdiff_t>(from),
+                          triangles.begin() + static_cast<std::ptrdiff_t>(from + written[k]),
+                          triangles.begin() + static_cast<std::ptrdiff_t>(tri_count));
+                if (!attributes.empty()) {
+                    std::copy(attributes.begin() + static_cast<std::ptrdiff_t>(from),
+                              attributes.begin() + static_cast<std::ptrdiff_t>(from + written[k]),
+                              attributes.begin() + static_cast<std::ptrdiff_t>(tri_count));
+                }
+            }
+            tri_count += written[k];
+        }
+        triangles.resize(tri_count);
+        if (!attributes.empty()) attributes.resize(tri_count);
+
+        Mesh<T> mesh{std::move(vertices), std::move(triangles)};
+        if (!normals.empty() || !texcoords.empty()) {
+            mesh.set_attributes(std::move(normals), std::move(texcoords), std::move(attributes));
         }
+        mesh.build_bvh();
         return mesh;
     }
 
-    /** Load OBJ from a file path. Throws std::runtime_error if the file cannot be opened. */
+    /** @brief Parses OBJ text using the shared thread pool. */
+    export template <Arithmetic T>
+    [[nodiscard]] Mesh<T> parse_obj(std::string_view text) {
+        return parse_obj<T>(text, *ThreadPool::shared());
+    }
+
+    /** @brief Loads an OBJ mesh from a stream (read completely, then parsed as with parse_obj()). */
+    export template <Arithmetic T>
+    [[nodiscard]] Mesh<T> load_obj(std::istream& in) {
+        const std::string text{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+        return parse_obj<T>(text);
+    }
+
+    /**
+     * @brief Loads an OBJ file, memory-mapping it and parsing in parallel (see parse_obj()).
+     * @throws std::runtime_error if the file cannot be opened
+     */
     export template <Arithmetic T>
     [[nodiscard]] Mesh<T> load_obj(const std::string& path) {
-        std::ifstream f(path);
-        if (!f.is_open()) throw std::runtime_error("Failed to open OBJ file: " + path);
-        return load_obj<T>(f);
+        const auto file = MappedFile::open(path);
+        if (!file) throw std::runtime_error("Failed to open OBJ file: " + path);
+        return parse_obj<T>(file->view());
     }
 }
@@ -0,0 +1,347 @@
+module;
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+export module glimmer.partial_frame;
+
+import glimmer.vector;
+import glimmer.color;
+import glimmer.image;
+import glimmer.accumulation;
+import glimmer.tile;
+import glimmer.sampler;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing partial framebuffers for splitting one frame across machines, their binary
+     * file format and the merger that combines them into the final image.
+     *
+     * A frame is split by tile (a run of TileGrid indices) and by sample (a run of per-pixel sample indices).
+     * Because samples are seeded from (seed, pixel, sample index), not from the thread or node that draws them,
+     * any set of disjoint ranges that covers every tile and sample index merges into the same image a single
+     * render() would produce, up to rounding of the summation order.
+     *
+     * File layout (native byte order): a 104-byte header with magic "GLIMPART", format version, endianness tag,
+     * scalar size, sampler, frame size, tile size, seed, the tile and sample ranges and the stored rows, followed
+     * by 5 scalars per stored pixel (RGB sum, luminance sum, luminance square sum) and one 32-bit sample count
+     * per stored pixel.
+     */
+
+    /** @brief Subset of a frame's work: tiles [first_tile, first_tile + tile_count) and samples likewise. */
+    export struct FrameRange {
+        /** @brief Count meaning "through the last tile" or "through samples_per_pixel()". */
+        static constexpr std::size_t all = std::numeric_limits<std::size_t>::max();
+
+        std::size_t first_tile{0};
+        std::size_t tile_count{all};
+        std::size_t first_sample{0};
+        std::size_t sample_count{all};
+
+        [[nodiscard]] friend constexpr bool operator==(const FrameRange&, const FrameRange&) noexcept = default;
+    };
+
+    /**
+     * @brief Samples of part of a frame, with the parameters needed to merge it with other parts.
+     * @tparam T arithmetic scalar type (float/double recommended)
+     * @details pixels covers full-width rows [y0, y0 + pixels.height()) of the frame: the rows touched by the
+     * tile range. Pixels of those rows outside the tile range hold no samples.
+     */
+    export template <Arithmetic T>
+    struct PartialFrame {
+        std::size_t width{0};
+        std::size_t height{0};
+        std::size_t tile_size{TileGrid::default_tile_size};
+        std::uint64_t seed{0};
+        SamplerKind sampler{SamplerKind::independent};
+        /** @brief Rendered range with `all` resolved and the tile range clipped to the grid. */
+        FrameRange range{0, 0, 0, 0};
+        std::size_t y0{0};
+        AccumulationBuffer<T> pixels{};
+
+        /**
+         * @brief Creates an empty partial frame for range of a width x height frame.
+         * @param samples_per_pixel sample count `FrameRange::all` stands for
+         * @details Tile ranges past the end of the grid are clipped; an empty range gives an empty buffer.
+         */
+        [[nodiscard]] static PartialFrame create(std::size_t width, std::size_t height, std::size_t tile_size,
+                                                 std::uint64_t seed, SamplerKind sampler, const FrameRange& range,
+                                                 std::size_t samples_per_pixel) {
+            PartialFrame part{};
+            part.width = width;
+            part.height = height;
+            part.tile_size = std::max<std::size_t>(tile_size, 1);
+            part.seed = seed;
+            part.sampler = sampler;
+            const TileGrid grid{width, height, part.tile_size};
+            FrameRange& r = part.range;
+            r.first_tile = std::min(range.first_tile, grid.count());
+            r.tile_count = std::min(range.tile_count, grid.count() - r.first_tile);
+            r.first_sample = range.first_sample;
+            if (range.sample_count != FrameRange::all) r.sample_count = range.sample_count;
+            else r.sample_count = samples_per_pixel > range.first_sample ? samples_per_pixel - range.first_sample : 0;
+            if (r.tile_count > 0) {
+                part.y0 = grid.tile(r.first_tile).y0;
+                part.pixels.resize(width, grid.tile(r.first_tile + r.tile_count - 1).y1 - part.y0);
+            }
+            return part;
+        }
+
+        /** @brief True if tile index i is part of the range. */
+        [[nodiscard]] bool has_tile(std::size_t i) const noexcept {
+            return i >= range.first_tile && i - range.first_tile < range.tile_count;
+        }
+
+        /** @brief Adds a sample to frame pixel (x,y); (x,y) must lie in a tile of the range. */
+        void add_sample(std::size_t x, std::size_t y, const Color<T,3>& c) noexcept { pixels.add_sample(x, y - y0, c); }
+    };
+
+    namespace partial_frame_detail {
+        inline constexpr char magic[8] = {'G', 'L', 'I', 'M', 'P', 'A', 'R', 'T'};
+        inline constexpr std::uint32_t endian_tag = 0x01020304u;
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t endian;
+            std::uint32_t scalar_size;
+            std::uint32_t sampler;
+            std::uint64_t width;
+            std::uint64_t height;
+            std::uint64_t tile_size;
+            std::uint64_t seed;
+            std::uint64_t first_tile;
+            std::uint64_t tile_count;
+            std::uint64_t first_sample;
+            std::uint64_t sample_count;
+            std::uint64_t y0;
+            std::uint64_t rows;
+        };
+        static_assert(sizeof(Header) == 104);
+
+        [[nodiscard]] constexpr bool overlaps(std::size_t a0, std::size_t an, std::size_t b0, std::size_t bn) noexcept {
+            return an > 0 && bn > 0 && a0 < b0 + bn && b0 < a0 + an;
+        }
+    }
+
+    /** @brief Current partial frame format version; files with another version are rejected. */
+    export inline constexpr std::uint32_t partial_frame_version = 1;
+
+    /**
+     * @brief Writes a partial frame to a binary file.
+     * @param part frame to store
+     * @param path destination path; the file is written under a temporary name and renamed into place
+     * @return true on success
+     */
+    export template <Arithmetic T>
+    [[nodiscard]] bool save_partial_frame(const PartialFrame<T>& part, const std::string& path) {
+        using namespace partial_frame_detail;
+        Header header{};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = partial_frame_version;
+        header.endian = endian_tag;
+        header.scalar_size = sizeof(T);
+        header.sampler = static_cast<std::uint32_t>(part.sampler);
+        header.width = part.width;
+        header.height = part.height;
+        header.tile_size = part.tile_size;
+        header.seed = part.seed;
+        header.first_tile = part.range.first_tile;
+        header.tile_count = part.range.tile_count;
+        header.first_sample = part.range.first_sample;
+        header.sample_count = part.range.sample_count;
+        header.y0 = part.y0;
+        header.rows = part.pixels.height();
+
+        const std::size_t w = part.pixels.width();
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) return false;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            // Row by row: sums first, counts after the last row, so both arrays are contiguous in the file
+            std::vector<T> scalars(5 * w);
+            for (std::size_t y = 0; y < header.rows; ++y) {
+                for (std::size_t x = 0; x < w; ++x) {
+                    const auto p = part.pixels.pixel_sums(x, y);
+                    T* s = scalars.data() + 5 * x;
+                    s[0] = p.sum[0]; s[1] = p.sum[1]; s[2] = p.sum[2]; s[3] = p.lum_sum; s[4] = p.lum_sq_sum;
+                }
+                out.write(reinterpret_cast<const char*>(scalars.data()),
+                          static_cast<std::streamsize>(scalars.size() * sizeof(T)));
+            }
+            std::vector<std::uint32_t> counts(w);
+            for (std::size_t y = 0; y < header.rows; ++y) {
+                for (std::size_t x = 0; x < w; ++x) counts[x] = part.pixels.samples(x, y);
+                out.write(reinterpret_cast<const char*>(counts.data()),
+                          static_cast<std::streamsize>(counts.size() * sizeof(std::uint32_t)));
+            }
+            if (!out.flush()) return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) std::filesystem::remove(tmp, ec);
+        return !ec;
+    }
+
+    /**
+     * @brief Loads a partial frame written by save_partial_frame().
+     * @return the frame, or std::nullopt if the file is missing, truncated, inconsistent, from another format
+     * version, or written with a different scalar type or byte order
+     */
+    export template <Arithmetic T>
+    [[nodiscard]] std::optional<PartialFrame<T>> load_partial_frame(const std::string& path) {
+        using namespace partial_frame_detail;
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return std::nullopt;
+        Header header{};
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return std::nullopt;
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != partial_frame_version ||
+            header.endian != endian_tag || header.scalar_size != sizeof(T) || header.sampler > 1 ||
+            header.tile_size == 0) {
+            return std::nullopt;
+        }
+        // Check the payload size before allocating anything from header values
+        constexpr std::uint64_t pixel_bytes = 5 * sizeof(T) + sizeof(std::uint32_t);
+        std::error_code ec;
+        const std::uint64_t file_size = std::filesystem::file_size(path, ec);
+        if (ec || file_size < sizeof(Header)) return std::nullopt;
+        const std::uint64_t payload = file_size - sizeof(Header);
+        if (header.rows != 0 && header.width > payload / pixel_bytes / header.rows) return std::nullopt;
+        if (payload != header.rows * header.width * pixel_bytes) return std::nullopt;
+
+        // The stored rows must be the ones create() derives from the tile range
+        const FrameRange range{static_cast<std::size_t>(header.first_tile), static_cast<std::size_t>(header.tile_count),
+                               static_cast<std::size_t>(header.first_sample),
+                               static_cast<std::size_t>(header.sample_count)};
+        if (range.sample_count == FrameRange::all) return std::nullopt;
+        // Resolve the tile range on a TileGrid, which allocates nothing, so that the rows create() allocates
+        // are the rows whose size was checked against the file above
+        const TileGrid grid{static_cast<std::size_t>(header.width), static_cast<std::size_t>(header.height),
+                            static_cast<std::size_t>(header.tile_size)};
+        if (grid.tiles_y() != 0 && grid.tiles_x() > std::numeric_limits<std::size_t>::max() / grid.tiles_y()) {
+            return std::nullopt;
+        }
+        const std::size_t first_tile = std::min(range.first_tile, grid.count());
+        const std::size_t tile_count = std::min(range.tile_count, grid.count() - first_tile);
+        const std::size_t y0 = tile_count > 0 ? grid.tile(first_tile).y0 : 0;
+        const std::size_t y1 = tile_count > 0 ? grid.tile(first_tile + tile_count - 1).y1 : 0;
+        if (header.y0 != y0 || header.rows != y1 - y0) return std::nullopt;
+        PartialFrame<T> part = PartialFrame<T>::create(static_cast<std::size_t>(header.width),
+                                                       static_cast<std::size_t>(header.height),
+                                                       static_cast<std::size_t>(header.tile_size), header.seed,
+                                                       static_cast<SamplerKind>(header.sampler), range, 0);
+        if (part.range != range || part.y0 != header.y0 || part.pixels.height() != header.rows) return std::nullopt;
+
+        const std::size_t w = part.pixels.width();
+        const std::size_t rows = part.pixels.height();
+        std::vector<T> scalars(5 * w * rows);
+        std::vector<std::uint32_t> counts(w * rows);
+        if (!in.read(reinterpret_cast<char*>(scalars.data()),
+                     static_cast<std::streamsize>(scalars.size() * sizeof(T))) ||
+            !in.read(reinterpret_cast<char*>(counts.data()),
+                     static_cast<std::streamsize>(counts.size() * sizeof(std::uint32_t)))) {
+            return std::nullopt;
+        }
+        for (std::size_t y = 0; y < rows; ++y) {
+            for (std::size_t x = 0; x < w; ++x) {
+                const std::size_t i = y * w + x;
+                const T* s = scalars.data() + 5 * i;
+                typename AccumulationBuffer<T>::PixelSums p{};
+                p.sum[0] = s[0]; p.sum[1] = s[1]; p.sum[2] = s[2];
+                p.lum_sum = s[3];
+                p.lum_sq_sum = s[4];
+                p.count = counts[i];
+                part.pixels.add_sums(x, y, p);
+            }
+        }
+        return part;
+    }
+
+    /**
+     * @brief Reads only the header of a partial frame file.
+     * @return sizeof(T) of the renderer that wrote it, or std::nullopt if the file is not a partial frame of this
+     * format version and byte order
+     * @details Lets tools pick the T to call load_partial_frame() with.
+     */
+    export [[nodiscard]] inline std::optional<std::size_t> partial_frame_scalar_size(const std::string& path) {
+        using namespace partial_frame_detail;
+        std::ifstream in(path, std::ios::binary);
+        Header header{};
+        if (!in || !in.read(reinterpret_cast<char*>(&header), sizeof(header))) return std::nullopt;
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != partial_frame_version ||
+            header.endian != endian_tag) {
+            return std::nullopt;
+        }
+        return header.scalar_size;
+    }
+
+    /**
+     * @brief Combines partial frames from any number of renders into the full frame.
+     * @tparam T arithmetic scalar type (float/double recommended)
+     * @details The first frame added fixes the frame size, tile size, seed and sampler; later frames must match
+     * them. Frames whose tile ranges and sample ranges both overlap would count the same samples twice, so they
+     * are rejected. Parts can arrive in any order; the merged estimate of a pixel is the mean of all its samples.
+     */
+    export template <Arithmetic T>
+    class FrameMerger {
+    public:
+        /**
+         * @brief Adds a partial frame's samples.
+         * @throws std::invalid_argument if part belongs to a different frame or overlaps a frame added earlier
+         */
+        void add(const PartialFrame<T>& part) {
+            if (ranges_.empty()) {
+                first_ = FrameKey{part.width, part.height, part.tile_size, part.seed, part.sampler};
+                acc_.resize(part.width, part.height);
+            } else if (FrameKey{part.width, part.height, part.tile_size, part.seed, part.sampler} != first_) {
+                throw std::invalid_argument("FrameMerger::add: partial frame of a different frame");
+            }
+            const FrameRange& r = part.range;
+            for (const FrameRange& o : ranges_) {
+                if (partial_frame_detail::overlaps(r.first_tile, r.tile_count, o.first_tile, o.tile_count) &&
+                    partial_frame_detail::overlaps(r.first_sample, r.sample_count, o.first_sample, o.sample_count)) {
+                    throw std::invalid_argument("FrameMerger::add: partial frame overlaps one added before");
+                }
+            }
+            acc_.merge(part.pixels, 0, part.y0);
+            ranges_.push_back(r);
+        }
+
+        /** @brief Number of partial frames added. */
+        [[nodiscard]] std::size_t part_count() const noexcept { return ranges_.size(); }
+
+        /** @brief Ranges of the frames added, in order. */
+        [[nodiscard]] const std::vector<FrameRange>& ranges() const noexcept { return ranges_; }
+
+        /** @brief Merged samples of the whole frame. */
+        [[nodiscard]] const AccumulationBuffer<T>& buffer() const noexcept { return acc_; }
+
+        /** @brief Writes the merged estimate to out (resizes if needed); pixels without samples are black. */
+        void resolve(Image<T,3>& out) const { acc_.resolve(out); }
+
+    private:
+        struct FrameKey {
+            std::size_t width{0};
+            std::size_t height{0};
+            std::size_t tile_size{0};
+            std::uint64_t seed{0};
+            SamplerKind sampler{SamplerKind::independent};
+            [[nodiscard]] friend bool operator==(const FrameKey&, const FrameKey&) noexcept = default;
+        };
+
+        FrameKey first_{};
+        std::vector<FrameRange> ranges_{};
+        AccumulationBuffer<T> acc_{};
+    };
+}
@@ -0,0 +1,210 @@
+module;
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+export module glimmer.pfm;
+
+import glimmer.vector;
+import glimmer.image;
+import glimmer.color;
+import glimmer.tile;
+import glimmer.image_sink;
+import glimmer.mapped_file;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing PFM (portable float map) IO for HDR RGB images.
+     * @details PFM stores 32-bit floats per channel after a short text header ("PF" for RGB, "Pf" for one
+     * channel, then width, height and a scale whose sign gives the byte order: negative for little-endian).
+     * Rows are stored bottom to top. Files are written in the host byte order; both orders are read.
+     */
+
+    namespace pfm_detail {
+        inline constexpr bool little_endian = std::endian::native == std::endian::little;
+
+        [[nodiscard]] inline std::string header(std::size_t width, std::size_t height) {
+            return "PF\n" + std::to_string(width) + ' ' + std::to_string(height) + (little_endian ? "\n-1.0\n" : "\n1.0\n");
+        }
+
+        // Skips the whitespace between header fields (PFM headers have no comments)
+        inline void skip_blanks(std::string_view text, std::size_t& pos) noexcept {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) ++pos;
+        }
+
+        template <class V>
+        [[nodiscard]] std::optional<V> read_number(std::string_view text, std::size_t& pos) noexcept {
+            skip_blanks(text, pos);
+            V v{};
+            const auto [ptr, ec] = std::from_chars(text.data() + pos, text.data() + text.size(), v);
+            if (ec != std::errc{}) return std::nullopt;
+            pos = static_cast<std::size_t>(ptr - text.data());
+            return v;
+        }
+
+        // Writes the pixels of one image row as host-order floats into out (3 * pixels.size() floats)
+        template <Arithmetic T>
+        void to_floats(std::span<const Color<T,3>> pixels, float* out) noexcept {
+            for (std::size_t i = 0; i < pixels.size(); ++i) {
+                for (std::size_t c = 0; c < 3; ++c) out[3 * i + c] = static_cast<float>(pixels[i][c]);
+            }
+        }
+
+        // Writes header and rows; row(y, floats) fills image row y (top to bottom) as 3 * width floats
+        template <class RowFn>
+        [[nodiscard]] bool write(const std::string& path, std::size_t width, std::size_t height, RowFn&& row) {
+            std::ofstream f(path, std::ios::binary);
+            if (!f.good()) return false;
+            f << header(width, height);
+            std::vector<float> floats(3 * width);
+            for (std::size_t k = 0; k < height; ++k) {
+                const std::size_t y = height - 1 - k;
+                row(y, floats.data());
+                f.write(reinterpret_cast<const char*>(floats.data()), static_cast<std::streamsize>(floats.size() * sizeof(float)));
+                if (!f.good()) return false;
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief Saves a 3-channel image to a PFM file (channels are converted to float, values are not clamped).
+     * @return true on success, false on failure
+     */
+    export template <Arithmetic T>
+    [[nodiscard]] inline bool save_pfm(const Image<T,3>& img, const std::string& path) {
+        const std::size_t w = img.width();
+        return pfm_detail::write(path, w, img.height(), [&](std::size_t y, float* out) {
+            pfm_detail::to_floats<T>(std::span<const Color<T,3>>{img.data() + y * w, w}, out);
+        });
+    }
+
+    /**
+     * @brief Saves a 3-channel compact image to a PFM file.
+     * @details f32 rows are written from the image storage as they are; f16 rows are widened to float.
+     */
+    export template <Arithmetic T, PixelFormat F>
+    [[nodiscard]] inline bool save_pfm(const CompactImage<T,3,F>& img, const std::string& path) {
+        const std::size_t w = img.width();
+        const auto channels = img.channels();
+        std::vector<Color<T,3>> pixels(F == PixelFormat::f32 ? 0 : w);
+        return pfm_detail::write(path, w, img.height(), [&](std::size_t y, float* out) {
+            if constexpr (F == PixelFormat::f32) {
+                std::copy_n(channels.data() + 3 * w * y, 3 * w, out);
+            } else {
+                img.read_row(0, y, pixels);
+                pfm_detail::to_floats<T>(pixels, out);
+            }
+        });
+    }
+
+    /**
+     * @brief Loads a PFM file into a 3-channel image.
+     * @tparam T arithmetic scalar per-channel type
+     * @param path filesystem path to read from
+     * @return the image (top row first), or std::nullopt if the file is missing, truncated or not a PFM file
+     * @details Supports RGB ("PF") and greyscale ("Pf") files in either byte order; greyscale values are copied
+     * to all three channels. The scale magnitude in the header is not applied. The file is memory-mapped and
+     * converted straight into the image storage.
+     */
+    export template <Arithmetic T>
+    [[nodiscard]] std::optional<Image<T,3>> load_pfm(const std::string& path) {
+        const auto file = MappedFile::open(path);
+        if (!file) return std::nullopt;
+        const std::string_view text = file->view();
+        if (text.size() < 3 || text[0] != 'P' || (text[1] != 'F' && text[1] != 'f')) return std::nullopt;
+        const std::size_t channels = text[1] == 'F' ? 3 : 1;
+        std::size_t pos = 2;
+        const auto w = pfm_detail::read_number<long>(text, pos);
+        const auto h = pfm_detail::read_number<long>(text, pos);
+        const auto scale = pfm_detail::read_number<double>(text, pos);
+        if (!w || !h || !scale || *w <= 0 || *h <= 0 || *scale == 0.0) return std::nullopt;
+        // A single whitespace character separates the header from the binary data
+        if (pos >= text.size()) return std::nullopt;
+        ++pos;
+        const std::size_t width = static_cast<std::size_t>(*w);
+        const std::size_t height = static_cast<std::size_t>(*h);
+        // Compare by division so that oversized headers cannot wrap the pixel count
+        if (width > (text.size() - pos) / sizeof(float) / channels / height) return std::nullopt;
+        const bool swap = (*scale < 0.0) != pfm_detail::little_endian;
+        const char* src = text.data() + pos;
+
+        Image<T,3> img{width, height};
+        for (std::size_t k = 0; k < height; ++k) {
+            Color<T,3>* row = img.data() + (height - 1 - k) * width;
+            const char* in = src + k * channels * width * sizeof(float);
+            for (std::size_t x = 0; x < width; ++x) {
+                for (std::size_t c = 0; c < 3; ++c) {
+                    std::uint32_t bits;
+                    std::memcpy(&bits, in + (channels * x + (channels == 3 ? c : 0)) * sizeof(float), sizeof(bits));
+                    if (swap) bits = std::byteswap(bits);
+                    row[x][c] = static_cast<T>(std::bit_cast<float>(bits));
+                }
+            }
+        }
+        return img;
+    }
+
+    /**
+     * @brief Image sink that streams a render into a PFM file.
+     * @tparam T arithmetic scalar per-channel type
+     * @details Tiles are converted to float as they arrive and handed to a StreamingRowWriter, which writes on
+     * a background I/O thread by default. PFM stores rows bottom to top, so with the usual top-to-bottom tile
+     * order rows are released only once the bottom band is done: peak memory is the float image (12 bytes per
+     * pixel), but no framebuffer of T is needed and encoding overlaps rendering.
+     */
+    export template <Arithmetic T>
+    class PfmStreamSink final : public ImageSink<T> {
+    public:
+        using Color3 = Color<T,3>;
+
+        /**
+         * @param path destination file
+         * @param async write on a background thread rather than on the render threads
+         */
+        explicit PfmStreamSink(std::string path, bool async = true) : path_{std::move(path)}, async_{async} {}
+
+        void begin(std::size_t width, std::size_t height) override {
+            height_ = height;
+            opened_ = writer_.open(path_, pfm_detail::header(width, height), height, 3 * width * sizeof(float), async_);
+        }
+
+        void write_tile(const Tile& tile, std::span<const Color3> pixels) override {
+            if (!opened_) return;
+            std::vector<float> floats(3 * tile.width());
+            for (std::size_t y = tile.y0; y < tile.y1; ++y) {
+                pfm_detail::to_floats<T>(pixels.subspan((y - tile.y0) * tile.width(), tile.width()), floats.data());
+                const std::size_t file_row = height_ - 1 - y;
+                const auto row = writer_.row(file_row).subspan(3 * tile.x0 * sizeof(float), floats.size() * sizeof(float));
+                std::memcpy(row.data(), floats.data(), row.size());
+                writer_.commit(file_row, row.size());
+            }
+        }
+
+        void end() override { ok_ = opened_ && writer_.close(); }
+
+        /** @brief True once the file has been written completely (after end()). */
+        [[nodiscard]] bool good() const noexcept { return ok_; }
+        /** @brief Allows tuning the I/O queue limit (see StreamingRowWriter). */
+        [[nodiscard]] StreamingRowWriter& writer() noexcept { return writer_; }
+
+    private:
+        std::string path_;
+        bool async_;
+        std::size_t height_{0};
+        bool opened_{false};
+        bool ok_{false};
+        StreamingRowWriter writer_{};
+    };
+}
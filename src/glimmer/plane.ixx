@@ -106,9 +106,20 @@ namespace glimmer
             const T u = dot(d, u_dir);
             const T v = dot(d, v_dir);
             h.uv = Vector<T, 2>{u, v};
+            h.uv_scale = T{1};
             return h;
         }
 
+        /** @brief Any-hit test: parallel check and range test only, no UV basis construction. */
+        [[nodiscard]] bool occluded(const Ray<T>& ray) const noexcept override
+        {
+            const T denom = dot(n_, ray.direction());
+            const T eps = static_cast<T>(1e-8);
+            if (denom > -eps && denom < eps) return false;
+            const T t = dot(p0_ - ray.origin(), n_) / denom;
+            return t >= ray.tmin() && t <= ray.tmax();
+        }
+
     private:
         static constexpr T big_extent_() noexcept
         {
@@ -1,18 +1,32 @@
 module;
-#include <string>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <future>
+#include <limits>
 #include <optional>
-#include <vector>
-#include <cctype>
+#include <span>
+#include <string>
+#include <string_view>
 #include <type_traits>
-#include <cstdlib>
-#include <cmath>
+#include <utility>
+#include <vector>
 
 export module glimmer.ppm;
 
 import glimmer.vector;
 import glimmer.image;
 import glimmer.color;
+import glimmer.tile;
+import glimmer.image_sink;
+import glimmer.mapped_file;
 
 namespace glimmer {
     /**
@@ -20,48 +34,354 @@ namespace glimmer {
      * @brief C++23 module providing PPM (P6) image IO helpers for 3-channel images.
      */
 
+    /** @brief Tone curve mapping scene-referred HDR values into [0,1] per channel. */
+    export enum class Tonemap {
+        clamp,    ///< values above 1 are clipped
+        reinhard, ///< x / (1 + x)
+        aces      ///< Narkowicz's fit of the ACES filmic curve
+    };
+
+    /** @brief Transfer curve applied when quantizing channels to 8 bits. */
+    export struct U8Encoding {
+        /** @brief Display gamma: channels are raised to 1/gamma before quantization (1 = linear). */
+        double gamma{1.0};
+        /** @brief Use the piecewise sRGB transfer function instead of the gamma power law. */
+        bool srgb{false};
+        /** @brief Scale applied to floating-point channels before the tone curve. */
+        double exposure{1.0};
+        /** @brief Tone curve applied to floating-point channels before the transfer curve. */
+        Tonemap tonemap{Tonemap::clamp};
+
+        /** @brief True if values are quantized linearly. */
+        [[nodiscard]] constexpr bool linear() const noexcept { return !srgb && gamma == 1.0; }
+        /** @brief True if channels pass through exposure and the tone curve unchanged (up to clipping). */
+        [[nodiscard]] constexpr bool unmapped() const noexcept { return exposure == 1.0 && tonemap == Tonemap::clamp; }
+    };
+
+    /**
+     * @brief Bulk converter from channel values to 8 bits.
+     * @tparam T arithmetic scalar per-channel type
+     * @details For floating-point T, channels are scaled by the exposure, mapped by the tone curve, clamped to
+     * [0,1] (NaN becomes 0), passed through the transfer curve of the U8Encoding, and rounded to the nearest of
+     * 0..255. For integral T, channels are clamped to [0,255]. The linear case is a branch-free loop the
+     * compiler vectorizes. Non-linear curves avoid a pow() per channel: the encoder precomputes the linear-space
+     * boundaries between consecutive 8-bit codes, estimates the code from polynomial log2/exp2 approximations
+     * of the curve in float (off by at most one code, in a loop the compiler vectorizes), and corrects the
+     * estimate against the two neighbouring boundaries, which gives exactly the rounded curve value. The
+     * correction reads the table, so it vectorizes only on targets with gather instructions. Gammas outside
+     * [0.1, 10], where the approximation is not accurate enough, use an 8-step binary search instead.
+     * encode() applies exposure and tone curve to blocks of channels in a separate branch-free loop per curve
+     * before quantizing them.
+     */
+    export template <Arithmetic T>
+    class U8Encoder {
+    public:
+        explicit U8Encoder(const U8Encoding& encoding = {})
+            : linear_{encoding.linear()}, unmapped_{encoding.unmapped()}, tonemap_{encoding.tonemap},
+              exposure_{static_cast<T>(encoding.exposure)}, srgb_{encoding.srgb},
+              approximate_{encoding.srgb || (encoding.gamma >= 0.1 && encoding.gamma <= 10.0)},
+              inv_gamma_{static_cast<float>(1.0 / encoding.gamma)} {
+            if constexpr (std::is_floating_point_v<T>) {
+                if (linear_) return;
+                // bounds_[k]: smallest linear value whose encoded code is >= k (k = 1..255); bounds_[0] = -inf and
+                // bounds_[256] = +inf, so the estimate correction never needs a range check
+                bounds_[0] = -std::numeric_limits<T>::infinity();
+                for (std::size_t k = 1; k < 256; ++k) {
+                    const double e = (static_cast<double>(k) - 0.5) / 255.0;
+                    bounds_[k] = static_cast<T>(encoding.srgb ? srgb_to_linear_(e) : std::pow(e, encoding.gamma));
+                }
+                bounds_[256] = std::numeric_limits<T>::infinity();
+            }
+        }
+
+        /** @brief Converts one channel value. */
+        [[nodiscard]] unsigned char operator()(T v) const noexcept {
+            if constexpr (std::is_floating_point_v<T>) {
+                if (!unmapped_) v = map_(v);
+                if (linear_) return quantize_linear_(v);
+                return approximate_ ? correct_(v, srgb_ ? estimate_<true>(v) : estimate_<false>(v)) : search_(v);
+            } else {
+                const long long c = std::clamp<long long>(static_cast<long long>(v), 0, 255);
+                return static_cast<unsigned char>(c);
+            }
+        }
+
+        /** @brief Converts in.size() channel values into out (which must be at least as large). */
+        void encode(std::span<const T> in, std::span<unsigned char> out) const noexcept {
+            const std::size_t n = in.size();
+            const T* src = in.data();
+            unsigned char* dst = out.data();
+            if constexpr (std::is_floating_point_v<T>) {
+                if (!unmapped_) {
+                    std::array<T, block_> mapped;
+                    for (std::size_t i = 0; i < n; i += block_) {
+                        const std::size_t m = std::min(block_, n - i);
+                        switch (tonemap_) {
+                        case Tonemap::clamp: map_block_<Tonemap::clamp>(src + i, mapped.data(), m); break;
+                        case Tonemap::reinhard: map_block_<Tonemap::reinhard>(src + i, mapped.data(), m); break;
+                        case Tonemap::aces: map_block_<Tonemap::aces>(src + i, mapped.data(), m); break;
+                        }
+                        quantize_(mapped.data(), dst + i, m);
+                    }
+                    return;
+                }
+                quantize_(src, dst, n);
+                return;
+            }
+            for (std::size_t i = 0; i < n; ++i) dst[i] = (*this)(src[i]);
+        }
+
+    private:
+        // Channels mapped per inner loop of encode()
+        static constexpr std::size_t block_ = 256;
+
+        // Exposure and tone curve of one channel; the result may still exceed [0,1] for Tonemap::clamp
+        template <Tonemap M>
+        [[nodiscard]] T map_one_(T v) const noexcept {
+            if constexpr (M == Tonemap::clamp) return v * exposure_;
+            else return curve_<M>(exposed_(v));
+        }
+
+        // Exposed value ready for a tone curve: NaN and negatives become 0, infinities a large finite value
+        [[nodiscard]] T exposed_(T v) const noexcept {
+            T x = v * exposure_;
+            x = x > T{0} ? x : T{0};
+            return x < T{1e4} ? x : T{1e4};
+        }
+
+        template <Tonemap M>
+        [[nodiscard]] static T curve_(T x) noexcept {
+            if constexpr (M == Tonemap::reinhard) return x / (T{1} + x);
+            else return (x * (T{2.51} * x + T{0.03})) / (x * (T{2.43} * x + T{0.59}) + T{0.14});
+        }
+
+        [[nodiscard]] T map_(T v) const noexcept {
+            switch (tonemap_) {
+            case Tonemap::reinhard: return map_one_<Tonemap::reinhard>(v);
+            case Tonemap::aces: return map_one_<Tonemap::aces>(v);
+            default: return map_one_<Tonemap::clamp>(v);
+            }
+        }
+
+        template <Tonemap M>
+        void map_block_(const T* src, T* dst, std::size_t n) const noexcept {
+            if constexpr (M == Tonemap::clamp) {
+                for (std::size_t i = 0; i < n; ++i) dst[i] = src[i] * exposure_;
+            } else {
+                // Separate loops: GCC keeps the clamps as branches when the curve follows in the same loop
+                for (std::size_t i = 0; i < n; ++i) dst[i] = exposed_(src[i]);
+                for (std::size_t i = 0; i < n; ++i) dst[i] = curve_<M>(dst[i]);
+            }
+        }
+
+        void quantize_(const T* src, unsigned char* dst, std::size_t n) const noexcept {
+            if (linear_) {
+                for (std::size_t i = 0; i < n; ++i) dst[i] = quantize_linear_(src[i]);
+            } else if (approximate_) {
+                // Estimates in one loop (vectorized), corrections against the table in another
+                std::array<std::int32_t, block_> codes;
+                for (std::size_t i = 0; i < n; i += block_) {
+                    const std::size_t m = std::min(block_, n - i);
+                    if (srgb_) {
+                        for (std::size_t j = 0; j < m; ++j) codes[j] = estimate_<true>(src[i + j]);
+                    } else {
+                        for (std::size_t j = 0; j < m; ++j) codes[j] = estimate_<false>(src[i + j]);
+                    }
+                    for (std::size_t j = 0; j < m; ++j) dst[i + j] = correct_(src[i + j], codes[j]);
+                }
+            } else {
+                for (std::size_t i = 0; i < n; ++i) dst[i] = search_(src[i]);
+            }
+        }
+
+        [[nodiscard]] static unsigned char quantize_linear_(T v) noexcept {
+            // Clamp first, so the truncation below rounds to nearest
+            T c = v > T{0} ? v : T{0};
+            c = c < T{1} ? c : T{1};
+            return static_cast<unsigned char>(static_cast<int>(c * T{255} + T{0.5}));
+        }
+
+        // v clamped to [smallest normal float, 1], with NaN and negatives at the low end. Integer masks rather
+        // than selects, which GCC does not if-convert in front of the float arithmetic of estimate_().
+        [[nodiscard]] static float clamp_bits_(float v) noexcept {
+            constexpr std::int32_t lo = 0x00800000; // 2^-126; every supported curve maps it to code 0
+            constexpr std::int32_t hi = 0x3f800000; // 1.0f
+            std::int32_t b = std::bit_cast<std::int32_t>(v);
+            b &= ~(b >> 31); // negative values and NaNs become +0
+            b &= ~((0x7f800000 - b) >> 31); // positive NaNs become +0
+            std::int32_t m = (b - lo) >> 31;
+            b = (b & ~m) | (lo & m);
+            m = (hi - b) >> 31;
+            b = (b & ~m) | (hi & m);
+            return std::bit_cast<float>(b);
+        }
+
+        // log2 for positive normal floats: exponent plus a quartic fit of log2 on the mantissa (error < 2.1e-4)
+        [[nodiscard]] static float log2_(float x) noexcept {
+            const auto bits = std::bit_cast<std::uint32_t>(x);
+            const float e = static_cast<float>(static_cast<int>(bits >> 23) - 127);
+            const float t = std::bit_cast<float>((bits & 0x7fffffu) | 0x3f800000u) - 1.0f;
+            return e + (0.00020317973f + t * (1.4361078f + t * (-0.66954228f + t * (0.31224097f - 0.079158161f * t))));
+        }
+
+        // 2^y for y <= 0: y is split into round(y) + f with the 1.5 * 2^23 trick, 2^f (|f| <= 1/2) is a cubic fit
+        // (relative error < 1.4e-4) and round(y) is added to its exponent; results below 2^-126 are not exact
+        [[nodiscard]] static float exp2_(float y) noexcept {
+            const float r = y + 12582912.0f;
+            const float f = y - (r - 12582912.0f);
+            std::int32_t k = std::bit_cast<std::int32_t>(r) - 0x4b400000;
+            k = k > -126 ? k : -126;
+            const float p = 0.999951254f + f * (0.693253244f + f * (0.24225878f + f * 0.055028843f));
+            return std::bit_cast<float>(std::bit_cast<std::int32_t>(p) + k * (std::int32_t{1} << 23));
+        }
+
+        // Code of v under the transfer curve from the approximations above; off by at most one code
+        template <bool Srgb>
+        [[nodiscard]] std::int32_t estimate_(T v) const noexcept {
+            const float x = clamp_bits_(static_cast<float>(v));
+            float e;
+            if constexpr (Srgb) {
+                const float curve = 1.055f * exp2_(log2_(x) * (1.0f / 2.4f)) - 0.055f;
+                const std::int32_t m = -static_cast<std::int32_t>(x <= 0.0031308f);
+                e = std::bit_cast<float>((std::bit_cast<std::int32_t>(12.92f * x) & m) |
+                                         (std::bit_cast<std::int32_t>(curve) & ~m));
+            } else {
+                e = exp2_(log2_(x) * inv_gamma_);
+            }
+            const auto k = static_cast<std::int32_t>(e * 255.0f + 0.5f);
+            return k < 255 ? k : 255;
+        }
+
+        // Exact code of v from an estimate off by at most one: one step up or down by the neighbouring bounds
+        [[nodiscard]] unsigned char correct_(T v, std::int32_t k) const noexcept {
+            T c = v > T{0} ? v : T{0};
+            c = c < T{1} ? c : T{1};
+            k += bounds_[static_cast<std::size_t>(k) + 1] <= c ? 1 : 0;
+            k -= bounds_[static_cast<std::size_t>(k)] > c ? 1 : 0;
+            return static_cast<unsigned char>(k);
+        }
+
+        [[nodiscard]] unsigned char search_(T v) const noexcept {
+            // Number of code boundaries <= v, i.e. the last k with bounds_[k] <= v
+            std::size_t k = 0;
+            for (std::size_t step = 128; step > 0; step >>= 1) k += bounds_[k + step] <= v ? step : 0;
+            return static_cast<unsigned char>(k);
+        }
+
+        [[nodiscard]] static double srgb_to_linear_(double e) noexcept {
+            return e <= 0.04045 ? e / 12.92 : std::pow((e + 0.055) / 1.055, 2.4);
+        }
+
+        bool linear_;
+        bool unmapped_;
+        Tonemap tonemap_;
+        T exposure_;
+        bool srgb_;
+        bool approximate_; // estimate_() is accurate enough for the curve
+        float inv_gamma_;
+        std::array<T, 257> bounds_{};
+    };
+
+    namespace ppm_detail {
+        [[nodiscard]] inline std::string header(std::size_t width, std::size_t height) {
+            return "P6\n" + std::to_string(width) + ' ' + std::to_string(height) + "\n255\n";
+        }
+
+        // Channels of a 3-channel image as one contiguous array
+        template <Arithmetic T>
+        [[nodiscard]] std::span<const T> channels(const Color<T,3>* pixels, std::size_t count) noexcept {
+            static_assert(sizeof(Color<T,3>) == 3 * sizeof(T));
+            return {pixels->data(), 3 * count};
+        }
+
+        // Skips whitespace and '#' comments in a header
+        inline void skip_blanks(std::string_view text, std::size_t& pos) noexcept {
+            while (pos < text.size()) {
+                const char c = text[pos];
+                if (c == '#') {
+                    while (pos < text.size() && text[pos] != '\n') ++pos;
+                } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f') {
+                    ++pos;
+                } else {
+                    return;
+                }
+            }
+        }
+
+        [[nodiscard]] inline std::optional<long> read_number(std::string_view text, std::size_t& pos) noexcept {
+            skip_blanks(text, pos);
+            long v = 0;
+            const auto [ptr, ec] = std::from_chars(text.data() + pos, text.data() + text.size(), v);
+            if (ec != std::errc{}) return std::nullopt;
+            pos = static_cast<std::size_t>(ptr - text.data());
+            return v;
+        }
+    }
+
     /**
      * @brief Saves a 3-channel image to a binary PPM (P6) file.
      * @tparam T arithmetic scalar per-channel type
      * @param img image with 3 channels (RGB)
      * @param path filesystem path to write to
+     * @param encoding transfer curve for floating-point channels (default: linear)
      * @return true on success, false on failure
-     * @details For floating-point T, channels are clamped to [0,1] and scaled to 8-bit. For integral T, channels
-     * are clamped to [0,255] and truncated to 8-bit. This function delegates to Image::write_ppm.
+     * @details Channels are converted with U8Encoder in blocks of rows and each block is written at once.
      */
     export template <Arithmetic T>
-    [[nodiscard]] inline bool save_ppm(const Image<T,3>& img, const std::string& path) {
+    [[nodiscard]] inline bool save_ppm(const Image<T,3>& img, const std::string& path, const U8Encoding& encoding = {}) {
         std::ofstream f(path, std::ios::binary);
         if (!f.good()) return false;
-        f << "P6\n" << img.width() << ' ' << img.height() << "\n255\n";
-        using size_type = typename Image<T,3>::size_type;
-        std::vector<unsigned char> row(3 * img.width());
-        for (size_type y = 0; y < img.height(); ++y) {
-            for (size_type x = 0; x < img.width(); ++x) {
-                const auto& c = img(x, y);
-                auto to_u8 = [](T v) -> unsigned char {
-                    if constexpr (std::is_floating_point_v<T>) {
-                        T vv = v;
-                        if (vv < T{0}) vv = T{0};
-                        if (vv > T{1}) vv = T{1};
-                        return static_cast<unsigned char>(std::lround(static_cast<long double>(vv) * 255.0L));
-                    } else {
-                        long long vv = static_cast<long long>(v);
-                        if (vv < 0) vv = 0;
-                        if (vv > 255) vv = 255;
-                        return static_cast<unsigned char>(vv);
-                    }
-                };
-                row[3*x + 0] = to_u8(c[0]);
-                row[3*x + 1] = to_u8(c[1]);
-                row[3*x + 2] = to_u8(c[2]);
-            }
-            f.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+        f << ppm_detail::header(img.width(), img.height());
+        const U8Encoder<T> encoder{encoding};
+        const std::size_t w = img.width();
+        const std::size_t rows_per_block = std::max<std::size_t>(1, (std::size_t{1} << 18) / std::max<std::size_t>(3 * w, 1));
+        std::vector<unsigned char> block;
+        for (std::size_t y = 0; y < img.height(); y += rows_per_block) {
+            const std::size_t rows = std::min(rows_per_block, img.height() - y);
+            block.resize(3 * w * rows);
+            encoder.encode(ppm_detail::channels(img.data() + y * w, w * rows), block);
+            f.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size()));
             if (!f.good()) return false;
         }
         return true;
     }
 
+    /**
+     * @brief Saves a 3-channel compact image to a binary PPM (P6) file.
+     * @details Rows are converted to T in blocks and encoded as in save_ppm() for Image.
+     */
+    export template <Arithmetic T, PixelFormat F>
+    [[nodiscard]] inline bool save_ppm(const CompactImage<T,3,F>& img, const std::string& path,
+                                       const U8Encoding& encoding = {}) {
+        std::ofstream f(path, std::ios::binary);
+        if (!f.good()) return false;
+        f << ppm_detail::header(img.width(), img.height());
+        const U8Encoder<T> encoder{encoding};
+        const std::size_t w = img.width();
+        std::vector<Color<T,3>> row(w);
+        std::vector<unsigned char> bytes(3 * w);
+        for (std::size_t y = 0; y < img.height(); ++y) {
+            img.read_row(0, y, row);
+            encoder.encode(ppm_detail::channels(row.data(), w), bytes);
+            f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!f.good()) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Saves an image on a background thread.
+     * @param img image to write; pass it with std::move to hand over its storage instead of copying it
+     * @return future that becomes ready with the result of save_ppm()
+     * @details Lets the caller render the next frame while the previous one is encoded and written.
+     */
+    export template <Arithmetic T>
+    [[nodiscard]] std::future<bool> save_ppm_async(Image<T,3> img, std::string path, U8Encoding encoding = {}) {
+        return std::async(std::launch::async, [img = std::move(img), path = std::move(path), encoding] {
+            return save_ppm(img, path, encoding);
+        });
+    }
+
     /**
      * @brief Loads a binary PPM (P6) file into a 3-channel image.
      * @tparam T arithmetic scalar per-channel type
@@ -69,76 +389,96 @@ namespace glimmer {
      * @return std::optional<Image<T,3>> containing the loaded image on success; std::nullopt on failure
      * @details Supports P6 with maxval 255. Header comments starting with '#' are skipped per the PPM spec.
      * For floating-point T, values are returned in [0,1]; for integral T, values are returned as 0..255.
+     * The file is memory-mapped and the payload converted straight into the image storage through a 256-entry
+     * lookup table.
      */
     export template <Arithmetic T>
     [[nodiscard]] std::optional<Image<T,3>> load_ppm(const std::string& path) {
-        std::ifstream f(path, std::ios::binary);
-        if (!f) return std::nullopt;
-
-        auto skip_ws_and_comments = [&f]() {
-            int c;
-            while ((c = f.peek()) != EOF) {
-                if (std::isspace(c)) { f.get(); continue; }
-                if (c == '#') {
-                    // Skip comment line
-                    f.get();
-                    while ((c = f.get()) != '\n' && c != EOF) {}
-                    continue;
-                }
-                break;
-            }
-        };
-
-        auto read_token = [&]() -> std::optional<std::string> {
-            skip_ws_and_comments();
-            std::string tok;
-            int c;
-            while ((c = f.peek()) != EOF && !std::isspace(c)) {
-                tok.push_back(static_cast<char>(f.get()));
-            }
-            if (tok.empty()) return std::nullopt;
-            return tok;
-        };
-
-        // Magic
-        auto magic = read_token();
-        if (!magic || *magic != "P6") return std::nullopt;
-        // Width, height, maxval
-        auto wtok = read_token();
-        auto htok = read_token();
-        auto mtok = read_token();
-        if (!wtok || !htok || !mtok) return std::nullopt;
-        long w = std::strtol(wtok->c_str(), nullptr, 10);
-        long h = std::strtol(htok->c_str(), nullptr, 10);
-        long maxv = std::strtol(mtok->c_str(), nullptr, 10);
-        if (w <= 0 || h <= 0 || maxv <= 0) return std::nullopt;
-        if (maxv != 255) return std::nullopt; // only 8-bit supported
-        // Consume single whitespace after header before binary data
-        f.get();
-        if (!f) return std::nullopt;
-        const std::size_t width = static_cast<std::size_t>(w);
-        const std::size_t height = static_cast<std::size_t>(h);
-        std::vector<unsigned char> buf(width * height * 3);
-        f.read(reinterpret_cast<char*>(buf.data()), static_cast<std::streamsize>(buf.size()));
-        if (static_cast<std::size_t>(f.gcount()) != buf.size()) return std::nullopt;
+        const auto file = MappedFile::open(path);
+        if (!file) return std::nullopt;
+        const std::string_view text = file->view();
+        if (text.size() < 2 || text.substr(0, 2) != "P6") return std::nullopt;
+        std::size_t pos = 2;
+        if (pos < text.size() && text[pos] != '#' && !std::isspace(static_cast<unsigned char>(text[pos]))) {
+            return std::nullopt;
+        }
+        const auto w = ppm_detail::read_number(text, pos);
+        const auto h = ppm_detail::read_number(text, pos);
+        const auto maxv = ppm_detail::read_number(text, pos);
+        if (!w || !h || !maxv || *w <= 0 || *h <= 0 || *maxv <= 0) return std::nullopt;
+        if (*maxv != 255) return std::nullopt; // only 8-bit supported
+        // A single whitespace character separates the header from the binary data
+        if (pos >= text.size()) return std::nullopt;
+        ++pos;
+        const std::size_t width = static_cast<std::size_t>(*w);
+        const std::size_t height = static_cast<std::size_t>(*h);
+        // Compare by division so that oversized headers cannot wrap the byte count
+        if (width > (text.size() - pos) / 3 / height) return std::nullopt;
+        const std::size_t count = 3 * width * height;
+        const auto* src = reinterpret_cast<const unsigned char*>(text.data() + pos);
 
         Image<T,3> img{width, height};
-        auto to_T = [](unsigned char v) -> T {
-            if constexpr (std::is_floating_point_v<T>) {
-                return static_cast<T>(v) / static_cast<T>(255);
-            } else {
-                return static_cast<T>(v);
-            }
-        };
-        std::size_t idx = 0;
-        for (std::size_t y=0; y<height; ++y) {
-            for (std::size_t x=0; x<width; ++x) {
-                auto& p = img(x,y);
-                p[0] = to_T(buf[idx++]);
-                p[1] = to_T(buf[idx++]);
-                p[2] = to_T(buf[idx++]);
+        static_assert(sizeof(Color<T,3>) == 3 * sizeof(T));
+        T* dst = img.data()->data();
+        if constexpr (std::is_same_v<T, unsigned char>) {
+            std::memcpy(dst, src, count);
+        } else {
+            std::array<T, 256> lut{};
+            for (std::size_t v = 0; v < 256; ++v) {
+                if constexpr (std::is_floating_point_v<T>) lut[v] = static_cast<T>(v) / static_cast<T>(255);
+                else lut[v] = static_cast<T>(v);
             }
+            for (std::size_t i = 0; i < count; ++i) dst[i] = lut[src[i]];
         }
         return img;
     }
+
+    /**
+     * @brief Image sink that streams a render into a binary PPM (P6) file.
+     * @tparam T arithmetic scalar per-channel type
+     * @details Tiles are converted to 8 bits with U8Encoder as they arrive and rows are written as soon as
+     * they and all rows above them are complete, on a background I/O thread by default. Only the 8-bit rows of
+     * tile bands still in progress are held in memory, so no full-resolution framebuffer is needed.
+     */
+    export template <Arithmetic T>
+    class PpmStreamSink final : public ImageSink<T> {
+    public:
+        using Color3 = Color<T,3>;
+
+        /**
+         * @param path destination file
+         * @param async write on a background thread rather than on the render threads
+         * @param encoding transfer curve for floating-point channels (as in save_ppm())
+         */
+        explicit PpmStreamSink(std::string path, bool async = true, const U8Encoding& encoding = {})
+            : path_{std::move(path)}, async_{async}, encoder_{encoding} {}
+
+        void begin(std::size_t width, std::size_t height) override {
+            opened_ = writer_.open(path_, ppm_detail::header(width, height), height, 3 * width, async_);
+        }
+
+        void write_tile(const Tile& tile, std::span<const Color3> pixels) override {
+            if (!opened_) return;
+            for (std::size_t y = tile.y0; y < tile.y1; ++y) {
+                const auto row = writer_.row(y).subspan(3 * tile.x0, 3 * tile.width());
+                encoder_.encode(ppm_detail::channels(pixels.data() + (y - tile.y0) * tile.width(), tile.width()), row);
+                writer_.commit(y, row.size());
+            }
+        }
+
+        void end() override { ok_ = opened_ && writer_.close(); }
+
+        /** @brief True once the file has been written completely (after end()). */
+        [[nodiscard]] bool good() const noexcept { return ok_; }
+        /** @brief Allows tuning the I/O queue limit (see StreamingRowWriter). */
+        [[nodiscard]] StreamingRowWriter& writer() noexcept { return writer_; }
+
+    private:
+        std::string path_;
+        bool async_;
+        U8Encoder<T> encoder_;
+        bool opened_{false};
+        bool ok_{false};
+        StreamingRowWriter writer_{};
+    };
 }
@@ -0,0 +1,473 @@
+module;
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+export module glimmer.primitive_list;
+
+import glimmer.vector;
+import glimmer.ray;
+import glimmer.aabb;
+import glimmer.ray_packet;
+import glimmer.bvh;
+import glimmer.arena;
+import glimmer.geometry;
+import glimmer.material_table;
+import glimmer.render_stats;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing flat world-space sphere and plane lists with batched intersection.
+     */
+
+    /**
+     * @brief World-space spheres and planes stored as structure-of-arrays, intersected without virtual calls.
+     * @tparam T arithmetic scalar type (float/double recommended)
+     * @details Meant for large numbers of simple primitives (e.g. particle caches), which as SceneObjects would
+     * each pay for a shared Geometry, two affine maps and a virtual intersect() per candidate. Here a sphere is
+     * four scalars and a MaterialId.
+     *
+     * Spheres are indexed by a bottom-level BVH once build_bvh() has been called; the sphere arrays are then
+     * reordered into the BVH's leaf order, so every leaf is tested by one branch-free loop over contiguous
+     * arrays (written, like the ray_packet kernels, so the compiler can map it onto SIMD lanes). Before the
+     * build, or after spheres are added, all spheres are tested by the same loop. Planes are unbounded and are
+     * always tested by a loop over their arrays.
+     *
+     * Queries report a primitive index: sphere i is i, plane j is sphere_count() + j. Indices are stable across
+     * BVH builds. Query results are a distance and an index only; hit() computes the normal and UV of the
+     * winning primitive afterwards.
+     */
+    export template <Arithmetic T>
+    class PrimitiveList {
+    public:
+        using Vec3 = Vector<T,3>;
+
+        /** @brief Index returned by queries that hit nothing. */
+        static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+        /** @brief Maximum number of spheres per BVH leaf. */
+        static constexpr std::size_t leaf_size = 8;
+
+        /** @brief Adds a sphere (invalidates the BVH) and returns its index. */
+        std::uint32_t add_sphere(const Vec3& center, T radius, MaterialId material) {
+            const auto i = static_cast<std::uint32_t>(slot_of_.size());
+            cx_.push_back(center[0]);
+            cy_.push_back(center[1]);
+            cz_.push_back(center[2]);
+            r_.push_back(radius);
+            sphere_material_.push_back(material);
+            order_.push_back(i);
+            slot_of_.push_back(i);
+            bvh_.clear();
+            return i;
+        }
+
+        /**
+         * @brief Adds a two-sided plane through point with the given normal and returns its index.
+         * @details UVs are measured from point along the same tangent basis as Plane.
+         */
+        std::uint32_t add_plane(const Vec3& point, const Vec3& normal, MaterialId material) {
+            const T len = normal.norm();
+            const Vec3 n = len != T{0} ? normal / len : Vec3{T{0}, T{0}, T{1}};
+            nx_.push_back(n[0]);
+            ny_.push_back(n[1]);
+            nz_.push_back(n[2]);
+            d_.push_back(dot(n, point));
+            planes_.push_back(PlaneFrame{point, n, tangent_(n)});
+            plane_material_.push_back(material);
+            return static_cast<std::uint32_t>(sphere_count() + planes_.size() - 1);
+        }
+
+        /** @brief Number of spheres. */
+        [[nodiscard]] std::size_t sphere_count() const noexcept { return slot_of_.size(); }
+        /** @brief Number of planes. */
+        [[nodiscard]] std::size_t plane_count() const noexcept { return planes_.size(); }
+        /** @brief Number of primitives (spheres and planes). */
+        [[nodiscard]] std::size_t size() const noexcept { return sphere_count() + plane_count(); }
+        /** @brief True if the list holds neither spheres nor planes. */
+        [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+        /** @brief Removes all primitives. */
+        void clear() noexcept {
+            cx_.clear(); cy_.clear(); cz_.clear(); r_.clear();
+            sphere_material_.clear();
+            order_.clear();
+            slot_of_.clear();
+            nx_.clear(); ny_.clear(); nz_.clear(); d_.clear();
+            planes_.clear();
+            plane_material_.clear();
+            bvh_.clear();
+            dirty_.clear();
+            dirty_flags_.clear();
+        }
+
+        /** @brief Center of sphere i. */
+        [[nodiscard]] Vec3 sphere_center(std::size_t i) const noexcept {
+            const std::uint32_t s = slot_of_[i];
+            return Vec3{cx_[s], cy_[s], cz_[s]};
+        }
+        /** @brief Radius of sphere i. */
+        [[nodiscard]] T sphere_radius(std::size_t i) const noexcept { return r_[slot_of_[i]]; }
+        /** @brief World-space bounds of sphere i. */
+        [[nodiscard]] AABB<T> sphere_bounds(std::size_t i) const noexcept { return slot_bounds_(slot_of_[i]); }
+
+        /** @brief Moves and resizes sphere i; marks it for the next refit(). */
+        void set_sphere(std::size_t i, const Vec3& center, T radius) {
+            const std::uint32_t s = slot_of_[i];
+            cx_[s] = center[0];
+            cy_[s] = center[1];
+            cz_[s] = center[2];
+            r_[s] = radius;
+            if (!bvh_valid()) return;
+            if (i >= dirty_flags_.size()) dirty_flags_.resize(sphere_count(), 0);
+            if (dirty_flags_[i]) return;
+            dirty_flags_[i] = 1;
+            dirty_.push_back(static_cast<std::uint32_t>(i));
+        }
+        /** @brief Number of spheres moved since the last build or refit. */
+        [[nodiscard]] std::size_t dirty_count() const noexcept { return dirty_.size(); }
+
+        /** @brief Material of primitive index. */
+        [[nodiscard]] MaterialId material(std::uint32_t index) const noexcept {
+            return index < sphere_count() ? sphere_material_[slot_of_[index]] : plane_material_[index - sphere_count()];
+        }
+        /** @brief True if the material id of every primitive is below count (e.g. the size of a MaterialTable). */
+        [[nodiscard]] bool materials_below(std::size_t count) const noexcept {
+            const auto below = [count](MaterialId m) { return m < count; };
+            return std::all_of(sphere_material_.begin(), sphere_material_.end(), below) &&
+                   std::all_of(plane_material_.begin(), plane_material_.end(), below);
+        }
+
+        /**
+         * @brief World-space bounds of all primitives.
+         * @details Planes contribute the same large finite box as Plane::aabb().
+         */
+        [[nodiscard]] AABB<T> bounds() const noexcept {
+            AABB<T> box;
+            for (std::size_t s = 0; s < r_.size(); ++s) box.expand(slot_bounds_(s));
+            const T m = static_cast<T>(1e6);
+            for (const auto& p : planes_) box.expand(AABB<T>{p.point - Vec3{m, m, m}, p.point + Vec3{m, m, m}});
+            return box;
+        }
+
+        /** @brief Builds the sphere BVH and reorders the sphere arrays into its leaf order. */
+        void build_bvh() {
+            dirty_.clear();
+            dirty_flags_.clear();
+            if (r_.empty()) { bvh_.clear(); return; }
+            {
+                const ArenaScope scratch;
+                ArenaVector<AABB<T>> bounds(sphere_count());
+                for (std::size_t i = 0; i < sphere_count(); ++i) bounds[i] = sphere_bounds(i);
+                bvh_.build(bounds, leaf_size);
+            }
+            // Slot s of the BVH holds sphere prims[s]; move its data there
+            const auto prims = bvh_.primitive_indices();
+            std::vector<T> cx(prims.size()), cy(prims.size()), cz(prims.size()), r(prims.size());
+            std::vector<MaterialId> mat(prims.size());
+            for (std::size_t s = 0; s < prims.size(); ++s) {
+                const std::uint32_t from = slot_of_[prims[s]];
+                cx[s] = cx_[from]; cy[s] = cy_[from]; cz[s] = cz_[from]; r[s] = r_[from];
+                mat[s] = sphere_material_[from];
+            }
+            cx_ = std::move(cx); cy_ = std::move(cy); cz_ = std::move(cz); r_ = std::move(r);
+            sphere_material_ = std::move(mat);
+            order_.assign(prims.begin(), prims.end());
+            for (std::size_t s = 0; s < order_.size(); ++s) slot_of_[order_[s]] = static_cast<std::uint32_t>(s);
+            build_cost_ = bvh_.sah_cost();
+        }
+
+        /**
+         * @brief Refits the BVH to the spheres moved with set_sphere(), or builds it if it is missing.
+         * @param rebuild_threshold SAH cost ratio (current / at build) above which the BVH is rebuilt instead
+         * @return true if the BVH was built from scratch
+         */
+        bool refit(T rebuild_threshold = static_cast<T>(1.5)) {
+            if (!bvh_valid()) {
+                if (r_.empty()) return false;
+                build_bvh();
+                return true;
+            }
+            if (dirty_.empty()) return false;
+            bvh_.refit(dirty_, [&](std::uint32_t i) noexcept { return sphere_bounds(i); });
+            for (const auto i : dirty_) dirty_flags_[i] = 0;
+            dirty_.clear();
+            if (bvh_.sah_cost() > rebuild_threshold * build_cost_) {
+                build_bvh();
+                return true;
+            }
+            return false;
+        }
+
+        /** @brief True if the sphere BVH is built and covers every sphere. */
+        [[nodiscard]] bool bvh_valid() const noexcept { return !r_.empty() && bvh_.primitive_count() == r_.size(); }
+        /** @brief Sphere BVH (empty until build_bvh()). */
+        [[nodiscard]] const Bvh<T>& bvh() const noexcept { return bvh_; }
+
+        /**
+         * @brief Closest primitive along ray within [ray.tmin(), t_max].
+         * @param ray world-space ray (need not be normalized)
+         * @param t_max search bound; lowered to the hit distance on a hit
+         * @return index of the closest primitive, or npos
+         */
+        [[nodiscard]] std::uint32_t intersect(const Ray<T>& ray, T& t_max) const noexcept {
+            const RayData q = ray_data_(ray);
+            std::uint32_t best = npos;
+            if (!r_.empty()) {
+                std::uint32_t slot = npos;
+                if (bvh_valid()) {
+                    const Ray<T> clipped{ray.origin(), ray.direction(), ray.tmin(), t_max};
+                    T t_hit = t_max;
+                    bvh_.intersect_leaves(clipped, [&](std::uint32_t first, std::uint32_t count, T& t) noexcept {
+                        const std::uint32_t s = closest_sphere_(q, first, count, t);
+                        if (s == npos) return false;
+                        slot = s;
+                        t_hit = t;
+                        return true;
+                    });
+                    t_max = t_hit;
+                } else {
+                    record_stat(StatCounter::primitive_tests, r_.size());
+                    slot = closest_sphere_(q, 0, static_cast<std::uint32_t>(r_.size()), t_max);
+                }
+                if (slot != npos) best = order_[slot];
+            }
+            if (!planes_.empty()) {
+                record_stat(StatCounter::primitive_tests, planes_.size());
+                const std::uint32_t j = closest_plane_(q, t_max);
+                if (j != npos) best = static_cast<std::uint32_t>(sphere_count() + j);
+            }
+            return best;
+        }
+
+        /** @brief True if any primitive blocks ray within [tmin, tmax]. */
+        [[nodiscard]] bool occluded(const Ray<T>& ray) const noexcept {
+            const RayData q = ray_data_(ray);
+            if (!planes_.empty()) {
+                record_stat(StatCounter::primitive_tests, planes_.size());
+                T t = ray.tmax();
+                if (closest_plane_(q, t) != npos) return true;
+            }
+            if (r_.empty()) return false;
+            if (bvh_valid()) {
+                return bvh_.occluded_leaves(ray, [&](std::uint32_t first, std::uint32_t count) noexcept {
+                    return any_sphere_(q, first, count);
+                });
+            }
+            record_stat(StatCounter::primitive_tests, r_.size());
+            return any_sphere_(q, 0, static_cast<std::uint32_t>(r_.size()));
+        }
+
+        /**
+         * @brief Closest primitives for a packet of rays.
+         * @param packet ray packet; only active() lanes are traced
+         * @param t_max per-lane search bound; lowered for lanes that hit
+         * @param index receives the closest primitive per hit lane
+         * @return mask of lanes that hit a primitive closer than t_max
+         */
+        template <std::size_t N>
+        PacketMask intersect_packet(const RayPacket<T,N>& packet, std::array<T,N>& t_max,
+                                    std::array<std::uint32_t,N>& index) const noexcept {
+            PacketMask hit = 0;
+            if (!r_.empty()) {
+                auto test = [&](std::uint32_t prim, std::uint32_t slot, PacketMask lanes) noexcept {
+                    const PacketMask h = sphere_lanes_(slot, packet, t_max, lanes);
+                    for (PacketMask m = h; m != 0; m &= m - 1) index[static_cast<std::size_t>(std::countr_zero(m))] = prim;
+                    return h;
+                };
+                if (bvh_valid()) {
+                    hit = bvh_.intersect_packet(packet, t_max, test);
+                } else {
+                    for (std::uint32_t s = 0; s < r_.size(); ++s) hit |= test(order_[s], s, packet.active());
+                }
+            }
+            for (PacketMask m = planes_.empty() ? 0 : packet.active(); m != 0; m &= m - 1) {
+                const auto lane = static_cast<std::size_t>(std::countr_zero(m));
+                const std::uint32_t j = closest_plane_(ray_data_(packet.ray(lane)), t_max[lane]);
+                if (j == npos) continue;
+                index[lane] = static_cast<std::uint32_t>(sphere_count() + j);
+                hit |= PacketMask{1} << lane;
+            }
+            return hit;
+        }
+
+        /**
+         * @brief Hit record of primitive index at distance t along ray.
+         * @details Spheres report the unit outward normal and zero UVs, like Sphere; planes report their unit
+         * normal and UVs in the plane's tangent basis, like Plane.
+         */
+        [[nodiscard]] typename Geometry<T>::Hit hit(std::uint32_t index, const Ray<T>& ray, T t) const noexcept {
+            typename Geometry<T>::Hit h{};
+            h.t = t;
+            const Vec3 p = ray.at(t);
+            if (index < sphere_count()) {
+                const std::uint32_t s = slot_of_[index];
+                h.normal = r_[s] != T{0} ? (p - Vec3{cx_[s], cy_[s], cz_[s]}) / r_[s] : Vec3{T{0}, T{0}, T{1}};
+                return h;
+            }
+            const PlaneFrame& f = planes_[index - sphere_count()];
+            const Vec3 d = p - f.point;
+            h.normal = f.normal;
+            h.uv = Vector<T,2>{dot(d, f.u), dot(d, cross(f.normal, f.u))};
+            h.uv_scale = T{1};
+            return h;
+        }
+
+    private:
+        // Ray terms shared by every primitive test
+        struct RayData {
+            T ox, oy, oz, dx, dy, dz;
+            T a, inv_a;
+            T tmin, tmax;
+        };
+
+        struct PlaneFrame {
+            Vec3 point{};
+            Vec3 normal{};
+            Vec3 u{}; // unit tangent; the second axis is cross(normal, u)
+        };
+
+        // Chunk of spheres or planes tested per inner loop
+        static constexpr std::uint32_t lanes_ = 8;
+
+        [[nodiscard]] static RayData ray_data_(const Ray<T>& ray) noexcept {
+            const Vec3& o = ray.origin();
+            const Vec3& d = ray.direction();
+            const T a = dot(d, d);
+            return RayData{o[0], o[1], o[2], d[0], d[1], d[2], a, a != T{0} ? T{1} / a : T{0}, ray.tmin(), ray.tmax()};
+        }
+
+        // Same tangent as Plane::intersect
+        [[nodiscard]] static Vec3 tangent_(const Vec3& n) noexcept {
+            const Vec3 ref = std::abs(static_cast<double>(n[2])) > 0.999 ? Vec3{T{0}, T{1}, T{0}} : Vec3{T{0}, T{0}, T{1}};
+            const Vec3 u = cross(n, ref);
+            const T len = u.norm();
+            return len != T{0} ? u / len : Vec3{T{1}, T{0}, T{0}};
+        }
+
+        [[nodiscard]] AABB<T> slot_bounds_(std::size_t s) const noexcept {
+            const Vec3 c{cx_[s], cy_[s], cz_[s]};
+            const Vec3 e{r_[s], r_[s], r_[s]};
+            return AABB<T>{c - e, c + e};
+        }
+
+        // Nearest root of the ray-sphere quadratic in [tmin, t_max]; infinity on a miss. Branch-free so loops over
+        // it vectorize.
+        [[nodiscard]] static T sphere_root_(const RayData& q, T cx, T cy, T cz, T r, T t_max) noexcept {
+            const T ocx = q.ox - cx, ocy = q.oy - cy, ocz = q.oz - cz;
+            const T b = ocx * q.dx + ocy * q.dy + ocz * q.dz; // half of the linear coefficient
+            const T c = ocx * ocx + ocy * ocy + ocz * ocz - r * r;
+            const T disc = b * b - q.a * c;
+            const T sq = static_cast<T>(std::sqrt(disc > T{0} ? disc : T{0}));
+            const T t0 = (-b - sq) * q.inv_a;
+            const T t1 = (-b + sq) * q.inv_a;
+            const T t = t0 >= q.tmin ? t0 : t1;
+            const bool ok = disc >= T{0} && t >= q.tmin && t <= t_max;
+            return ok ? t : std::numeric_limits<T>::infinity();
+        }
+
+        // Closest sphere in slots [first, first + count) with a root below t_max; lowers t_max
+        [[nodiscard]] std::uint32_t closest_sphere_(const RayData& q, std::uint32_t first, std::uint32_t count,
+                                                    T& t_max) const noexcept {
+            std::uint32_t best = npos;
+            const std::uint32_t end = first + count;
+            for (std::uint32_t s0 = first; s0 < end; s0 += lanes_) {
+                const std::uint32_t n = std::min(lanes_, end - s0);
+                std::array<T, lanes_> t;
+                for (std::uint32_t k = 0; k < n; ++k) {
+                    t[k] = sphere_root_(q, cx_[s0 + k], cy_[s0 + k], cz_[s0 + k], r_[s0 + k], t_max);
+                }
+                for (std::uint32_t k = 0; k < n; ++k) {
+                    if (t[k] < t_max) { t_max = t[k]; best = s0 + k; }
+                }
+            }
+            return best;
+        }
+
+        // True if either root of a sphere in slots [first, first + count) lies in [tmin, tmax]
+        [[nodiscard]] bool any_sphere_(const RayData& q, std::uint32_t first, std::uint32_t count) const noexcept {
+            const std::uint32_t end = first + count;
+            for (std::uint32_t s0 = first; s0 < end; s0 += lanes_) {
+                const std::uint32_t n = std::min(lanes_, end - s0);
+                bool any = false;
+                for (std::uint32_t k = 0; k < n; ++k) {
+                    any |= sphere_root_(q, cx_[s0 + k], cy_[s0 + k], cz_[s0 + k], r_[s0 + k], q.tmax) <
+                           std::numeric_limits<T>::infinity();
+                }
+                if (any) return true;
+            }
+            return false;
+        }
+
+        // Closest plane with a hit below t_max (near-parallel rays miss, as in Plane); lowers t_max
+        [[nodiscard]] std::uint32_t closest_plane_(const RayData& q, T& t_max) const noexcept {
+            std::uint32_t best = npos;
+            const T eps = static_cast<T>(1e-8);
+            const auto count = static_cast<std::uint32_t>(planes_.size());
+            for (std::uint32_t j0 = 0; j0 < count; j0 += lanes_) {
+                const std::uint32_t n = std::min(lanes_, count - j0);
+                std::array<T, lanes_> t;
+                for (std::uint32_t k = 0; k < n; ++k) {
+                    const std::uint32_t j = j0 + k;
+                    const T denom = nx_[j] * q.dx + ny_[j] * q.dy + nz_[j] * q.dz;
+                    const bool parallel = denom > -eps && denom < eps;
+                    const T tj = (d_[j] - (nx_[j] * q.ox + ny_[j] * q.oy + nz_[j] * q.oz)) / (parallel ? T{1} : denom);
+                    t[k] = !parallel && tj >= q.tmin && tj <= t_max ? tj : std::numeric_limits<T>::infinity();
+                }
+                for (std::uint32_t k = 0; k < n; ++k) {
+                    if (t[k] < t_max) { t_max = t[k]; best = j0 + k; }
+                }
+            }
+            return best;
+        }
+
+        // Tests the sphere in slot s against the given lanes; lowers t_max for lanes that hit
+        template <std::size_t N>
+        PacketMask sphere_lanes_(std::uint32_t s, const RayPacket<T,N>& p, std::array<T,N>& t_max,
+                                 PacketMask lanes) const noexcept {
+            const T cx = cx_[s], cy = cy_[s], cz = cz_[s], r = r_[s];
+            std::array<T,N> t{};
+            for (std::size_t i = 0; i < N; ++i) {
+                const T a = p.dx[i] * p.dx[i] + p.dy[i] * p.dy[i] + p.dz[i] * p.dz[i];
+                const RayData q{p.ox[i], p.oy[i], p.oz[i], p.dx[i], p.dy[i], p.dz[i], a,
+                                a != T{0} ? T{1} / a : T{0}, p.tmin[i], t_max[i]};
+                t[i] = sphere_root_(q, cx, cy, cz, r, t_max[i]);
+            }
+            PacketMask hit = 0;
+            for (PacketMask m = lanes; m != 0; m &= m - 1) {
+                const auto i = static_cast<std::size_t>(std::countr_zero(m));
+                if (!(t[i] < t_max[i])) continue;
+                t_max[i] = t[i];
+                hit |= PacketMask{1} << i;
+            }
+            return hit;
+        }
+
+        // Sphere arrays in slot order (BVH leaf order once built)
+        std::vector<T> cx_{};
+        std::vector<T> cy_{};
+        std::vector<T> cz_{};
+        std::vector<T> r_{};
+        std::vector<MaterialId> sphere_material_{};
+        std::vector<std::uint32_t> order_{};   // slot -> sphere index
+        std::vector<std::uint32_t> slot_of_{}; // sphere index -> slot
+        Bvh<T> bvh_{};
+        T build_cost_{};
+        std::vector<std::uint32_t> dirty_{};
+        std::vector<std::uint8_t> dirty_flags_{};
+
+        // Planes: normal and offset (dot(n, p) = d) for the tests, frames for hit()
+        std::vector<T> nx_{};
+        std::vector<T> ny_{};
+        std::vector<T> nz_{};
+        std::vector<T> d_{};
+        std::vector<PlaneFrame> planes_{};
+        std::vector<MaterialId> plane_material_{};
+    };
+}
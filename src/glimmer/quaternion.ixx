@@ -66,13 +66,11 @@ namespace glimmer
         static constexpr Quaternion from_axis_angle(const Vector<T, 3>& axis, T angle) noexcept
         {
             T ax = axis[0], ay = axis[1], az = axis[2];
-            T len = static_cast<T>(std::sqrt(
-                static_cast<long double>(ax) * ax + static_cast<long double>(ay) * ay + static_cast<long double>(az) *
-                az));
+            T len = static_cast<T>(std::sqrt(ax * ax + ay * ay + az * az));
             if (len == T{}) return Quaternion{}; // identity for zero axis
             T half = angle * static_cast<T>(0.5);
-            T s = static_cast<T>(std::sin(static_cast<long double>(half)));
-            T c = static_cast<T>(std::cos(static_cast<long double>(half)));
+            T s = static_cast<T>(std::sin(half));
+            T c = static_cast<T>(std::cos(half));
             T nx = ax / len, ny = ay / len, nz = az / len;
             return Quaternion{c, nx * s, ny * s, nz * s};
         }
@@ -171,10 +169,8 @@ namespace glimmer
         /** @brief Euclidean norm (length). */
         [[nodiscard]] T norm() const noexcept
         {
-            long double s = static_cast<long double>(w_) * w_ + static_cast<long double>(x_) * x_ + static_cast<long
-                double>(y_) * y_ + static_cast<long double>(z_) * z_;
-            if constexpr (std::is_floating_point_v<T>) return static_cast<T>(std::sqrt(s));
-            else return static_cast<T>(std::llround(std::sqrt(s)));
+            if constexpr (std::is_floating_point_v<T>) return std::sqrt(norm_sq());
+            else return static_cast<T>(std::llround(std::sqrt(static_cast<double>(norm_sq()))));
         }
 
         /** @brief Returns a normalized quaternion; identity if zero-length. */
@@ -338,10 +334,10 @@ namespace glimmer
             };
             return r.normalized();
         }
-        auto omega = static_cast<T>(std::acos(static_cast<long double>(cos_omega)));
-        T sin_omega = static_cast<T>(std::sin(static_cast<long double>(omega)));
-        T s0 = static_cast<T>(std::sin(static_cast<long double>((one - t) * omega))) / sin_omega;
-        T s1 = static_cast<T>(std::sin(static_cast<long double>(t * omega))) / sin_omega;
+        auto omega = static_cast<T>(std::acos(cos_omega));
+        T sin_omega = static_cast<T>(std::sin(omega));
+        T s0 = static_cast<T>(std::sin((one - t) * omega)) / sin_omega;
+        T s1 = static_cast<T>(std::sin(t * omega)) / sin_omega;
         Quaternion<T> r{
             a.w() * s0 + b.w() * s1,
             a.x() * s0 + b.x() * s1,
@@ -0,0 +1,234 @@
+module;
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+export module glimmer.ray_packet;
+
+import glimmer.vector;
+import glimmer.ray;
+import glimmer.aabb;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing SoA ray packets and packet intersection kernels.
+     * @details The kernels are plain loops over fixed-size lane arrays without data-dependent branches, written so
+     * that the compiler can map them onto the target's SIMD width (SSE/AVX/NEON) without intrinsics. Lanes are
+     * selected with a bit mask (bit i = lane i).
+     */
+
+    /** @brief Lane mask type; bit i selects lane i (packets have at most 32 lanes). */
+    export using PacketMask = std::uint32_t;
+
+    /** @brief Default packet width used by the renderers for camera rays. */
+    export inline constexpr std::size_t default_packet_size = 8;
+
+    /**
+     * @brief Packet of up to N rays in structure-of-arrays layout.
+     * @tparam T arithmetic scalar type (float/double recommended)
+     * @tparam N number of lanes (1..32)
+     * @details Stores origins, directions, reciprocal directions and [tmin, tmax] per lane. Only the first size()
+     * lanes are valid; unused lanes are filled with degenerate rays and excluded by active().
+     */
+    export template <Arithmetic T, std::size_t N>
+    struct RayPacket {
+        static_assert(N > 0 && N <= 32, "RayPacket supports 1..32 lanes");
+        static constexpr std::size_t lanes = N;
+
+        alignas(64) std::array<T,N> ox{};
+        alignas(64) std::array<T,N> oy{};
+        alignas(64) std::array<T,N> oz{};
+        alignas(64) std::array<T,N> dx{};
+        alignas(64) std::array<T,N> dy{};
+        alignas(64) std::array<T,N> dz{};
+        alignas(64) std::array<T,N> inv_dx{};
+        alignas(64) std::array<T,N> inv_dy{};
+        alignas(64) std::array<T,N> inv_dz{};
+        alignas(64) std::array<T,N> tmin{};
+        alignas(64) std::array<T,N> tmax{};
+        std::size_t count{0};
+
+        /** @brief Builds a packet from up to N rays (extra rays are ignored). */
+        [[nodiscard]] static RayPacket from_rays(std::span<const Ray<T>> rays) noexcept {
+            RayPacket p;
+            const std::size_t n = std::min(rays.size(), N);
+            for (std::size_t i = 0; i < n; ++i) p.set(i, rays[i]);
+            p.count = n;
+            return p;
+        }
+
+        /** @brief Number of valid lanes. */
+        [[nodiscard]] constexpr std::size_t size() const noexcept { return count; }
+
+        /** @brief Mask of the valid lanes. */
+        [[nodiscard]] constexpr PacketMask active() const noexcept {
+            return count >= 32 ? ~PacketMask{0} : ((PacketMask{1} << count) - 1);
+        }
+
+        /** @brief Stores a ray into lane i (does not change size()). */
+        void set(std::size_t i, const Ray<T>& r) noexcept {
+            ox[i] = r.origin()[0]; oy[i] = r.origin()[1]; oz[i] = r.origin()[2];
+            dx[i] = r.direction()[0]; dy[i] = r.direction()[1]; dz[i] = r.direction()[2];
+            inv_dx[i] = reciprocal_(dx[i]); inv_dy[i] = reciprocal_(dy[i]); inv_dz[i] = reciprocal_(dz[i]);
+            tmin[i] = r.tmin(); tmax[i] = r.tmax();
+        }
+
+        /** @brief Recomputes the reciprocal directions of the first size() lanes after writing dx/dy/dz directly. */
+        void update_reciprocals() noexcept {
+            for (std::size_t i = 0; i < count; ++i) {
+                inv_dx[i] = reciprocal_(dx[i]); inv_dy[i] = reciprocal_(dy[i]); inv_dz[i] = reciprocal_(dz[i]);
+            }
+        }
+
+        /** @brief Reconstructs the ray of lane i. */
+        [[nodiscard]] Ray<T> ray(std::size_t i) const noexcept {
+            return Ray<T>{Vector<T,3>{ox[i], oy[i], oz[i]}, Vector<T,3>{dx[i], dy[i], dz[i]}, tmin[i], tmax[i]};
+        }
+
+    private:
+        static constexpr T reciprocal_(T d) noexcept {
+            if (d != T{0}) return T{1} / d;
+            if constexpr (std::is_floating_point_v<T>) return std::numeric_limits<T>::infinity();
+            else return std::numeric_limits<T>::max();
+        }
+    };
+
+    namespace packet_detail {
+        template <std::size_t N>
+        [[nodiscard]] constexpr PacketMask to_mask(const std::array<bool,N>& ok) noexcept {
+            PacketMask m = 0;
+            for (std::size_t i = 0; i < N; ++i) m |= static_cast<PacketMask>(ok[i]) << i;
+            return m;
+        }
+
+        [[nodiscard]] constexpr bool lane_on(PacketMask m, std::size_t i) noexcept { return (m >> i) & 1u; }
+    }
+
+    /**
+     * @brief Packet slab test against an AABB.
+     * @param box axis-aligned box
+     * @param p ray packet
+     * @param t_max per-lane upper bound (e.g. the closest hit found so far)
+     * @param t_entry receives the per-lane entry distance for lanes that hit
+     * @param active lanes to test
+     * @return mask of active lanes whose [tmin, t_max] interval overlaps the box
+     */
+    export template <Arithmetic T, std::size_t N>
+    [[nodiscard]] PacketMask intersect_aabb(const AABB<T>& box, const RayPacket<T,N>& p, const std::array<T,N>& t_max,
+                                            std::array<T,N>& t_entry, PacketMask active) noexcept {
+        const Vector<T,3> lo = box.min();
+        const Vector<T,3> hi = box.max();
+        std::array<bool,N> ok{};
+        for (std::size_t i = 0; i < N; ++i) {
+            T t0 = p.tmin[i];
+            T t1 = t_max[i];
+            const T ax = (lo[0] - p.ox[i]) * p.inv_dx[i], bx = (hi[0] - p.ox[i]) * p.inv_dx[i];
+            const T ay = (lo[1] - p.oy[i]) * p.inv_dy[i], by = (hi[1] - p.oy[i]) * p.inv_dy[i];
+            const T az = (lo[2] - p.oz[i]) * p.inv_dz[i], bz = (hi[2] - p.oz[i]) * p.inv_dz[i];
+            // Written as selects so NaNs (0 * inf on a slab plane) leave the interval unchanged.
+            const T nx = bx < ax ? bx : ax, fx = bx < ax ? ax : bx;
+            const T ny = by < ay ? by : ay, fy = by < ay ? ay : by;
+            const T nz = bz < az ? bz : az, fz = bz < az ? az : bz;
+            t0 = nx > t0 ? nx : t0; t0 = ny > t0 ? ny : t0; t0 = nz > t0 ? nz : t0;
+            t1 = fx < t1 ? fx : t1; t1 = fy < t1 ? fy : t1; t1 = fz < t1 ? fz : t1;
+            t_entry[i] = t0;
+            ok[i] = t0 <= t1;
+        }
+        return packet_detail::to_mask(ok) & active;
+    }
+
+    /**
+     * @brief Packet two-sided Möller–Trumbore ray-triangle test on a triangle given by vertex 0 and its edges.
+     * @param p0 triangle vertex 0
+     * @param e1 edge from vertex 0 to vertex 1
+     * @param e2 edge from vertex 0 to vertex 2
+     * @param p ray packet
+     * @param t_max per-lane upper bound; lanes that hit closer are updated to the hit distance
+     * @param u receives barycentric u for lanes that hit
+     * @param v receives barycentric v for lanes that hit
+     * @param active lanes to test
+     * @return mask of lanes with a hit in [tmin, t_max]
+     */
+    export template <Arithmetic T, std::size_t N>
+    PacketMask intersect_triangle_edges(const Vector<T,3>& p0, const Vector<T,3>& e1, const Vector<T,3>& e2,
+                                        const RayPacket<T,N>& p, std::array<T,N>& t_max, std::array<T,N>& u,
+                                        std::array<T,N>& v, PacketMask active) noexcept {
+        const T eps = static_cast<T>(1e-8);
+        std::array<bool,N> ok{};
+        for (std::size_t i = 0; i < N; ++i) {
+            const T px = p.dy[i] * e2[2] - p.dz[i] * e2[1];
+            const T py = p.dz[i] * e2[0] - p.dx[i] * e2[2];
+            const T pz = p.dx[i] * e2[1] - p.dy[i] * e2[0];
+            const T det = e1[0] * px + e1[1] * py + e1[2] * pz;
+            const bool det_ok = det > eps || det < -eps;
+            const T inv_det = T{1} / (det_ok ? det : T{1});
+            const T tx = p.ox[i] - p0[0], ty = p.oy[i] - p0[1], tz = p.oz[i] - p0[2];
+            const T uu = (tx * px + ty * py + tz * pz) * inv_det;
+            const T qx = ty * e1[2] - tz * e1[1];
+            const T qy = tz * e1[0] - tx * e1[2];
+            const T qz = tx * e1[1] - ty * e1[0];
+            const T vv = (p.dx[i] * qx + p.dy[i] * qy + p.dz[i] * qz) * inv_det;
+            const T t = (e2[0] * qx + e2[1] * qy + e2[2] * qz) * inv_det;
+            const bool hit = det_ok && uu >= T{0} && uu <= T{1} && vv >= T{0} && uu + vv <= T{1} &&
+                             t >= p.tmin[i] && t <= t_max[i] && packet_detail::lane_on(active, i);
+            t_max[i] = hit ? t : t_max[i];
+            u[i] = hit ? uu : u[i];
+            v[i] = hit ? vv : v[i];
+            ok[i] = hit;
+        }
+        return packet_detail::to_mask(ok);
+    }
+
+    /**
+     * @brief Packet two-sided Möller–Trumbore ray-triangle test.
+     * @param p0 triangle vertex 0
+     * @param p1 triangle vertex 1
+     * @param p2 triangle vertex 2
+     * @details See intersect_triangle_edges() for the remaining parameters and the result.
+     */
+    export template <Arithmetic T, std::size_t N>
+    PacketMask intersect_triangle(const Vector<T,3>& p0, const Vector<T,3>& p1, const Vector<T,3>& p2,
+                                  const RayPacket<T,N>& p, std::array<T,N>& t_max, std::array<T,N>& u,
+                                  std::array<T,N>& v, PacketMask active) noexcept {
+        return intersect_triangle_edges(p0, p1 - p0, p2 - p0, p, t_max, u, v, active);
+    }
+
+    /**
+     * @brief Packet ray-sphere test choosing the nearest root in [tmin, t_max].
+     * @param center sphere center
+     * @param radius sphere radius
+     * @param p ray packet
+     * @param t_max per-lane upper bound; lanes that hit closer are updated to the hit distance
+     * @param active lanes to test
+     * @return mask of lanes with a hit
+     */
+    export template <Arithmetic T, std::size_t N>
+    PacketMask intersect_sphere(const Vector<T,3>& center, T radius, const RayPacket<T,N>& p,
+                                std::array<T,N>& t_max, PacketMask active) noexcept {
+        std::array<bool,N> ok{};
+        for (std::size_t i = 0; i < N; ++i) {
+            const T ocx = p.ox[i] - center[0], ocy = p.oy[i] - center[1], ocz = p.oz[i] - center[2];
+            const T a = p.dx[i] * p.dx[i] + p.dy[i] * p.dy[i] + p.dz[i] * p.dz[i];
+            const T b = T{2} * (ocx * p.dx[i] + ocy * p.dy[i] + ocz * p.dz[i]);
+            const T c = ocx * ocx + ocy * ocy + ocz * ocz - radius * radius;
+            const T disc = b * b - T{4} * a * c;
+            const T s = static_cast<T>(std::sqrt(disc > T{0} ? disc : T{0}));
+            const T inv_2a = T{1} / (T{2} * (a != T{0} ? a : T{1}));
+            const T t0 = (-b - s) * inv_2a;
+            const T t1 = (-b + s) * inv_2a;
+            const bool in0 = t0 >= p.tmin[i] && t0 <= t_max[i];
+            const bool in1 = t1 >= p.tmin[i] && t1 <= t_max[i];
+            const bool hit = disc >= T{0} && a != T{0} && (in0 || in1) && packet_detail::lane_on(active, i);
+            const T t = in0 ? t0 : t1;
+            t_max[i] = hit ? t : t_max[i];
+            ok[i] = hit;
+        }
+        return packet_detail::to_mask(ok);
+    }
+}
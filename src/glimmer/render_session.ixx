@@ -0,0 +1,256 @@
+module;
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+export module glimmer.render_session;
+
+import glimmer.vector;
+import glimmer.color;
+import glimmer.image;
+import glimmer.camera;
+import glimmer.transform;
+import glimmer.affine;
+import glimmer.scene;
+import glimmer.renderer;
+import glimmer.render_stats;
+import glimmer.ppm;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing a multi-frame render session that keeps its buffers and scene acceleration
+     * between frames and overlaps the output of one frame with the rendering of the next.
+     */
+
+    /**
+     * @brief Changes applied to the scene before a frame is rendered.
+     * @tparam T arithmetic scalar type (float/double recommended)
+     */
+    export template <Arithmetic T>
+    struct FrameUpdate {
+        /** @brief New camera, if it moved. */
+        std::optional<Camera<T>> camera{};
+        /** @brief (object index, new object-to-world transform) pairs. */
+        std::vector<std::pair<std::size_t, Transform<T>>> objects{};
+        /** @brief (instance index, new instance-to-world map) pairs. */
+        std::vector<std::pair<std::size_t, Affine3<T>>> instances{};
+    };
+
+    /**
+     * @brief Renders a sequence of frames of one scene with one renderer.
+     * @tparam T arithmetic scalar type (float/double recommended)
+     * @details The session holds two framebuffers, which are sized once, and one output thread, which is
+     * started once. Each render_frame() applies the frame's camera and transform updates and brings the
+     * scene's BVHs up to date with Scene::update(), so moved objects are refitted instead of rebuilt. It
+     * renders into the free framebuffer and hands the frame to the output thread. Frame N is therefore encoded
+     * and written while frame N + 1 renders; a frame waits only if the output of the frame before it is still
+     * running when it finishes. Render threads, tile scratch and sampler settings are those of the renderer,
+     * whose thread pool and thread arenas already persist across frames.
+     *
+     * Scene and renderer are referenced, not owned, and must outlive the session. Outputs run in frame order
+     * on the output thread and get read-only access to the frame's buffer. An exception thrown by an output is
+     * rethrown by the next render_frame() or finish().
+     */
+    export template <Arithmetic T>
+    class RenderSession {
+    public:
+        /** @brief Frame output: receives the frame number (from 0) and the image; returns false on failure. */
+        using Output = std::function<bool(std::size_t frame, const Image<T,3>& image)>;
+
+        /**
+         * @brief Starts a session.
+         * @param scene scene to render; updated in place by render_frame()
+         * @param renderer renderer used for every frame
+         * @param width frame width in pixels
+         * @param height frame height in pixels
+         * @param output called with every finished frame on the output thread (optional)
+         */
+        RenderSession(Scene<T>& scene, const Renderer<T>& renderer, std::size_t width, std::size_t height,
+                      Output output = {})
+            : scene_{scene}, renderer_{renderer}, width_{width}, height_{height}, output_{std::move(output)}
+        {
+            for (auto& b : buffers_) b.resize(width_, height_);
+            if (output_) output_thread_ = std::thread{[this] { output_loop_(); }};
+        }
+
+        RenderSession(const RenderSession&) = delete;
+        RenderSession& operator=(const RenderSession&) = delete;
+
+        ~RenderSession() {
+            {
+                std::unique_lock lock{mutex_};
+                idle_.wait(lock, [&] { return !pending_; });
+                stop_ = true;
+            }
+            work_.notify_all();
+            if (output_thread_.joinable()) output_thread_.join();
+        }
+
+        /**
+         * @brief Applies update, renders the next frame and queues it for output.
+         * @return how the scene's acceleration structures were brought up to date
+         * @throws std::out_of_range if an update names an object or instance that does not exist
+         * @details Returns once the frame is rendered and handed over; its output may still be running.
+         */
+        SceneUpdate render_frame(const FrameUpdate<T>& update = {}) {
+            // Checked up front so a bad update leaves the scene unchanged
+            for (const auto& entry : update.objects) {
+                if (entry.first >= scene_.size()) throw std::out_of_range("RenderSession: object index out of range");
+            }
+            for (const auto& entry : update.instances) {
+                if (entry.first >= scene_.instance_count()) {
+                    throw std::out_of_range("RenderSession: instance index out of range");
+                }
+            }
+            if (update.camera) scene_.set_camera(*update.camera);
+            for (const auto& [i, xform] : update.objects) scene_.set_object_transform(i, xform);
+            for (const auto& [i, map] : update.instances) scene_.set_instance_transform(i, map);
+            const SceneUpdate result = scene_.update();
+
+            // The other buffer may still be in the output; this one was released when its output finished
+            Image<T,3>& target = buffers_[frames_ % buffers_.size()];
+            renderer_.render(scene_, target, width_, height_);
+            stats_ = renderer_.stats();
+            last_ = frames_;
+            if (output_) {
+                const auto start = std::chrono::steady_clock::now();
+                std::unique_lock lock{mutex_};
+                idle_.wait(lock, [&] { return !pending_; });
+                output_wait_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                rethrow_();
+                pending_ = true;
+                pending_frame_ = frames_;
+                lock.unlock();
+                work_.notify_one();
+            }
+            ++frames_;
+            return result;
+        }
+
+        /** @brief Renders one frame per update in order; returns the number of frames rendered. */
+        std::size_t render_frames(std::span<const FrameUpdate<T>> updates) {
+            for (const auto& u : updates) render_frame(u);
+            return updates.size();
+        }
+
+        /**
+         * @brief Waits until the output of every rendered frame has finished.
+         * @return true if every output so far succeeded
+         * @throws the exception of a failed output
+         */
+        [[nodiscard]] bool finish() {
+            std::unique_lock lock{mutex_};
+            idle_.wait(lock, [&] { return !pending_; });
+            rethrow_();
+            return good_;
+        }
+
+        /** @brief Number of frames rendered so far. */
+        [[nodiscard]] std::size_t frame_count() const noexcept { return frames_; }
+        /** @brief Frame width in pixels. */
+        [[nodiscard]] std::size_t width() const noexcept { return width_; }
+        /** @brief Frame height in pixels. */
+        [[nodiscard]] std::size_t height() const noexcept { return height_; }
+        /** @brief Scene the session renders. */
+        [[nodiscard]] const Scene<T>& scene() const noexcept { return scene_; }
+
+        /**
+         * @brief Most recently rendered frame (black before the first frame).
+         * @details Stays valid until the next render_frame() call; its output may still be reading it.
+         */
+        [[nodiscard]] const Image<T,3>& frame() const noexcept { return buffers_[last_ % buffers_.size()]; }
+        /** @brief Renderer statistics of the most recent frame. */
+        [[nodiscard]] const RenderStats& stats() const noexcept { return stats_; }
+        /** @brief Total time render_frame() waited for the previous frame's output, in seconds. */
+        [[nodiscard]] double output_wait_seconds() const noexcept { return output_wait_; }
+
+    private:
+        void output_loop_() {
+            std::unique_lock lock{mutex_};
+            while (true) {
+                work_.wait(lock, [&] { return pending_ || stop_; });
+                if (!pending_) return;
+                const std::size_t frame = pending_frame_;
+                lock.unlock();
+                // The renderer never writes this buffer while pending_ is set
+                bool ok = false;
+                std::exception_ptr error{};
+                try {
+                    ok = output_(frame, buffers_[frame % buffers_.size()]);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                lock.lock();
+                good_ = good_ && ok;
+                if (error && !error_) error_ = error;
+                pending_ = false;
+                idle_.notify_all();
+            }
+        }
+
+        // Called with mutex_ held; an output error is reported once
+        void rethrow_() {
+            if (!error_) return;
+            good_ = false;
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+
+        Scene<T>& scene_;
+        const Renderer<T>& renderer_;
+        std::size_t width_;
+        std::size_t height_;
+        Output output_;
+        std::array<Image<T,3>, 2> buffers_{};
+        std::size_t frames_{0};
+        std::size_t last_{0};
+        RenderStats stats_{};
+        double output_wait_{0};
+
+        std::thread output_thread_{};
+        std::mutex mutex_{};
+        std::condition_variable work_{};
+        std::condition_variable idle_{};
+        bool pending_{false};
+        std::size_t pending_frame_{0};
+        bool stop_{false};
+        bool good_{true};
+        std::exception_ptr error_{};
+    };
+
+    /**
+     * @brief Substitutes frame into the run of '#' characters of pattern, zero-padded to the run's length.
+     * @details "frame_####.ppm" becomes "frame_0007.ppm" for frame 7; longer numbers are not truncated. Patterns
+     * without '#' get the number appended.
+     */
+    export [[nodiscard]] inline std::string frame_path(const std::string& pattern, std::size_t frame) {
+        const std::string number = std::to_string(frame);
+        const auto first = pattern.find('#');
+        if (first == std::string::npos) return pattern + number;
+        auto last = pattern.find_first_not_of('#', first);
+        if (last == std::string::npos) last = pattern.size();
+        const std::size_t width = last - first;
+        std::string padded = number.size() < width ? std::string(width - number.size(), '0') + number : number;
+        return pattern.substr(0, first) + padded + pattern.substr(last);
+    }
+
+    /** @brief Session output that saves every frame as a PPM file named by frame_path(pattern, frame). */
+    export template <Arithmetic T>
+    [[nodiscard]] typename RenderSession<T>::Output ppm_sequence_output(std::string pattern,
+                                                                        U8Encoding encoding = {}) {
+        return [pattern = std::move(pattern), encoding](std::size_t frame, const Image<T,3>& image) {
+            return save_ppm(image, frame_path(pattern, frame), encoding);
+        };
+    }
+}
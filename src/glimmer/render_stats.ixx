@@ -0,0 +1,146 @@
+module;
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+export module glimmer.render_stats;
+
+import glimmer.tile;
+import glimmer.image;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing optional render instrumentation: per-thread counters, tile timings and a
+     * per-pixel cost heatmap.
+     */
+
+    /**
+     * @brief True if the instrumentation is compiled in (GLIMMER_RENDER_STATS defined).
+     * @details Without it StatTally and record_stat() are empty and Renderer::stats() only reports the image size
+     * and the wall-clock time of the last render, so release builds pay nothing in the traversal loops.
+     */
+#if defined(GLIMMER_RENDER_STATS)
+    export inline constexpr bool render_stats_enabled = true;
+#else
+    export inline constexpr bool render_stats_enabled = false;
+#endif
+
+    /** @brief Event counted by the instrumentation. */
+    export enum class StatCounter : std::uint8_t {
+        rays,            // closest-hit scene queries (each packet lane counts as one ray)
+        shadow_rays,     // any-hit scene queries
+        aabb_tests,      // ray/box slab tests in BVH traversal and object bounds
+        primitive_tests, // primitives handed to a BVH leaf callback
+        bounces,         // path vertices shaded by a path tracer
+        rr_terminations, // paths ended by Russian roulette
+        count_
+    };
+
+    /** @brief Number of StatCounter values. */
+    export inline constexpr std::size_t stat_counter_count = static_cast<std::size_t>(StatCounter::count_);
+
+    /** @brief One value per StatCounter. */
+    export struct RenderCounters {
+        std::array<std::uint64_t, stat_counter_count> values{};
+
+        [[nodiscard]] constexpr std::uint64_t& operator[](StatCounter c) noexcept {
+            return values[static_cast<std::size_t>(c)];
+        }
+        [[nodiscard]] constexpr std::uint64_t operator[](StatCounter c) const noexcept {
+            return values[static_cast<std::size_t>(c)];
+        }
+
+        constexpr RenderCounters& operator+=(const RenderCounters& o) noexcept {
+            for (std::size_t i = 0; i < stat_counter_count; ++i) values[i] += o.values[i];
+            return *this;
+        }
+        /** @brief Element-wise difference; used to turn two snapshots of a thread's counters into a delta. */
+        [[nodiscard]] friend constexpr RenderCounters operator-(RenderCounters a, const RenderCounters& b) noexcept {
+            for (std::size_t i = 0; i < stat_counter_count; ++i) a.values[i] -= b.values[i];
+            return a;
+        }
+        [[nodiscard]] friend constexpr bool operator==(const RenderCounters&, const RenderCounters&) noexcept = default;
+
+        /** @brief Traversal work: AABB tests plus primitive tests (the quantity shown by the heatmap). */
+        [[nodiscard]] constexpr std::uint64_t cost() const noexcept {
+            return (*this)[StatCounter::aabb_tests] + (*this)[StatCounter::primitive_tests];
+        }
+    };
+
+    /**
+     * @brief Counters of the calling thread; they only grow, so readers take snapshots and subtract.
+     * @details Each thread writes its own instance, so counting needs no atomics.
+     */
+    export [[nodiscard]] inline RenderCounters& thread_render_counters() noexcept {
+        static thread_local RenderCounters counters{};
+        return counters;
+    }
+
+    /** @brief Adds n to the calling thread's counter c; compiles to nothing unless render_stats_enabled. */
+    export inline void record_stat(StatCounter c, std::uint64_t n = 1) noexcept {
+        if constexpr (render_stats_enabled) thread_render_counters()[c] += n;
+    }
+
+    /**
+     * @brief Counts events in a local and adds them to the thread's counters once, on destruction.
+     * @details Meant for inner loops (BVH traversal), where touching the thread-local on every node would cost
+     * more than the work being counted. Empty, and optimized out, unless render_stats_enabled.
+     */
+    export class StatTally {
+    public:
+        explicit StatTally(StatCounter c) noexcept : counter_{c} {}
+        StatTally(const StatTally&) = delete;
+        StatTally& operator=(const StatTally&) = delete;
+        ~StatTally() { if constexpr (render_stats_enabled) if (n_ != 0) thread_render_counters()[counter_] += n_; }
+
+        void add(std::uint64_t n = 1) noexcept { if constexpr (render_stats_enabled) n_ += n; }
+
+    private:
+        StatCounter counter_;
+        std::uint64_t n_{0};
+    };
+
+    /** @brief Work done on one tile; seconds and counters add up over the passes of a progressive render. */
+    export struct TileStats {
+        Tile tile{};
+        double seconds{0};
+        RenderCounters counters{};
+    };
+
+    /**
+     * @brief Statistics of a renderer's last render() or render_progressive() call (see Renderer::stats()).
+     * @details counters, tiles and heatmap are only filled when render_stats_enabled; width, height and seconds
+     * are always set.
+     */
+    export struct RenderStats {
+        std::size_t width{0};
+        std::size_t height{0};
+        /** @brief Wall-clock time of the whole call. */
+        double seconds{0};
+        /** @brief Sum of all tiles' counters. */
+        RenderCounters counters{};
+        /** @brief One entry per tile in TileGrid order. */
+        std::vector<TileStats> tiles{};
+        /**
+         * @brief Per-pixel RenderCounters::cost(), if enabled with Renderer::set_stats_heatmap().
+         * @details Renderers that trace pixels one at a time measure each pixel; packet and wavefront renderers
+         * spread a tile's cost evenly over its pixels.
+         */
+        Image<float,1> heatmap{};
+
+        /** @brief Closest-hit and any-hit queries per second of wall-clock time. */
+        [[nodiscard]] double rays_per_second() const noexcept {
+            if (seconds <= 0) return 0;
+            return static_cast<double>(counters[StatCounter::rays] + counters[StatCounter::shadow_rays]) / seconds;
+        }
+
+        /** @brief Wall-clock time of the slowest tile (0 without tiles). */
+        [[nodiscard]] double max_tile_seconds() const noexcept {
+            double m = 0;
+            for (const auto& t : tiles) m = t.seconds > m ? t.seconds : m;
+            return m;
+        }
+    };
+}
@@ -1,5 +1,11 @@
 module;
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
 
 export module glimmer.renderer;
 
@@ -8,6 +14,12 @@ import glimmer.color;
 import glimmer.ray;
 import glimmer.scene;
 import glimmer.image;
+import glimmer.thread_pool;
+import glimmer.tile;
+import glimmer.sampler;
+import glimmer.image_sink;
+import glimmer.arena;
+import glimmer.render_stats;
 
 namespace glimmer {
     /**
@@ -18,7 +30,18 @@ namespace glimmer {
     /**
      * @brief Abstract renderer interface.
      * @tparam T arithmetic scalar type (float/double recommended)
-     * @details Defines the minimum API for rendering a Scene to an Image and tracing a ray.
+     * @details Defines the minimum API for rendering a Scene to an Image and tracing a ray. Implementations render
+     * the image in tiles of tile_size() pixels on thread_pool(), which defaults to the process-wide
+     * ThreadPool::shared() so repeated render() calls do not spawn threads.
+     *
+     * Implementations render into an ImageSink, which receives every finished tile; rendering into an Image is
+     * the special case of an ImageTarget sink. Streaming sinks such as PpmStreamSink write tiles as they are
+     * done, so only tile-sized buffers are needed. Tile buffers and other per-tile scratch come from the render
+     * thread's arena (thread_arena()), so repeated renders do not allocate on the heap once the arenas are warm.
+     *
+     * Every render() records a RenderStats, available from stats() until the next call; with GLIMMER_RENDER_STATS
+     * it includes per-tile timings and work counters. Because of this, one renderer must not run two renders
+     * at the same time.
      */
     export template <Arithmetic T>
     class Renderer {
@@ -30,7 +53,150 @@ namespace glimmer {
 
         /** @brief Evaluates radiance for a primary ray in the given scene. */
         [[nodiscard]] virtual Color3 trace_ray(const Scene<T>& scene, const Ray<T>& ray) const noexcept = 0;
+        /**
+         * @brief Renders the scene tile by tile into a sink.
+         * @details Calls sink.begin(width, height), sink.write_tile() for every tile (concurrently from the
+         * render threads) and sink.end().
+         */
+        virtual void render(const Scene<T>& scene, ImageSink<T>& sink, std::size_t width, std::size_t height) const = 0;
+
         /** @brief Renders the scene to the given RGB image (resizes if needed). */
-        virtual void render(const Scene<T>& scene, Image<T,3>& out, std::size_t width, std::size_t height) const = 0;
+        void render(const Scene<T>& scene, Image<T,3>& out, std::size_t width, std::size_t height) const {
+            ImageTarget<T> target{out};
+            render(scene, target, width, height);
+        }
+
+        /** @brief Uses a dedicated pool for rendering; nullptr restores the shared pool. */
+        void set_thread_pool(std::shared_ptr<ThreadPool> pool) noexcept { pool_ = std::move(pool); }
+        /** @brief Pool used for rendering (never null). */
+        [[nodiscard]] ThreadPool& thread_pool() const noexcept { return pool_ ? *pool_ : *ThreadPool::shared(); }
+
+        /** @brief Sets the tile edge length in pixels used to distribute work (0 is treated as 1). */
+        void set_tile_size(std::size_t size) noexcept { tile_size_ = size; }
+        /** @brief Tile edge length in pixels. */
+        [[nodiscard]] std::size_t tile_size() const noexcept { return tile_size_; }
+
+        /** @brief Selects the sample sequence used by Monte Carlo renderers. */
+        void set_sampler(SamplerKind kind) noexcept { sampler_ = kind; }
+        /** @brief Sample sequence used by Monte Carlo renderers (default: SamplerKind::independent). */
+        [[nodiscard]] SamplerKind sampler() const noexcept { return sampler_; }
+
+        /** @brief Statistics of the last render() (or render_progressive()) call. */
+        [[nodiscard]] const RenderStats& stats() const noexcept { return stats_; }
+        /** @brief Enables the per-pixel cost heatmap in stats() (off by default; needs render_stats_enabled). */
+        void set_stats_heatmap(bool enabled) noexcept { heatmap_ = enabled; }
+        /** @brief True if the cost heatmap is requested. */
+        [[nodiscard]] bool stats_heatmap() const noexcept { return heatmap_; }
+
+    protected:
+        /**
+         * @brief Drives sink over all tiles of a width x height image.
+         * @param fn callback `void(const Tile&, std::span<Color3> pixels)` filling the tile's pixels (row-major)
+         */
+        template <class Fn>
+        void render_tiles_(ImageSink<T>& sink, std::size_t width, std::size_t height, Fn&& fn) const {
+            begin_stats_(width, height);
+            sink.begin(width, height);
+            if (width > 0 && height > 0) {
+                for_each_tile_(width, height, [&](const Tile& tile) {
+                    // Released when the tile is done; fn may allocate further tile scratch in the same arena
+                    const ArenaScope scratch;
+                    ArenaVector<Color3> pixels(tile.width() * tile.height());
+                    fn(tile, std::span<Color3>{pixels});
+                    sink.write_tile(tile, pixels);
+                });
+            }
+            sink.end();
+            end_stats_();
+        }
+
+        /**
+         * @brief Runs fn(const Tile&) for every tile of a width x height image on the renderer's pool.
+         * @details With render_stats_enabled each tile's time and counters are added to its stats().tiles entry,
+         * so several calls between begin_stats_() and end_stats_() (progressive passes) accumulate.
+         */
+        template <class Fn>
+        void for_each_tile_(std::size_t width, std::size_t height, Fn&& fn) const {
+            const TileGrid grid{width, height, tile_size_};
+            if constexpr (render_stats_enabled) {
+                if (stats_.tiles.size() != grid.count()) reset_tile_stats_(grid);
+                thread_pool().parallel_for(grid.count(), [&](std::size_t i, std::size_t) {
+                    // Each tile runs on one thread, so the delta of that thread's counters is the tile's work
+                    const auto start = std::chrono::steady_clock::now();
+                    const RenderCounters before = thread_render_counters();
+                    fn(grid.tile(i));
+                    TileStats& ts = stats_.tiles[i];
+                    ts.counters += thread_render_counters() - before;
+                    ts.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                });
+            } else {
+                thread_pool().parallel_for(grid.count(), [&](std::size_t i, std::size_t) { fn(grid.tile(i)); });
+            }
+        }
+
+        /** @brief Starts the stats() of a width x height render: clears counters, tiles and heatmap. */
+        void begin_stats_(std::size_t width, std::size_t height) const {
+            stats_.width = width;
+            stats_.height = height;
+            stats_.seconds = 0;
+            stats_.counters = {};
+            if constexpr (render_stats_enabled) {
+                reset_tile_stats_(TileGrid{width, height, tile_size_});
+                if (heatmap_) stats_.heatmap.resize(width, height);
+                else stats_.heatmap = {};
+            }
+            stats_start_ = std::chrono::steady_clock::now();
+        }
+
+        /** @brief Finishes stats(): total time, counter sums and (unless pixels were measured) the tile heatmap. */
+        void end_stats_() const {
+            stats_.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - stats_start_).count();
+            if constexpr (render_stats_enabled) {
+                for (const TileStats& ts : stats_.tiles) stats_.counters += ts.counters;
+                if (stats_.heatmap.empty() || measures_pixel_cost_()) return;
+                for (const TileStats& ts : stats_.tiles) {
+                    const std::size_t pixels = ts.tile.width() * ts.tile.height();
+                    if (pixels == 0) continue;
+                    const auto avg = static_cast<float>(static_cast<double>(ts.counters.cost()) /
+                                                        static_cast<double>(pixels));
+                    for (std::size_t y = ts.tile.y0; y < ts.tile.y1; ++y) {
+                        for (std::size_t x = ts.tile.x0; x < ts.tile.x1; ++x) stats_.heatmap(x, y)[0] = avg;
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Runs fn() for pixel (x, y) and charges the traversal work it did to the heatmap.
+         * @details Renderers that call this for every pixel override measures_pixel_cost_() to return true.
+         */
+        template <class Fn>
+        void measure_pixel_(std::size_t x, std::size_t y, Fn&& fn) const {
+            if constexpr (render_stats_enabled) {
+                if (!stats_.heatmap.empty()) {
+                    const std::uint64_t before = thread_render_counters().cost();
+                    fn();
+                    stats_.heatmap(x, y)[0] += static_cast<float>(thread_render_counters().cost() - before);
+                    return;
+                }
+            }
+            fn();
+        }
+
+        /** @brief True if the renderer fills the heatmap through measure_pixel_(); else tiles are averaged. */
+        [[nodiscard]] virtual bool measures_pixel_cost_() const noexcept { return false; }
+
+    private:
+        void reset_tile_stats_(const TileGrid& grid) const {
+            stats_.tiles.resize(grid.count());
+            for (std::size_t i = 0; i < grid.count(); ++i) stats_.tiles[i] = TileStats{grid.tile(i), 0, {}};
+        }
+
+        std::shared_ptr<ThreadPool> pool_{};
+        std::size_t tile_size_{TileGrid::default_tile_size};
+        SamplerKind sampler_{SamplerKind::independent};
+        bool heatmap_{false};
+        mutable RenderStats stats_{};
+        mutable std::chrono::steady_clock::time_point stats_start_{};
     };
 }
@@ -2,12 +2,17 @@ module;
 #include <cstddef>
 #include <type_traits>
 #include <algorithm>
-#include <thread>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <utility>
 #include <vector>
-#include <random>
-#include <cmath>
-#include <numbers>
 #include <bit>
+#include <cmath>
 
 export module glimmer.renderer_path_tracer;
 
@@ -19,7 +24,17 @@ import glimmer.scene;
 import glimmer.scene_object;
 import glimmer.geometry;
 import glimmer.image;
+import glimmer.accumulation;
+import glimmer.aov;
+import glimmer.partial_frame;
 import glimmer.material;
+import glimmer.tile;
+import glimmer.ray_packet;
+import glimmer.bsdf;
+import glimmer.sampler;
+import glimmer.light;
+import glimmer.image_sink;
+import glimmer.render_stats;
 import glimmer.renderer; // base interface
 
 namespace glimmer
@@ -31,83 +46,40 @@ namespace glimmer
 
     namespace detail_pt
     {
-        template <Arithmetic T>
-        [[nodiscard]] inline Vector<T, 3> reflect(const Vector<T, 3>& v, const Vector<T, 3>& n) noexcept
-        {
-            return v - n * (T{2} * dot(v, n));
-        }
-
-        template <Arithmetic T>
-        [[nodiscard]] inline bool refract(const Vector<T, 3>& v, const Vector<T, 3>& n, T eta,
-                                          Vector<T, 3>& out) noexcept
-        {
-            // v: incident direction (unit), n: surface normal (unit), eta = n1/n2
-            const T cosi = std::clamp<T>(-dot(v, n), T{-1}, T{1});
-            const T sint2 = std::max<T>(T{0}, T{1} - cosi * cosi);
-            const T k = T{1} - eta * eta * (T{1} - cosi * cosi);
-            if (k < T{0}) return false;
-            out = v * eta + n * (eta * cosi - static_cast<T>(std::sqrt(static_cast<long double>(k))));
-            return true;
-        }
-
-        template <Arithmetic T>
-        [[nodiscard]] inline T schlick(T cos_theta, T eta_i, T eta_t) noexcept
-        {
-            T r0 = (eta_i - eta_t) / (eta_i + eta_t);
-            r0 = r0 * r0;
-            return r0 + (T{1} - r0) * std::pow(static_cast<double>(T{1} - cos_theta), 5.0);
-        }
-
-        template <Arithmetic T>
-        [[nodiscard]] inline Vector<T, 3> cosine_sample_hemisphere(T u1, T u2) noexcept
-        {
-            const T r = static_cast<T>(std::sqrt(static_cast<long double>(u1)));
-            const T theta = static_cast<T>(T{2} * std::numbers::pi_v<T> * u2);
-            const T x = r * static_cast<T>(std::cos(static_cast<long double>(theta)));
-            const T y = r * static_cast<T>(std::sin(static_cast<long double>(theta)));
-            const T z = static_cast<T>(std::sqrt(static_cast<long double>(std::max<T>(T{0}, T{1} - u1))));
-            return {x, y, z};
-        }
-
-        template <Arithmetic T>
-        [[nodiscard]] inline void build_ortho_basis(const Vector<T, 3>& n, Vector<T, 3>& t, Vector<T, 3>& b) noexcept
-        {
-            // n normalized expected
-            if (std::abs(static_cast<double>(n[2])) < 0.999)
-            {
-                t = cross(Vector<T, 3>{T{0}, T{0}, T{1}}, n).normalized();
-            }
-            else
-            {
-                t = cross(Vector<T, 3>{T{1}, T{0}, T{0}}, n).normalized();
-            }
-            b = cross(n, t);
-        }
-
-        template <Arithmetic T>
-        [[nodiscard]] inline Vector<T, 3> to_world(const Vector<T, 3>& local, const Vector<T, 3>& n) noexcept
-        {
-            Vector<T, 3> t, b;
-            build_ortho_basis(n, t, b);
-            return t * local[0] + b * local[1] + n * local[2];
-        }
-
         // Simple hash for deterministic seeding from pixel/ray
         [[nodiscard]] inline std::uint64_t mix_seed(std::uint64_t a, std::uint64_t b) noexcept
         {
             a ^= b + 0x9e3779b97f4a7c15ULL + (a << 6) + (a >> 2);
             return a;
         }
-
-        template <Arithmetic T>
-        [[nodiscard]] inline Vector<T, 3> hadamard(const Vector<T, 3>& a, const Vector<T, 3>& b) noexcept
-        {
-            return Vector<T, 3>{a[0] * b[0], a[1] * b[1], a[2] * b[2]};
-        }
     }
 
+    /**
+     * @brief Compile-time feature set of a RendererPathTracer kernel.
+     * @details Branches for disabled features are removed from the kernel: dielectric and specular lobes,
+     * emission with its MIS weights and next-event estimation (shading.emission), ray-cone tracking for filtered
+     * textures (shading.textured) and Russian roulette (roulette). The default enables everything.
+     */
+    export struct PathFeatures
+    {
+        ShadingFeatures shading{};
+        bool roulette{true};
+
+        friend constexpr bool operator==(const PathFeatures&, const PathFeatures&) = default;
+    };
+
     /**
      * @brief Path tracing renderer with configurable samples per pixel and depth.
+     * @details At every vertex with a diffuse lobe the integrator also samples a point on one of the scene's
+     * lights() and traces a shadow ray towards it (next-event estimation). Light sampling and BSDF sampling are
+     * combined with the power heuristic, so small or distant emitters converge with far fewer samples while
+     * large emitters seen through BSDF samples stay noise-free. Specular and dielectric lobes pick up emission
+     * by BSDF sampling only.
+     *
+     * Each render scans the scene's materials once (Scene::shading_features()) and traces with the kernel
+     * specialized for exactly the features the scene needs (see path_features()), e.g. one without refraction,
+     * emission or roulette branches for a scene of rough opaque surfaces under a sky rendered with a depth of
+     * 3. All kernels consume the same sample dimensions, so they render the same image as the general one.
      */
     export template <Arithmetic T>
     class RendererPathTracer : public Renderer<T>
@@ -133,209 +105,495 @@ namespace glimmer
                 h = detail_pt::mix_seed(h, std::bit_cast<std::uint64_t>(static_cast<double>(o[i])));
                 h = detail_pt::mix_seed(h, std::bit_cast<std::uint64_t>(static_cast<double>(d[i])));
             }
-            std::mt19937_64 rng{h};
-            return path_trace_(scene, ray, rng);
+            IndependentSampler<T> sampler{h};
+            sampler.start_pixel_sample(0, 0, 0);
+            return path_trace_<PathFeatures{}>(scene, ray, scene.intersect(ray), sampler, T{0});
+        }
+
+        using Renderer<T>::render;
+
+        void render(const Scene<T>& scene, ImageSink<T>& sink, std::size_t width, std::size_t height) const override
+        {
+            render_(scene, sink, nullptr, width, height);
+        }
+
+        /**
+         * @brief Renders the beauty image into a sink and the first-hit albedo, normal and depth into aovs.
+         * @details aovs is resized to width x height. The beauty image is identical to render()'s; the features
+         * add one material evaluation per sample at the first hit.
+         */
+        void render(const Scene<T>& scene, ImageSink<T>& sink, AovImages<T>& aovs, std::size_t width,
+                    std::size_t height) const
+        {
+            aovs.resize(width, height);
+            render_(scene, sink, &aovs, width, height);
         }
 
-        void render(const Scene<T>& scene, Image<T, 3>& out, std::size_t width, std::size_t height) const override
+        /** @brief Renders the beauty image and the AOVs into images (resized if needed). */
+        void render(const Scene<T>& scene, Image<T, 3>& out, AovImages<T>& aovs, std::size_t width,
+                    std::size_t height) const
         {
-            if (out.width() != width || out.height() != height)
+            ImageTarget<T> target{out};
+            render(scene, target, aovs, width, height);
+        }
+
+        /** @brief Settings for render_progressive(). */
+        struct ProgressiveOptions
+        {
+            /** @brief Samples added to each unconverged pixel per pass. */
+            std::size_t samples_per_pass{4};
+            /** @brief Samples a pixel needs before its noise estimate is trusted. */
+            std::size_t min_samples{16};
+            /** @brief Per-pixel sample cap; 0 uses samples_per_pixel(). */
+            std::size_t max_samples{0};
+            /** @brief Relative error (see AccumulationBuffer::relative_error) at which a pixel stops; 0 disables. */
+            T noise_threshold{static_cast<T>(0.01)};
+            /** @brief Wall-clock budget; rendering stops at the first tile boundary past it. 0 means unlimited. */
+            std::chrono::milliseconds time_budget{0};
+        };
+
+        /** @brief Summary returned by render_progressive(). */
+        struct ProgressiveStats
+        {
+            std::size_t passes{0};
+            std::uint64_t samples{0};
+            std::size_t active_tiles{0}; // tiles still unconverged when rendering stopped
+            bool converged{false};
+            bool out_of_time{false};
+            bool cancelled{false};
+        };
+
+        /** @brief Called after every pass with the buffer and the pass index; returning false stops rendering. */
+        using PassCallback = std::function<bool(const AccumulationBuffer<T>&, std::size_t)>;
+
+        /**
+         * @brief Renders progressively into an accumulation buffer until converged, out of time, or cancelled.
+         * @param scene scene to render
+         * @param acc accumulation buffer; resized and cleared
+         * @param width image width in pixels
+         * @param height image height in pixels
+         * @param options pass size, noise threshold and budgets
+         * @param on_pass optional callback invoked after every pass (e.g. to resolve and show a preview)
+         * @details Each pass adds options.samples_per_pass samples to every pixel that is not yet done. A pixel is
+         * done once it reaches max_samples, or has min_samples and a relative error below noise_threshold. Tiles
+         * whose pixels are all done are skipped in later passes, so flat regions stop early while noisy ones keep
+         * sampling. Each pixel continues its sample sequence from pass to pass (so low-discrepancy samplers keep
+         * their stratification); without a time budget the result does not depend on the number of threads.
+         */
+        ProgressiveStats render_progressive(const Scene<T>& scene, AccumulationBuffer<T>& acc, std::size_t width,
+                                            std::size_t height, const ProgressiveOptions& options = {},
+                                            const PassCallback& on_pass = {}) const
+        {
+            using clock = std::chrono::steady_clock;
+            acc.resize(width, height);
+            this->begin_stats_(width, height);
+            ProgressiveStats stats{};
+            if (width == 0 || height == 0) { stats.converged = true; this->end_stats_(); return stats; }
+            const CameraRayGenerator<T> rays{scene.camera(), width, height};
+            const PathFeatures features = path_features(scene);
+            const std::size_t max_samples = options.max_samples ? options.max_samples : spp_;
+            const std::size_t per_pass = std::max<std::size_t>(options.samples_per_pass, 1);
+            const bool has_budget = options.time_budget.count() > 0;
+            const auto deadline = clock::now() + options.time_budget;
+
+            auto pixel_done = [&](std::size_t x, std::size_t y) noexcept
             {
-                out.resize(width, height, Color<T, 3>{T{0}, T{0}, T{0}});
-            }
-            if (width == 0 || height == 0) return;
-            const auto& cam = scene.camera();
+                const std::size_t n = acc.samples(x, y);
+                if (n >= max_samples) return true;
+                return options.noise_threshold > T{0} && n >= options.min_samples &&
+                       acc.relative_error(x, y) <= options.noise_threshold;
+            };
 
-            const std::size_t hw = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4;
-            const std::size_t thread_count = std::min<std::size_t>(hw, height);
-            std::vector<std::thread> threads;
-            threads.reserve(thread_count);
+            const TileGrid grid{width, height, this->tile_size()};
+            std::vector<unsigned char> active(grid.count(), 1);
+            std::atomic<bool> out_of_time{false};
+            std::size_t active_tiles = grid.count();
 
-            auto worker = [&](std::size_t y_begin, std::size_t y_end, std::uint64_t thread_seed) noexcept
+            while (active_tiles > 0)
             {
-                std::mt19937_64 rng{thread_seed};
-                std::uniform_real_distribution<double> uni(0.0, 1.0);
-                for (std::size_t y = y_begin; y < y_end; ++y)
+                visit_sampler<T>(this->sampler(), seed_, [&](const auto& prototype)
                 {
-                    for (std::size_t x = 0; x < width; ++x)
+                    this->for_each_tile_(width, height, [&](const Tile& tile) noexcept
                     {
-                        Color3 sum{T{0}, T{0}, T{0}};
-                        for (std::size_t s = 0; s < spp_; ++s)
+                        if (!active[tile.index]) return;
+                        if (has_budget && clock::now() >= deadline)
                         {
-                            T jx = static_cast<T>(uni(rng));
-                            T jy = static_cast<T>(uni(rng));
-                            T fx = static_cast<T>(x) + jx;
-                            T fy = static_cast<T>(y) + jy;
-                            Ray<T> ray = cam.generate_ray(fx, fy, width, height);
-                            sum += path_trace_(scene, ray, rng);
+                            out_of_time.store(true, std::memory_order_relaxed);
+                            return;
                         }
-                        out(x, y) = sum / static_cast<T>(spp_);
-                    }
+                        auto sampler = prototype;
+                        bool tile_done = true;
+                        for (std::size_t y = tile.y0; y < tile.y1; ++y)
+                        {
+                            for (std::size_t x = tile.x0; x < tile.x1; ++x)
+                            {
+                                if (pixel_done(x, y)) continue;
+                                const std::size_t first = acc.samples(x, y);
+                                const std::size_t n = std::min(per_pass, max_samples - first);
+                                this->measure_pixel_(x, y, [&] {
+                                    sample_pixel_(scene, rays, features, x, y, first, n, sampler,
+                                                  [&](const Color3& c) { acc.add_sample(x, y, c); });
+                                });
+                                if (!pixel_done(x, y)) tile_done = false;
+                            }
+                        }
+                        if (tile_done) active[tile.index] = 0;
+                    });
+                });
+                ++stats.passes;
+                active_tiles = static_cast<std::size_t>(std::count(active.begin(), active.end(), 1));
+                if (on_pass && !on_pass(acc, stats.passes - 1)) { stats.cancelled = true; break; }
+                if (out_of_time.load(std::memory_order_relaxed) || (has_budget && clock::now() >= deadline))
+                {
+                    stats.out_of_time = active_tiles > 0;
+                    break;
                 }
-            };
+            }
+            stats.samples = acc.total_samples();
+            stats.active_tiles = active_tiles;
+            stats.converged = active_tiles == 0;
+            this->end_stats_();
+            return stats;
+        }
 
-            // Split rows into contiguous blocks per thread
-            const std::size_t rows_per_thread = height / thread_count;
-            const std::size_t remainder = height % thread_count;
-            std::size_t y0 = 0;
-            for (std::size_t t = 0; t < thread_count; ++t)
+        /**
+         * @brief Renders a run of tiles and sample indices of a frame into a mergeable partial frame.
+         * @param scene scene to render
+         * @param width frame width in pixels
+         * @param height frame height in pixels
+         * @param range tiles (TileGrid indices for tile_size()) and per-pixel sample indices to render; sample
+         * counts of FrameRange::all stand for samples_per_pixel()
+         * @details Samples are seeded from the renderer's seed, the pixel and the sample index, so renders on
+         * different machines with the same seed, sampler and tile size can each take a disjoint range, and
+         * FrameMerger combines their results into the image render() would give. Sample indices past
+         * samples_per_pixel() are valid and add further independent samples.
+         */
+        [[nodiscard]] PartialFrame<T> render_partial(const Scene<T>& scene, std::size_t width, std::size_t height,
+                                                     const FrameRange& range = {}) const
+        {
+            auto part = PartialFrame<T>::create(width, height, this->tile_size(), seed_, this->sampler(), range, spp_);
+            this->begin_stats_(width, height);
+            const FrameRange& r = part.range;
+            if (r.tile_count > 0 && r.sample_count > 0)
             {
-                const std::size_t count = rows_per_thread + (t < remainder ? 1 : 0);
-                const std::size_t y1 = y0 + count;
-                const std::uint64_t tseed = detail_pt::mix_seed(seed_, static_cast<std::uint64_t>((y0 << 32) ^ y1 ^ t));
-                threads.emplace_back(worker, y0, y1, tseed);
-                y0 = y1;
+                const CameraRayGenerator<T> rays{scene.camera(), width, height};
+                const PathFeatures features = path_features(scene);
+                visit_sampler<T>(this->sampler(), seed_, [&](const auto& prototype)
+                {
+                    this->for_each_tile_(width, height, [&](const Tile& tile) noexcept
+                    {
+                        if (!part.has_tile(tile.index)) return;
+                        auto sampler = prototype;
+                        for (std::size_t y = tile.y0; y < tile.y1; ++y)
+                        {
+                            for (std::size_t x = tile.x0; x < tile.x1; ++x)
+                            {
+                                this->measure_pixel_(x, y, [&] {
+                                    sample_pixel_(scene, rays, features, x, y, r.first_sample, r.sample_count,
+                                                  sampler, [&](const Color3& c) { part.add_sample(x, y, c); });
+                                });
+                            }
+                        }
+                    });
+                });
             }
-            for (auto& th : threads) th.join();
+            this->end_stats_();
+            return part;
+        }
+
+        /**
+         * @brief Features of the kernel used to render scene.
+         * @details The scene's shading features, plus Russian roulette if paths can be longer than the depth at
+         * which roulette starts. Everything is enabled while kernel specialization is off.
+         */
+        [[nodiscard]] PathFeatures path_features(const Scene<T>& scene) const noexcept
+        {
+            if (!specialize_) return PathFeatures{};
+            return PathFeatures{scene.shading_features(), max_depth_ > roulette_depth_};
         }
 
+        /** @brief Enables or disables scene-specialized kernels (on by default); off always uses the general one. */
+        void set_kernel_specialization(bool enabled) noexcept { specialize_ = enabled; }
+        /** @brief True if kernels are specialized to the scene. */
+        [[nodiscard]] bool kernel_specialization() const noexcept { return specialize_; }
+
+        /** @brief Fixed per-pixel sample count used by render(). */
+        [[nodiscard]] std::size_t samples_per_pixel() const noexcept { return spp_; }
+
+        /** @brief Enables or disables next-event estimation (on by default); off finds light by BSDF sampling only. */
+        void set_light_sampling(bool enabled) noexcept { light_sampling_ = enabled; }
+        /** @brief True if next-event estimation is enabled. */
+        [[nodiscard]] bool light_sampling() const noexcept { return light_sampling_; }
+
+    protected:
+        [[nodiscard]] bool measures_pixel_cost_() const noexcept override { return true; }
+
     private:
-        [[nodiscard]] Color3 path_trace_(const Scene<T>& scene, Ray<T> ray, std::mt19937_64& rng) const noexcept
+        // Sample dimension layout: pixel jitter (and the lens position for thin-lens cameras), then a fixed block per
+        // bounce (roulette, up to 3 for the BSDF, then light selection and the point on the light)
+        static constexpr std::uint32_t camera_dimensions_ = 2;
+        static constexpr std::uint32_t lens_dimensions_ = 2;
+        static constexpr std::uint32_t bsdf_dimensions_ = 3;
+        static constexpr std::uint32_t bounce_dimensions_ = 1 + bsdf_dimensions_ + 3;
+        // Depth from which Russian roulette may end a path
+        static constexpr std::size_t roulette_depth_ = 3;
+
+        // First-hit features of one sample (summed over a pixel's samples for AovImages)
+        struct AovSample
         {
-            using Vec3 = Vector<T, 3>;
-            std::uniform_real_distribution<double> uni(0.0, 1.0);
-            Color3 L{T{0}, T{0}, T{0}}; // accumulated radiance
-            Color3 beta{T{1}, T{1}, T{1}}; // throughput
+            Color3 albedo{T{0}, T{0}, T{0}};
+            Vector<T, 3> normal{T{0}, T{0}, T{0}};
+            T depth{0};
+        };
 
-            for (std::size_t depth = 0; depth < max_depth_; ++depth)
+        void render_(const Scene<T>& scene, ImageSink<T>& sink, AovImages<T>* aovs, std::size_t width,
+                     std::size_t height) const
+        {
+            const CameraRayGenerator<T> rays{scene.camera(), width, height};
+            const PathFeatures features = path_features(scene);
+
+            // Samples are indexed by pixel and sample number, so the image does not depend on which thread
+            // renders which tile or on the number of threads.
+            visit_sampler<T>(this->sampler(), seed_, [&](const auto& prototype)
             {
-                // Intersect scene
-                T best_t = ray.tmax();
-                Vec3 best_n{};
-                Vec3 best_p{};
-                Vector<T, 2> best_uv{};
-                const Material<T>* best_m = nullptr;
-                bool any_hit = false;
-                for (const auto& obj : scene.objects())
+                this->render_tiles_(sink, width, height, [&](const Tile& tile, std::span<Color3> pixels) noexcept
                 {
-                    if (auto box_hit = obj.aabb().intersect(ray); !box_hit.has_value()) continue;
-                    if (auto h = obj.intersect(ray))
+                    auto sampler = prototype;
+                    const T inv_spp = T{1} / static_cast<T>(spp_);
+                    for (std::size_t y = tile.y0; y < tile.y1; ++y)
                     {
-                        if (h->t >= ray.tmin() && h->t <= best_t)
+                        for (std::size_t x = tile.x0; x < tile.x1; ++x)
                         {
-                            any_hit = true;
-                            best_t = h->t;
-                            best_n = h->normal.normalized();
-                            best_p = ray.at(h->t);
-                            best_uv = h->uv;
-                            best_m = &obj.material();
+                            Color3 sum{T{0}, T{0}, T{0}};
+                            AovSample aov{};
+                            this->measure_pixel_(x, y, [&] {
+                                sample_pixel_(scene, rays, features, x, y, 0, spp_, sampler,
+                                              [&](const Color3& c) { sum += c; }, aovs ? &aov : nullptr);
+                            });
+                            pixels[(y - tile.y0) * tile.width() + (x - tile.x0)] = sum / static_cast<T>(spp_);
+                            if (aovs)
+                            {
+                                aovs->albedo(x, y) = aov.albedo * inv_spp;
+                                aovs->normal(x, y) = aov.normal * inv_spp;
+                                aovs->depth(x, y)[0] = aov.depth * inv_spp;
+                            }
                         }
                     }
-                }
+                });
+            });
+        }
 
-                if (!any_hit)
+        /**
+         * @brief Traces samples [first, first + count) of pixel (x,y), passing each radiance estimate to sink.
+         * @details Camera rays are generated and intersected in packets of default_packet_size; each path then
+         * continues from its primary hit on its own. If aov_sum is set, the first-hit features of every sample
+         * are added to it. Paths are traced by the kernel for features.
+         */
+        template <class Sampler, class Sink>
+        void sample_pixel_(const Scene<T>& scene, const CameraRayGenerator<T>& rays, const PathFeatures& features,
+                           std::size_t x, std::size_t y, std::size_t first, std::size_t count, Sampler& sampler,
+                           Sink&& sink, AovSample* aov_sum = nullptr) const noexcept
+        {
+            constexpr std::size_t N = default_packet_size;
+            const PathKernel<Sampler> kernel = kernel_<Sampler>(features);
+            const auto px = static_cast<std::uint32_t>(x);
+            const auto py = static_cast<std::uint32_t>(y);
+            const T spread = rays.pixel_spread();
+            const std::uint32_t camera_dims = camera_dimensions_ + (rays.has_lens() ? lens_dimensions_ : 0);
+            RayPacket<T, N> packet;
+            std::array<Vector<T, 2>, N> film;
+            std::array<Vector<T, 2>, N> lens;
+            std::array<std::optional<typename Scene<T>::Hit>, N> hits;
+            for (std::size_t s0 = 0; s0 < count; s0 += N)
+            {
+                const std::size_t n = std::min(N, count - s0);
+                for (std::size_t i = 0; i < n; ++i)
                 {
-                    L += detail_pt::hadamard<T>(beta, scene.background());
-                    break;
+                    sampler.start_pixel_sample(px, py, first + s0 + i);
+                    const Vector<T, 2> jitter = sampler.next_2d();
+                    film[i][0] = static_cast<T>(x) + jitter[0];
+                    film[i][1] = static_cast<T>(y) + jitter[1];
+                    if (rays.has_lens()) lens[i] = sampler.next_2d();
                 }
-
-                // Emission
-                if (best_m)
+                rays.rays(packet, std::span<const Vector<T, 2>>{film.data(), n},
+                          std::span<const Vector<T, 2>>{lens.data(), n});
+                scene.intersect_packet(packet, hits);
+                for (std::size_t i = 0; i < n; ++i)
                 {
-                    Color3 emission = best_m->radiance(best_uv) * best_m->emission(best_uv);
-                    L += detail_pt::hadamard<T>(beta, emission);
+                    sampler.start_pixel_sample(px, py, first + s0 + i);
+                    const Ray<T> ray = packet.ray(i);
+                    if (aov_sum && hits[i]) add_aov_(scene, ray, *hits[i], spread, *aov_sum);
+                    sink((this->*kernel)(scene, ray, hits[i], sampler, spread, camera_dims));
                 }
+            }
+        }
 
-                // Prepare material terms
-                const Color3 albedo = (best_m ? best_m->albedo(best_uv) : Color3::zeros());
-                const T roughness = (best_m ? best_m->roughness(best_uv) : T{0});
-                const T transparency = (best_m ? best_m->transparency(best_uv) : T{0});
-                const T ior = (best_m ? best_m->refractive_index(best_uv) : T{1});
+        template <class Sampler>
+        using PathKernel = Color3 (RendererPathTracer::*)(const Scene<T>&, Ray<T>,
+                                                          std::optional<typename Scene<T>::Hit>, Sampler&, T,
+                                                          std::uint32_t) const noexcept;
 
-                // Russian roulette (after a few bounces)
-                if (depth >= 3)
-                {
-                    T max_c = std::max({beta[0], beta[1], beta[2]});
-                    max_c = std::clamp<T>(max_c, T{0}, T{1});
-                    T q = static_cast<T>(1) - max_c;
-                    if (static_cast<T>(uni(rng)) < q) break;
-                    beta = beta / (static_cast<T>(1) - q);
-                }
+        // One kernel per combination of the five PathFeatures flags, indexed by kernel_index_()
+        static constexpr std::size_t kernel_count_ = 32;
+
+        [[nodiscard]] static constexpr std::size_t kernel_index_(const PathFeatures& f) noexcept
+        {
+            return static_cast<std::size_t>(f.shading.dielectric) | static_cast<std::size_t>(f.shading.specular) << 1 |
+                   static_cast<std::size_t>(f.shading.emission) << 2 | static_cast<std::size_t>(f.shading.textured) << 3 |
+                   static_cast<std::size_t>(f.roulette) << 4;
+        }
+
+        [[nodiscard]] static constexpr PathFeatures kernel_features_(std::size_t i) noexcept
+        {
+            return PathFeatures{ShadingFeatures{(i & 1) != 0, (i & 2) != 0, (i & 4) != 0, (i & 8) != 0}, (i & 16) != 0};
+        }
 
-                // Compute next ray by sampling BSDF components
-                const Vec3 n = best_n;
-                Vec3 wo = -ray.direction(); // outgoing direction toward eye
+        template <class Sampler, std::size_t... I>
+        [[nodiscard]] static constexpr std::array<PathKernel<Sampler>, kernel_count_>
+        kernel_table_(std::index_sequence<I...>) noexcept
+        {
+            return {&RendererPathTracer::path_trace_<kernel_features_(I), Sampler>...};
+        }
 
-                // Handle transmission if any transparency
-                const bool entering = dot(ray.direction(), n) < T{0};
-                Vec3 nl = entering ? n : -n; // oriented normal
+        template <class Sampler>
+        [[nodiscard]] static PathKernel<Sampler> kernel_(const PathFeatures& features) noexcept
+        {
+            static constexpr auto table = kernel_table_<Sampler>(std::make_index_sequence<kernel_count_>{});
+            return table[kernel_index_(features)];
+        }
 
-                if (transparency > T{0})
+        // Adds the features of a camera ray's first hit; the normal is flipped to face the camera
+        void add_aov_(const Scene<T>& scene, const Ray<T>& ray, const typename Scene<T>::Hit& hit, T spread,
+                      AovSample& sum) const noexcept
+        {
+            const T dir_len = ray.direction().norm();
+            Vector<T, 3> n = hit.normal.normalized();
+            if (dot(n, ray.direction()) > T{0}) n = -n;
+            sum.albedo += scene.surface(hit, spread * hit.t).albedo;
+            sum.normal += n;
+            sum.depth += hit.t * dir_len;
+        }
+
+        // first_hit is the precomputed closest hit of ray (e.g. from a packet query). Texture footprints come
+        // from a ray cone of the pixel's spread angle along the total path length (surface curvature ignored).
+        // Bounce dimensions start after the camera_dims the camera ray used. Branches for features outside F are
+        // compiled out; every bounce still addresses its sample dimensions explicitly, so skipping the roulette
+        // or light sample does not shift the numbers the BSDF sees.
+        template <PathFeatures F, PixelSampler<T> Sampler>
+        [[nodiscard]] Color3 path_trace_(const Scene<T>& scene, Ray<T> ray,
+                                         std::optional<typename Scene<T>::Hit> first_hit, Sampler& sampler, T spread,
+                                         std::uint32_t camera_dims = camera_dimensions_) const noexcept
+        {
+            using Vec3 = Vector<T, 3>;
+            Color3 L{T{0}, T{0}, T{0}}; // accumulated radiance
+            Color3 beta{T{1}, T{1}, T{1}}; // throughput
+            [[maybe_unused]] T distance{0}; // path length to the current vertex
+            [[maybe_unused]] T bsdf_pdf{0}; // solid-angle density of the last BSDF sample when light sampling was also used there
+            const bool sample_lights = F.shading.emission && light_sampling_ && !scene.lights().empty();
+
+            for (std::size_t depth = 0; depth < max_depth_; ++depth)
+            {
+                // Intersect scene
+                const auto hit = depth == 0 ? first_hit : scene.intersect(ray);
+                if (!hit)
                 {
-                    // Dielectric: sample Fresnel reflect vs refract. Always include Fresnel reflections.
-                    // Compute indices and oriented normal
-                    T eta_i = entering ? T{1} : ior;
-                    T eta_t = entering ? ior : T{1};
-                    T eta = eta_i / eta_t;
-
-                    // Cosine of incident angle w.r.t. the oriented normal
-                    T cos_theta_i = std::clamp<T>(-dot(ray.direction(), nl), T{0}, T{1});
-                    // Schlick Fresnel reflectance
-                    T R = detail_pt::schlick<T>(cos_theta_i, eta_i, eta_t);
-
-                    // Try to compute refraction direction ahead of time to detect TIR
-                    Vec3 refr_dir;
-                    const bool can_refract = detail_pt::refract(ray.direction(), nl, eta, refr_dir);
-
-                    // If TIR, force reflection
-                    if (!can_refract)
-                    {
-                        Vec3 refl = detail_pt::reflect(ray.direction(), nl).normalized();
-                        ray = Ray<T>{best_p + refl * static_cast<T>(1e-4), refl, ray.tmin(), ray.tmax()};
-                        // Specular reflection branch. Throughput scaled by albedo; divide by prob 1 to keep unbiased.
-                        beta = detail_pt::hadamard<T>(beta, albedo);
-                        continue;
-                    }
+                    L += hadamard<T>(beta, scene.background());
+                    break;
+                }
+                record_stat(StatCounter::bounces);
+                const Vec3 n = hit->normal.normalized();
+                const Vec3 p = ray.at(hit->t);
+                T cone_width{0};
+                if constexpr (F.shading.textured)
+                {
+                    distance += hit->t;
+                    cone_width = spread * distance;
+                }
+                const SurfaceParams<T> surface = scene.surface(*hit, cone_width);
 
-                    // Sample reflection vs refraction according to R
-                    T xi = static_cast<T>(uni(rng));
-                    if (xi < R)
-                    {
-                        // Reflect
-                        Vec3 refl = detail_pt::reflect(ray.direction(), nl).normalized();
-                        ray = Ray<T>{best_p + refl * static_cast<T>(1e-4), refl, ray.tmin(), ray.tmax()};
-                        // Unbiased: divide by sampling prob R. For simple model, tint by albedo.
-                        beta = detail_pt::hadamard<T>(beta, albedo) / std::max<T>(R, static_cast<T>(1e-3));
-                        continue;
-                    }
-                    else
+                // Emission, weighted against the light sample taken at the previous vertex
+                if constexpr (F.shading.emission)
+                {
+                    T w_bsdf{1};
+                    if (bsdf_pdf > T{0})
                     {
-                        // Refract
-                        refr_dir = refr_dir.normalized();
-                        ray = Ray<T>{best_p + refr_dir * static_cast<T>(1e-4), refr_dir, ray.tmin(), ray.tmax()};
-                        // Unbiased: divide by sampling prob (1-R). Apply transparency as transmission factor.
-                        T prob = std::max<T>(T{1} - R, static_cast<T>(1e-3));
-                        beta = detail_pt::hadamard<T>(beta, albedo) * transparency / prob;
-                        continue;
+                        const T cos_l = std::abs(dot(n, ray.direction())) / ray.direction().norm();
+                        const T pdf_light = cos_l > T{0}
+                            ? scene.light_pdf(*hit) * hit->t * hit->t * dot(ray.direction(), ray.direction()) / cos_l
+                            : T{0};
+                        w_bsdf = power_heuristic(bsdf_pdf, pdf_light);
                     }
+                    L += hadamard<T>(beta, surface.emitted) * w_bsdf;
                 }
 
-                // Opaque surface: mix specular and diffuse by roughness
-                T prob_spec = std::clamp<T>(T{1} - roughness, T{0}, T{1});
-                if (static_cast<T>(uni(rng)) < prob_spec)
+                // Russian roulette (after a few bounces)
+                const auto dim = camera_dims + static_cast<std::uint32_t>(depth) * bounce_dimensions_;
+                if constexpr (F.roulette)
                 {
-                    // Specular (perfect) reflection
-                    Vec3 refl = detail_pt::reflect(-wo, n).normalized();
-                    ray = Ray<T>{best_p + refl * static_cast<T>(1e-4), refl, ray.tmin(), ray.tmax()};
-                    beta = detail_pt::hadamard<T>(beta, albedo) / std::max(prob_spec, static_cast<T>(1e-3));
+                    sampler.set_dimension(dim);
+                    const T u_rr = sampler.next_1d();
+                    if (depth >= roulette_depth_ && !russian_roulette(beta, u_rr))
+                    {
+                        record_stat(StatCounter::rr_terminations);
+                        break;
+                    }
                 }
                 else
                 {
-                    // Diffuse Lambert: cosine-weighted hemisphere sampling
-                    Vector<T, 3> local = detail_pt::cosine_sample_hemisphere<T>(
-                        static_cast<T>(uni(rng)), static_cast<T>(uni(rng)));
-                    Vec3 dir = detail_pt::to_world(local, n).normalized();
-                    ray = Ray<T>{best_p + dir * static_cast<T>(1e-4), dir, ray.tmin(), ray.tmax()};
-                    // BRDF = albedo/pi, pdf = cos(theta)/pi => weight = albedo
-                    beta = detail_pt::hadamard<T>(beta, albedo) / std::max<T>(T{1} - prob_spec, static_cast<T>(1e-3));
+                    sampler.set_dimension(dim + 1);
                 }
+
+                // Next-event estimation; its paths are one vertex longer, so skip it where the path must end
+                const bool nee = sample_lights && depth + 1 < max_depth_;
+                if (nee)
+                {
+                    sampler.set_dimension(dim + 1 + bsdf_dimensions_);
+                    const T u_pick = sampler.next_1d();
+                    const Vector<T, 2> u_light = sampler.next_2d();
+                    L += hadamard<T>(beta, sample_light_<F>(scene, surface, p, n, u_pick, u_light));
+                    sampler.set_dimension(dim + 1);
+                }
+
+                // Continue the path by sampling the BSDF
+                const BsdfSample<T> bs = scatter_surface<F.shading>(surface, ray, p, n, [&] { return sampler.next_1d(); });
+                ray = bs.ray;
+                beta = hadamard<T>(beta, bs.weight);
+                bsdf_pdf = nee ? bs.pdf : T{0};
             }
 
             return L;
         }
 
+        // Direct light from one point on a light towards the diffuse lobe at p, MIS-weighted against BSDF sampling
+        template <PathFeatures F>
+        [[nodiscard]] static Color3 sample_light_(const Scene<T>& scene, const SurfaceParams<T>& surface,
+                                                  const Vector<T, 3>& p, const Vector<T, 3>& n, T u_pick,
+                                                  const Vector<T, 2>& u) noexcept
+        {
+            using Vec3 = Vector<T, 3>;
+            const Color3 none{T{0}, T{0}, T{0}};
+            const auto ls = scene.sample_light(u_pick, u);
+            if (!ls) return none;
+            const Vec3 to = ls->p - p;
+            const T dist2 = dot(to, to);
+            const T offset = static_cast<T>(1e-4);
+            if (!(dist2 > T{16} * offset * offset)) return none;
+            const T dist = static_cast<T>(std::sqrt(dist2));
+            const Vec3 wi = to / dist;
+            const T cos_l = std::abs(dot(ls->normal, wi));
+            if (!(cos_l > T{0})) return none;
+            const BsdfEval<T> f = evaluate_surface<F.shading>(surface, n, wi);
+            if (!(f.pdf > T{0})) return none;
+            if (scene.occluded(Ray<T>{p + wi * offset, wi, T{0}, dist - T{2} * offset})) return none;
+            const T pdf_light = ls->pdf * dist2 / cos_l;
+            const T weight = power_heuristic(pdf_light, f.pdf) / pdf_light;
+            return hadamard<T>(f.f_cos, ls->emitted) * weight;
+        }
+
         std::size_t spp_;
         std::size_t max_depth_;
         std::uint64_t seed_;
+        bool light_sampling_{true};
+        bool specialize_{true};
     };
 }
@@ -2,8 +2,9 @@ module;
 #include <cstddef>
 #include <type_traits>
 #include <algorithm>
-#include <thread>
-#include <vector>
+#include <array>
+#include <optional>
+#include <span>
 
 export module glimmer.renderer_simple_rt;
 
@@ -16,6 +17,10 @@ import glimmer.scene_object;
 import glimmer.geometry;
 import glimmer.image;
 import glimmer.material;
+import glimmer.bsdf;
+import glimmer.tile;
+import glimmer.ray_packet;
+import glimmer.image_sink;
 import glimmer.renderer; // base interface
 
 namespace glimmer {
@@ -34,69 +39,43 @@ namespace glimmer {
         using Color3 = Color<T,3>;
 
         [[nodiscard]] Color3 trace_ray(const Scene<T>& scene, const Ray<T>& ray) const noexcept override {
-            // Iterate objects and track closest hit
-            T best_t = ray.tmax();
-            Vector<T,3> best_n{};
-            Vector<T, 2> best_uv{};
-            const Material<T>* best_m = nullptr;
-            bool any_hit = false;
-            for (const auto& obj : scene.objects()) {
-                // Early AABB reject in world space via cached aabb in SceneObject
-                if (auto box_hit = obj.aabb().intersect(ray); !box_hit.has_value()) {
-                    continue;
-                }
-                if (auto h = obj.intersect(ray)) {
-                    if (h->t >= ray.tmin() && h->t <= best_t) {
-                        any_hit = true;
-                        best_t = h->t;
-                        best_n = h->normal;
-                        best_uv = h->uv;
-                        best_m = &obj.material();
-                    }
-                }
-            }
-            if (!any_hit) return scene.background();
-            // Simple shading
-            const Vector<T,3> L = Vector<T,3>{ T{1}, T{1}, T{1} }.normalized();
-            const T ndotl = std::max<T>(T{0}, dot(best_n.normalized(), L));
-            const auto uv = best_uv;
-            Color3 emission = (best_m ? best_m->radiance(uv) * best_m->emission(uv) : Color3::zeros());
-            Color3 diffuse = (best_m ? best_m->albedo(uv) * ndotl : Color3::zeros());
-            return emission + diffuse;
+            // Closest hit via the scene's acceleration structure
+            return shade_(scene, scene.intersect(ray), T{0});
         }
 
-        void render(const Scene<T>& scene, Image<T,3>& out, std::size_t width, std::size_t height) const override {
-            if (out.width() != width || out.height() != height) {
-                out.resize(width, height, Color<T,3>{T{0},T{0},T{0}});
-            }
-            if (width == 0 || height == 0) return;
-            const auto& cam = scene.camera();
+        using Renderer<T>::render;
 
-            const std::size_t hw = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4;
-            const std::size_t thread_count = std::min<std::size_t>(hw, height);
-            std::vector<std::thread> threads;
-            threads.reserve(thread_count);
+        void render(const Scene<T>& scene, ImageSink<T>& sink, std::size_t width, std::size_t height) const override {
+            const CameraRayGenerator<T> rays{scene.camera(), width, height};
+            const T spread = rays.pixel_spread();
 
-            auto worker = [&](std::size_t y_begin, std::size_t y_end) noexcept {
-                for (std::size_t y = y_begin; y < y_end; ++y) {
-                    for (std::size_t x = 0; x < width; ++x) {
-                        Ray<T> ray = cam.generate_ray(static_cast<T>(x), static_cast<T>(y), width, height);
-                        out(x,y) = trace_ray(scene, ray);
+            // Tiles are handed out dynamically so expensive regions do not stall the other threads. Camera rays
+            // of a row segment are traced together as one packet.
+            constexpr std::size_t N = default_packet_size;
+            this->render_tiles_(sink, width, height, [&](const Tile& tile, std::span<Color3> pixels) noexcept {
+                RayPacket<T,N> packet;
+                std::array<std::optional<typename Scene<T>::Hit>, N> hits;
+                for (std::size_t y = tile.y0; y < tile.y1; ++y) {
+                    for (std::size_t x0 = tile.x0; x0 < tile.x1; x0 += N) {
+                        const std::size_t n = std::min(N, tile.x1 - x0);
+                        rays.row(packet, x0, y, n);
+                        scene.intersect_packet(packet, hits);
+                        Color3* row = pixels.data() + (y - tile.y0) * tile.width() + (x0 - tile.x0);
+                        for (std::size_t i = 0; i < n; ++i) row[i] = shade_(scene, hits[i], spread);
                     }
                 }
-            };
+            });
+        }
 
-            // Split rows into contiguous blocks per thread
-            const std::size_t rows_per_thread = height / thread_count;
-            const std::size_t remainder = height % thread_count;
-            std::size_t y0 = 0;
-            for (std::size_t t = 0; t < thread_count; ++t) {
-                const std::size_t count = rows_per_thread + (t < remainder ? 1 : 0);
-                const std::size_t y1 = y0 + count;
-                threads.emplace_back(worker, y0, y1);
-                y0 = y1;
-            }
-            for (auto& th : threads) th.join();
+    private:
+        // Simple shading: emission plus a Lambert term for a fixed directional light
+        [[nodiscard]] Color3 shade_(const Scene<T>& scene, const std::optional<typename Scene<T>::Hit>& hit,
+                                    T spread) const noexcept {
+            if (!hit) return scene.background();
+            const SurfaceParams<T> surface = scene.surface(*hit, spread * hit->t);
+            const Vector<T,3> L = Vector<T,3>{ T{1}, T{1}, T{1} }.normalized();
+            const T ndotl = std::max<T>(T{0}, dot(hit->normal.normalized(), L));
+            return surface.emitted + surface.albedo * ndotl;
         }
     };
 }
@@ -0,0 +1,297 @@
+module;
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+export module glimmer.renderer_wavefront;
+
+import glimmer.vector;
+import glimmer.color;
+import glimmer.ray;
+import glimmer.camera;
+import glimmer.scene;
+import glimmer.scene_object;
+import glimmer.image;
+import glimmer.material;
+import glimmer.tile;
+import glimmer.ray_packet;
+import glimmer.bsdf;
+import glimmer.sampler;
+import glimmer.image_sink;
+import glimmer.render_stats;
+import glimmer.arena;
+import glimmer.renderer; // base interface
+
+namespace glimmer
+{
+    /**
+     * @file
+     * @brief Wavefront (breadth-first) path tracer processing many paths per stage.
+     */
+
+    /**
+     * @brief Path tracer that advances a whole wave of paths one bounce at a time.
+     * @tparam T arithmetic scalar type (float/double recommended)
+     * @details Instead of following each path to the end, every tile generates a wave of paths (all pixels times
+     * samples_per_wave() samples) held in structure-of-arrays buffers, then repeats these stages for each bounce:
+     *  - intersect: live paths are traced in ray packets against the scene BVH;
+     *  - miss: paths that left the scene pick up the background and retire;
+     *  - shade: surviving hits are counting-sorted by material id, so material lookups and BSDF sampling run
+     *    in runs of the same material;
+     *  - compact: retired paths are removed from the live list.
+     *
+     * Surface scattering uses the same model as RendererPathTracer (glimmer.bsdf), so both renderers converge to
+     * the same image. Each path owns a copy of the sampler positioned at its (pixel, sample index), so the
+     * result does not depend on the number of threads or the tile size.
+     */
+    export template <Arithmetic T>
+    class RendererWavefront : public Renderer<T>
+    {
+    public:
+        using Color3 = Color<T, 3>;
+
+        explicit RendererWavefront(std::size_t samples_per_pixel = 1600, std::size_t max_depth = 4,
+                                   std::uint64_t seed = 1337ULL, std::size_t samples_per_wave = 4)
+            : spp_{samples_per_pixel}, max_depth_{max_depth}, seed_{seed},
+              samples_per_wave_{std::max<std::size_t>(samples_per_wave, 1)}
+        {
+        }
+
+        /** @brief Samples per pixel. */
+        [[nodiscard]] std::size_t samples_per_pixel() const noexcept { return spp_; }
+        /** @brief Samples per pixel generated together in one wave. */
+        [[nodiscard]] std::size_t samples_per_wave() const noexcept { return samples_per_wave_; }
+
+        [[nodiscard]] Color3 trace_ray(const Scene<T>& scene, const Ray<T>& ray) const noexcept override
+        {
+            const ArenaScope scratch;
+            Wave<IndependentSampler<T>> wave;
+            IndependentSampler<T> sampler{seed_ ^ 0x5851f42d4c957f2dULL};
+            sampler.start_pixel_sample(0, 0, 0);
+            sampler.set_dimension(camera_dimensions_);
+            wave.push(ray, 0, sampler);
+            run_wave_(scene, wave, T{0}, camera_dimensions_);
+            return Color3{wave.lr[0], wave.lg[0], wave.lb[0]};
+        }
+
+        using Renderer<T>::render;
+
+        void render(const Scene<T>& scene, ImageSink<T>& sink, std::size_t width, std::size_t height) const override
+        {
+            const CameraRayGenerator<T> rays{scene.camera(), width, height};
+
+            visit_sampler<T>(this->sampler(), seed_, [&](const auto& prototype)
+            {
+                this->render_tiles_(sink, width, height, [&](const Tile& tile, std::span<Color3> pixels) noexcept
+                {
+                    render_tile_(scene, rays, tile, prototype, pixels);
+                });
+            });
+        }
+
+    private:
+        using Hit = typename Scene<T>::Hit;
+
+        // Sample dimension layout: pixel jitter (and the lens position for thin-lens cameras), then a fixed block per
+        // bounce (roulette + up to 3 for the BSDF)
+        static constexpr std::uint32_t camera_dimensions_ = 2;
+        static constexpr std::uint32_t lens_dimensions_ = 2;
+        static constexpr std::uint32_t bounce_dimensions_ = 4;
+
+        /** @brief Renders all samples of one tile, wave by wave, into its row-major pixels. */
+        template <class Sampler>
+        void render_tile_(const Scene<T>& scene, const CameraRayGenerator<T>& rays, const Tile& tile,
+                          const Sampler& prototype, std::span<Color3> pixels) const noexcept
+        {
+            // Tile scratch in the render thread's arena (released by render_tiles_ after the tile)
+            ArenaVector<Color3> sum(pixels.size(), Color3{T{0}, T{0}, T{0}});
+            const std::uint32_t camera_dims = camera_dimensions_ + (rays.has_lens() ? lens_dimensions_ : 0);
+            Wave<Sampler> wave;
+            wave.reserve(pixels.size() * std::min(samples_per_wave_, spp_));
+            Sampler sampler = prototype;
+            for (std::size_t s0 = 0; s0 < spp_; s0 += samples_per_wave_)
+            {
+                // Generate: one path per (pixel, sample) of this wave
+                const std::size_t ns = std::min(samples_per_wave_, spp_ - s0);
+                wave.clear();
+                for (std::size_t y = tile.y0; y < tile.y1; ++y)
+                {
+                    for (std::size_t x = tile.x0; x < tile.x1; ++x)
+                    {
+                        const auto local = static_cast<std::uint32_t>((y - tile.y0) * tile.width() + (x - tile.x0));
+                        for (std::size_t s = s0; s < s0 + ns; ++s)
+                        {
+                            sampler.start_pixel_sample(static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(y), s);
+                            const Vector<T, 2> jitter = sampler.next_2d();
+                            const T fx = static_cast<T>(x) + jitter[0];
+                            const T fy = static_cast<T>(y) + jitter[1];
+                            wave.push(rays.has_lens() ? rays.ray(fx, fy, sampler.next_2d()) : rays.ray(fx, fy),
+                                      local, sampler);
+                        }
+                    }
+                }
+                run_wave_(scene, wave, rays.pixel_spread(), camera_dims);
+                // Accumulate in path order, which is fixed by the generation loop above
+                for (std::size_t i = 0; i < wave.size(); ++i)
+                {
+                    sum[wave.pixel[i]] += Color3{wave.lr[i], wave.lg[i], wave.lb[i]};
+                }
+            }
+            for (std::size_t i = 0; i < pixels.size(); ++i) pixels[i] = sum[i] / static_cast<T>(spp_);
+        }
+
+        /** @brief Structure-of-arrays path state for one wave. */
+        template <class Sampler>
+        struct Wave
+        {
+            ArenaVector<T> ox, oy, oz, dx, dy, dz, tmin, tmax; // current ray
+            ArenaVector<T> br, bg, bb; // throughput
+            ArenaVector<T> lr, lg, lb; // accumulated radiance
+            ArenaVector<T> distance; // path length so far (ray cone footprints)
+            ArenaVector<Sampler> sampler;
+            ArenaVector<std::uint32_t> pixel;
+            ArenaVector<std::optional<Hit>> hits;
+
+            [[nodiscard]] std::size_t size() const noexcept { return pixel.size(); }
+
+            void reserve(std::size_t n)
+            {
+                for (auto* v : {&ox, &oy, &oz, &dx, &dy, &dz, &tmin, &tmax, &br, &bg, &bb, &lr, &lg, &lb, &distance}) v->reserve(n);
+                sampler.reserve(n);
+                pixel.reserve(n);
+                hits.reserve(n);
+            }
+
+            void clear() noexcept
+            {
+                for (auto* v : {&ox, &oy, &oz, &dx, &dy, &dz, &tmin, &tmax, &br, &bg, &bb, &lr, &lg, &lb, &distance}) v->clear();
+                sampler.clear();
+                pixel.clear();
+                hits.clear();
+            }
+
+            void push(const Ray<T>& r, std::uint32_t pix, const Sampler& s)
+            {
+                ox.push_back(r.origin()[0]); oy.push_back(r.origin()[1]); oz.push_back(r.origin()[2]);
+                dx.push_back(r.direction()[0]); dy.push_back(r.direction()[1]); dz.push_back(r.direction()[2]);
+                tmin.push_back(r.tmin()); tmax.push_back(r.tmax());
+                br.push_back(T{1}); bg.push_back(T{1}); bb.push_back(T{1});
+                lr.push_back(T{0}); lg.push_back(T{0}); lb.push_back(T{0});
+                distance.push_back(T{0});
+                sampler.push_back(s);
+                pixel.push_back(pix);
+                hits.emplace_back();
+            }
+
+            [[nodiscard]] Ray<T> ray(std::size_t i) const noexcept
+            {
+                return Ray<T>{Vector<T, 3>{ox[i], oy[i], oz[i]}, Vector<T, 3>{dx[i], dy[i], dz[i]}, tmin[i], tmax[i]};
+            }
+
+            void set_ray(std::size_t i, const Ray<T>& r) noexcept
+            {
+                ox[i] = r.origin()[0]; oy[i] = r.origin()[1]; oz[i] = r.origin()[2];
+                dx[i] = r.direction()[0]; dy[i] = r.direction()[1]; dz[i] = r.direction()[2];
+                tmin[i] = r.tmin(); tmax[i] = r.tmax();
+            }
+
+            void add_radiance(std::size_t i, const Color3& c) noexcept
+            {
+                lr[i] += br[i] * c[0]; lg[i] += bg[i] * c[1]; lb[i] += bb[i] * c[2];
+            }
+        };
+
+        /** @brief Runs all bounce stages for every path of the wave; bounce dimensions start at camera_dims. */
+        template <class Sampler>
+        void run_wave_(const Scene<T>& scene, Wave<Sampler>& w, T spread, std::uint32_t camera_dims) const noexcept
+        {
+            constexpr std::size_t N = default_packet_size;
+            // Queues live in the thread's arena and are released after the wave; w itself must not grow here
+            const ArenaScope scratch;
+            ArenaVector<std::uint32_t> live(w.size());
+            for (std::size_t i = 0; i < live.size(); ++i) live[i] = static_cast<std::uint32_t>(i);
+            ArenaVector<std::uint32_t> sorted;
+            sorted.reserve(w.size());
+            ArenaVector<std::uint32_t> bucket_start;
+            // Shading buckets: one per material, plus one for hits without a table entry
+            const std::size_t buckets = scene.materials().size() + 1;
+            auto bucket = [&](const Hit& h) noexcept { return std::min<std::size_t>(h.material, buckets - 1); };
+            bucket_start.reserve(buckets + 1);
+            ArenaVector<std::uint32_t> next_live;
+            next_live.reserve(w.size());
+            const Color3 background = scene.background();
+
+            for (std::size_t depth = 0; depth < max_depth_ && !live.empty(); ++depth)
+            {
+                // Intersect: trace live paths in packets
+                RayPacket<T, N> packet;
+                std::array<std::optional<Hit>, N> packet_hits;
+                for (std::size_t k0 = 0; k0 < live.size(); k0 += N)
+                {
+                    const std::size_t n = std::min(N, live.size() - k0);
+                    for (std::size_t j = 0; j < n; ++j) packet.set(j, w.ray(live[k0 + j]));
+                    packet.count = n;
+                    scene.intersect_packet(packet, packet_hits);
+                    for (std::size_t j = 0; j < n; ++j) w.hits[live[k0 + j]] = packet_hits[j];
+                }
+
+                // Miss: add background and retire; count survivors per material for the shading sort
+                bucket_start.assign(buckets + 1, 0);
+                std::size_t survivors = 0;
+                for (const std::uint32_t i : live)
+                {
+                    if (!w.hits[i]) { w.add_radiance(i, background); continue; }
+                    ++bucket_start[bucket(*w.hits[i]) + 1];
+                    ++survivors;
+                }
+                for (std::size_t b = 1; b < bucket_start.size(); ++b) bucket_start[b] += bucket_start[b - 1];
+                sorted.resize(survivors);
+                for (const std::uint32_t i : live)
+                {
+                    if (w.hits[i]) sorted[bucket_start[bucket(*w.hits[i])]++] = i;
+                }
+
+                // Shade: runs of paths that hit the same material
+                record_stat(StatCounter::bounces, sorted.size());
+                next_live.clear();
+                for (const std::uint32_t i : sorted)
+                {
+                    const Hit& hit = *w.hits[i];
+                    const Ray<T> ray = w.ray(i);
+                    w.distance[i] += hit.t;
+                    const SurfaceParams<T> surface = scene.surface(hit, spread * w.distance[i]);
+                    w.add_radiance(i, surface.emitted);
+                    Color3 beta{w.br[i], w.bg[i], w.bb[i]};
+                    Sampler& sampler = w.sampler[i];
+                    sampler.set_dimension(camera_dims + static_cast<std::uint32_t>(depth) * bounce_dimensions_);
+                    const T u_rr = sampler.next_1d();
+                    if (depth >= 3 && !russian_roulette(beta, u_rr))
+                    {
+                        record_stat(StatCounter::rr_terminations);
+                        continue;
+                    }
+                    const BsdfSample<T> bs = scatter_surface(surface, ray, ray.at(hit.t), hit.normal.normalized(),
+                                                             [&] { return sampler.next_1d(); });
+                    beta = hadamard<T>(beta, bs.weight);
+                    w.br[i] = beta[0]; w.bg[i] = beta[1]; w.bb[i] = beta[2];
+                    w.set_ray(i, bs.ray);
+                    next_live.push_back(i);
+                }
+
+                // Compact: keep surviving paths in index order for coherent packets in the next bounce
+                std::sort(next_live.begin(), next_live.end());
+                live.swap(next_live);
+            }
+        }
+
+        std::size_t spp_;
+        std::size_t max_depth_;
+        std::uint64_t seed_;
+        std::size_t samples_per_wave_;
+    };
+}
@@ -0,0 +1,257 @@
+module;
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+export module glimmer.sampler;
+
+import glimmer.vector;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing small-state random number generators and per-pixel sample sequences.
+     */
+
+    namespace sampler_detail {
+        // SplitMix64 finalizer: a cheap, well-mixed 64-bit hash
+        [[nodiscard]] constexpr std::uint64_t mix64(std::uint64_t z) noexcept {
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        [[nodiscard]] constexpr std::uint64_t pixel_key(std::uint64_t seed, std::uint32_t x, std::uint32_t y) noexcept {
+            return mix64(seed ^ mix64((static_cast<std::uint64_t>(y) << 32) | x));
+        }
+
+        // Largest value below 1 representable in T
+        template <class T>
+        inline constexpr T one_minus_epsilon = T{1} - std::numeric_limits<T>::epsilon() / T{2};
+
+        // Uniform in [0,1) from a 64-bit word, using as many bits as T can hold
+        template <class T>
+        [[nodiscard]] constexpr T to_unit(std::uint64_t bits) noexcept {
+            if constexpr (sizeof(T) <= 4) {
+                return static_cast<T>(bits >> 40) * static_cast<T>(0x1.0p-24);
+            } else {
+                return static_cast<T>(static_cast<double>(bits >> 11) * 0x1.0p-53);
+            }
+        }
+
+        inline constexpr std::array<std::uint32_t, 32> primes{
+            2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+            59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131};
+
+        // Van der Corput radical inverse of index in the given base
+        [[nodiscard]] constexpr double radical_inverse(std::uint32_t base, std::uint64_t index) noexcept {
+            if (base == 2) {
+                std::uint64_t v = index;
+                v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
+                v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
+                v = ((v >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((v & 0x0f0f0f0f0f0f0f0fULL) << 4);
+                v = ((v >> 8) & 0x00ff00ff00ff00ffULL) | ((v & 0x00ff00ff00ff00ffULL) << 8);
+                v = ((v >> 16) & 0x0000ffff0000ffffULL) | ((v & 0x0000ffff0000ffffULL) << 16);
+                v = (v >> 32) | (v << 32);
+                return static_cast<double>(v >> 11) * 0x1.0p-53;
+            }
+            const double inv_base = 1.0 / static_cast<double>(base);
+            double inv = 1.0;
+            double result = 0.0;
+            while (index > 0) {
+                const std::uint64_t next = index / base;
+                inv *= inv_base;
+                result += static_cast<double>(index - next * base) * inv;
+                index = next;
+            }
+            return result;
+        }
+    }
+
+    /**
+     * @brief PCG32 random number generator (O'Neill's PCG-XSH-RR with 64-bit state).
+     * @details 16 bytes of state, independent streams selected by the sequence number, and O(log n) jump-ahead
+     * so a stream can be positioned at any dimension without drawing the numbers in between.
+     */
+    export class Pcg32 {
+    public:
+        /** @brief Creates the generator for the given seed and stream. */
+        constexpr explicit Pcg32(std::uint64_t seed = 0x853c49e6748fea9bULL,
+                                 std::uint64_t sequence = 0xda3e39cb94b95bdbULL) noexcept {
+            this->seed(seed, sequence);
+        }
+
+        /** @brief Restarts the generator at the beginning of a stream. */
+        constexpr void seed(std::uint64_t seed, std::uint64_t sequence = 1) noexcept {
+            state_ = 0;
+            inc_ = (sequence << 1) | 1u;
+            step_();
+            state_ += seed;
+            step_();
+        }
+
+        /** @brief Next 32 uniformly distributed bits. */
+        [[nodiscard]] constexpr std::uint32_t next_u32() noexcept {
+            const std::uint64_t old = state_;
+            step_();
+            const auto xorshifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+            const auto rot = static_cast<std::uint32_t>(old >> 59);
+            return (xorshifted >> rot) | (xorshifted << ((~rot + 1u) & 31u));
+        }
+
+        /** @brief Uniform number in [0,1). */
+        template <Arithmetic T = double>
+        [[nodiscard]] constexpr T uniform() noexcept {
+            if constexpr (sizeof(T) <= 4) {
+                return sampler_detail::to_unit<T>(static_cast<std::uint64_t>(next_u32()) << 32);
+            } else {
+                const std::uint64_t hi = next_u32();
+                return sampler_detail::to_unit<T>((hi << 32) | next_u32());
+            }
+        }
+
+        /** @brief Skips delta outputs (negative deltas via unsigned wrap-around). */
+        constexpr void advance(std::uint64_t delta) noexcept {
+            std::uint64_t mult = multiplier_, plus = inc_, acc_mult = 1, acc_plus = 0;
+            while (delta > 0) {
+                if (delta & 1u) {
+                    acc_mult *= mult;
+                    acc_plus = acc_plus * mult + plus;
+                }
+                plus = (mult + 1) * plus;
+                mult *= mult;
+                delta >>= 1;
+            }
+            state_ = acc_mult * state_ + acc_plus;
+        }
+
+        [[nodiscard]] constexpr bool operator==(const Pcg32&) const noexcept = default;
+
+    private:
+        static constexpr std::uint64_t multiplier_ = 6364136223846793005ULL;
+
+        constexpr void step_() noexcept { state_ = state_ * multiplier_ + inc_; }
+
+        std::uint64_t state_{};
+        std::uint64_t inc_{};
+    };
+
+    /**
+     * @brief Requirements for a per-pixel sample generator.
+     * @details A sampler produces the components of sample `index` of pixel (x, y) one dimension at a time.
+     * start_pixel_sample() selects the sample and resets the dimension to 0; set_dimension() jumps to a given
+     * dimension so that callers can reserve a fixed block of dimensions per path vertex. Values are in [0,1) and
+     * depend only on (seed, pixel, index, dimension), never on the order in which samples are requested.
+     */
+    export template <class S, class T>
+    concept PixelSampler = requires(S& s, std::uint32_t x, std::uint32_t y, std::uint64_t index, std::uint32_t dim) {
+        s.start_pixel_sample(x, y, index);
+        s.set_dimension(dim);
+        { s.next_1d() } -> std::same_as<T>;
+        { s.next_2d() } -> std::same_as<Vector<T, 2>>;
+    };
+
+    /**
+     * @brief Independent uniform samples from a PCG32 stream per (pixel, sample).
+     * @tparam T floating-point scalar type
+     */
+    export template <Arithmetic T>
+    class IndependentSampler {
+    public:
+        constexpr explicit IndependentSampler(std::uint64_t seed = 0) noexcept : seed_{seed} {}
+
+        constexpr void start_pixel_sample(std::uint32_t x, std::uint32_t y, std::uint64_t index) noexcept {
+            base_.seed(sampler_detail::pixel_key(seed_, x, y), index);
+            rng_ = base_;
+        }
+
+        constexpr void set_dimension(std::uint32_t dim) noexcept {
+            rng_ = base_;
+            rng_.advance(sizeof(T) <= 4 ? dim : std::uint64_t{2} * dim);
+        }
+
+        [[nodiscard]] constexpr T next_1d() noexcept { return rng_.uniform<T>(); }
+
+        [[nodiscard]] constexpr Vector<T, 2> next_2d() noexcept {
+            const T u = next_1d();
+            return Vector<T, 2>{u, next_1d()};
+        }
+
+    private:
+        std::uint64_t seed_;
+        Pcg32 base_{};
+        Pcg32 rng_{};
+    };
+
+    /**
+     * @brief Randomized Halton sequence: radical inverses in successive prime bases per dimension.
+     * @tparam T floating-point scalar type
+     * @details Each pixel gets its own Cranley-Patterson rotation per dimension, so neighbouring pixels are
+     * decorrelated while the samples within a pixel stay stratified. Dimensions beyond the prime table fall back
+     * to hashed independent values.
+     */
+    export template <Arithmetic T>
+    class HaltonSampler {
+    public:
+        /** @brief Number of dimensions that use a low-discrepancy base. */
+        static constexpr std::uint32_t max_dimensions = static_cast<std::uint32_t>(sampler_detail::primes.size());
+
+        constexpr explicit HaltonSampler(std::uint64_t seed = 0) noexcept : seed_{seed} {}
+
+        constexpr void start_pixel_sample(std::uint32_t x, std::uint32_t y, std::uint64_t index) noexcept {
+            key_ = sampler_detail::pixel_key(seed_, x, y);
+            index_ = index;
+            dim_ = 0;
+        }
+
+        constexpr void set_dimension(std::uint32_t dim) noexcept { dim_ = dim; }
+
+        [[nodiscard]] constexpr T next_1d() noexcept {
+            using namespace sampler_detail;
+            const std::uint32_t d = dim_++;
+            const std::uint64_t dim_key = mix64(key_ ^ (static_cast<std::uint64_t>(d) * 0x9e3779b97f4a7c15ULL));
+            if (d >= max_dimensions) {
+                return to_unit<T>(mix64(dim_key ^ mix64(index_ + 0x632be59bd9b4e019ULL)));
+            }
+            double u = radical_inverse(primes[d], index_) + to_unit<double>(dim_key);
+            if (u >= 1.0) u -= 1.0;
+            return std::min(static_cast<T>(u), one_minus_epsilon<T>);
+        }
+
+        [[nodiscard]] constexpr Vector<T, 2> next_2d() noexcept {
+            const T u = next_1d();
+            return Vector<T, 2>{u, next_1d()};
+        }
+
+    private:
+        std::uint64_t seed_;
+        std::uint64_t key_{};
+        std::uint64_t index_{};
+        std::uint32_t dim_{};
+    };
+
+    /** @brief Sample sequences selectable at run time. */
+    export enum class SamplerKind {
+        independent, ///< IndependentSampler (PCG32)
+        halton       ///< HaltonSampler
+    };
+
+    /**
+     * @brief Calls fn with a sampler of the given kind, so renderers can be written once against PixelSampler.
+     * @return whatever fn returns
+     */
+    export template <Arithmetic T, class Fn>
+    decltype(auto) visit_sampler(SamplerKind kind, std::uint64_t seed, Fn&& fn) {
+        switch (kind) {
+        case SamplerKind::halton:
+            return std::forward<Fn>(fn)(HaltonSampler<T>{seed});
+        case SamplerKind::independent:
+        default:
+            return std::forward<Fn>(fn)(IndependentSampler<T>{seed});
+        }
+    }
+}
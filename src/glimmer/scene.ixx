@@ -1,12 +1,34 @@
 module;
+#include <array>
+#include <bit>
+#include <numbers>
 #include <vector>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 
 export module glimmer.scene;
 
 import glimmer.vector;
 import glimmer.color;
 import glimmer.aabb;
+import glimmer.ray;
+import glimmer.ray_packet;
+import glimmer.bvh;
+import glimmer.arena;
+import glimmer.render_stats;
+import glimmer.material;
+import glimmer.material_table;
+import glimmer.bsdf;
+import glimmer.light;
+import glimmer.geometry;
+import glimmer.affine;
+import glimmer.instance;
+import glimmer.primitive_list;
+import glimmer.transform;
 import glimmer.scene_object;
 import glimmer.camera;
 
@@ -16,12 +38,49 @@ namespace glimmer {
      * @brief C++23 module defining a simple Scene container with objects, background color, and a camera.
      */
 
+    /** @brief What Scene::update() did to the top-level BVHs. */
+    export enum class SceneUpdate : std::uint8_t {
+        none,    // nothing had changed
+        refit,   // bounds of the changed objects and instances were refitted
+        rebuild  // the BVHs were built from scratch
+    };
+
     /**
      * @brief Simple scene consisting of a list of objects, a background color, and a camera.
      * @tparam T arithmetic scalar type (float/double recommended)
      * @details The scene owns a list of SceneObject<T> by value, a background color (RGB, linear), and a Camera<T>.
      * It provides convenience methods to add/clear objects, query counts, access the camera and background, and
      * compute the world-space union AABB of all contained objects.
+     *
+     * Ray queries go through intersect(), which uses a top-level BVH over the objects' world-space AABBs once
+     * build_bvh() has been called. Adding or removing objects invalidates the BVH (queries then fall back to
+     * a linear scan until the next build).
+     *
+     * For animation, move objects with set_object_transform() (or call mark_object_dirty() after editing one
+     * through objects()) and instances with set_instance_transform(), then call update() once per frame. It
+     * refits only the BVH paths above the changed entries, and rebuilds when refitting has degraded the tree's
+     * SAH cost beyond rebuild_threshold() times its cost at the last build. A frame in which nothing moved costs
+     * next to nothing.
+     *
+     * Materials live in a scene-wide MaterialTable. Objects can refer to table entries by MaterialId
+     * (add_material()); objects carrying a material by value get an entry when they are added, shared by all
+     * copies of the same object. Integrators evaluate materials through surface().
+     *
+     * Objects whose material emits light and whose geometry can be sampled by area (Geometry::area()) are
+     * collected into lights(), which integrators sample directly (sample_light(), light_pdf()). The list is
+     * extended by add_object() and rebuilt by build_lights(), build_bvh() and refit_bvh(); call build_lights()
+     * after changing materials or transforms through objects().
+     *
+     * For large numbers of copies, geometry can instead be registered once (add_geometry()) and placed with
+     * add_instance(). Instances are compact Instance records in a flat array with their own top-level BVH; a
+     * ray is mapped into an instance's object space only when traversal reaches it, and then descends the
+     * geometry's own BVH (e.g. Mesh::build_bvh()). Instances take part in every ray query and in shading,
+     * but are not sampled as lights.
+     *
+     * Plain world-space spheres and planes can be added with add_sphere() and add_plane() instead. They live in
+     * a PrimitiveList (SoA arrays, spheres under their own BVH), are intersected in batches without virtual
+     * calls, and take part in every ray query and in shading like instances. Their hits have no SceneObject and
+     * object_index objects().size() + instance_count() + the primitive's index; they are not sampled as lights.
      */
     export template <Arithmetic T>
     class Scene {
@@ -29,6 +88,28 @@ namespace glimmer {
         using Vec3 = Vector<T,3>;
         using Color3 = Color<T,3>;
 
+        /** @brief Closest-hit record returned by Scene::intersect. */
+        struct Hit
+        {
+            T t{};
+            Vec3 normal{}; // world-space, not necessarily unit length
+            Vector<T,2> uv{};
+            T uv_scale{}; // UV units per world-space length at the hit (0 if unknown)
+            const SceneObject<T>* object{}; // null for instance hits
+            std::size_t object_index{}; // index into objects(), then instances(), then primitives() (see Scene)
+            MaterialId material{invalid_material};
+        };
+
+        /** @brief Point on an emitter drawn by sample_light(). */
+        struct LightSample
+        {
+            Vec3 p{};
+            Vec3 normal{}; // unit geometric normal
+            Color3 emitted{}; // radiance leaving the point (emitters are two-sided)
+            T pdf{}; // density with respect to world-space area, including the light selection probability
+            std::size_t object_index{};
+        };
+
         /** @brief Constructs an empty scene with black background and identity camera. */
         Scene() : bg_{T{0},T{0},T{0}}, cam_{Camera<T>::from_look_at(Vec3{0,0,0}, Vec3{0,0,-1}, Vec3{0,1,0},
                                                                     static_cast<T>(60.0 * 3.14159265358979323846 / 180.0),
@@ -47,33 +128,529 @@ namespace glimmer {
         /** @brief Set camera. */
         void set_camera(const Camera<T>& c) noexcept { cam_ = c; }
 
-        /** @brief Number of objects in the scene. */
+        /** @brief Number of objects in the scene (instances not included). */
         [[nodiscard]] std::size_t size() const noexcept { return objects_.size(); }
-        /** @brief Returns true if there are no objects. */
-        [[nodiscard]] bool empty() const noexcept { return objects_.empty(); }
+        /** @brief Number of instances. */
+        [[nodiscard]] std::size_t instance_count() const noexcept { return instances_.size(); }
+        /** @brief Upper bound of Hit::object_index: objects, instances and primitives. */
+        [[nodiscard]] std::size_t primitive_count() const noexcept {
+            return objects_.size() + instances_.size() + primitives_.size();
+        }
+        /** @brief Returns true if there are no objects, instances or primitives. */
+        [[nodiscard]] bool empty() const noexcept { return objects_.empty() && instances_.empty() && primitives_.empty(); }
+
+        /** @brief Removes all objects, geometries, instances, primitives and materials. */
+        void clear() {
+            objects_.clear();
+            bvh_.clear();
+            geometries_.clear();
+            instances_.clear();
+            instance_bvh_.clear();
+            primitives_.clear();
+            materials_.clear();
+            lights_.clear();
+            clear_dirty_();
+        }
+
+        /** @brief Registers a geometry for instancing and returns its id. */
+        GeometryId add_geometry(std::shared_ptr<const Geometry<T>> geometry) {
+            geometries_.push_back(std::move(geometry));
+            return static_cast<GeometryId>(geometries_.size() - 1);
+        }
+        /** @brief Geometries registered with add_geometry(). */
+        [[nodiscard]] const std::vector<std::shared_ptr<const Geometry<T>>>& geometries() const noexcept { return geometries_; }
+
+        /**
+         * @brief Places geometry with material using the object-to-world map to_world (invalidates the instance BVH).
+         * @return index of the instance in instances()
+         * @throws std::out_of_range if the geometry id is unknown
+         * @throws std::domain_error if to_world is singular
+         */
+        std::size_t add_instance(GeometryId geometry, MaterialId material, const Affine3<T>& to_world) {
+            if (geometry >= geometries_.size() || !geometries_[geometry]) throw std::out_of_range("unknown geometry id");
+            instances_.push_back(Instance<T>{to_world, to_world.inverse(), geometry, material});
+            instance_bvh_.clear();
+            return instances_.size() - 1;
+        }
+        /** @brief Places geometry with the matrices of a Transform. */
+        std::size_t add_instance(GeometryId geometry, MaterialId material, const Transform<T>& xform) {
+            if (geometry >= geometries_.size() || !geometries_[geometry]) throw std::out_of_range("unknown geometry id");
+            instances_.push_back(Instance<T>{xform.affine(), xform.inverse_affine(), geometry, material});
+            instance_bvh_.clear();
+            return instances_.size() - 1;
+        }
+        /** @brief Moves instance i and marks it for the next update(). */
+        void set_instance_transform(std::size_t i, const Affine3<T>& to_world) {
+            instances_[i].to_world = to_world;
+            instances_[i].to_object = to_world.inverse();
+            mark_(instance_dirty_, dirty_instances_, i);
+        }
+        /** @brief Instance records. */
+        [[nodiscard]] const std::vector<Instance<T>>& instances() const noexcept { return instances_; }
+        /** @brief World-space bounds of instance i. */
+        [[nodiscard]] AABB<T> instance_aabb(std::size_t i) const noexcept {
+            const Instance<T>& in = instances_[i];
+            return in.to_world.apply_bounds(geometries_[in.geometry]->aabb());
+        }
+
+        /** @brief Adds a world-space sphere with a table material (invalidates the sphere BVH); returns its index. */
+        std::uint32_t add_sphere(const Vec3& center, T radius, MaterialId material) {
+            return primitives_.add_sphere(center, radius, material);
+        }
+        /** @brief Adds a world-space two-sided plane with a table material; returns its index. */
+        std::uint32_t add_plane(const Vec3& point, const Vec3& normal, MaterialId material) {
+            return primitives_.add_plane(point, normal, material);
+        }
+        /** @brief Moves sphere i of primitives() and marks it for the next update(). */
+        void set_sphere(std::size_t i, const Vec3& center, T radius) { primitives_.set_sphere(i, center, radius); }
+        /** @brief Spheres and planes added with add_sphere() and add_plane(). */
+        [[nodiscard]] const PrimitiveList<T>& primitives() const noexcept { return primitives_; }
+
+        /** @brief Adds an object by value (invalidates the BVH). */
+        void add_object(const SceneObject<T>& obj) {
+            objects_.push_back(obj);
+            bind_material_(objects_.back());
+            add_light_(objects_.size() - 1);
+            bvh_.clear();
+        }
+        /** @brief Adds an object by moving (invalidates the BVH). */
+        void add_object(SceneObject<T>&& obj) {
+            objects_.push_back(std::move(obj));
+            bind_material_(objects_.back());
+            add_light_(objects_.size() - 1);
+            bvh_.clear();
+        }
+
+        /** @brief Adds a material to the scene's table; pass the id to SceneObject to use it. */
+        MaterialId add_material(const Material<T>& m) { return materials_.add(m); }
+        /** @brief Scene-wide material table. */
+        [[nodiscard]] const MaterialTable<T>& materials() const noexcept { return materials_; }
+
+        /**
+         * @brief Shading terms at a hit, evaluated from the material table in one call.
+         * @param hit closest hit
+         * @param cone_width world-space width of the sample's ray cone at the hit (0 samples textures unfiltered)
+         * @details Objects whose material was replaced via objects() after they were added are evaluated from
+         * their Material directly.
+         */
+        [[nodiscard]] SurfaceParams<T> surface(const Hit& hit, T cone_width = T{0}) const noexcept {
+            const T footprint = cone_width * hit.uv_scale;
+            if (hit.material < materials_.size()) return materials_.surface(hit.material, hit.uv, footprint);
+            if (hit.object) return surface_params(hit.object->material(), hit.uv);
+            return surface_params(Material<T>{}, hit.uv);
+        }
+
+        /**
+         * @brief Union of the shading features of the scene's materials (see ShadingFeatures).
+         * @details Read from the material table after one pass over the objects and instances. Objects carrying a
+         * material that has no table entry, and instances and primitives without a material, count as having
+         * every feature.
+         */
+        [[nodiscard]] ShadingFeatures shading_features() const noexcept {
+            for (const auto& o : objects_) if (o.material_id() >= materials_.size()) return ShadingFeatures{};
+            for (const auto& in : instances_) if (in.material >= materials_.size()) return ShadingFeatures{};
+            if (!primitives_.materials_below(materials_.size())) return ShadingFeatures{};
+            return materials_.features();
+        }
 
-        /** @brief Removes all objects. */
-        void clear() { objects_.clear(); }
+        /** @brief Emitters available for direct sampling. */
+        [[nodiscard]] const LightList<T>& lights() const noexcept { return lights_; }
 
-        /** @brief Adds an object by value. */
-        void add_object(const SceneObject<T>& obj) { objects_.push_back(obj); }
-        /** @brief Adds an object by moving. */
-        void add_object(SceneObject<T>&& obj) { objects_.push_back(std::move(obj)); }
+        /** @brief Rebuilds lights() from the objects' current materials and transforms. */
+        void build_lights() {
+            lights_.clear();
+            for (std::size_t i = 0; i < objects_.size(); ++i) add_light_(i);
+        }
+
+        /**
+         * @brief Samples a point on an emitter: picks a light by power, then a point uniformly by area.
+         * @param u_pick uniform number in [0,1) selecting the light
+         * @param u uniform numbers in [0,1) selecting the point
+         * @return sample, or std::nullopt if there are no lights
+         */
+        [[nodiscard]] std::optional<LightSample> sample_light(T u_pick, const Vector<T,2>& u) const noexcept {
+            if (lights_.empty()) return std::nullopt;
+            const auto pick = lights_.pick(u_pick);
+            const std::size_t index = lights_[pick.light].object;
+            const auto& obj = objects_[index];
+            const auto s = obj.sample_surface(u);
+            if (!s) return std::nullopt;
+            return LightSample{s->p, s->normal, surface_(obj, s->uv, T{0}).emitted, s->pdf * pick.pmf, index};
+        }
+
+        /**
+         * @brief Area density with which sample_light() produces the point of hit (0 if the object is not a light).
+         * @details Lets integrators weight emission found by BSDF sampling against light sampling.
+         */
+        [[nodiscard]] T light_pdf(const Hit& hit) const noexcept {
+            const auto light = lights_.find(hit.object_index);
+            if (light == LightList<T>::npos) return T{0};
+            return lights_.pmf(light) * hit.object->area_pdf(hit.normal);
+        }
 
         /** @brief Access list of objects. */
         [[nodiscard]] const std::vector<SceneObject<T>>& objects() const noexcept { return objects_; }
-        /** @brief Mutable access to list of objects. */
+        /** @brief Mutable access to list of objects; call mark_object_dirty() after moving one. */
         [[nodiscard]] std::vector<SceneObject<T>>& objects() noexcept { return objects_; }
 
+        /** @brief Sets the transform of object i and marks it for the next update(). */
+        void set_object_transform(std::size_t i, const Transform<T>& xform) {
+            objects_[i].set_transform(xform);
+            mark_(object_dirty_, dirty_objects_, i);
+        }
+        /** @brief Marks object i as moved, e.g. after changing it through objects(). */
+        void mark_object_dirty(std::size_t i) { mark_(object_dirty_, dirty_objects_, i); }
+        /** @brief Number of objects, instances and spheres marked since the last update() or BVH build. */
+        [[nodiscard]] std::size_t dirty_count() const noexcept {
+            return dirty_objects_.size() + dirty_instances_.size() + primitives_.dirty_count();
+        }
+
+        /** @brief SAH cost ratio (current / at build) above which update() rebuilds instead of refitting. */
+        [[nodiscard]] T rebuild_threshold() const noexcept { return rebuild_threshold_; }
+        /** @brief Sets the rebuild threshold; values <= 1 rebuild on almost every change. */
+        void set_rebuild_threshold(T ratio) noexcept { rebuild_threshold_ = ratio; }
+
+        /**
+         * @brief Brings the BVHs and the light list up to date after objects or instances moved.
+         * @details Builds the BVHs if they are missing or out of date (objects or instances were added). Otherwise
+         * refits the leaves of the marked entries and their ancestors only, then rebuilds if either tree's SAH
+         * cost has grown past rebuild_threshold() times its cost at the last build. The light list is rebuilt only
+         * if a moved object is a light.
+         */
+        SceneUpdate update() {
+            if ((!objects_.empty() && !bvh_valid()) || (!instances_.empty() && !instance_bvh_valid_()) ||
+                (primitives_.sphere_count() > 0 && !primitives_.bvh_valid())) {
+                build_bvh();
+                return SceneUpdate::rebuild;
+            }
+            const bool spheres_moved = primitives_.dirty_count() > 0;
+            const bool spheres_rebuilt = primitives_.refit(rebuild_threshold_);
+            if (dirty_objects_.empty() && dirty_instances_.empty()) {
+                if (spheres_rebuilt) return SceneUpdate::rebuild;
+                return spheres_moved ? SceneUpdate::refit : SceneUpdate::none;
+            }
+            bool lights_moved = false;
+            for (const auto i : dirty_objects_) lights_moved = lights_moved || lights_.find(i) != LightList<T>::npos;
+            bvh_.refit(dirty_objects_, [&](std::uint32_t i) noexcept { return objects_[i].aabb(); });
+            instance_bvh_.refit(dirty_instances_, [&](std::uint32_t i) noexcept { return instance_aabb(i); });
+            clear_dirty_();
+            if (bvh_.sah_cost() > rebuild_threshold_ * bvh_build_cost_ ||
+                instance_bvh_.sah_cost() > rebuild_threshold_ * instance_build_cost_) {
+                build_bvh();
+                return SceneUpdate::rebuild;
+            }
+            if (lights_moved) build_lights();
+            return spheres_rebuilt ? SceneUpdate::rebuild : SceneUpdate::refit;
+        }
+
         /** @brief Computes the union AABB of all objects in world space. Returns empty if no objects. */
         [[nodiscard]] AABB<T> aabb() const noexcept {
             AABB<T> box; // empty
             for (const auto& o : objects_) box.expand(o.aabb());
+            for (std::size_t i = 0; i < instances_.size(); ++i) box.expand(instance_aabb(i));
+            if (!primitives_.empty()) box.expand(primitives_.bounds());
             return box;
         }
 
+        /** @brief Builds (or rebuilds) the top-level BVHs over the objects' and instances' AABBs and the sphere BVH. */
+        void build_bvh() {
+            {
+                const ArenaScope scratch;
+                const auto bounds = object_bounds_();
+                bvh_.build(bounds, 1);
+            }
+            {
+                const ArenaScope scratch;
+                const auto bounds = instance_bounds_();
+                instance_bvh_.build(bounds, 1);
+            }
+            primitives_.build_bvh();
+            bvh_build_cost_ = bvh_.sah_cost();
+            instance_build_cost_ = instance_bvh_.sah_cost();
+            clear_dirty_();
+            build_lights();
+        }
+
+        /**
+         * @brief Refits the BVHs to all objects' and instances' current AABBs.
+         * @details Keeps the tree topology; builds from scratch if a BVH is missing or out of date. Prefer
+         * update() when only some entries moved.
+         */
+        void refit_bvh() {
+            if (!bvh_valid() && !objects_.empty()) { build_bvh(); return; }
+            if (!instance_bvh_valid_() && !instances_.empty()) { build_bvh(); return; }
+            if (!primitives_.bvh_valid() && primitives_.sphere_count() > 0) { build_bvh(); return; }
+            {
+                const ArenaScope scratch;
+                const auto bounds = object_bounds_();
+                if (!bounds.empty()) bvh_.refit(bounds);
+            }
+            {
+                const ArenaScope scratch;
+                const auto bounds = instance_bounds_();
+                if (!bounds.empty()) instance_bvh_.refit(bounds);
+            }
+            primitives_.refit(std::numeric_limits<T>::infinity());
+            clear_dirty_();
+            build_lights();
+        }
+
+        /** @brief Returns true if the BVH is built and matches the current object list. */
+        [[nodiscard]] bool bvh_valid() const noexcept {
+            return !objects_.empty() && bvh_.primitive_count() == objects_.size();
+        }
+
+        /** @brief Access the top-level BVH over objects (empty until build_bvh()). */
+        [[nodiscard]] const Bvh<T>& bvh() const noexcept { return bvh_; }
+        /** @brief Access the top-level BVH over instances (empty until build_bvh()). */
+        [[nodiscard]] const Bvh<T>& instance_bvh() const noexcept { return instance_bvh_; }
+
+        /**
+         * @brief Closest hit along a world-space ray within [tmin, tmax].
+         * @return hit record with the object that was hit, or std::nullopt
+         */
+        [[nodiscard]] std::optional<Hit> intersect(const Ray<T>& ray) const noexcept {
+            record_stat(StatCounter::rays);
+            Hit best{};
+            bool any_hit = false;
+            auto test = [&](std::size_t i, T& t_max) noexcept {
+                const auto& obj = objects_[i];
+                const Ray<T> clipped{ray.origin(), ray.direction(), ray.tmin(), t_max};
+                auto h = obj.intersect(clipped);
+                if (!h || h->t < ray.tmin() || h->t > t_max) return false;
+                t_max = h->t;
+                best = Hit{h->t, h->normal, h->uv, h->uv_scale, &obj, i, obj.material_id()};
+                any_hit = true;
+                return true;
+            };
+            T t_max = ray.tmax();
+            if (bvh_valid()) {
+                bvh_.intersect(ray, [&](std::uint32_t prim, T& t) noexcept {
+                    const bool found = test(prim, t);
+                    if (found) t_max = t;
+                    return found;
+                });
+            } else {
+                for (std::size_t i = 0; i < objects_.size(); ++i) test(i, t_max);
+            }
+            if (!instances_.empty()) {
+                auto test_instance = [&](std::size_t i, T& t) noexcept {
+                    auto h = intersect_instance_(i, ray, ray.tmin(), t);
+                    if (!h) return false;
+                    t = h->t;
+                    best = *h;
+                    any_hit = true;
+                    return true;
+                };
+                const Ray<T> clipped{ray.origin(), ray.direction(), ray.tmin(), t_max};
+                if (instance_bvh_valid_()) {
+                    instance_bvh_.intersect(clipped, [&](std::uint32_t prim, T& t) noexcept { return test_instance(prim, t); });
+                } else {
+                    for (std::size_t i = 0; i < instances_.size(); ++i) test_instance(i, t_max);
+                }
+                if (any_hit) t_max = best.t;
+            }
+            if (!primitives_.empty()) {
+                const std::uint32_t k = primitives_.intersect(ray, t_max);
+                if (k != PrimitiveList<T>::npos) {
+                    best = primitive_hit_(k, ray, t_max);
+                    any_hit = true;
+                }
+            }
+            if (!any_hit) return std::nullopt;
+            return best;
+        }
+
+        /**
+         * @brief Closest hits for a packet of world-space rays.
+         * @param packet ray packet (e.g. coherent camera rays); only active() lanes are traced
+         * @param hits receives the closest hit per lane, or std::nullopt on a miss
+         * @return mask of lanes that hit something
+         * @details Shares one top-level BVH traversal across all lanes. Mesh and sphere objects trace the lanes
+         * that reach them with the geometry's packet kernel; instances and other geometry are tested per lane.
+         */
+        template <std::size_t N>
+        PacketMask intersect_packet(const RayPacket<T,N>& packet, std::array<std::optional<Hit>,N>& hits) const noexcept {
+            record_stat(StatCounter::rays, packet.count);
+            for (auto& h : hits) h.reset();
+            std::array<T,N> t_max = packet.tmax;
+            std::array<typename Geometry<T>::Hit,N> object_hits{};
+            auto test = [&](std::size_t i, PacketMask lanes) noexcept {
+                const auto& obj = objects_[i];
+                const PacketMask out = obj.intersect_packet(packet, lanes, t_max, object_hits);
+                for (PacketMask m = out; m != 0; m &= m - 1) {
+                    const auto lane = static_cast<std::size_t>(std::countr_zero(m));
+                    const auto& h = object_hits[lane];
+                    hits[lane] = Hit{h.t, h.normal, h.uv, h.uv_scale, &obj, i, obj.material_id()};
+                }
+                return out;
+            };
+            PacketMask hit = 0;
+            if (bvh_valid()) {
+                hit = bvh_.intersect_packet(packet, t_max,
+                                            [&](std::uint32_t prim, PacketMask lanes) noexcept { return test(prim, lanes); });
+            } else {
+                for (std::size_t i = 0; i < objects_.size(); ++i) hit |= test(i, packet.active());
+            }
+            if (instances_.empty()) return hit | intersect_primitives_(packet, t_max, hits);
+            auto test_instance = [&](std::size_t i, PacketMask lanes) noexcept {
+                PacketMask out = 0;
+                for (PacketMask m = lanes; m != 0; m &= m - 1) {
+                    const auto lane = static_cast<std::size_t>(std::countr_zero(m));
+                    auto h = intersect_instance_(i, packet.ray(lane), packet.tmin[lane], t_max[lane]);
+                    if (!h) continue;
+                    t_max[lane] = h->t;
+                    hits[lane] = *h;
+                    out |= PacketMask{1} << lane;
+                }
+                return out;
+            };
+            if (instance_bvh_valid_()) {
+                // t_max already holds the closest object hits, which bounds this traversal
+                hit |= instance_bvh_.intersect_packet(packet, t_max,
+                                                      [&](std::uint32_t prim, PacketMask lanes) noexcept { return test_instance(prim, lanes); });
+            } else {
+                for (std::size_t i = 0; i < instances_.size(); ++i) hit |= test_instance(i, packet.active());
+            }
+            return hit | intersect_primitives_(packet, t_max, hits);
+        }
+
+        /**
+         * @brief Any-hit query: returns true if any object blocks the ray within [tmin, tmax].
+         * @details Stops at the first blocker found; use for shadow rays and visibility tests.
+         */
+        [[nodiscard]] bool occluded(const Ray<T>& ray) const noexcept {
+            record_stat(StatCounter::shadow_rays);
+            if (bvh_valid()) {
+                if (bvh_.occluded(ray, [&](std::uint32_t prim) noexcept { return objects_[prim].occluded(ray); })) return true;
+            } else {
+                for (const auto& o : objects_) if (o.occluded(ray)) return true;
+            }
+            if (!primitives_.empty() && primitives_.occluded(ray)) return true;
+            if (instances_.empty()) return false;
+            if (instance_bvh_valid_()) {
+                return instance_bvh_.occluded(ray, [&](std::uint32_t prim) noexcept { return instance_occluded_(prim, ray); });
+            }
+            for (std::size_t i = 0; i < instances_.size(); ++i) if (instance_occluded_(i, ray)) return true;
+            return false;
+        }
+
     private:
+        void bind_material_(SceneObject<T>& obj) {
+            if (obj.material_ptr()) obj.bind_material(materials_.intern(obj.material_ptr()));
+        }
+
+        [[nodiscard]] SurfaceParams<T> surface_(const SceneObject<T>& obj, const Vector<T,2>& uv, T footprint) const noexcept {
+            const MaterialId id = obj.material_id();
+            if (id < materials_.size()) return materials_.surface(id, uv, footprint);
+            return surface_params(obj.material(), uv);
+        }
+
+        // Registers object i as a light if it emits and can be sampled by area
+        void add_light_(std::size_t i) {
+            const auto& obj = objects_[i];
+            const MaterialId id = obj.material_id();
+            const Color3 e = id < materials_.size() ? materials_.average_emitted(id)
+                                                    : surface_params(obj.material(), Vector<T,2>{T{0.5}, T{0.5}}).emitted;
+            const T radiance = (e[0] + e[1] + e[2]) / T{3};
+            if (!(radiance > T{0})) return;
+            const T area = obj.area();
+            lights_.add(Light<T>{static_cast<std::uint32_t>(i), area, std::numbers::pi_v<T> * area * radiance});
+        }
+
+        // Queues entry i for the next update() unless it is already queued
+        static void mark_(std::vector<std::uint8_t>& flags, std::vector<std::uint32_t>& list, std::size_t i) {
+            if (i >= flags.size()) flags.resize(i + 1, 0);
+            if (flags[i]) return;
+            flags[i] = 1;
+            list.push_back(static_cast<std::uint32_t>(i));
+        }
+
+        void clear_dirty_() noexcept {
+            for (const auto i : dirty_objects_) object_dirty_[i] = 0;
+            for (const auto i : dirty_instances_) instance_dirty_[i] = 0;
+            dirty_objects_.clear();
+            dirty_instances_.clear();
+        }
+
+        [[nodiscard]] bool instance_bvh_valid_() const noexcept {
+            return !instances_.empty() && instance_bvh_.primitive_count() == instances_.size();
+        }
+
+        // Maps the ray into instance i's object space; t is the same in both spaces since the direction is not
+        // renormalized
+        [[nodiscard]] Ray<T> instance_ray_(const Instance<T>& in, const Ray<T>& ray, T tmin, T tmax) const noexcept {
+            return Ray<T>{in.to_object.apply_point(ray.origin()), in.to_object.apply_direction(ray.direction()), tmin, tmax};
+        }
+
+        [[nodiscard]] std::optional<Hit> intersect_instance_(std::size_t i, const Ray<T>& ray, T tmin, T tmax) const noexcept {
+            const Instance<T>& in = instances_[i];
+            const Ray<T> local = instance_ray_(in, ray, tmin, tmax);
+            const auto h = geometries_[in.geometry]->intersect(local);
+            if (!h || h->t < tmin || h->t > tmax) return std::nullopt;
+            // UV density per object-space length becomes density per world-space length along the ray
+            const T dw = ray.direction().norm();
+            const T uv_scale = dw > T{0} ? h->uv_scale * (local.direction().norm() / dw) : h->uv_scale;
+            return Hit{h->t, in.to_object.apply_transposed(h->normal), h->uv, uv_scale, nullptr,
+                       objects_.size() + i, in.material};
+        }
+
+        [[nodiscard]] Hit primitive_hit_(std::uint32_t k, const Ray<T>& ray, T t) const noexcept {
+            const auto h = primitives_.hit(k, ray, t);
+            return Hit{h.t, h.normal, h.uv, h.uv_scale, nullptr, objects_.size() + instances_.size() + k,
+                       primitives_.material(k)};
+        }
+
+        // Closest primitive hits below t_max for a packet; replaces hits of the lanes they win
+        template <std::size_t N>
+        PacketMask intersect_primitives_(const RayPacket<T,N>& packet, std::array<T,N>& t_max,
+                                         std::array<std::optional<Hit>,N>& hits) const noexcept {
+            if (primitives_.empty()) return 0;
+            std::array<std::uint32_t,N> index{};
+            const PacketMask hit = primitives_.intersect_packet(packet, t_max, index);
+            for (PacketMask m = hit; m != 0; m &= m - 1) {
+                const auto lane = static_cast<std::size_t>(std::countr_zero(m));
+                hits[lane] = primitive_hit_(index[lane], packet.ray(lane), t_max[lane]);
+            }
+            return hit;
+        }
+
+        [[nodiscard]] bool instance_occluded_(std::size_t i, const Ray<T>& ray) const noexcept {
+            const Instance<T>& in = instances_[i];
+            return geometries_[in.geometry]->occluded(instance_ray_(in, ray, ray.tmin(), ray.tmax()));
+        }
+
+        // Allocated in the calling thread's arena
+        [[nodiscard]] ArenaVector<AABB<T>> instance_bounds_() const {
+            ArenaVector<AABB<T>> bounds;
+            bounds.reserve(instances_.size());
+            for (std::size_t i = 0; i < instances_.size(); ++i) bounds.push_back(instance_aabb(i));
+            return bounds;
+        }
+
+        // Allocated in the calling thread's arena
+        [[nodiscard]] ArenaVector<AABB<T>> object_bounds_() const {
+            ArenaVector<AABB<T>> bounds;
+            bounds.reserve(objects_.size());
+            for (const auto& o : objects_) bounds.push_back(o.aabb());
+            return bounds;
+        }
+
         std::vector<SceneObject<T>> objects_{};
+        Bvh<T> bvh_{};
+        MaterialTable<T> materials_{};
+        LightList<T> lights_{};
+        std::vector<std::shared_ptr<const Geometry<T>>> geometries_{};
+        std::vector<Instance<T>> instances_{};
+        Bvh<T> instance_bvh_{};
+        PrimitiveList<T> primitives_{};
+        std::vector<std::uint8_t> object_dirty_{};
+        std::vector<std::uint32_t> dirty_objects_{};
+        std::vector<std::uint8_t> instance_dirty_{};
+        std::vector<std::uint32_t> dirty_instances_{};
+        T bvh_build_cost_{};
+        T instance_build_cost_{};
+        T rebuild_threshold_{static_cast<T>(1.5)};
         Color3 bg_{};
         Camera<T> cam_;
     };
@@ -1,4 +1,10 @@
 module;
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <type_traits>
@@ -6,22 +12,32 @@ module;
 export module glimmer.scene_object;
 
 import glimmer.vector;
-import glimmer.matrix;
 import glimmer.transform;
+import glimmer.affine;
 import glimmer.geometry;
+import glimmer.mesh;
+import glimmer.sphere;
 import glimmer.ray;
+import glimmer.ray_packet;
 import glimmer.aabb;
 import glimmer.material;
+import glimmer.material_table;
+import glimmer.render_stats;
 
 namespace glimmer {
     /**
      * @brief A renderable scene object combining geometry, material, and transform with a cached world-space AABB.
      * @tparam T arithmetic scalar type (float/double recommended)
+     * @details The material is either given by value, in which case the object shares one immutable copy (so
+     * copying an object costs a single reference count), or as a MaterialId into the table of the Scene the
+     * object is added to, in which case no material is owned at all. Scene::add_object assigns ids to objects
+     * given by value; shading only uses the id.
      */
     export template <Arithmetic T>
     class SceneObject {
     public:
         using GeoPtr = std::shared_ptr<const Geometry<T>>;
+        using MaterialPtr = std::shared_ptr<const Material<T>>;
 
         /** @brief Constructs an empty object (no geometry). */
         SceneObject() { cache_from_transform_(); }
@@ -33,22 +49,53 @@ namespace glimmer {
          * @param xform object-to-world transform
          */
         SceneObject(GeoPtr geom, const Material<T>& material, const Transform<T>& xform)
-            : geom_{std::move(geom)}, mat_{material}, xf_{xform} {
+            : geom_{std::move(geom)}, mat_{std::make_shared<const Material<T>>(material)}, xf_{xform} {
             cache_from_transform_();
+            cache_packet_geometry_();
+            update_aabb();
+        }
+
+        /**
+         * @brief Constructs a scene object referring to a material of the scene's MaterialTable.
+         * @param geom shared ownership pointer to immutable geometry
+         * @param material id returned by Scene::add_material
+         * @param xform object-to-world transform
+         */
+        SceneObject(GeoPtr geom, MaterialId material, const Transform<T>& xform)
+            : geom_{std::move(geom)}, material_id_{material}, xf_{xform} {
+            cache_from_transform_();
+            cache_packet_geometry_();
             update_aabb();
         }
 
         /** @brief Access geometry pointer (may be null). */
         [[nodiscard]] const GeoPtr& geometry() const noexcept { return geom_; }
-        /** @brief Access material parameters. */
-        [[nodiscard]] const Material<T>& material() const noexcept { return mat_; }
+        /** @brief Access material parameters (a default material if the object only has a MaterialId). */
+        [[nodiscard]] const Material<T>& material() const noexcept {
+            static const Material<T> none{};
+            return mat_ ? *mat_ : none;
+        }
+        /** @brief Material given by value, or null if the object only refers to a MaterialId. */
+        [[nodiscard]] const MaterialPtr& material_ptr() const noexcept { return mat_; }
+        /** @brief Material table id (invalid_material until assigned). */
+        [[nodiscard]] MaterialId material_id() const noexcept { return material_id_; }
         /** @brief Access transform. */
         [[nodiscard]] const Transform<T>& transform() const noexcept { return xf_; }
 
         /** @brief Sets a new transform and refreshes cached AABB. */
         void set_transform(const Transform<T>& xform) { xf_ = xform; cache_from_transform_(); update_aabb(); }
-        /** @brief Sets a new material. */
-        void set_material(const Material<T>& m) noexcept { mat_ = m; }
+        /** @brief Sets a new material by value; the table id is reassigned when the object is added to a scene. */
+        void set_material(const Material<T>& m) {
+            mat_ = std::make_shared<const Material<T>>(m);
+            material_id_ = invalid_material;
+        }
+        /** @brief Refers to a material of the scene's MaterialTable. */
+        void set_material(MaterialId id) noexcept {
+            mat_.reset();
+            material_id_ = id;
+        }
+        /** @brief Records the table id of the material given by value (used by Scene). */
+        void bind_material(MaterialId id) noexcept { material_id_ = id; }
 
         /** @brief World-space axis-aligned bounding box (cached). */
         [[nodiscard]] const AABB<T>& aabb() const noexcept { return aabb_world_; }
@@ -71,38 +118,147 @@ namespace glimmer {
             return wh;
         }
 
+        /**
+         * @brief Closest hits of several lanes of a world-space ray packet.
+         * @param packet world-space ray packet
+         * @param lanes lanes to test
+         * @param t_max per-lane world-space search bound; lowered to the hit distance on hits
+         * @param hits receives the world-space hit of every lane in the returned mask
+         * @return mask of lanes with a hit in [tmin, t_max]
+         * @details Meshes and spheres transform the packet into object space once and trace it with their packet
+         * kernels; other geometry falls back to intersect() per lane.
+         */
+        template <std::size_t N>
+        PacketMask intersect_packet(const RayPacket<T,N>& packet, PacketMask lanes, std::array<T,N>& t_max,
+                                    std::array<typename Geometry<T>::Hit,N>& hits) const noexcept {
+            if (!geom_ || lanes == 0) return 0;
+            PacketMask out = 0;
+            auto accept = [&](std::size_t lane, const typename Geometry<T>::Hit& h) noexcept {
+                if (h.t < packet.tmin[lane] || h.t > t_max[lane]) return;
+                t_max[lane] = h.t;
+                hits[lane] = h;
+                out |= PacketMask{1} << lane;
+            };
+            if (!mesh_ && !sphere_) {
+                for (PacketMask m = lanes; m != 0; m &= m - 1) {
+                    const auto lane = static_cast<std::size_t>(std::countr_zero(m));
+                    Ray<T> clipped = packet.ray(lane);
+                    clipped.set_range(packet.tmin[lane], t_max[lane]);
+                    if (auto h = intersect(clipped)) accept(lane, *h);
+                }
+                return out;
+            }
+
+            record_stat(StatCounter::aabb_tests, static_cast<std::uint64_t>(std::popcount(lanes)));
+            std::array<T,N> t_entry{};
+            lanes = intersect_aabb(aabb_world_, packet, t_max, t_entry, lanes);
+            if (lanes == 0) return 0;
+            // Object-space copy of the packet; lanes that are not tested get an empty range so the kernels skip them
+            RayPacket<T,N> local{};
+            local.count = packet.count;
+            std::array<T,N> t_obj{};
+            t_obj.fill(std::numeric_limits<T>::lowest());
+            for (PacketMask m = lanes; m != 0; m &= m - 1) {
+                const auto lane = static_cast<std::size_t>(std::countr_zero(m));
+                Ray<T> ray_w = packet.ray(lane);
+                ray_w.set_range(packet.tmin[lane], t_max[lane]);
+                const Ray<T> ray_o = to_object_ray_(ray_w);
+                local.set(lane, ray_o);
+                t_obj[lane] = ray_o.tmax();
+            }
+
+            if (mesh_) {
+                std::array<std::uint32_t,N> tri{};
+                std::array<T,N> u{}, v{};
+                const PacketMask m = mesh_->intersect_packet(local, t_obj, tri, u, v) & lanes;
+                for (PacketMask k = m; k != 0; k &= k - 1) {
+                    const auto lane = static_cast<std::size_t>(std::countr_zero(k));
+                    accept(lane, map_hit_to_world_(packet.ray(lane), local.ray(lane),
+                                                   mesh_->hit_at(tri[lane], t_obj[lane], u[lane], v[lane])));
+                }
+            } else {
+                const PacketMask m = intersect_sphere(sphere_->center(), sphere_->radius(), local, t_obj, lanes);
+                for (PacketMask k = m; k != 0; k &= k - 1) {
+                    const auto lane = static_cast<std::size_t>(std::countr_zero(k));
+                    const Ray<T> ray_o = local.ray(lane);
+                    accept(lane, map_hit_to_world_(packet.ray(lane), ray_o, sphere_->hit_at(ray_o, t_obj[lane])));
+                }
+            }
+            return out;
+        }
+
+        /**
+         * @brief Any-hit query in world space (shadow rays).
+         * @param ray_w world-space ray; hits are accepted anywhere within [tmin, tmax]
+         * @return true if the geometry blocks the ray; no hit record or world-space mapping is computed
+         */
+        [[nodiscard]] bool occluded(const Ray<T>& ray_w) const noexcept {
+            if (!geom_) return false;
+            if (!aabb_hits_(ray_w)) return false;
+            return geom_->occluded(to_object_ray_(ray_w));
+        }
+
+        /** @brief Point on the object drawn by sample_surface(), in world space. */
+        struct SurfaceSample {
+            Vector<T,3> p{};
+            Vector<T,3> normal{}; // unit
+            Vector<T,2> uv{};
+            T pdf{}; // density with respect to world-space area
+        };
+
+        /**
+         * @brief Draws a point on the surface uniformly by object-space area (see Geometry::sample_surface).
+         * @return sample with its world-space area density, or std::nullopt if the geometry cannot be sampled
+         */
+        [[nodiscard]] std::optional<SurfaceSample> sample_surface(const Vector<T,2>& u) const noexcept {
+            if (!geom_) return std::nullopt;
+            const T area = geom_->area();
+            if (!(area > T{0})) return std::nullopt;
+            const auto s = geom_->sample_surface(u);
+            const Vector<T,3> n_world = to_object_.apply_transposed(s.normal);
+            const T pdf = area_pdf(n_world);
+            if (!(pdf > T{0})) return std::nullopt;
+            return SurfaceSample{to_world_.apply_point(s.p), n_world.normalized(), s.uv, pdf};
+        }
+
+        /**
+         * @brief World-space area density of sample_surface() at a point with the given world-space normal.
+         * @param normal_world object-space unit normal mapped by the normal matrix, i.e. the unnormalized
+         *        normal reported by intersect()
+         * @details An affine transform scales area elements by |det A| * |A^-T n|, so the density is exact for
+         * any transform as long as the normal is the geometric one (shading normals make it approximate).
+         */
+        [[nodiscard]] T area_pdf(const Vector<T,3>& normal_world) const noexcept {
+            if (!geom_) return T{0};
+            const T jacobian = area_scale_ * normal_world.norm();
+            const T area = geom_->area() * jacobian;
+            return area > T{0} ? T{1} / area : T{0};
+        }
+
+        /** @brief World-space surface area (exact for similarity transforms, an estimate otherwise). */
+        [[nodiscard]] T area() const noexcept {
+            if (!geom_) return T{0};
+            return geom_->area() * static_cast<T>(std::pow(static_cast<double>(area_scale_), 2.0 / 3.0));
+        }
+
         /** @brief Recomputes and caches the world-space AABB from geometry and transform. */
         void update_aabb() {
             if (!geom_) { aabb_world_ = AABB<T>{}; return; }
-            auto box = geom_->aabb();
-            if (box.empty()) { aabb_world_ = AABB<T>{}; return; }
-            // Transform all 8 corners and expand
-            Vector<T,3> mn = box.min();
-            Vector<T,3> mx = box.max();
-            Vector<T,3> corners[8] = {
-                {mn[0], mn[1], mn[2]}, {mx[0], mn[1], mn[2]}, {mn[0], mx[1], mn[2]}, {mn[0], mn[1], mx[2]},
-                {mx[0], mx[1], mn[2]}, {mx[0], mn[1], mx[2]}, {mn[0], mx[1], mx[2]}, {mx[0], mx[1], mx[2]}
-            };
-            AABB<T> world_box;
-            for (auto& c : corners) {
-                // transform corner using cached matrix via homogeneous coordinates
-                Vector<T,4> c4 = to_homogeneous_point(c);
-                Vector<T,4> cw = m_world_ * c4;
-                world_box.expand(Vector<T,3>{cw[0], cw[1], cw[2]});
-            }
-            aabb_world_ = world_box;
+            // Same box as the union of the eight transformed corners, from the center and |A| times the extents
+            aabb_world_ = to_world_.apply_bounds(geom_->aabb());
         }
 
     private:
         // Fast-path helpers extracted from intersect() for readability and inlining.
-        [[nodiscard]] constexpr bool aabb_hits_(const Ray<T>& ray_w) const noexcept {
+        [[nodiscard]] bool aabb_hits_(const Ray<T>& ray_w) const noexcept {
+            record_stat(StatCounter::aabb_tests);
             auto box_hit = aabb_world_.intersect(ray_w);
             return box_hit.has_value();
         }
 
         [[nodiscard]] Ray<T> to_object_ray_(const Ray<T>& ray_w) const noexcept {
-            const Vector<T,3> o = resize_dim<T,4,3>(inv_world_ * to_homogeneous_point(ray_w.origin()));
-            const Vector<T,3> d_obj = resize_dim<T,4,3>(inv_world_ * to_homogeneous_dir(ray_w.direction()));
+            const Vector<T,3> o = to_object_.apply_point(ray_w.origin());
+            const Vector<T,3> d_obj = to_object_.apply_direction(ray_w.direction());
             const T len = d_obj.norm();
             if (len != T{}) {
                 Vector<T,3> d_unit{};
@@ -128,36 +284,41 @@ namespace glimmer {
                                                                   const typename Geometry<T>::Hit& local_hit) const noexcept {
             const T t_obj = local_hit.t;
             const Vector<T,3> p_obj = ray_o.at(t_obj);
-            const Vector<T,4> p4_w = m_world_ * to_homogeneous_point(p_obj);
-            const Vector<T,3> p_world{ p4_w[0], p4_w[1], p4_w[2] };
-            const Vector<T,3> n_world = normal_it3_ * local_hit.normal;
+            const Vector<T,3> p_world = to_world_.apply_point(p_obj);
+            const Vector<T,3> n_world = to_object_.apply_transposed(local_hit.normal);
             const T t_world = compute_world_t_(ray_w, p_world);
             typename Geometry<T>::Hit wh{};
             wh.t = t_world;
             wh.normal = n_world;
             wh.uv = local_hit.uv; // UVs are defined in object space and remain the same under rigid transforms
+            // Object-space length per world-space length along the ray rescales the texture density
+            wh.uv_scale = t_world > T{0} ? local_hit.uv_scale * (t_obj / t_world) : local_hit.uv_scale;
             return wh;
         }
 
-        // Cache matrices to avoid recomputing in hot paths
+        // Geometry with a packet kernel, looked up once since the geometry of an object never changes
+        void cache_packet_geometry_() noexcept {
+            mesh_ = dynamic_cast<const Mesh<T>*>(geom_.get());
+            sphere_ = dynamic_cast<const Sphere<T>*>(geom_.get());
+        }
+
+        // Cache 3x4 maps to avoid homogeneous 4x4 products in hot paths; normals use to_object_'s transpose
         void cache_from_transform_() noexcept {
-            m_world_ = xf_.matrix();
-            inv_world_ = xf_.inverse_matrix();
-            // Precompute 3x3 normal matrix = (inverse)^T upper-left
-            normal_it3_ = Matrix<T,3,3>{
-                inv_world_(0,0), inv_world_(1,0), inv_world_(2,0),
-                inv_world_(0,1), inv_world_(1,1), inv_world_(2,1),
-                inv_world_(0,2), inv_world_(1,2), inv_world_(2,2)
-            };
+            to_world_ = xf_.affine();
+            to_object_ = xf_.inverse_affine();
+            area_scale_ = std::abs(to_world_.determinant());
         }
 
         GeoPtr geom_{};
-        Material<T> mat_{};
+        const Mesh<T>* mesh_{}; // geom_ when it is a Mesh
+        const Sphere<T>* sphere_{}; // geom_ when it is a Sphere
+        MaterialPtr mat_{};
+        MaterialId material_id_{invalid_material};
         Transform<T> xf_{}; // object-to-world
-        // Cached matrices for fast transformations
-        Matrix<T,4,4> m_world_{};
-        Matrix<T,4,4> inv_world_{};
-        Matrix<T,3,3> normal_it3_{};
+        // Cached maps for fast transformations
+        Affine3<T> to_world_{};
+        Affine3<T> to_object_{};
+        T area_scale_{1}; // |det| of the linear part of to_world_
         AABB<T> aabb_world_{};
     };
 }
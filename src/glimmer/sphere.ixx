@@ -1,9 +1,11 @@
 module;
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <ostream>
 #include <type_traits>
 #include <optional>
+#include <numbers>
 
 export module glimmer.sphere;
 
@@ -59,7 +61,7 @@ namespace glimmer {
             const T c = dot(oc, oc) - r_ * r_;
             const T disc = b*b - T{4}*a*c;
             if (disc < T{0}) return std::nullopt;
-            const T sqrt_disc = static_cast<T>(std::sqrt(static_cast<long double>(disc)));
+            const T sqrt_disc = static_cast<T>(std::sqrt(disc));
             // two roots
             T t0 = (-b - sqrt_disc) / (T{2} * a);
             T t1 = (-b + sqrt_disc) / (T{2} * a);
@@ -69,10 +71,17 @@ namespace glimmer {
                 t_candidate = t1;
                 if (t_candidate < ray.tmin() || t_candidate > ray.tmax()) return std::nullopt;
             }
-            Vector<T,3> p = ray.at(t_candidate);
-            Vector<T,3> n = p - c_;
+            return hit_at(ray, t_candidate);
+        }
+
+        /**
+         * @brief Hit record for a ray that reaches the sphere at parameter t (outward unit normal, zero uv).
+         * @details Shared by intersect() and packet queries that find t with the packet kernel.
+         */
+        [[nodiscard]] typename Geometry<T>::Hit hit_at(const Ray<T>& ray, T t) const noexcept {
+            const Vector<T,3> n = ray.at(t) - c_;
             typename Geometry<T>::Hit hit{};
-            hit.t = t_candidate;
+            hit.t = t;
             auto nn = n.norm();
             if (nn != T{0}) {
                 if constexpr (std::is_floating_point_v<T>) hit.normal = n / nn;
@@ -83,6 +92,37 @@ namespace glimmer {
             return hit;
         }
 
+        /**
+         * @brief Any-hit test: true if either root of the ray-sphere quadratic lies within [tmin,tmax].
+         */
+        [[nodiscard]] bool occluded(const Ray<T>& ray) const noexcept override {
+            const Vector<T,3> oc = ray.origin() - c_;
+            const T a = dot(ray.direction(), ray.direction());
+            const T b = T{2} * dot(oc, ray.direction());
+            const T c = dot(oc, oc) - r_ * r_;
+            const T disc = b*b - T{4}*a*c;
+            if (disc < T{0}) return false;
+            const T sqrt_disc = static_cast<T>(std::sqrt(disc));
+            T t0 = (-b - sqrt_disc) / (T{2} * a);
+            T t1 = (-b + sqrt_disc) / (T{2} * a);
+            if (t0 > t1) { auto tmp = t0; t0 = t1; t1 = tmp; }
+            return (t0 >= ray.tmin() && t0 <= ray.tmax()) || (t1 >= ray.tmin() && t1 <= ray.tmax());
+        }
+
+        /** @brief Surface area 4 pi r^2. */
+        [[nodiscard]] T area() const noexcept override {
+            return static_cast<T>(T{4} * std::numbers::pi_v<T> * r_ * r_);
+        }
+
+        /** @brief Uniform point on the sphere (z = 1 - 2 u0, phi = 2 pi u1); uv is zero like intersect(). */
+        [[nodiscard]] typename Geometry<T>::SurfaceSample sample_surface(const Vector<T,2>& u) const noexcept override {
+            const T z = T{1} - T{2} * u[0];
+            const T r = static_cast<T>(std::sqrt(std::max(T{0}, T{1} - z * z)));
+            const T phi = static_cast<T>(T{2} * std::numbers::pi_v<T> * u[1]);
+            const Vector<T,3> n{r * static_cast<T>(std::cos(phi)), r * static_cast<T>(std::sin(phi)), z};
+            return {c_ + n * r_, n, Vector<T,2>{}};
+        }
+
     private:
         Vector<T,3> c_{};
         T r_{1};
@@ -0,0 +1,287 @@
+module;
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+export module glimmer.texture;
+
+import glimmer.vector;
+import glimmer.color;
+import glimmer.image;
+import glimmer.half;
+import glimmer.material_property.image; // for AddressMode
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing mip-mapped, tiled textures with compact texel formats and filtered sampling.
+     */
+
+    /** @brief Storage format of texels. */
+    export enum class TexelFormat {
+        unorm8,  ///< 8 bits per channel, linear
+        srgb8,   ///< 8 bits per channel, sRGB-encoded (more precision in dark tones)
+        half     ///< IEEE binary16 per channel (HDR)
+    };
+
+    /** @brief Texture reconstruction filter. */
+    export enum class TextureFilter {
+        nearest,   ///< nearest texel of the closest mip level
+        bilinear,  ///< bilinear within the closest mip level
+        trilinear  ///< bilinear in the two nearest mip levels, blended by level of detail
+    };
+
+    /** @brief Texture construction options. */
+    export struct TextureOptions {
+        TexelFormat format{TexelFormat::srgb8};
+        TextureFilter filter{TextureFilter::trilinear};
+        AddressMode address{AddressMode::Repeat};
+        bool mipmaps{true};
+    };
+
+    namespace texture_detail {
+        /** @brief Edge length of the square texel tiles; a tile of RGBA8 texels is one 64-byte cache line. */
+        inline constexpr std::size_t tile = 4;
+
+        // Morton (Z-order) index of (x, y) within a 4x4 tile
+        [[nodiscard]] constexpr std::size_t morton4(std::size_t x, std::size_t y) noexcept {
+            return (x & 1u) | ((y & 1u) << 1) | ((x & 2u) << 1) | ((y & 2u) << 2);
+        }
+
+        [[nodiscard]] inline float srgb_to_linear(float c) noexcept {
+            return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+
+        [[nodiscard]] inline float linear_to_srgb(float c) noexcept {
+            return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+        }
+    }
+
+    /**
+     * @brief Read-only RGB texture with a mip pyramid, stored in 4x4 Morton-ordered tiles.
+     * @tparam T arithmetic scalar type of UVs and sampled colors
+     * @details Texels are stored as four 8-bit or half channels (the fourth is padding, so every texel is one
+     * aligned load), in 4x4 tiles whose texels follow a Z-order curve. Neighbouring texels, and the 2x2 quads
+     * fetched by bilinear filtering, therefore usually share a cache line, and a texel takes 4 or 8 bytes instead
+     * of 3 * sizeof(T). Mip levels are box-filtered in linear space when the texture is built.
+     *
+     * UVs follow the texel-center convention: texel (i, j) of a w x h level covers [i/w, (i+1)/w) x [j/h, (j+1)/h).
+     * The level of detail comes from a footprint, the UV-space width covered by one sample (for example a pixel's
+     * ray cone at the hit point); a footprint of zero samples the finest level.
+     */
+    export template <Arithmetic T>
+    class Texture {
+    public:
+        using Color3 = Color<T,3>;
+        using Vector2 = Vector<T,2>;
+
+        Texture() = default;
+
+        /** @brief Builds a texture (and its mip pyramid) from a linear RGB image. */
+        explicit Texture(const Image<T,3>& image, const TextureOptions& options = {})
+            : format_{options.format}, filter_{options.filter}, address_{options.address} {
+            if (image.empty()) return;
+            for (std::size_t i = 0; i < 256; ++i) {
+                const float c = static_cast<float>(i) / 255.0f;
+                decode_[i] = format_ == TexelFormat::srgb8 ? texture_detail::srgb_to_linear(c) : c;
+            }
+            std::vector<Color<float,3>> level(image.width() * image.height());
+            for (std::size_t y = 0; y < image.height(); ++y) {
+                for (std::size_t x = 0; x < image.width(); ++x) {
+                    const auto& c = image(x, y);
+                    level[y * image.width() + x] = Color<float,3>{static_cast<float>(c[0]), static_cast<float>(c[1]),
+                                                                  static_cast<float>(c[2])};
+                }
+            }
+            std::size_t w = image.width(), h = image.height();
+            while (true) {
+                store_level_(level, w, h);
+                if (!options.mipmaps || (w == 1 && h == 1)) break;
+                level = downsample_(level, w, h);
+                w = std::max<std::size_t>(w / 2, 1);
+                h = std::max<std::size_t>(h / 2, 1);
+            }
+        }
+
+        [[nodiscard]] bool empty() const noexcept { return levels_.empty(); }
+        /** @brief Width of the finest level. */
+        [[nodiscard]] std::size_t width() const noexcept { return levels_.empty() ? 0 : levels_[0].width; }
+        /** @brief Height of the finest level. */
+        [[nodiscard]] std::size_t height() const noexcept { return levels_.empty() ? 0 : levels_[0].height; }
+        /** @brief Number of mip levels (1 without mip-maps). */
+        [[nodiscard]] std::size_t levels() const noexcept { return levels_.size(); }
+        [[nodiscard]] std::size_t level_width(std::size_t level) const noexcept { return levels_[level].width; }
+        [[nodiscard]] std::size_t level_height(std::size_t level) const noexcept { return levels_[level].height; }
+
+        [[nodiscard]] TexelFormat format() const noexcept { return format_; }
+        [[nodiscard]] TextureFilter filter() const noexcept { return filter_; }
+        void set_filter(TextureFilter f) noexcept { filter_ = f; }
+        [[nodiscard]] AddressMode address_mode() const noexcept { return address_; }
+        void set_address_mode(AddressMode m) noexcept { address_ = m; }
+
+        /** @brief Bytes of texel storage across all levels. */
+        [[nodiscard]] std::size_t memory_bytes() const noexcept { return u8_.size() * 4 + f16_.size() * 8; }
+
+        /** @brief Decoded texel (x, y) of a mip level. */
+        [[nodiscard]] Color3 texel(std::size_t level, std::size_t x, std::size_t y) const noexcept {
+            const Level& l = levels_[level];
+            const std::size_t i = l.offset + ((y / texture_detail::tile) * l.tiles_x + x / texture_detail::tile) *
+                                                 (texture_detail::tile * texture_detail::tile) +
+                                  texture_detail::morton4(x, y);
+            if (format_ == TexelFormat::half) {
+                const std::uint64_t t = f16_[i];
+                return Color3{static_cast<T>(half_to_float(static_cast<std::uint16_t>(t))),
+                              static_cast<T>(half_to_float(static_cast<std::uint16_t>(t >> 16))),
+                              static_cast<T>(half_to_float(static_cast<std::uint16_t>(t >> 32)))};
+            }
+            const std::uint32_t t = u8_[i];
+            return Color3{static_cast<T>(decode_[t & 0xffu]), static_cast<T>(decode_[(t >> 8) & 0xffu]),
+                          static_cast<T>(decode_[(t >> 16) & 0xffu])};
+        }
+
+        /** @brief Level of detail for a UV-space footprint (0 = finest level, may be negative or beyond the last level). */
+        [[nodiscard]] T lod(T footprint) const noexcept {
+            if (!(footprint > T{0}) || levels_.empty()) return T{0};
+            const auto extent = static_cast<T>(std::max(width(), height()));
+            return static_cast<T>(std::log2(static_cast<double>(footprint * extent)));
+        }
+
+        /**
+         * @brief Filtered color at uv.
+         * @param uv texture coordinates (addressed per address_mode() outside [0,1])
+         * @param footprint UV-space width of the sample; selects the mip level
+         */
+        [[nodiscard]] Color3 sample(const Vector2& uv, T footprint = T{0}) const noexcept {
+            if (levels_.empty()) return Color3{T{0}, T{0}, T{0}};
+            const T last = static_cast<T>(levels_.size() - 1);
+            const T l = std::clamp(lod(footprint), T{0}, last);
+            switch (filter_) {
+            case TextureFilter::nearest:
+                return nearest_(nearest_level_(l), uv);
+            case TextureFilter::bilinear:
+                return bilinear_(nearest_level_(l), uv);
+            case TextureFilter::trilinear:
+                break;
+            }
+            const auto l0 = static_cast<std::size_t>(l);
+            const T f = l - static_cast<T>(l0);
+            const Color3 c0 = bilinear_(l0, uv);
+            if (f <= T{0} || l0 + 1 >= levels_.size()) return c0;
+            return c0 * (T{1} - f) + bilinear_(l0 + 1, uv) * f;
+        }
+
+    private:
+        struct Level {
+            std::size_t width{0};
+            std::size_t height{0};
+            std::size_t tiles_x{0};
+            std::size_t offset{0}; // first texel in the storage array
+        };
+
+        [[nodiscard]] std::size_t nearest_level_(T l) const noexcept {
+            return std::min(static_cast<std::size_t>(l + T{0.5}), levels_.size() - 1);
+        }
+
+        // Folds a texel coordinate into [0, n) per the address mode
+        [[nodiscard]] std::size_t fold_(long long i, std::size_t n) const noexcept {
+            const auto nn = static_cast<long long>(n);
+            if (address_ == AddressMode::Repeat) {
+                i %= nn;
+                if (i < 0) i += nn;
+                return static_cast<std::size_t>(i);
+            }
+            return static_cast<std::size_t>(std::clamp(i, 0LL, nn - 1));
+        }
+
+        // Reduces a coordinate to [0,1] (clamp) or [0,1) (repeat) so texel coordinates stay small
+        [[nodiscard]] T wrap_(T u) const noexcept {
+            if (address_ == AddressMode::Repeat) return u - static_cast<T>(std::floor(static_cast<double>(u)));
+            return std::clamp(u, T{0}, T{1});
+        }
+
+        [[nodiscard]] Color3 nearest_(std::size_t level, const Vector2& uv) const noexcept {
+            const Level& l = levels_[level];
+            const auto x = static_cast<long long>(std::floor(static_cast<double>(wrap_(uv[0]) * static_cast<T>(l.width))));
+            const auto y = static_cast<long long>(std::floor(static_cast<double>(wrap_(uv[1]) * static_cast<T>(l.height))));
+            return texel(level, fold_(x, l.width), fold_(y, l.height));
+        }
+
+        [[nodiscard]] Color3 bilinear_(std::size_t level, const Vector2& uv) const noexcept {
+            const Level& l = levels_[level];
+            const T fx = wrap_(uv[0]) * static_cast<T>(l.width) - T{0.5};
+            const T fy = wrap_(uv[1]) * static_cast<T>(l.height) - T{0.5};
+            const T x0f = static_cast<T>(std::floor(static_cast<double>(fx)));
+            const T y0f = static_cast<T>(std::floor(static_cast<double>(fy)));
+            const T ax = fx - x0f, ay = fy - y0f;
+            const auto xi = static_cast<long long>(x0f), yi = static_cast<long long>(y0f);
+            const std::size_t x0 = fold_(xi, l.width), x1 = fold_(xi + 1, l.width);
+            const std::size_t y0 = fold_(yi, l.height), y1 = fold_(yi + 1, l.height);
+            const Color3 top = texel(level, x0, y0) * (T{1} - ax) + texel(level, x1, y0) * ax;
+            const Color3 bottom = texel(level, x0, y1) * (T{1} - ax) + texel(level, x1, y1) * ax;
+            return top * (T{1} - ay) + bottom * ay;
+        }
+
+        // 2x2 box filter; on an odd axis the last texel averages three rows/columns, so no source texel is dropped
+        [[nodiscard]] static std::vector<Color<float,3>> downsample_(const std::vector<Color<float,3>>& src,
+                                                                     std::size_t w, std::size_t h) {
+            const std::size_t dw = std::max<std::size_t>(w / 2, 1), dh = std::max<std::size_t>(h / 2, 1);
+            // Source rows/columns averaged into destination index i along an axis of n texels
+            auto taps = [](std::size_t i, std::size_t n, std::size_t dn) -> std::size_t {
+                if (n == 1) return 1;
+                return i + 1 == dn && n % 2 == 1 ? 3 : 2;
+            };
+            std::vector<Color<float,3>> dst(dw * dh);
+            for (std::size_t y = 0; y < dh; ++y) {
+                const std::size_t ny = taps(y, h, dh);
+                for (std::size_t x = 0; x < dw; ++x) {
+                    const std::size_t nx = taps(x, w, dw);
+                    Color<float,3> sum{0.0f, 0.0f, 0.0f};
+                    for (std::size_t j = 0; j < ny; ++j)
+                        for (std::size_t i = 0; i < nx; ++i) sum += src[(2 * y + j) * w + 2 * x + i];
+                    dst[y * dw + x] = sum * (1.0f / static_cast<float>(nx * ny));
+                }
+            }
+            return dst;
+        }
+
+        void store_level_(const std::vector<Color<float,3>>& texels, std::size_t w, std::size_t h) {
+            constexpr std::size_t tile = texture_detail::tile;
+            Level l{w, h, (w + tile - 1) / tile, u8_.size() + f16_.size()};
+            const std::size_t padded = l.tiles_x * ((h + tile - 1) / tile) * tile * tile;
+            if (format_ == TexelFormat::half) f16_.resize(l.offset + padded, 0);
+            else u8_.resize(l.offset + padded, 0);
+            for (std::size_t y = 0; y < h; ++y) {
+                for (std::size_t x = 0; x < w; ++x) {
+                    const std::size_t i = l.offset + ((y / tile) * l.tiles_x + x / tile) * (tile * tile) +
+                                          texture_detail::morton4(x, y);
+                    const auto& c = texels[y * w + x];
+                    if (format_ == TexelFormat::half) {
+                        f16_[i] = std::uint64_t{float_to_half(c[0])} | (std::uint64_t{float_to_half(c[1])} << 16) |
+                                  (std::uint64_t{float_to_half(c[2])} << 32) |
+                                  (std::uint64_t{float_to_half(1.0f)} << 48);
+                    } else {
+                        u8_[i] = encode_u8_(c[0]) | (encode_u8_(c[1]) << 8) | (encode_u8_(c[2]) << 16) | 0xff000000u;
+                    }
+                }
+            }
+            levels_.push_back(l);
+        }
+
+        [[nodiscard]] std::uint32_t encode_u8_(float c) const noexcept {
+            c = std::clamp(c, 0.0f, 1.0f);
+            if (format_ == TexelFormat::srgb8) c = texture_detail::linear_to_srgb(c);
+            return static_cast<std::uint32_t>(c * 255.0f + 0.5f);
+        }
+
+        std::vector<Level> levels_{};
+        std::vector<std::uint32_t> u8_{};   // RGBA8 texels (unorm8, srgb8)
+        std::vector<std::uint64_t> f16_{};  // RGBA16F texels (half)
+        std::array<float,256> decode_{};    // 8-bit code -> linear value
+        TexelFormat format_{TexelFormat::srgb8};
+        TextureFilter filter_{TextureFilter::trilinear};
+        AddressMode address_{AddressMode::Repeat};
+    };
+}
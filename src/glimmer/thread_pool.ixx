@@ -0,0 +1,165 @@
+module;
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+export module glimmer.thread_pool;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module providing a persistent thread pool with dynamic load balancing.
+     */
+
+    namespace pool_detail {
+        inline constexpr std::size_t no_participant = std::numeric_limits<std::size_t>::max();
+        // Participant id of the job running on this thread, so nested parallel_for calls run inline
+        // instead of deadlocking.
+        inline thread_local std::size_t current_participant = no_participant;
+    }
+
+    /**
+     * @brief Persistent pool of worker threads executing index-space jobs.
+     * @details Workers are created once and reused across parallel_for() calls, so per-frame rendering does not
+     * spawn threads. Work items are handed out through a shared atomic counter: each participant grabs the next
+     * index as soon as it finishes the previous one, which balances uneven item costs. The calling thread
+     * participates as well, so a pool with concurrency N owns N-1 worker threads.
+     */
+    export class ThreadPool {
+    public:
+        /**
+         * @brief Creates a pool.
+         * @param concurrency total number of participants including the calling thread; 0 selects
+         * std::thread::hardware_concurrency() (or 4 if unknown)
+         */
+        explicit ThreadPool(std::size_t concurrency = 0) {
+            if (concurrency == 0) {
+                const unsigned hw = std::thread::hardware_concurrency();
+                concurrency = hw ? hw : 4;
+            }
+            workers_.reserve(concurrency - 1);
+            for (std::size_t i = 0; i + 1 < concurrency; ++i) {
+                workers_.emplace_back([this, i] { worker_loop_(i); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lock{mutex_};
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for (auto& w : workers_) w.join();
+        }
+
+        /** @brief Number of participants in a parallel_for (worker threads + calling thread). */
+        [[nodiscard]] std::size_t concurrency() const noexcept { return workers_.size() + 1; }
+
+        /**
+         * @brief Runs fn(index, participant) for every index in [0, count) and blocks until all are done.
+         * @param count number of work items
+         * @param fn callable `void(std::size_t index, std::size_t participant)`; participant is in
+         * [0, concurrency()) and identifies the executing thread for the duration of the call (useful for
+         * per-thread scratch storage)
+         * @details Calls from different threads are serialized. Calls from inside a job run inline on the
+         * current thread. The first exception thrown by fn is rethrown after all items have been processed.
+         */
+        template <class Fn>
+        void parallel_for(std::size_t count, Fn&& fn) {
+            if (count == 0) return;
+            const std::size_t nested = pool_detail::current_participant;
+            if (workers_.empty() || nested != pool_detail::no_participant || count == 1) {
+                const std::size_t participant = nested != pool_detail::no_participant ? nested : workers_.size();
+                for (std::size_t i = 0; i < count; ++i) fn(i, participant);
+                return;
+            }
+
+            std::lock_guard submit{submit_mutex_};
+            std::function<void(std::size_t, std::size_t)> job = [&fn](std::size_t i, std::size_t p) { fn(i, p); };
+            {
+                std::lock_guard lock{mutex_};
+                job_ = &job;
+                count_ = count;
+                next_.store(0, std::memory_order_relaxed);
+                pending_ = workers_.size();
+                error_ = nullptr;
+                ++generation_;
+            }
+            wake_.notify_all();
+
+            run_items_(workers_.size());
+
+            std::unique_lock lock{mutex_};
+            done_.wait(lock, [this] { return pending_ == 0; });
+            job_ = nullptr;
+            if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+
+        /**
+         * @brief Process-wide default pool sized to the hardware concurrency.
+         * @details Created on first use and shared by renderers unless they are given a dedicated pool.
+         */
+        [[nodiscard]] static const std::shared_ptr<ThreadPool>& shared() {
+            static const std::shared_ptr<ThreadPool> pool = std::make_shared<ThreadPool>();
+            return pool;
+        }
+
+    private:
+        void worker_loop_(std::size_t participant) {
+            std::size_t seen = 0;
+            while (true) {
+                {
+                    std::unique_lock lock{mutex_};
+                    wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                    if (stop_) return;
+                    seen = generation_;
+                }
+                run_items_(participant);
+                {
+                    std::lock_guard lock{mutex_};
+                    if (--pending_ == 0) done_.notify_one();
+                }
+            }
+        }
+
+        void run_items_(std::size_t participant) {
+            const auto* job = job_;
+            const std::size_t count = count_;
+            pool_detail::current_participant = participant;
+            for (std::size_t i = next_.fetch_add(1, std::memory_order_relaxed); i < count;
+                 i = next_.fetch_add(1, std::memory_order_relaxed)) {
+                try {
+                    (*job)(i, participant);
+                } catch (...) {
+                    std::lock_guard lock{mutex_};
+                    if (!error_) error_ = std::current_exception();
+                }
+            }
+            pool_detail::current_participant = pool_detail::no_participant;
+        }
+
+        std::vector<std::thread> workers_{};
+        std::mutex submit_mutex_{};
+        std::mutex mutex_{};
+        std::condition_variable wake_{};
+        std::condition_variable done_{};
+        const std::function<void(std::size_t, std::size_t)>* job_{};
+        std::size_t count_{};
+        std::atomic<std::size_t> next_{0};
+        std::size_t pending_{};
+        std::size_t generation_{};
+        std::exception_ptr error_{};
+        bool stop_{false};
+    };
+}
@@ -0,0 +1,76 @@
+module;
+#include <algorithm>
+#include <cstddef>
+
+export module glimmer.tile;
+
+namespace glimmer {
+    /**
+     * @file
+     * @brief C++23 module splitting an image into fixed-size tiles for parallel rendering.
+     */
+
+    /** @brief Rectangular image region [x0, x1) x [y0, y1) with its linear index in the grid. */
+    export struct Tile {
+        std::size_t x0{};
+        std::size_t y0{};
+        std::size_t x1{};
+        std::size_t y1{};
+        std::size_t index{};
+
+        /** @brief Width in pixels. */
+        [[nodiscard]] constexpr std::size_t width() const noexcept { return x1 - x0; }
+        /** @brief Height in pixels. */
+        [[nodiscard]] constexpr std::size_t height() const noexcept { return y1 - y0; }
+    };
+
+    /**
+     * @brief Row-major grid of square tiles covering a width x height image.
+     * @details Tiles on the right and bottom borders are clipped to the image. The tile index is stable for a given
+     * image size and tile size, so it can be used to derive per-tile RNG seeds independent of scheduling order.
+     */
+    export class TileGrid {
+    public:
+        /** @brief Default tile edge length in pixels. */
+        static constexpr std::size_t default_tile_size = 32;
+
+        /**
+         * @brief Creates a grid for an image.
+         * @param width image width in pixels
+         * @param height image height in pixels
+         * @param tile_size tile edge length in pixels (0 is treated as 1)
+         */
+        constexpr TileGrid(std::size_t width, std::size_t height, std::size_t tile_size = default_tile_size) noexcept
+            : width_{width}, height_{height}, size_{std::max<std::size_t>(tile_size, 1)},
+              tiles_x_{(width + size_ - 1) / size_}, tiles_y_{(height + size_ - 1) / size_} {}
+
+        /** @brief Image width in pixels. */
+        [[nodiscard]] constexpr std::size_t width() const noexcept { return width_; }
+        /** @brief Image height in pixels. */
+        [[nodiscard]] constexpr std::size_t height() const noexcept { return height_; }
+        /** @brief Tile edge length in pixels. */
+        [[nodiscard]] constexpr std::size_t tile_size() const noexcept { return size_; }
+        /** @brief Number of tile columns. */
+        [[nodiscard]] constexpr std::size_t tiles_x() const noexcept { return tiles_x_; }
+        /** @brief Number of tile rows. */
+        [[nodiscard]] constexpr std::size_t tiles_y() const noexcept { return tiles_y_; }
+        /** @brief Total number of tiles. */
+        [[nodiscard]] constexpr std::size_t count() const noexcept { return tiles_x_ * tiles_y_; }
+
+        /** @brief Returns the tile with the given linear index (row-major, index < count()). */
+        [[nodiscard]] constexpr Tile tile(std::size_t index) const noexcept {
+            const std::size_t tx = index % tiles_x_;
+            const std::size_t ty = index / tiles_x_;
+            const std::size_t x0 = tx * size_;
+            const std::size_t y0 = ty * size_;
+            return Tile{x0, y0, std::min(x0 + size_, width_), std::min(y0 + size_, height_), index};
+        }
+
+    private:
+        std::size_t width_;
+        std::size_t height_;
+        std::size_t size_;
+        std::size_t tiles_x_;
+        std::size_t tiles_y_;
+    };
+}
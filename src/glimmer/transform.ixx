@@ -2,6 +2,7 @@ module;
 #include <cmath>
 #include <cstddef>
 #include <ostream>
+#include <span>
 #include <stdexcept>
 
 /**
@@ -13,6 +14,7 @@ export module glimmer.transform;
 import glimmer.vector;
 import glimmer.matrix;
 import glimmer.quaternion;
+import glimmer.affine;
 
 namespace glimmer
 {
@@ -20,6 +22,8 @@ namespace glimmer
      * @brief Rigid/affine transform with cached inverse.
      * @tparam T arithmetic scalar type
      * @details Stores a 4x4 matrix and its inverse. Provides composition and application to points/dirs.
+     * Inverses of affine matrices are computed in closed form (from_trs() builds its inverse directly from
+     * the translation, quaternion and scale); bulk transforms of point arrays go through apply_points().
      */
     export template <Arithmetic T>
     class Transform
@@ -43,6 +47,11 @@ namespace glimmer
         /** @brief Returns inverse matrix. */
         [[nodiscard]] constexpr const Mat4& inverse_matrix() const noexcept { return inv_; }
 
+        /** @brief Forward map as a compact 3x4 affine matrix (drops the projective row). */
+        [[nodiscard]] constexpr Affine3<T> affine() const noexcept { return Affine3<T>::from_matrix(m_); }
+        /** @brief Inverse map as a compact 3x4 affine matrix. */
+        [[nodiscard]] constexpr Affine3<T> inverse_affine() const noexcept { return Affine3<T>::from_matrix(inv_); }
+
         /** @brief Returns the inverse transform (swapping matrices). */
         [[nodiscard]] constexpr Transform inverse() const noexcept { return Transform{inv_, m_}; }
 
@@ -74,6 +83,22 @@ namespace glimmer
             return r;
         }
 
+        /**
+         * @brief Applies to an array of points (affine part only); in and out may be the same span.
+         * @details Uses the SIMD batch kernel of Affine3::apply_points() rather than calling apply_point() per
+         * element.
+         */
+        void apply_points(std::span<const Vector<T, 3>> in, std::span<Vector<T, 3>> out) const noexcept
+        {
+            affine().apply_points(in, out);
+        }
+
+        /** @brief Applies to an array of directions; in and out may be the same span. */
+        void apply_directions(std::span<const Vector<T, 3>> in, std::span<Vector<T, 3>> out) const noexcept
+        {
+            affine().apply_directions(in, out);
+        }
+
         /**
          * @brief Transforms a normal using the inverse-transpose 3x3 of the transform.
          * @details Appropriate for non-uniform scaling.
@@ -175,7 +200,7 @@ namespace glimmer
         {
             if (aspect <= T{0}) throw std::invalid_argument("aspect must be > 0");
             if (!(z_near > T{0}) || !(z_far > z_near)) throw std::invalid_argument("invalid near/far");
-            T f = T{1} / static_cast<T>(std::tan(static_cast<long double>(fov_y) / 2.0L));
+            T f = T{1} / static_cast<T>(std::tan(fov_y / T{2}));
             Matrix<T,4,4> M{};
             M(0,0) = f / aspect;
             M(1,1) = f;
@@ -9,6 +9,16 @@ module;
 #include <stdexcept>
 #include <type_traits>
 
+// Hand-written SSE/NEON kernels for Vector<float,3> and Vector<float,4>; define GLIMMER_NO_SIMD to use the
+// portable scalar code everywhere.
+#if !defined(GLIMMER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define GLIMMER_SIMD_SSE 1
+#include <immintrin.h>
+#elif !defined(GLIMMER_NO_SIMD) && defined(__ARM_NEON) && defined(__aarch64__)
+#define GLIMMER_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
 /**
  * @file
  * @brief C++23 module providing glimmer::Vector and related algorithms.
@@ -31,6 +41,75 @@ namespace glimmer
     export template <class T>
     concept Arithmetic = std::is_arithmetic_v<T>;
 
+    /** @brief True when dot/cross/norm of Vector<float,3|4> use the SSE or NEON kernels. */
+    export inline constexpr bool simd_kernels_enabled =
+#if defined(GLIMMER_SIMD_SSE) || defined(GLIMMER_SIMD_NEON)
+        true;
+#else
+        false;
+#endif
+
+    namespace simd_detail
+    {
+        // Lane 3 of a 3-component load is zero so that it does not contribute to horizontal sums.
+#if defined(GLIMMER_SIMD_SSE)
+        [[nodiscard]] inline __m128 load(const float* p, std::size_t n) noexcept
+        {
+            return n == 4 ? _mm_loadu_ps(p) : _mm_setr_ps(p[0], p[1], p[2], 0.0f);
+        }
+
+        [[nodiscard]] inline float hsum(__m128 v) noexcept
+        {
+            __m128 sh = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+            __m128 s = _mm_add_ps(v, sh);
+            sh = _mm_movehl_ps(sh, s);
+            return _mm_cvtss_f32(_mm_add_ss(s, sh));
+        }
+
+        [[nodiscard]] inline float dot(const float* a, const float* b, std::size_t n) noexcept
+        {
+            return hsum(_mm_mul_ps(load(a, n), load(b, n)));
+        }
+
+        inline void cross(const float* a, const float* b, float* out) noexcept
+        {
+            const __m128 va = load(a, 3);
+            const __m128 vb = load(b, 3);
+            const __m128 a_yzx = _mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 0, 2, 1));
+            const __m128 b_yzx = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 0, 2, 1));
+            const __m128 c = _mm_sub_ps(_mm_mul_ps(va, b_yzx), _mm_mul_ps(a_yzx, vb));
+            alignas(16) float r[4];
+            _mm_store_ps(r, _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+            out[0] = r[0]; out[1] = r[1]; out[2] = r[2];
+        }
+#elif defined(GLIMMER_SIMD_NEON)
+        [[nodiscard]] inline float32x4_t load(const float* p, std::size_t n) noexcept
+        {
+            if (n == 4) return vld1q_f32(p);
+            const float tmp[4] = {p[0], p[1], p[2], 0.0f};
+            return vld1q_f32(tmp);
+        }
+
+        [[nodiscard]] inline float dot(const float* a, const float* b, std::size_t n) noexcept
+        {
+            return vaddvq_f32(vmulq_f32(load(a, n), load(b, n)));
+        }
+
+        inline void cross(const float* a, const float* b, float* out) noexcept
+        {
+            // (y, z, x) rotations via table-free lane moves
+            const float32x4_t va = load(a, 3);
+            const float32x4_t vb = load(b, 3);
+            const float a_yzx_s[4] = {a[1], a[2], a[0], 0.0f};
+            const float b_yzx_s[4] = {b[1], b[2], b[0], 0.0f};
+            const float32x4_t c = vsubq_f32(vmulq_f32(va, vld1q_f32(b_yzx_s)), vmulq_f32(vld1q_f32(a_yzx_s), vb));
+            float r[4];
+            vst1q_f32(r, c);
+            out[0] = r[1]; out[1] = r[2]; out[2] = r[0];
+        }
+#endif
+    }
+
     /**
      * @brief Fixed-size geometric vector.
      * @tparam T Arithmetic scalar type.
@@ -190,19 +269,18 @@ namespace glimmer
 
         /**
              * @brief Computes the Euclidean norm (length).
-             * @return ||v||_2. For floating T, precise sqrt; for integral T, rounded.
+             * @return ||v||_2. For floating T, computed in T; for integral T, computed in double and rounded.
              */
         [[nodiscard]] constexpr auto norm() const noexcept -> T
         {
-            long double sum = 0.0L;
-            for (size_type i = 0; i < N; ++i) sum += static_cast<long double>(data_[i]) * static_cast<long double>(data_
-                [i]);
             if constexpr (std::is_floating_point_v<T>)
             {
-                return static_cast<T>(std::sqrt(sum));
+                return std::sqrt(dot(*this, *this));
             }
             else
             {
+                double sum = 0.0;
+                for (size_type i = 0; i < N; ++i) sum += static_cast<double>(data_[i]) * static_cast<double>(data_[i]);
                 return static_cast<T>(std::llround(std::sqrt(sum)));
             }
         }
@@ -376,6 +454,12 @@ namespace glimmer
     export template <Arithmetic T, std::size_t N>
     [[nodiscard]] constexpr T dot(const Vector<T, N>& a, const Vector<T, N>& b) noexcept
     {
+#if defined(GLIMMER_SIMD_SSE) || defined(GLIMMER_SIMD_NEON)
+        if constexpr (std::is_same_v<T, float> && (N == 3 || N == 4))
+        {
+            if !consteval { return simd_detail::dot(a.data(), b.data(), N); }
+        }
+#endif
         T sum = static_cast<T>(0);
         for (std::size_t i = 0; i < N; ++i) sum += a[i] * b[i];
         return sum;
@@ -391,6 +475,17 @@ namespace glimmer
     export template <Arithmetic T>
     [[nodiscard]] constexpr Vector<T, 3> cross(const Vector<T, 3>& a, const Vector<T, 3>& b) noexcept
     {
+#if defined(GLIMMER_SIMD_SSE) || defined(GLIMMER_SIMD_NEON)
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if !consteval
+            {
+                Vector<T, 3> r{};
+                simd_detail::cross(a.data(), b.data(), r.data());
+                return r;
+            }
+        }
+#endif
         return Vector<T, 3>{
             a[1] * b[2] - a[2] * b[1],
             a[2] * b[0] - a[0] * b[2],
@@ -11,13 +11,41 @@ import glimmer.material;
 import glimmer.material_property.checkerboard;
 import glimmer.renderer;
 import glimmer.renderer_path_tracer;
+import glimmer.render_stats;
+import glimmer.partial_frame;
+import glimmer.aov;
+import glimmer.denoise;
+import glimmer.render_session;
 import glimmer.ppm;
+import glimmer.pfm;
 import glimmer.quaternion;
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <numbers>
+#include <string>
+
+// Parses "first:count" into a sample or tile range; count may be omitted to mean "through the end"
+static bool parse_range(const std::string& arg, std::size_t& first, std::size_t& count) {
+    const auto colon = arg.find(':');
+    char* end = nullptr;
+    first = std::strtoull(arg.c_str(), &end, 10);
+    if (colon == std::string::npos) return *end == '\0';
+    if (end != arg.c_str() + colon) return false;
+    if (colon + 1 == arg.size()) { count = glimmer::FrameRange::all; return true; }
+    count = std::strtoull(arg.c_str() + colon + 1, &end, 10);
+    return *end == '\0';
+}
 
-int main() {
+// Usage: glimmer [--spp N] [--denoise | --frames N] [--hdr | --tonemap reinhard|aces]
+//                [--partial out.part [--tiles first:count] [--samples first:count]]
+// Without --partial the whole frame is written to render.ppm; with it only the given tiles and sample indices
+// are rendered, to be combined with the other parts by glimmer_merge. --denoise filters the frame with
+// AtrousDenoiser, guided by the albedo, normal and depth AOVs, before it is written. --frames renders a camera
+// orbit of N frames to frame_0000.ppm, frame_0001.ppm, ... with a RenderSession. --hdr writes the unclamped
+// radiance to render.pfm instead; --tonemap compresses highlights in the 8-bit output instead of clipping them.
+int main(int argc, char** argv) {
     using T = double;
     using glimmer::Vector;
     using glimmer::Scene;
@@ -25,7 +53,6 @@ int main() {
     using glimmer::Sphere;
     using glimmer::Camera;
     using glimmer::Transform;
-    using glimmer::Image;
     using glimmer::Material;
 
     // Image settings
@@ -90,18 +117,106 @@ int main() {
     scene.add_object(mirror);
     scene.add_object(ground);
     scene.add_object(light);
+    scene.build_bvh();
+
+    std::string partial_path;
+    glimmer::FrameRange range{};
+    std::size_t spp = 256;
+    std::size_t frames = 0;
+    bool denoise = false;
+    bool hdr = false;
+    glimmer::U8Encoding encoding{};
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        bool ok = has_value;
+        if (arg == "--partial" && has_value) partial_path = argv[++i];
+        else if (arg == "--tiles" && has_value) ok = parse_range(argv[++i], range.first_tile, range.tile_count);
+        else if (arg == "--samples" && has_value) ok = parse_range(argv[++i], range.first_sample, range.sample_count);
+        else if (arg == "--spp" && has_value) ok = (spp = std::strtoull(argv[++i], nullptr, 10)) > 0;
+        else if (arg == "--frames" && has_value) ok = (frames = std::strtoull(argv[++i], nullptr, 10)) > 0;
+        else if (arg == "--denoise") { denoise = true; ok = true; }
+        else if (arg == "--hdr") { hdr = true; ok = true; }
+        else if (arg == "--tonemap" && has_value) {
+            const std::string curve = argv[++i];
+            if (curve == "reinhard") encoding.tonemap = glimmer::Tonemap::reinhard;
+            else if (curve == "aces") encoding.tonemap = glimmer::Tonemap::aces;
+            else ok = false;
+        }
+        else ok = false;
+        if (!ok) {
+            std::cerr << "usage: " << argv[0]
+                      << " [--spp N] [--denoise | --frames N] [--hdr | --tonemap reinhard|aces]"
+                      << " [--partial out.part [--tiles first:count] [--samples first:count]]\n";
+            return 2;
+        }
+    }
 
-    // Render
-    Image<T,3> img{width, height};
-    glimmer::RendererPathTracer<T> renderer;
-    renderer.render(scene, img, width, height);
+    // Next-event estimation samples the small light directly, so far fewer samples than the default suffice
+    glimmer::RendererPathTracer<T> renderer{spp};
+    if (!partial_path.empty()) {
+        const auto part = renderer.render_partial(scene, width, height, range);
+        if (!glimmer::save_partial_frame(part, partial_path)) {
+            std::cerr << "Failed to write partial frame to " << partial_path << "\n";
+            return 1;
+        }
+        std::cout << "Wrote tiles " << part.range.first_tile << "+" << part.range.tile_count << ", samples "
+                  << part.range.first_sample << "+" << part.range.sample_count << " to " << partial_path << "\n";
+        return 0;
+    }
 
-    // Save to PPM
-    const char* out_path = "render.ppm";
-    if (glimmer::save_ppm(img, out_path)) {
-        std::cout << "Wrote PPM image to " << out_path << " (" << width << "x" << height << ")\n";
+    if (frames > 0) {
+        // One full orbit around the target; frame N is written while frame N + 1 renders
+        const char* pattern = "frame_####.ppm";
+        glimmer::RenderSession<T> session{scene, renderer, width, height, glimmer::ppm_sequence_output<T>(pattern, encoding)};
+        const T radius = (eye - target).norm();
+        for (std::size_t f = 0; f < frames; ++f) {
+            const T a = T{2} * std::numbers::pi_v<T> * static_cast<T>(f) / static_cast<T>(frames);
+            glimmer::FrameUpdate<T> update;
+            update.camera = Camera<T>::from_look_at(target + Vector<T,3>{radius * std::sin(a), 0, radius * std::cos(a)},
+                                                    target, up, cam.fov_y(), cam.aspect(), cam.z_near(), cam.z_far());
+            session.render_frame(update);
+            std::cout << "Frame " << f << " rendered in " << session.stats().seconds << " s\n";
+        }
+        if (!session.finish()) {
+            std::cerr << "Failed to write the frames to " << pattern << "\n";
+            return 1;
+        }
+        std::cout << "Wrote " << frames << " frames to " << pattern << " (" << width << "x" << height
+                  << "); waited " << session.output_wait_seconds() << " s for output\n";
+        return 0;
+    }
+
+    // Render straight into the PPM file; tiles are encoded and written as they finish. The denoiser needs the whole
+    // frame, so with --denoise the image and its AOVs are kept in memory and saved once filtered.
+    const char* out_path = hdr ? "render.pfm" : "render.ppm";
+    bool written = false;
+    if (denoise) {
+        glimmer::Image<T,3> img;
+        glimmer::AovImages<T> aovs;
+        renderer.render(scene, img, aovs, width, height);
+        glimmer::AtrousDenoiser<T>{}.apply(img, aovs);
+        written = hdr ? glimmer::save_pfm(img, out_path) : glimmer::save_ppm(img, out_path, encoding);
+    } else if (hdr) {
+        glimmer::PfmStreamSink<T> sink{out_path};
+        renderer.render(scene, sink, width, height);
+        written = sink.good();
+    } else {
+        glimmer::PpmStreamSink<T> sink{out_path, true, encoding};
+        renderer.render(scene, sink, width, height);
+        written = sink.good();
+    }
+    if (written) {
+        std::cout << "Wrote image to " << out_path << " (" << width << "x" << height << ")\n";
+        const glimmer::RenderStats& stats = renderer.stats();
+        std::cout << "Rendered in " << stats.seconds << " s";
+        if constexpr (glimmer::render_stats_enabled) {
+            std::cout << " (" << stats.rays_per_second() * 1e-6 << " Mrays/s, slowest tile "
+                      << stats.max_tile_seconds() << " s)";
+        }
+        std::cout << "\n";
     } else {
-        std::cerr << "Failed to write PPM image to " << out_path << "\n";
+        std::cerr << "Failed to write image to " << out_path << "\n";
         return 1;
     }
 
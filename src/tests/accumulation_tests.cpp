@@ -0,0 +1,80 @@
+import glimmer.accumulation;
+import glimmer.color;
+import glimmer.image;
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+using glimmer::AccumulationBuffer;
+using glimmer::Color;
+using glimmer::Image;
+
+static void test_mean_and_counts() {
+    AccumulationBuffer<double> acc{3, 2};
+    assert(acc.width() == 3 && acc.height() == 2 && !acc.empty());
+    assert(acc.samples(1, 1) == 0);
+    auto m0 = acc.mean(1, 1);
+    assert(m0[0] == 0.0 && m0[1] == 0.0 && m0[2] == 0.0);
+    acc.add_sample(1, 1, Color<double,3>{1.0, 2.0, 3.0});
+    acc.add_sample(1, 1, Color<double,3>{3.0, 2.0, 1.0});
+    assert(acc.samples(1, 1) == 2);
+    auto m = acc.mean(1, 1);
+    assert(std::abs(m[0] - 2.0) < 1e-12 && std::abs(m[1] - 2.0) < 1e-12 && std::abs(m[2] - 2.0) < 1e-12);
+    assert(acc.total_samples() == 2);
+}
+
+static void test_variance_and_relative_error() {
+    AccumulationBuffer<double> acc{1, 1};
+    assert(acc.relative_error(0, 0) == 1.0);
+    // Constant samples have zero variance
+    for (int i = 0; i < 4; ++i) acc.add_sample(0, 0, Color<double,3>{0.5, 0.5, 0.5});
+    assert(acc.luminance_variance(0, 0) < 1e-12);
+    assert(acc.relative_error(0, 0) < 1e-6);
+    // Gray samples 0 and 2: luminance variance 2 (unbiased), mean 1
+    acc.clear();
+    acc.add_sample(0, 0, Color<double,3>{0, 0, 0});
+    acc.add_sample(0, 0, Color<double,3>{2, 2, 2});
+    assert(std::abs(acc.luminance_variance(0, 0) - 2.0) < 1e-9);
+    assert(std::abs(acc.relative_error(0, 0) - 1.0) < 1e-9); // sqrt(2/2) / 1
+}
+
+static void test_resolve() {
+    AccumulationBuffer<float> acc{2, 2};
+    acc.add_sample(0, 1, Color<float,3>{4.0f, 0.0f, 0.0f});
+    acc.add_sample(0, 1, Color<float,3>{2.0f, 0.0f, 0.0f});
+    Image<float,3> img;
+    acc.resolve(img);
+    assert(img.width() == 2 && img.height() == 2);
+    assert(std::abs(img(0, 1)[0] - 3.0f) < 1e-6f);
+    assert(img(1, 0)[0] == 0.0f);
+}
+
+static void test_merge_matches_single_buffer() {
+    AccumulationBuffer<double> all{3, 2}, part{2, 1}, whole{3, 2};
+    const Color<double,3> a{1.0, 0.5, 0.0}, b{0.0, 2.0, 1.0}, c{3.0, 3.0, 3.0};
+    all.add_sample(1, 1, a);
+    all.add_sample(1, 1, b);
+    all.add_sample(2, 1, c);
+    whole.add_sample(1, 1, a);
+    part.add_sample(0, 0, b);
+    part.add_sample(1, 0, c);
+    whole.merge(part, 1, 1);
+    assert(whole.samples(1, 1) == 2 && whole.samples(2, 1) == 1 && whole.total_samples() == 3);
+    for (int k = 0; k < 3; ++k) assert(std::abs(whole.mean(1, 1)[k] - all.mean(1, 1)[k]) < 1e-12);
+    assert(std::abs(whole.luminance_variance(1, 1) - all.luminance_variance(1, 1)) < 1e-12);
+    const auto p = whole.pixel_sums(2, 1);
+    assert(p.count == 1 && p.sum[0] == 3.0);
+    bool threw = false;
+    try { whole.merge(part, 2, 1); } catch (const std::out_of_range&) { threw = true; }
+    assert(threw);
+}
+
+int main() {
+    test_mean_and_counts();
+    test_variance_and_relative_error();
+    test_resolve();
+    test_merge_matches_single_buffer();
+    std::cout << "All accumulation tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,83 @@
+import glimmer.affine;
+import glimmer.transform;
+import glimmer.quaternion;
+import glimmer.matrix;
+import glimmer.vector;
+import glimmer.aabb;
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+using glimmer::Affine3;
+using glimmer::Transform;
+using V3 = glimmer::Vector<double,3>;
+
+static bool close(const V3& a, const V3& b, double eps = 1e-12)
+{
+    return std::abs(a[0] - b[0]) < eps && std::abs(a[1] - b[1]) < eps && std::abs(a[2] - b[2]) < eps;
+}
+
+static Transform<double> sample_transform()
+{
+    return Transform<double>::from_trs(V3{1.0, -2.0, 0.5}, glimmer::Quaternion<double>::from_axis_angle(V3{1, 2, 3}.normalized(), 0.7),
+                                       V3{2.0, 0.5, 1.5});
+}
+
+static void test_matches_transform()
+{
+    const auto xf = sample_transform();
+    const auto a = Affine3<double>::from_matrix(xf.matrix());
+    const V3 p{0.3, -1.2, 4.0};
+    assert(close(a.apply_point(p), xf.apply_point(p)));
+    assert(close(a.apply_direction(p), xf.apply_direction(p)));
+    // Normals: inverse transpose
+    const auto inv = Affine3<double>::from_matrix(xf.inverse_matrix());
+    assert(close(inv.apply_transposed(p), xf.apply_normal(p)));
+    assert(std::abs(a.determinant() - 1.5) < 1e-12);
+    const auto m = a.matrix();
+    for (std::size_t r = 0; r < 4; ++r)
+        for (std::size_t c = 0; c < 4; ++c) assert(std::abs(m(r, c) - xf.matrix()(r, c)) < 1e-15);
+}
+
+static void test_inverse_and_composition()
+{
+    const auto a = Affine3<double>::from_matrix(sample_transform().matrix());
+    const auto inv = a.inverse();
+    const V3 p{-0.7, 2.0, 1.1};
+    assert(close(inv.apply_point(a.apply_point(p)), p));
+    assert(close((a * inv).apply_point(p), p));
+    const auto b = Affine3<double>::from_matrix(Transform<double>::from_trs(V3{0, 1, 0}, glimmer::Quaternion<double>{},
+                                                                             V3{3, 3, 3}).matrix());
+    assert(close((a * b).apply_point(p), a.apply_point(b.apply_point(p))));
+    assert(Affine3<double>{} * a == a);
+
+    bool threw = false;
+    try { (void)Affine3<double>{std::array<double,12>{1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0}}.inverse(); }
+    catch (const std::domain_error&) { threw = true; }
+    assert(threw);
+}
+
+static void test_bounds_contain_corners()
+{
+    const auto a = Affine3<double>::from_matrix(sample_transform().matrix());
+    const glimmer::AABB<double> box{V3{-1, 0, 2}, V3{1, 3, 2.5}};
+    const auto wb = a.apply_bounds(box);
+    glimmer::AABB<double> corners;
+    for (int i = 0; i < 8; ++i) {
+        const V3 c{i & 1 ? 1.0 : -1.0, i & 2 ? 3.0 : 0.0, i & 4 ? 2.5 : 2.0};
+        corners.expand(a.apply_point(c));
+    }
+    // The projected extents are exactly the bounds of the transformed corners
+    assert(close(wb.min(), corners.min(), 1e-12) && close(wb.max(), corners.max(), 1e-12));
+    assert(a.apply_bounds(glimmer::AABB<double>{}).empty());
+}
+
+int main()
+{
+    test_matches_transform();
+    test_inverse_and_composition();
+    test_bounds_contain_corners();
+    std::cout << "All affine tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,138 @@
+import glimmer.arena;
+import glimmer.scene;
+import glimmer.scene_object;
+import glimmer.sphere;
+import glimmer.material;
+import glimmer.transform;
+import glimmer.color;
+import glimmer.vector;
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+
+using glimmer::Arena;
+using glimmer::ArenaScope;
+using glimmer::ArenaVector;
+
+static bool aligned(const void* p, std::size_t align)
+{
+    return reinterpret_cast<std::uintptr_t>(p) % align == 0;
+}
+
+static void test_allocate_and_align()
+{
+    Arena arena{256};
+    void* a = arena.allocate(3, 1);
+    void* b = arena.allocate(8, 8);
+    void* c = arena.allocate(16, 64);
+    assert(a && b && c);
+    assert(aligned(b, 8) && aligned(c, 64));
+    assert(static_cast<std::byte*>(b) >= static_cast<std::byte*>(a) + 3);
+    // Requests larger than the block size get a block of their own
+    void* big = arena.allocate(1000, 16);
+    assert(aligned(big, 16));
+    assert(arena.block_count() == 2);
+    assert(arena.bytes_reserved() >= 1256);
+    arena.release();
+    assert(arena.block_count() == 0 && arena.bytes_reserved() == 0);
+}
+
+static void test_rewind_reuses_memory()
+{
+    Arena arena{1024};
+    const auto m = arena.mark();
+    int* first = arena.allocate_array<int>(16);
+    arena.rewind(m);
+    int* second = arena.allocate_array<int>(16);
+    assert(first == second);
+
+    arena.reset();
+    for (int i = 0; i < 100; ++i) (void)arena.allocate(100);
+    const std::size_t blocks = arena.block_count();
+    for (int round = 0; round < 5; ++round) {
+        arena.reset();
+        for (int i = 0; i < 100; ++i) (void)arena.allocate(100);
+    }
+    assert(arena.block_count() == blocks);
+}
+
+static void test_scope_and_vector()
+{
+    Arena arena{512};
+    const auto before = arena.mark();
+    {
+        ArenaScope outer{arena};
+        ArenaVector<int> v{glimmer::ArenaAllocator<int>{arena}};
+        v.reserve(64);
+        {
+            ArenaScope inner{arena};
+            ArenaVector<double> scratch(32, 1.0, glimmer::ArenaAllocator<double>{arena});
+            assert(scratch.size() == 32 && scratch[31] == 1.0);
+        }
+        for (int i = 0; i < 64; ++i) v.push_back(i); // within the reserved capacity
+        assert(v[63] == 63);
+    }
+    const auto after = arena.mark();
+    assert(after.block == before.block && after.offset == before.offset);
+
+    // Growing a vector past one block spills into new blocks that are kept for the next round
+    for (int round = 0; round < 3; ++round) {
+        ArenaScope scope{arena};
+        ArenaVector<int> v{glimmer::ArenaAllocator<int>{arena}};
+        for (int i = 0; i < 1000; ++i) v.push_back(i);
+        assert(v.size() == 1000 && v[999] == 999);
+    }
+    const std::size_t blocks = arena.block_count();
+    {
+        ArenaScope scope{arena};
+        ArenaVector<int> v{glimmer::ArenaAllocator<int>{arena}};
+        for (int i = 0; i < 1000; ++i) v.push_back(i);
+    }
+    assert(arena.block_count() == blocks);
+}
+
+static void test_thread_arena_is_per_thread()
+{
+    Arena& a = glimmer::thread_arena();
+    assert(&a == &glimmer::thread_arena());
+    ArenaScope scope;
+    assert(&scope.arena() == &a);
+}
+
+static void test_repeated_builds_reuse_scratch()
+{
+    using Vec3 = glimmer::Vector<float,3>;
+    glimmer::Scene<float> scene;
+    const auto mat = glimmer::Material<float>::lambertian(glimmer::Color3f{0.5f, 0.5f, 0.5f});
+    for (int i = 0; i < 2000; ++i) {
+        const auto f = static_cast<float>(i);
+        scene.add_object(glimmer::SceneObject<float>{
+            std::make_shared<glimmer::Sphere<float>>(Vec3{f * 0.01f, (i % 37) * 0.1f, (i % 11) * 0.2f}, 0.05f),
+            mat, glimmer::Transform<float>{}});
+    }
+    Arena& arena = glimmer::thread_arena();
+    const auto before = arena.mark();
+    scene.build_bvh();
+    const std::size_t blocks = arena.block_count();
+    assert(blocks > 0);
+    for (int i = 0; i < 3; ++i) {
+        scene.build_bvh();
+        scene.refit_bvh();
+    }
+    assert(arena.block_count() == blocks);
+    const auto after = arena.mark();
+    assert(after.block == before.block && after.offset == before.offset);
+}
+
+int main()
+{
+    test_allocate_and_align();
+    test_rewind_reuses_memory();
+    test_scope_and_vector();
+    test_thread_arena_is_per_thread();
+    test_repeated_builds_reuse_scratch();
+    std::cout << "All arena tests passed.\n";
+    return 0;
+}
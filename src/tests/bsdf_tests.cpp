@@ -0,0 +1,86 @@
+import glimmer.bsdf;
+import glimmer.vector;
+import glimmer.color;
+import glimmer.ray;
+import glimmer.material;
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+using glimmer::Vector;
+using glimmer::Color;
+using glimmer::Ray;
+
+static void test_reflect_refract() {
+    const Vector<double,3> n{0, 0, 1};
+    const Vector<double,3> v = Vector<double,3>{1, 0, -1}.normalized();
+    auto r = glimmer::reflect(v, n);
+    assert(std::abs(r[0] - v[0]) < 1e-12 && std::abs(r[2] + v[2]) < 1e-12);
+    // Refraction at normal incidence keeps the direction
+    Vector<double,3> out;
+    assert(glimmer::refract(Vector<double,3>{0, 0, -1}, n, 1.0 / 1.5, out));
+    assert(std::abs(out[2] + 1.0) < 1e-12);
+    // Grazing exit from glass into air is totally reflected
+    const Vector<double,3> grazing = Vector<double,3>{1, 0, -0.2}.normalized();
+    assert(!glimmer::refract(grazing, n, 1.5, out));
+    // Schlick: R0 at normal incidence, 1 at grazing
+    assert(std::abs(glimmer::schlick(1.0, 1.0, 1.5) - 0.04) < 1e-12);
+    assert(std::abs(glimmer::schlick(0.0, 1.0, 1.5) - 1.0) < 1e-12);
+}
+
+static void test_cosine_sample_and_basis() {
+    for (int i = 0; i < 16; ++i) {
+        auto d = glimmer::cosine_sample_hemisphere(0.05 + 0.06 * i, 0.93 - 0.05 * i);
+        assert(std::abs(d.norm() - 1.0) < 1e-9 && d[2] >= 0.0);
+    }
+    const Vector<double,3> n = Vector<double,3>{0.3, -0.5, 0.8}.normalized();
+    Vector<double,3> t, b;
+    glimmer::build_ortho_basis(n, t, b);
+    assert(std::abs(dot(t, n)) < 1e-12 && std::abs(dot(b, n)) < 1e-12 && std::abs(dot(t, b)) < 1e-12);
+    auto w = glimmer::to_world(Vector<double,3>{0, 0, 1}, n);
+    assert(std::abs(w[0] - n[0]) < 1e-12 && std::abs(w[1] - n[1]) < 1e-12 && std::abs(w[2] - n[2]) < 1e-12);
+}
+
+static void test_scatter_lobes() {
+    const Ray<double> ray{Vector<double,3>{0, 0, 1}, Vector<double,3>{0, 0, -1}};
+    const Vector<double,3> p{0, 0, 0}, n{0, 0, 1};
+    // Smooth metal (roughness 0) always mirrors with weight = albedo
+    auto metal = glimmer::surface_params(glimmer::Material<double>::metal(Color<double,3>{0.9, 0.5, 0.1}, 0.0),
+                                         Vector<double,2>{0, 0});
+    auto bs = glimmer::scatter_surface(metal, ray, p, n, [] { return 0.5; });
+    assert(std::abs(bs.ray.direction()[2] - 1.0) < 1e-12);
+    assert(std::abs(bs.weight[0] - 0.9) < 1e-12 && std::abs(bs.weight[2] - 0.1) < 1e-12);
+    assert(bs.ray.origin()[2] > 0.0); // offset off the surface
+    // Lambertian scatters into the upper hemisphere with weight = albedo
+    auto diffuse = glimmer::surface_params(glimmer::Material<double>::lambertian(Color<double,3>{0.5, 0.5, 0.5}),
+                                           Vector<double,2>{0, 0});
+    assert(diffuse.roughness == 1.0);
+    int calls = 0;
+    bs = glimmer::scatter_surface(diffuse, ray, p, n, [&] { ++calls; return 0.3; });
+    assert(calls == 3 && bs.ray.direction()[2] > 0.0);
+    assert(std::abs(bs.weight[1] - 0.5) < 1e-12);
+    // Glass: a small uniform number picks Fresnel reflection, a large one refraction through the surface
+    auto glass = glimmer::surface_params(glimmer::Material<double>::glass(Color<double,3>{1, 1, 1}, 0.0, 1.0),
+                                         Vector<double,2>{0, 0});
+    bs = glimmer::scatter_surface(glass, ray, p, n, [] { return 0.001; });
+    assert(bs.ray.direction()[2] > 0.0);
+    bs = glimmer::scatter_surface(glass, ray, p, n, [] { return 0.999; });
+    assert(bs.ray.direction()[2] < 0.0);
+}
+
+static void test_russian_roulette() {
+    Color<double,3> beta{0.25, 0.5, 0.1};
+    assert(!glimmer::russian_roulette(beta, 0.4)); // survival probability 0.5
+    Color<double,3> kept{0.25, 0.5, 0.1};
+    assert(glimmer::russian_roulette(kept, 0.6));
+    assert(std::abs(kept[1] - 1.0) < 1e-12 && std::abs(kept[0] - 0.5) < 1e-12);
+}
+
+int main() {
+    test_reflect_refract();
+    test_cosine_sample_and_basis();
+    test_scatter_lobes();
+    test_russian_roulette();
+    std::cout << "All BSDF tests passed.\n";
+    return 0;
+}
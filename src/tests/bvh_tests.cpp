@@ -0,0 +1,245 @@
+import glimmer.bvh;
+import glimmer.aabb;
+import glimmer.vector;
+import glimmer.ray;
+import glimmer.ray_packet;
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <vector>
+
+using glimmer::AABB;
+using glimmer::Bvh;
+using glimmer::Vector;
+using glimmer::Ray;
+
+// Unit boxes along the X axis at x = 0, 2, 4, ...
+static std::vector<AABB<double>> make_row(std::size_t n) {
+    std::vector<AABB<double>> boxes;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double x = 2.0 * static_cast<double>(i);
+        boxes.emplace_back(Vector<double,3>{x - 0.5, -0.5, -0.5}, Vector<double,3>{x + 0.5, 0.5, 0.5});
+    }
+    return boxes;
+}
+
+// Closest box entry by brute force, used as reference.
+static std::optional<std::uint32_t> brute_force(const std::vector<AABB<double>>& boxes, const Ray<double>& r) {
+    std::optional<std::uint32_t> best;
+    double best_t = r.tmax();
+    for (std::uint32_t i = 0; i < boxes.size(); ++i) {
+        if (auto h = boxes[i].intersect(r); h && h->t_near <= best_t) { best_t = h->t_near; best = i; }
+    }
+    return best;
+}
+
+static std::optional<std::uint32_t> query(const Bvh<double>& bvh, const std::vector<AABB<double>>& boxes,
+                                          const Ray<double>& r) {
+    std::optional<std::uint32_t> best;
+    bvh.intersect(r, [&](std::uint32_t prim, double& t_max) {
+        const Ray<double> clipped{r.origin(), r.direction(), r.tmin(), t_max};
+        auto h = boxes[prim].intersect(clipped);
+        if (!h) return false;
+        t_max = h->t_near;
+        best = prim;
+        return true;
+    });
+    return best;
+}
+
+static void test_empty_bvh() {
+    Bvh<double> bvh;
+    bvh.build({});
+    assert(bvh.empty());
+    Ray<double> r{Vector<double,3>{0,0,5}, Vector<double,3>{0,0,-1}};
+    assert(!bvh.intersect(r, [](std::uint32_t, double&) { return true; }));
+}
+
+static void test_build_structure() {
+    auto boxes = make_row(100);
+    Bvh<double> bvh;
+    bvh.build(boxes, 2);
+    assert(bvh.primitive_count() == 100);
+    assert(bvh.node_count() > 1);
+    // Every primitive appears exactly once among the leaves
+    std::vector<int> seen(100, 0);
+    for (const auto& n : bvh.nodes()) {
+        if (!n.is_leaf()) continue;
+        assert(n.count <= 2);
+        for (std::uint32_t k = 0; k < n.count; ++k) ++seen[bvh.primitive_indices()[n.first + k]];
+    }
+    for (int c : seen) assert(c == 1);
+    auto root = bvh.bounds();
+    assert(std::abs(root.min()[0] + 0.5) < 1e-12 && std::abs(root.max()[0] - 198.5) < 1e-12);
+}
+
+static void test_closest_hit_matches_brute_force() {
+    auto boxes = make_row(64);
+    Bvh<double> bvh;
+    bvh.build(boxes);
+    // Rays along +X and -X hit the first box they meet
+    Ray<double> rx{Vector<double,3>{-10,0,0}, Vector<double,3>{1,0,0}};
+    assert(query(bvh, boxes, rx) == std::optional<std::uint32_t>{0});
+    Ray<double> rnx{Vector<double,3>{1000,0,0}, Vector<double,3>{-1,0,0}};
+    assert(query(bvh, boxes, rnx) == std::optional<std::uint32_t>{63});
+    // Vertical rays above each box
+    for (std::uint32_t i = 0; i < 64; ++i) {
+        Ray<double> r{Vector<double,3>{2.0 * i, 5, 0.1}, Vector<double,3>{0,-1,0}};
+        assert(query(bvh, boxes, r) == brute_force(boxes, r));
+        assert(query(bvh, boxes, r) == std::optional<std::uint32_t>{i});
+    }
+    // Miss between boxes
+    Ray<double> miss{Vector<double,3>{1.0, 5, 0}, Vector<double,3>{0,-1,0}};
+    assert(!query(bvh, boxes, miss).has_value());
+    // Range-limited ray stops before the first box
+    Ray<double> short_ray{Vector<double,3>{-10,0,0}, Vector<double,3>{1,0,0}, 0.0, 5.0};
+    assert(!query(bvh, boxes, short_ray).has_value());
+    // With the default unbounded range, boxes the ray misses are culled, not visited
+    std::size_t calls = 0;
+    Ray<double> above{Vector<double,3>{-10,5,0}, Vector<double,3>{1,0,0}};
+    assert(!bvh.intersect(above, [&](std::uint32_t, double&) { ++calls; return false; }));
+    assert(calls == 0);
+}
+
+static void test_refit_follows_moved_primitives() {
+    auto boxes = make_row(16);
+    Bvh<double> bvh;
+    bvh.build(boxes);
+    // Move box 5 up by 10 units
+    boxes[5] = AABB<double>{Vector<double,3>{9.5, 9.5, -0.5}, Vector<double,3>{10.5, 10.5, 0.5}};
+    bvh.refit(boxes);
+    Ray<double> r{Vector<double,3>{10, 20, 0}, Vector<double,3>{0,-1,0}};
+    assert(query(bvh, boxes, r) == std::optional<std::uint32_t>{5});
+    Ray<double> old_place{Vector<double,3>{10, 5, 0}, Vector<double,3>{0,-1,0}};
+    assert(!query(bvh, boxes, old_place).has_value());
+    assert(bvh.bounds().max()[1] >= 10.5);
+}
+
+static void test_partial_refit_matches_full_refit() {
+    auto boxes = make_row(64);
+    Bvh<double> partial;
+    partial.build(boxes);
+    Bvh<double> full = partial;
+    const double cost = partial.sah_cost();
+    assert(cost > 1.0);
+    // Move a few boxes; refit only those and compare with refitting everything
+    const std::vector<std::uint32_t> moved{3, 40, 41, 3};
+    for (const auto i : moved) {
+        const double y = 3.0 * static_cast<double>(i % 5) + 1.0;
+        const double x = 2.0 * static_cast<double>(i);
+        boxes[i] = AABB<double>{Vector<double,3>{x - 0.5, y - 0.5, -0.5}, Vector<double,3>{x + 0.5, y + 0.5, 0.5}};
+    }
+    partial.refit(moved, [&](std::uint32_t i) { return boxes[i]; });
+    full.refit(boxes);
+    assert(partial.node_count() == full.node_count());
+    for (std::size_t i = 0; i < full.node_count(); ++i) assert(partial.nodes()[i].bounds == full.nodes()[i].bounds);
+    assert(std::abs(partial.sah_cost() - full.sah_cost()) < 1e-9 * full.sah_cost());
+    assert(partial.sah_cost() != cost);
+    // An unchanged primitive stops at its leaf
+    partial.refit(std::vector<std::uint32_t>{7}, [&](std::uint32_t i) { return boxes[i]; });
+    assert(std::abs(partial.sah_cost() - full.sah_cost()) < 1e-9 * full.sah_cost());
+    Ray<double> r{Vector<double,3>{6, 20, 0}, Vector<double,3>{0,-1,0}};
+    assert(query(partial, boxes, r) == std::optional<std::uint32_t>{3});
+}
+
+static void test_coincident_centroids() {
+    // All boxes identical: builder must still terminate and produce a usable tree
+    std::vector<AABB<double>> boxes(50, AABB<double>{Vector<double,3>{0,0,0}, Vector<double,3>{1,1,1}});
+    Bvh<double> bvh;
+    bvh.build(boxes, 4);
+    std::size_t tested = 0;
+    Ray<double> r{Vector<double,3>{0.5,0.5,5}, Vector<double,3>{0,0,-1}};
+    bvh.intersect(r, [&](std::uint32_t, double&) { ++tested; return false; });
+    assert(tested == 50);
+}
+
+static void test_occluded_stops_early() {
+    auto boxes = make_row(32);
+    Bvh<double> bvh;
+    bvh.build(boxes, 1);
+    // Ray along +X passes all boxes; any-hit query stops after the first accepted primitive
+    Ray<double> r{Vector<double,3>{-10,0,0}, Vector<double,3>{1,0,0}};
+    std::size_t calls = 0;
+    assert(bvh.occluded(r, [&](std::uint32_t prim) {
+        ++calls;
+        return boxes[prim].intersect(r).has_value();
+    }));
+    assert(calls == 1);
+    // Leaf rejecting everything visits all candidates and reports no occlusion
+    calls = 0;
+    assert(!bvh.occluded(r, [&](std::uint32_t) { ++calls; return false; }));
+    assert(calls == 32);
+    // Ray missing the root box never calls the leaf
+    calls = 0;
+    Ray<double> miss{Vector<double,3>{-10,5,0}, Vector<double,3>{1,0,0}};
+    assert(!bvh.occluded(miss, [&](std::uint32_t) { ++calls; return true; }));
+    assert(calls == 0);
+}
+
+static void test_packet_traversal_matches_scalar() {
+    // Two rows of boxes so some lanes hit the near row and some only the far one
+    auto boxes = make_row(40);
+    for (std::size_t i = 0; i < 40; ++i) {
+        const double x = 2.0 * static_cast<double>(i) + 1.0;
+        boxes.emplace_back(Vector<double,3>{x - 0.5, -0.5, -4.5}, Vector<double,3>{x + 0.5, 0.5, -3.5});
+    }
+    Bvh<double> bvh;
+    bvh.build(boxes, 2);
+    std::vector<Ray<double>> rays;
+    for (int k = 0; k < 8; ++k) rays.emplace_back(Vector<double,3>{0.4 + 1.1 * k, 0, 5}, Vector<double,3>{0, 0, -1});
+    auto packet = glimmer::RayPacket<double,8>::from_rays(rays);
+    std::array<double,8> t_max = packet.tmax;
+    std::array<std::optional<std::uint32_t>,8> best{};
+    const glimmer::PacketMask hit = bvh.intersect_packet(packet, t_max, [&](std::uint32_t prim, glimmer::PacketMask lanes) {
+        glimmer::PacketMask out = 0;
+        for (std::size_t i = 0; i < 8; ++i) {
+            if (!((lanes >> i) & 1u)) continue;
+            const Ray<double> clipped{rays[i].origin(), rays[i].direction(), rays[i].tmin(), t_max[i]};
+            auto h = boxes[prim].intersect(clipped);
+            if (!h) continue;
+            t_max[i] = h->t_near;
+            best[i] = prim;
+            out |= glimmer::PacketMask{1} << i;
+        }
+        return out;
+    });
+    for (std::size_t i = 0; i < 8; ++i) {
+        const auto ref = brute_force(boxes, rays[i]);
+        assert(best[i] == ref);
+        assert(((hit >> i) & 1u) == (ref.has_value() ? 1u : 0u));
+    }
+}
+
+static void test_leaf_callbacks_receive_slot() {
+    const auto boxes = make_row(40);
+    Bvh<double> bvh;
+    bvh.build(boxes, 2);
+    const auto order = bvh.primitive_indices();
+    std::size_t calls = 0;
+    Ray<double> r{Vector<double,3>{-5, 0, 0}, Vector<double,3>{1, 0, 0}};
+    bvh.intersect(r, [&](std::uint32_t prim, std::uint32_t slot, double&) {
+        assert(order[slot] == prim);
+        ++calls;
+        return false;
+    });
+    assert(calls == boxes.size());
+    assert(!bvh.occluded(r, [&](std::uint32_t prim, std::uint32_t slot) { assert(order[slot] == prim); return false; }));
+}
+
+int main() {
+    test_empty_bvh();
+    test_build_structure();
+    test_closest_hit_matches_brute_force();
+    test_refit_follows_moved_primitives();
+    test_partial_refit_matches_full_refit();
+    test_coincident_centroids();
+    test_occluded_stops_early();
+    test_packet_traversal_matches_scalar();
+    test_leaf_callbacks_receive_slot();
+    std::cout << "All BVH tests passed.\n";
+    return 0;
+}
@@ -3,14 +3,24 @@ import glimmer.vector;
 import glimmer.matrix;
 import glimmer.transform;
 import glimmer.ray;
+import glimmer.ray_packet;
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <span>
+#include <stdexcept>
 
 using glimmer::Camera;
 using glimmer::Vector;
 using glimmer::Transform;
 using glimmer::Ray;
+using glimmer::CameraRayGenerator;
+using glimmer::RayPacket;
+
+static bool near(const Vector<double,3>& a, const Vector<double,3>& b, double eps) {
+    return std::abs(a[0]-b[0]) < eps && std::abs(a[1]-b[1]) < eps && std::abs(a[2]-b[2]) < eps;
+}
 
 static void test_center_ray_points_to_target() {
     Vector<double,3> eye{0,0,5};
@@ -61,10 +71,82 @@ static void test_viewproj_basic() {
     assert(std::abs(clip[3]) > 1e-12);
 }
 
+static void test_generator_matches_generate_ray() {
+    auto cam = Camera<double>::from_look_at(Vector<double,3>{1,2,3}, Vector<double,3>{-1,0,0}, Vector<double,3>{0,1,0},
+                                            50.0 * M_PI/180.0, 4.0/3.0, 0.1, 100.0);
+    const std::size_t W = 64, H = 48;
+    const CameraRayGenerator<double> gen{cam, W, H};
+    assert(!gen.has_lens() && gen.pixel_spread() == cam.pixel_spread(H));
+    const double pts[][2] = {{0, 0}, {63, 47}, {12.25, 30.75}, {31.5, 23.5}};
+    for (const auto& p : pts) {
+        const auto a = cam.generate_ray(p[0], p[1], W, H);
+        const auto b = gen.ray(p[0], p[1]);
+        assert(near(a.origin(), b.origin(), 1e-12) && near(a.direction(), b.direction(), 1e-12));
+        assert(a.tmin() == b.tmin() && a.tmax() == b.tmax());
+        // Lens samples do nothing without a lens
+        const auto c = gen.ray(p[0], p[1], Vector<double,2>{0.9, 0.1});
+        assert(near(b.direction(), c.direction(), 1e-15));
+    }
+
+    // Batches: arbitrary film positions and a full row of pixel centers
+    std::array<Vector<double,2>, 4> film{};
+    for (int i = 0; i < 4; ++i) film[i] = Vector<double,2>{pts[i][0], pts[i][1]};
+    RayPacket<double, 8> packet;
+    gen.rays(packet, std::span<const Vector<double,2>>{film});
+    assert(packet.size() == 4);
+    for (std::size_t i = 0; i < 4; ++i) {
+        const auto a = cam.generate_ray(film[i][0], film[i][1], W, H);
+        assert(near(packet.ray(i).direction(), a.direction(), 1e-12));
+        assert(std::abs(packet.inv_dx[i] * packet.dx[i] - 1.0) < 1e-12);
+    }
+    gen.row(packet, 58, 7, 6);
+    assert(packet.size() == 6);
+    for (std::size_t i = 0; i < 6; ++i) {
+        const auto a = cam.generate_ray(58.0 + static_cast<double>(i), 7.0, W, H);
+        assert(near(packet.ray(i).origin(), a.origin(), 1e-12));
+        assert(near(packet.ray(i).direction(), a.direction(), 1e-12));
+    }
+}
+
+static void test_thin_lens_focuses_on_the_focal_plane() {
+    auto cam = Camera<double>::from_look_at(Vector<double,3>{0,0,5}, Vector<double,3>{0,0,0}, Vector<double,3>{0,1,0},
+                                            M_PI/3, 1.0, 0.1, 100.0);
+    bool threw = false;
+    try { cam.set_lens(-1.0, 2.0); } catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+    cam.set_lens(0.25, 3.0);
+    const std::size_t W = 32, H = 32;
+    const CameraRayGenerator<double> gen{cam, W, H};
+    assert(gen.has_lens());
+
+    // All lens samples of one film position meet where the pinhole ray crosses the focal plane (z = 2)
+    const double px = 5.5, py = 20.25;
+    const auto pin = gen.ray(px, py);
+    const auto focus = pin.at(-3.0 / pin.direction()[2]);
+    const Vector<double,2> lens[] = {{0.5, 0.5}, {0.0, 0.0}, {0.99, 0.2}, {0.1, 0.85}, {0.7, 0.3}};
+    RayPacket<double, 8> packet;
+    std::array<Vector<double,2>, 5> film{};
+    film.fill(Vector<double,2>{px, py});
+    gen.rays(packet, std::span<const Vector<double,2>>{film}, std::span<const Vector<double,2>>{lens});
+    for (std::size_t i = 0; i < 5; ++i) {
+        const auto r = gen.ray(px, py, lens[i]);
+        const auto o = r.origin();
+        // Origins lie on the aperture disk around the eye
+        assert(std::abs(o[2] - 5.0) < 1e-12 && std::hypot(o[0], o[1]) <= 0.25 + 1e-12);
+        assert(std::abs(r.direction().norm() - 1.0) < 1e-12);
+        assert(near(r.at((focus[2] - o[2]) / r.direction()[2]), focus, 1e-9));
+        assert(near(packet.ray(i).origin(), o, 1e-12) && near(packet.ray(i).direction(), r.direction(), 1e-12));
+    }
+    // The lens center is the pinhole ray
+    assert(near(gen.ray(px, py, Vector<double,2>{0.5, 0.5}).direction(), pin.direction(), 1e-12));
+}
+
 int main(){
     test_center_ray_points_to_target();
     test_corner_rays_with_aspect();
     test_viewproj_basic();
+    test_generator_matches_generate_ray();
+    test_thin_lens_focuses_on_the_focal_plane();
     std::cout << "All camera tests passed.\n";
     return 0;
 }
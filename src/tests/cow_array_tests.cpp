@@ -0,0 +1,51 @@
+import glimmer.cow_array;
+#include <array>
+#include <cassert>
+#include <iostream>
+#include <span>
+#include <utility>
+#include <vector>
+
+using glimmer::CowArray;
+
+static void test_owned(){
+    CowArray<int> a{std::vector<int>{1, 2, 3}};
+    assert(!a.borrowed());
+    assert(a.size() == 3 && a[1] == 2 && a.front() == 1);
+    a.push_back(4);
+    assert(a.size() == 4 && a[3] == 4);
+
+    // Copies and moves keep their own views
+    CowArray<int> b = a;
+    b.modify([](std::vector<int>& v) { v[0] = 10; });
+    assert(a[0] == 1 && b[0] == 10);
+    CowArray<int> c = std::move(b);
+    assert(c.size() == 4 && c[0] == 10 && b.empty());
+    a = c;
+    assert(a[0] == 10 && a.data() != c.data());
+}
+
+static void test_borrowed_copy_on_write(){
+    const std::array<int, 3> storage{5, 6, 7};
+    auto a = CowArray<int>::borrow(storage);
+    assert(a.borrowed() && a.data() == storage.data() && a.size() == 3);
+
+    CowArray<int> b = a;
+    assert(b.borrowed() && b.data() == storage.data());
+
+    b.push_back(8);
+    assert(!b.borrowed() && b.size() == 4 && b[0] == 5 && b[3] == 8);
+    assert(a.borrowed() && a.size() == 3 && storage[0] == 5);
+
+    std::span<const int> view = a;
+    assert(view.data() == storage.data());
+    a.clear();
+    assert(a.empty() && !a.borrowed());
+}
+
+int main(){
+    test_owned();
+    test_borrowed_copy_on_write();
+    std::cout << "All cow_array tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,164 @@
+import glimmer.denoise;
+import glimmer.aov;
+import glimmer.renderer_path_tracer;
+import glimmer.thread_pool;
+import glimmer.scene;
+import glimmer.scene_object;
+import glimmer.sphere;
+import glimmer.plane;
+import glimmer.camera;
+import glimmer.transform;
+import glimmer.vector;
+import glimmer.color;
+import glimmer.image;
+import glimmer.material;
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+using glimmer::AtrousDenoiser;
+using glimmer::AovImages;
+using glimmer::Scene;
+using glimmer::SceneObject;
+using glimmer::Sphere;
+using glimmer::Plane;
+using glimmer::Camera;
+using glimmer::Vector;
+using glimmer::Color;
+using glimmer::Image;
+using glimmer::Material;
+
+template <class T>
+static double mse(const Image<T,3>& a, const Image<T,3>& b) {
+    double sum = 0;
+    for (std::size_t i = 0; i < a.size(); ++i)
+        for (int c = 0; c < 3; ++c) {
+            const double d = static_cast<double>(a.data()[i][c]) - static_cast<double>(b.data()[i][c]);
+            sum += d * d;
+        }
+    return sum / static_cast<double>(3 * a.size());
+}
+
+// Flat AOVs: one surface facing the camera at depth 1 with white albedo
+template <class T>
+static AovImages<T> flat_aovs(std::size_t w, std::size_t h) {
+    AovImages<T> aovs;
+    aovs.resize(w, h);
+    for (std::size_t y = 0; y < h; ++y)
+        for (std::size_t x = 0; x < w; ++x) {
+            aovs.albedo(x, y) = Color<T,3>{1, 1, 1};
+            aovs.normal(x, y) = Vector<T,3>{0, 0, 1};
+            aovs.depth(x, y)[0] = T{1};
+        }
+    return aovs;
+}
+
+static void test_zero_iterations_and_size_check() {
+    using T = float;
+    Image<T,3> img{6, 4, Color<T,3>{0.25f, 0.5f, 0.75f}};
+    img(2, 1) = Color<T,3>{3, 0, 1};
+    const Image<T,3> orig = img;
+    AtrousDenoiser<T>::Options opt{};
+    opt.iterations = 0;
+    AtrousDenoiser<T> denoiser{opt};
+    denoiser.apply(img, flat_aovs<T>(6, 4));
+    assert(mse(img, orig) == 0.0);
+
+    bool threw = false;
+    try { denoiser.apply(img, flat_aovs<T>(6, 5)); } catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+}
+
+static void test_smooths_noise_and_keeps_normal_edges() {
+    using T = double;
+    const std::size_t W = 40, H = 30;
+    // Left half: a surface facing +z lit at 0.2; right half: one facing +x lit at 0.8; both with noise
+    Image<T,3> clean{W, H}, noisy{W, H};
+    AovImages<T> aovs = flat_aovs<T>(W, H);
+    std::uint64_t state = 12345;
+    auto noise = [&] {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<T>(state >> 11) / static_cast<T>(1ULL << 53) - T{0.5};
+    };
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x) {
+            const bool right = x >= W / 2;
+            const T v = right ? T{0.8} : T{0.2};
+            if (right) aovs.normal(x, y) = Vector<T,3>{1, 0, 0};
+            clean(x, y) = Color<T,3>{v, v, v};
+            const T n = T{0.3} * noise();
+            noisy(x, y) = Color<T,3>{v + n, v + n, v + n};
+        }
+    Image<T,3> out;
+    AtrousDenoiser<T> denoiser;
+    denoiser.apply(noisy, aovs, out);
+    assert(mse(out, clean) < 0.1 * mse(noisy, clean));
+    // Nothing leaks across the normal discontinuity
+    for (std::size_t y = 0; y < H; ++y) {
+        assert(std::abs(out(W/2 - 1, y)[0] - 0.2) < 0.05);
+        assert(std::abs(out(W/2, y)[0] - 0.8) < 0.05);
+    }
+
+    // The result does not depend on the pool size
+    Image<T,3> one;
+    denoiser.set_thread_pool(std::make_shared<glimmer::ThreadPool>(1));
+    denoiser.apply(noisy, aovs, one);
+    assert(mse(one, out) == 0.0);
+}
+
+static void test_demodulation_keeps_texture() {
+    using T = double;
+    const std::size_t W = 32, H = 32;
+    // Uniform lighting on a checker albedo: the texture lives only in the albedo AOV
+    Image<T,3> img{W, H};
+    AovImages<T> aovs = flat_aovs<T>(W, H);
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x) {
+            const T a = ((x / 2 + y / 2) % 2) ? T{0.9} : T{0.1};
+            aovs.albedo(x, y) = Color<T,3>{a, a, a};
+            img(x, y) = Color<T,3>{a, a, a} * T{0.5};
+        }
+    const Image<T,3> orig = img;
+    AtrousDenoiser<T> denoiser;
+    denoiser.apply(img, aovs);
+    assert(mse(img, orig) < 1e-20);
+}
+
+static void test_denoised_render_approaches_reference() {
+    using T = float;
+    auto cam = Camera<T>::from_look_at(Vector<T,3>{0,1,5}, Vector<T,3>{0,0,0}, Vector<T,3>{0,1,0},
+                                       static_cast<T>(M_PI/3), T{1}, T{0.1f}, T{100});
+    Scene<T> scene{cam, Color<T,3>{0.1f,0.1f,0.1f}};
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0,0,0}, T{1}),
+                                    Material<T>::lambertian(Color<T,3>{0.8f, 0.5f, 0.3f}), glimmer::Transform<T>{}});
+    scene.add_object(SceneObject<T>{std::make_shared<Plane<T>>(Vector<T,3>{0,-1,0}, Vector<T,3>{0,1,0}),
+                                    Material<T>::lambertian(Color<T,3>{0.7f, 0.7f, 0.7f}), glimmer::Transform<T>{}});
+    // The light is out of view: the aliased edge of a visible emitter is noise no denoiser should remove
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{3,5,3}, T{1}),
+                                    Material<T>::emissive(Color<T,3>{1, 1, 1}, 8.0f), glimmer::Transform<T>{}});
+    scene.build_bvh();
+
+    const std::size_t W = 32, H = 32;
+    Image<T,3> reference, noisy;
+    glimmer::RendererPathTracer<T>{512, 4, 1}.render(scene, reference, W, H);
+    AovImages<T> aovs;
+    glimmer::RendererPathTracer<T>{8, 4, 2}.render(scene, noisy, aovs, W, H);
+
+    Image<T,3> denoised;
+    AtrousDenoiser<T>{}.apply(noisy, aovs, denoised);
+    const double before = mse(noisy, reference);
+    const double after = mse(denoised, reference);
+    assert(after < 0.35 * before);
+}
+
+int main() {
+    test_zero_iterations_and_size_check();
+    test_smooths_noise_and_keeps_normal_edges();
+    test_demodulation_keeps_texture();
+    test_denoised_render_approaches_reference();
+    std::cout << "All denoise tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,58 @@
+import glimmer.half;
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+using glimmer::float_to_half;
+using glimmer::half_to_float;
+
+static void test_round_trip_all_halves()
+{
+    for (std::uint32_t h = 0; h < 0x10000u; ++h) {
+        const auto bits = static_cast<std::uint16_t>(h);
+        const float f = half_to_float(bits);
+        if (std::isnan(f)) {
+            assert(std::isnan(half_to_float(float_to_half(f))));
+            continue;
+        }
+        assert(float_to_half(f) == bits);
+    }
+}
+
+static void test_known_values()
+{
+    assert(float_to_half(0.0f) == 0x0000u);
+    assert(float_to_half(-0.0f) == 0x8000u);
+    assert(float_to_half(1.0f) == 0x3c00u);
+    assert(float_to_half(-2.0f) == 0xc000u);
+    assert(float_to_half(65504.0f) == 0x7bffu);
+    assert(float_to_half(1e6f) == 0x7c00u);
+    assert(float_to_half(std::numeric_limits<float>::infinity()) == 0x7c00u);
+    assert(float_to_half(0x1p-24f) == 0x0001u); // smallest subnormal
+    assert(float_to_half(0x1p-26f) == 0x0000u);
+    assert(half_to_float(0x3555u) > 0.333f && half_to_float(0x3555u) < 0.3334f);
+}
+
+static void test_rounding_to_nearest_even()
+{
+    // 1 + 2^-11 lies halfway between 1 and the next half (1 + 2^-10): ties go to the even mantissa
+    assert(float_to_half(1.0f + 0x1p-11f) == 0x3c00u);
+    assert(float_to_half(1.0f + 3 * 0x1p-11f) == 0x3c02u);
+    assert(float_to_half(1.0f + 0x1p-11f + 0x1p-20f) == 0x3c01u);
+    // Relative error of normal values stays within half an ulp
+    for (float v = 1e-4f; v < 6e4f; v *= 1.37f) {
+        const float r = half_to_float(float_to_half(v));
+        assert(std::abs(r - v) <= v * 0x1p-11f);
+    }
+}
+
+int main()
+{
+    test_round_trip_all_halves();
+    test_known_values();
+    test_rounding_to_nearest_even();
+    std::cout << "All half tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,97 @@
+import glimmer.image_sink;
+import glimmer.image;
+import glimmer.color;
+import glimmer.tile;
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+using glimmer::Color;
+using glimmer::Image;
+using glimmer::StreamingRowWriter;
+using glimmer::Tile;
+using glimmer::TileGrid;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+static void test_image_target_assembles_tiles() {
+    Image<double,3> img;
+    glimmer::ImageTarget<double> target{img};
+    const TileGrid grid{7, 5, 3};
+    target.begin(7, 5);
+    assert(img.width() == 7 && img.height() == 5);
+    for (std::size_t i = grid.count(); i-- > 0;) {
+        const Tile t = grid.tile(i);
+        std::vector<Color<double,3>> px;
+        for (std::size_t y = t.y0; y < t.y1; ++y)
+            for (std::size_t x = t.x0; x < t.x1; ++x) px.push_back(Color<double,3>{double(x), double(y), 1.0});
+        target.write_tile(t, px);
+    }
+    target.end();
+    for (std::size_t y = 0; y < 5; ++y)
+        for (std::size_t x = 0; x < 7; ++x) assert(img(x, y) == (Color<double,3>{double(x), double(y), 1.0}));
+}
+
+static void test_row_writer(bool async) {
+    // Rows are filled in two halves by different threads in reverse order; the file must still be in order
+    const std::string path = async ? "row_writer_async.bin" : "row_writer_sync.bin";
+    const std::size_t rows = 64, row_bytes = 10;
+    StreamingRowWriter writer;
+    writer.set_max_pending_bytes(25); // forces writers to wait for the I/O thread
+    assert(writer.open(path, "HDR\n", rows, row_bytes, async));
+    auto fill = [&](std::size_t offset) {
+        for (std::size_t y = rows; y-- > 0;) {
+            auto r = writer.row(y);
+            for (std::size_t i = offset; i < offset + row_bytes / 2; ++i) r[i] = static_cast<unsigned char>(y + i);
+            writer.commit(y, row_bytes / 2);
+        }
+    };
+    std::thread a{fill, 0}, b{fill, row_bytes / 2};
+    a.join();
+    b.join();
+    assert(writer.rows_done() == rows);
+    assert(writer.close());
+
+    const std::string data = read_file(path);
+    assert(data.size() == 4 + rows * row_bytes);
+    assert(data.substr(0, 4) == "HDR\n");
+    for (std::size_t y = 0; y < rows; ++y)
+        for (std::size_t i = 0; i < row_bytes; ++i)
+            assert(static_cast<unsigned char>(data[4 + y * row_bytes + i]) == static_cast<unsigned char>(y + i));
+    std::filesystem::remove(path);
+}
+
+static void test_row_writer_incomplete_and_unopenable() {
+    const std::string path = "row_writer_incomplete.bin";
+    StreamingRowWriter writer;
+    assert(writer.open(path, "", 2, 4));
+    auto r = writer.row(0);
+    std::fill(r.begin(), r.end(), 1);
+    writer.commit(0, 4);
+    assert(!writer.close()); // row 1 never arrived
+    std::filesystem::remove(path);
+
+    StreamingRowWriter bad;
+    assert(!bad.open("no_such_dir/out.bin", "", 1, 1));
+    assert(!bad.close());
+}
+
+int main() {
+    test_image_target_assembles_tiles();
+    test_row_writer(true);
+    test_row_writer(false);
+    test_row_writer_incomplete_and_unopenable();
+    std::cout << "All image_sink tests passed.\n";
+    return 0;
+}
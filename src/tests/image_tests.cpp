@@ -3,6 +3,7 @@ import glimmer.color;
 import glimmer.vector;
 import glimmer.ppm;
 #include <cassert>
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
@@ -66,10 +67,41 @@ static void test_write_ppm() {
     assert(header == std::string("P6"));
 }
 
+static void test_compact_image() {
+    Image<double,3> img{5,3};
+    for (std::size_t y=0; y<img.height(); ++y)
+        for (std::size_t x=0; x<img.width(); ++x)
+            img(x,y) = Vector<double,3>{0.1 * double(x), 1000.0 + double(y), -0.3};
+
+    // f32 halves a double framebuffer, f16 quarters it; values round to the storage format
+    const glimmer::CompactImage<double,3> f32{img};
+    const glimmer::CompactImage<double,3,glimmer::PixelFormat::f16> f16{img};
+    assert(f32.bytes() * 2 == img.size() * sizeof(Vector<double,3>));
+    assert(f16.bytes() * 4 == img.size() * sizeof(Vector<double,3>));
+    for (std::size_t y=0; y<img.height(); ++y)
+        for (std::size_t x=0; x<img.width(); ++x)
+            for (int c=0; c<3; ++c) {
+                assert(f32.get(x,y)[c] == double(float(img(x,y)[c])));
+                assert(std::abs(f16.get(x,y)[c] - img(x,y)[c]) <= 1e-3 * std::abs(img(x,y)[c]));
+            }
+    const auto back = f32.to_image();
+    assert(back.width() == 5 && back.height() == 3 && back(4,2) == f32.get(4,2));
+
+    glimmer::CompactImage<float,3,glimmer::PixelFormat::f16> acc{2,2};
+    acc.add(1,1, Color3f{0.5f, 1.0f, 2.0f});
+    acc.add(1,1, Color3f{0.25f, 1.0f, 2.0f});
+    assert(acc.get(1,1) == (Color3f{0.75f, 2.0f, 4.0f}) && acc.get(0,0) == (Color3f{0,0,0}));
+    bool threw=false; try { (void)acc.at(2,0); } catch(...) { threw=true; }
+    assert(threw);
+    acc.resize(3,1);
+    assert(acc.width()==3 && acc.size()==3 && acc.get(1,0) == (Color3f{0,0,0}));
+}
+
 int main(){
     test_construct_and_access();
     test_clear_and_resize();
     test_write_ppm();
+    test_compact_image();
     std::cout << "All image tests passed.\n";
     return 0;
 }
@@ -0,0 +1,153 @@
+import glimmer.instance;
+import glimmer.affine;
+import glimmer.scene;
+import glimmer.scene_object;
+import glimmer.sphere;
+import glimmer.mesh;
+import glimmer.material;
+import glimmer.bsdf;
+import glimmer.transform;
+import glimmer.quaternion;
+import glimmer.ray;
+import glimmer.ray_packet;
+import glimmer.sampler;
+import glimmer.color;
+import glimmer.vector;
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <numbers>
+#include <optional>
+#include <stdexcept>
+
+using glimmer::Scene;
+using glimmer::SceneObject;
+using glimmer::Transform;
+using glimmer::Material;
+using V3 = glimmer::Vector<float,3>;
+using Color3 = glimmer::Color<float,3>;
+
+static_assert(sizeof(glimmer::Instance<float>) == 24 * sizeof(float) + 8);
+
+static std::shared_ptr<glimmer::Mesh<float>> make_box()
+{
+    auto mesh = std::make_shared<glimmer::Mesh<float>>();
+    for (int i = 0; i < 8; ++i) mesh->add_vertex(V3{i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f});
+    const int faces[6][4] = {{0, 1, 3, 2}, {4, 6, 7, 5}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 2, 6, 4}, {1, 5, 7, 3}};
+    for (const auto& f : faces) {
+        mesh->add_triangle(f[0], f[1], f[2]);
+        mesh->add_triangle(f[0], f[2], f[3]);
+    }
+    mesh->build_bvh();
+    return mesh;
+}
+
+static Transform<float> placement(int i)
+{
+    const float x = static_cast<float>(i % 10) * 1.5f - 7.0f;
+    const float z = static_cast<float>(i / 10) * -1.5f;
+    return Transform<float>::from_trs(V3{x, 0.1f * static_cast<float>(i % 3), z},
+                                      glimmer::Quaternion<float>::from_axis_angle(V3{0, 1, 0}, 0.3f * static_cast<float>(i)),
+                                      V3{1.0f, 0.5f + 0.05f * static_cast<float>(i % 7), 1.0f});
+}
+
+// The same forest built from SceneObjects and from instances answers every query identically
+static void test_instances_match_objects()
+{
+    const auto box = make_box();
+    const auto sphere = std::make_shared<glimmer::Sphere<float>>(V3{0, 0, 0}, 0.6f);
+    Scene<float> objects, instances;
+    const auto red = Material<float>::lambertian(Color3{1, 0, 0});
+    const auto blue = Material<float>::lambertian(Color3{0, 0, 1});
+    const auto red_id = instances.add_material(red);
+    const auto blue_id = instances.add_material(blue);
+    const auto box_id = instances.add_geometry(box);
+    const auto sphere_id = instances.add_geometry(sphere);
+    for (int i = 0; i < 60; ++i) {
+        const bool is_box = i % 2 == 0;
+        objects.add_object(SceneObject<float>{is_box ? std::shared_ptr<const glimmer::Geometry<float>>{box}
+                                                     : std::shared_ptr<const glimmer::Geometry<float>>{sphere},
+                                              is_box ? red : blue, placement(i)});
+        instances.add_instance(is_box ? box_id : sphere_id, is_box ? red_id : blue_id, placement(i));
+    }
+    assert(instances.instance_count() == 60 && instances.size() == 0 && instances.primitive_count() == 60);
+    objects.build_bvh();
+
+    glimmer::Pcg32 rng{5};
+    auto random_ray = [&] {
+        const V3 o{rng.uniform<float>() * 20.0f - 10.0f, 3.0f, 4.0f};
+        const V3 target{rng.uniform<float>() * 16.0f - 8.0f, rng.uniform<float>() - 0.5f, -rng.uniform<float>() * 9.0f};
+        return glimmer::Ray<float>{o, (target - o).normalized()};
+    };
+    for (int pass = 0; pass < 2; ++pass) { // linear scan, then BVH
+        glimmer::Pcg32 reset{5};
+        rng = reset;
+        int hits = 0;
+        for (int k = 0; k < 2000; ++k) {
+            const auto ray = random_ray();
+            const auto a = objects.intersect(ray);
+            const auto b = instances.intersect(ray);
+            assert(a.has_value() == b.has_value());
+            assert(objects.occluded(ray) == instances.occluded(ray));
+            if (!a) continue;
+            ++hits;
+            assert(std::abs(a->t - b->t) < 1e-4f * a->t);
+            assert(b->object == nullptr && b->object_index == a->object_index);
+            const V3 na = a->normal.normalized(), nb = b->normal.normalized();
+            assert(dot(na, nb) > 0.9999f);
+            assert(objects.surface(*a).albedo == instances.surface(*b).albedo);
+        }
+        assert(hits > 200);
+        instances.build_bvh();
+        assert(instances.instance_bvh().primitive_count() == 60);
+    }
+
+    // Packet queries agree with single-ray queries
+    glimmer::RayPacket<float, glimmer::default_packet_size> packet;
+    std::array<std::optional<Scene<float>::Hit>, glimmer::default_packet_size> hits;
+    for (std::size_t i = 0; i < glimmer::default_packet_size; ++i) packet.set(i, random_ray());
+    packet.count = glimmer::default_packet_size;
+    instances.intersect_packet(packet, hits);
+    for (std::size_t i = 0; i < glimmer::default_packet_size; ++i) {
+        const auto single = instances.intersect(packet.ray(i));
+        assert(single.has_value() == hits[i].has_value());
+        if (single) assert(single->t == hits[i]->t && single->object_index == hits[i]->object_index);
+    }
+}
+
+static void test_instance_updates()
+{
+    Scene<float> scene;
+    const auto geo = scene.add_geometry(std::make_shared<glimmer::Sphere<float>>(V3{0, 0, 0}, 1.0f));
+    const auto mat = scene.add_material(Material<float>::lambertian(Color3{0.5f, 0.5f, 0.5f}));
+    scene.add_instance(geo, mat, glimmer::Affine3<float>{});
+    scene.build_bvh();
+    const glimmer::Ray<float> ray{V3{5, 0, 0}, V3{-1, 0, 0}};
+    auto hit = scene.intersect(ray);
+    assert(hit && std::abs(hit->t - 4.0f) < 1e-5f);
+
+    // Moving an instance and refitting updates the answers
+    std::array<float,12> shifted{1, 0, 0, 2, 0, 1, 0, 0, 0, 0, 1, 0};
+    scene.set_instance_transform(0, glimmer::Affine3<float>{shifted});
+    scene.refit_bvh();
+    hit = scene.intersect(ray);
+    assert(hit && std::abs(hit->t - 2.0f) < 1e-5f);
+    assert(scene.aabb().max()[0] == 3.0f);
+
+    bool threw = false;
+    try { scene.add_instance(7, mat, glimmer::Affine3<float>{}); } catch (const std::out_of_range&) { threw = true; }
+    assert(threw);
+    scene.clear();
+    assert(scene.empty() && scene.geometries().empty());
+}
+
+int main()
+{
+    test_instances_match_objects();
+    test_instance_updates();
+    std::cout << "All instance tests passed.\n";
+    return 0;
+}
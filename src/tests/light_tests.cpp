@@ -0,0 +1,158 @@
+import glimmer.light;
+import glimmer.scene;
+import glimmer.scene_object;
+import glimmer.sphere;
+import glimmer.plane;
+import glimmer.mesh;
+import glimmer.material;
+import glimmer.transform;
+import glimmer.quaternion;
+import glimmer.sampler;
+import glimmer.color;
+import glimmer.vector;
+import glimmer.ray;
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <numbers>
+
+using glimmer::Light;
+using glimmer::LightList;
+using glimmer::Scene;
+using glimmer::SceneObject;
+using glimmer::Sphere;
+using glimmer::Material;
+using glimmer::Transform;
+using glimmer::Vector;
+using Color3d = glimmer::Color<double,3>;
+using V3 = Vector<double,3>;
+using V2 = Vector<double,2>;
+
+static void test_pick_by_power()
+{
+    LightList<double> lights;
+    lights.add(Light<double>{2, 1.0, 1.0});
+    lights.add(Light<double>{5, 1.0, 0.0}); // ignored: no power
+    lights.add(Light<double>{7, 1.0, 3.0});
+    assert(lights.size() == 2);
+    assert(lights.total_power() == 4.0);
+    assert(lights.find(2) == 0 && lights.find(7) == 1);
+    assert(lights.find(5) == LightList<double>::npos && lights.find(100) == LightList<double>::npos);
+    assert(lights.pmf(0) == 0.25 && lights.pmf(1) == 0.75);
+    assert(lights.pick(0.0).light == 0 && lights.pick(0.2).light == 0);
+    assert(lights.pick(0.3).light == 1 && lights.pick(0.999).light == 1);
+    assert(lights.pick(0.3).pmf == 0.75);
+    lights.clear();
+    assert(lights.empty() && lights.find(2) == LightList<double>::npos);
+}
+
+static void test_power_heuristic()
+{
+    const double a = glimmer::power_heuristic(2.0, 1.0);
+    const double b = glimmer::power_heuristic(1.0, 2.0);
+    assert(std::abs(a - 0.8) < 1e-12 && std::abs(a + b - 1.0) < 1e-12);
+    assert(glimmer::power_heuristic(1.0, 0.0) == 1.0);
+    assert(glimmer::power_heuristic(0.0, 0.0) == 0.0);
+}
+
+static void test_scene_collects_emitters()
+{
+    Scene<double> scene;
+    auto unit = std::make_shared<Sphere<double>>(V3{0, 0, 0}, 1.0);
+    scene.add_object(SceneObject<double>{unit, Material<double>::lambertian(Color3d{0.5, 0.5, 0.5}), Transform<double>{}});
+    const auto half = Transform<double>::from_trs(V3{0, 3, 0}, glimmer::Quaternion<double>{}, V3{0.5, 0.5, 0.5});
+    scene.add_object(SceneObject<double>{unit, Material<double>::emissive(Color3d{2, 2, 2}, 3.0), half});
+    // Unbounded shapes cannot be sampled by area
+    scene.add_object(SceneObject<double>{std::make_shared<glimmer::Plane<double>>(V3{0, -1, 0}, V3{0, 1, 0}),
+                                         Material<double>::emissive(Color3d{1, 1, 1}, 1.0), Transform<double>{}});
+    assert(scene.lights().size() == 1);
+    const auto& light = scene.lights()[0];
+    assert(light.object == 1);
+    assert(std::abs(light.area - std::numbers::pi) < 1e-9);
+    assert(std::abs(light.power - std::numbers::pi * std::numbers::pi * 6.0) < 1e-9);
+
+    scene.build_bvh();
+    assert(scene.lights().size() == 1);
+    // Materials changed through objects() are picked up by build_lights()
+    scene.objects()[0].set_material(Material<double>::emissive(Color3d{1, 0, 0}, 1.0));
+    scene.build_lights();
+    assert(scene.lights().size() == 2);
+    scene.clear();
+    assert(scene.lights().empty());
+}
+
+// The density reported for hits must match the density samples are drawn with, also under non-uniform scale
+static void test_sample_density_matches_hits()
+{
+    Scene<double> scene;
+    auto unit = std::make_shared<Sphere<double>>(V3{0, 0, 0}, 1.0);
+    const auto xf = Transform<double>::from_trs(V3{0.5, 0, 0}, glimmer::Quaternion<double>::from_axis_angle(V3{0, 0, 1}, 0.3),
+                                                V3{2.0, 1.0, 0.5});
+    scene.add_object(SceneObject<double>{unit, Material<double>::emissive(Color3d{1, 1, 1}, 1.0), xf});
+    scene.build_bvh();
+
+    glimmer::Pcg32 rng{7};
+    double area = 0.0;
+    const int n = 20000;
+    for (int i = 0; i < n; ++i) {
+        const auto s = scene.sample_light(rng.uniform<double>(), V2{rng.uniform<double>(), rng.uniform<double>()});
+        assert(s && s->object_index == 0 && s->pdf > 0.0);
+        assert(std::abs(s->normal.norm() - 1.0) < 1e-9);
+        assert(s->emitted[0] == 1.0);
+        area += 1.0 / s->pdf;
+        if (i % 100 == 0) {
+            // Shoot at the sampled point from outside along its normal
+            const V3 origin = s->p + s->normal * 10.0;
+            const auto hit = scene.intersect(glimmer::Ray<double>{origin, -s->normal});
+            assert(hit);
+            assert(std::abs(scene.light_pdf(*hit) - s->pdf) < 1e-6 * s->pdf);
+        }
+    }
+    area /= n;
+    // Ellipsoid with semi-axes 2, 1, 0.5 (Knud Thomsen's approximation is within about 1%)
+    const double p = 1.6075;
+    const double approx = 4.0 * std::numbers::pi *
+        std::pow((std::pow(2.0 * 1.0, p) + std::pow(2.0 * 0.5, p) + std::pow(1.0 * 0.5, p)) / 3.0, 1.0 / p);
+    assert(std::abs(area - approx) / approx < 0.02);
+}
+
+static void test_mesh_emitter()
+{
+    glimmer::Mesh<double> quad;
+    quad.add_vertex(V3{0, 0, 0});
+    quad.add_vertex(V3{2, 0, 0});
+    quad.add_vertex(V3{2, 1, 0});
+    quad.add_vertex(V3{0, 1, 0});
+    quad.add_triangle(0, 1, 2);
+    quad.add_triangle(0, 2, 3);
+    assert(quad.area() == 0.0); // not tabulated before build_bvh()
+    quad.build_bvh();
+    assert(std::abs(quad.area() - 2.0) < 1e-12);
+
+    Scene<double> scene;
+    scene.add_object(SceneObject<double>{std::make_shared<glimmer::Mesh<double>>(quad),
+                                         Material<double>::emissive(Color3d{1, 1, 1}, 1.0), Transform<double>{}});
+    assert(scene.lights().size() == 1);
+    glimmer::Pcg32 rng{3};
+    double mean_x = 0.0;
+    for (int i = 0; i < 4000; ++i) {
+        const auto s = scene.sample_light(rng.uniform<double>(), V2{rng.uniform<double>(), rng.uniform<double>()});
+        assert(s && std::abs(s->pdf - 0.5) < 1e-12);
+        assert(s->p[0] >= -1e-12 && s->p[0] <= 2 + 1e-12 && s->p[1] >= -1e-12 && s->p[1] <= 1 + 1e-12);
+        assert(std::abs(s->p[2]) < 1e-12 && std::abs(std::abs(s->normal[2]) - 1.0) < 1e-12);
+        mean_x += s->p[0];
+    }
+    assert(std::abs(mean_x / 4000 - 1.0) < 0.05);
+}
+
+int main()
+{
+    test_pick_by_power();
+    test_power_heuristic();
+    test_scene_collects_emitters();
+    test_sample_density_matches_hits();
+    test_mesh_emitter();
+    std::cout << "All light tests passed.\n";
+    return 0;
+}
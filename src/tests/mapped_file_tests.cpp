@@ -0,0 +1,44 @@
+import glimmer.mapped_file;
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+
+using glimmer::MappedFile;
+
+static void test_map_contents() {
+    const std::string path = "mapped_file_test.txt";
+    const std::string contents = "hello\nmapped world\n";
+    { std::ofstream f(path, std::ios::binary); f << contents; }
+    auto file = MappedFile::open(path);
+    assert(file.has_value());
+    assert(file->size() == contents.size());
+    assert(file->view() == contents);
+    assert(file->bytes().size() == contents.size());
+
+    // Moving transfers the view
+    MappedFile moved = std::move(*file);
+    assert(moved.view() == contents);
+    assert(file->empty() && file->data() == nullptr);
+    std::filesystem::remove(path);
+}
+
+static void test_empty_and_missing() {
+    const std::string path = "mapped_file_empty.txt";
+    { std::ofstream f(path, std::ios::binary); }
+    auto empty = MappedFile::open(path);
+    assert(empty.has_value() && empty->empty() && empty->view().empty());
+    std::filesystem::remove(path);
+
+    assert(!MappedFile::open("this_file_does_not_exist.bin").has_value());
+}
+
+int main() {
+    test_map_contents();
+    test_empty_and_missing();
+    std::cout << "All mapped_file tests passed.\n";
+    return 0;
+}
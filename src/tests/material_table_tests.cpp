@@ -0,0 +1,171 @@
+import glimmer.material_table;
+import glimmer.material;
+import glimmer.material_property;
+import glimmer.material_property.image;
+import glimmer.material_property.checkerboard;
+import glimmer.bsdf;
+import glimmer.image;
+import glimmer.color;
+import glimmer.vector;
+import glimmer.scene;
+import glimmer.scene_object;
+import glimmer.sphere;
+import glimmer.transform;
+import glimmer.ray;
+#include <cassert>
+#include <iostream>
+#include <memory>
+
+using glimmer::Material;
+using glimmer::MaterialTable;
+using glimmer::MaterialId;
+using glimmer::SurfaceParams;
+using glimmer::Vector;
+using glimmer::Color3f;
+using M = Material<float>;
+using V2 = Vector<float,2>;
+
+static bool same(const SurfaceParams<float>& a, const SurfaceParams<float>& b)
+{
+    return a.emitted == b.emitted && a.albedo == b.albedo && a.roughness == b.roughness
+        && a.transparency == b.transparency && a.ior == b.ior;
+}
+
+// Property outside the recognized implementations: evaluated through the virtual interface
+class RampProperty final : public glimmer::MaterialProperty<float, float>
+{
+public:
+    [[nodiscard]] float get(const V2& uv) const noexcept override { return uv[0]; }
+};
+
+static void test_uniform_materials_match()
+{
+    MaterialTable<float> table;
+    const M mats[] = {
+        M::lambertian(Color3f{0.2f, 0.4f, 0.6f}),
+        M::metal(Color3f{0.9f, 0.9f, 0.9f}, 1.5f),
+        M::emissive(Color3f{4.0f, 2.0f, 1.0f}, 3.0f),
+        M::glass(Color3f{1.0f, 1.0f, 1.0f}, 0.1f, 0.9f),
+    };
+    for (const auto& m : mats) {
+        const MaterialId id = table.add(m);
+        assert(table.uniform(id));
+        assert(same(table.surface(id, V2{0.3f, 0.7f}), glimmer::surface_params(m, V2{0.3f, 0.7f})));
+    }
+    assert(table.size() == 4);
+    // Clamping matches the Material accessors
+    assert(table.surface(1, V2{0.0f, 0.0f}).roughness == 1.0f);
+}
+
+static void test_textured_properties_match()
+{
+    glimmer::Image<float,3> img{4, 4, Color3f{0.0f, 0.0f, 0.0f}};
+    for (std::size_t y = 0; y < 4; ++y)
+        for (std::size_t x = 0; x < 4; ++x) img(x, y) = Color3f{x * 0.25f, y * 0.25f, 1.0f};
+
+    M checker = M::lambertian(Color3f{1.0f, 1.0f, 1.0f});
+    checker.set_albedo_property(std::make_shared<glimmer::CheckerboardMaterialProperty<float,3>>(
+        Color3f{1.0f, 0.0f, 0.0f}, Color3f{0.0f, 0.0f, 1.0f}, 4.0f, 4.0f));
+    M textured = M::metal(Color3f{0.0f, 0.0f, 0.0f}, 0.5f);
+    textured.set_albedo_property(std::make_shared<glimmer::ImageMaterialProperty<float,3>>(img));
+    M ramp = M::lambertian(Color3f{0.5f, 0.5f, 0.5f});
+    ramp.set_roughness_property(std::make_shared<RampProperty>());
+
+    MaterialTable<float> table;
+    const MaterialId ids[] = {table.add(checker), table.add(textured), table.add(ramp)};
+    const M* mats[] = {&checker, &textured, &ramp};
+    for (std::size_t k = 0; k < 3; ++k) {
+        assert(!table.uniform(ids[k]));
+        for (float u = -0.5f; u < 1.5f; u += 0.125f) {
+            const V2 uv{u, 1.0f - u};
+            assert(same(table.surface(ids[k], uv), glimmer::surface_params(*mats[k], uv)));
+        }
+    }
+}
+
+static void test_intern_deduplicates()
+{
+    MaterialTable<float> table;
+    const auto a = std::make_shared<const M>(M::lambertian(Color3f{1.0f, 0.0f, 0.0f}));
+    const auto b = std::make_shared<const M>(*a);
+    const MaterialId ia = table.intern(a);
+    assert(table.intern(a) == ia);
+    assert(table.intern(b) != ia);
+    assert(table.intern(nullptr) == glimmer::invalid_material);
+    assert(table.size() == 2);
+    table.clear();
+    assert(table.empty());
+}
+
+static void test_scene_binds_materials()
+{
+    using glimmer::Scene;
+    using glimmer::SceneObject;
+    Scene<float> scene;
+    auto geom = std::make_shared<glimmer::Sphere<float>>(Vector<float,3>{0, 0, 0}, 1.0f);
+    const SceneObject<float> red{geom, M::lambertian(Color3f{1.0f, 0.0f, 0.0f}), glimmer::Transform<float>{}};
+    scene.add_object(red);
+    scene.add_object(red); // copies share one entry
+    const MaterialId blue = scene.add_material(M::lambertian(Color3f{0.0f, 0.0f, 1.0f}));
+    scene.add_object(SceneObject<float>{geom, blue, glimmer::Transform<float>{}});
+    assert(scene.materials().size() == 2);
+    assert(scene.objects()[0].material_id() == scene.objects()[1].material_id());
+    assert(scene.objects()[2].material_id() == blue);
+    assert(!scene.objects()[2].material_ptr());
+
+    const glimmer::Ray<float> ray{Vector<float,3>{0, 0, 5}, Vector<float,3>{0, 0, -1}};
+    auto hit = scene.intersect(ray);
+    assert(hit);
+    const float albedo_r = scene.surface(*hit).albedo[0];
+    const float albedo_b = scene.surface(*hit).albedo[2];
+    assert((albedo_r == 1.0f && albedo_b == 0.0f) || (albedo_r == 0.0f && albedo_b == 1.0f));
+
+    // Replacing a material after the object was added falls back to evaluating it directly
+    for (auto& o : scene.objects()) o.set_material(M::lambertian(Color3f{0.0f, 1.0f, 0.0f}));
+    hit = scene.intersect(ray);
+    assert(hit && scene.surface(*hit).albedo[1] == 1.0f);
+}
+
+static void test_shading_features()
+{
+    using glimmer::ShadingFeatures;
+    MaterialTable<float> table;
+    assert(table.features() == ShadingFeatures::none());
+    const MaterialId diffuse = table.add(M::lambertian(Color3f{0.5f, 0.5f, 0.5f}));
+    assert(table.features(diffuse) == ShadingFeatures::none());
+    const MaterialId mirror = table.add(M::metal(Color3f{0.9f, 0.9f, 0.9f}, 0.2f));
+    assert(table.features(mirror).specular && !table.features(mirror).dielectric);
+    const MaterialId glass = table.add(M::glass(Color3f{1.0f, 1.0f, 1.0f}, 0.0f, 1.0f));
+    assert(table.features(glass).dielectric);
+    assert(!table.features().emission && !table.features().textured);
+
+    // A roughness that varies with UV may reach 0 anywhere
+    M ramp = M::lambertian(Color3f{0.5f, 0.5f, 0.5f});
+    ramp.set_roughness_property(std::make_shared<RampProperty>());
+    const ShadingFeatures f = table.features(table.add(ramp));
+    assert(f.textured && f.specular && !f.dielectric && !f.emission);
+    table.add(M::emissive(Color3f{1.0f, 1.0f, 1.0f}, 2.0f));
+    assert(table.features() == (ShadingFeatures{true, true, true, true}));
+    table.clear();
+    assert(table.features() == ShadingFeatures::none());
+
+    // Scenes report the union of their materials, and everything for materials outside the table
+    glimmer::Scene<float> scene;
+    auto geom = std::make_shared<glimmer::Sphere<float>>(Vector<float,3>{0, 0, 0}, 1.0f);
+    scene.add_object(glimmer::SceneObject<float>{geom, M::lambertian(Color3f{1.0f, 0.0f, 0.0f}),
+                                                 glimmer::Transform<float>{}});
+    assert(scene.shading_features() == ShadingFeatures::none());
+    scene.objects()[0].set_material(M::lambertian(Color3f{0.0f, 1.0f, 0.0f}));
+    assert(scene.shading_features() == ShadingFeatures{});
+}
+
+int main()
+{
+    test_uniform_materials_match();
+    test_textured_properties_match();
+    test_intern_deduplicates();
+    test_scene_binds_materials();
+    test_shading_features();
+    std::cout << "All material table tests passed.\n";
+    return 0;
+}
@@ -124,6 +124,33 @@ static void test_det_inverse_4x4() {
             assert(std::abs(I(r,c) - (r==c ? 1.0 : 0.0)) < 1e-7);
 }
 
+static void test_affine_inverse_4x4() {
+    // Last row 0 0 0 1 takes the closed-form path; it must agree with the general case
+    Matrix<double,4,4> A{
+        2, 1, 0, 3,
+        0, 3, -1, -2,
+        1, 0, 4, 0.5,
+        0, 0, 0, 1
+    };
+    auto inv = A.inverse();
+    auto I = A * inv;
+    for (std::size_t r = 0; r < 4; ++r)
+        for (std::size_t c = 0; c < 4; ++c)
+            assert(std::abs(I(r,c) - (r==c ? 1.0 : 0.0)) < 1e-12);
+    assert(inv(3,0) == 0.0 && inv(3,1) == 0.0 && inv(3,2) == 0.0 && inv(3,3) == 1.0);
+
+    Matrix<double,4,4> flat{
+        1, 0, 0, 1,
+        0, 1, 0, 2,
+        0, 0, 0, 3,
+        0, 0, 0, 1
+    };
+    bool threw = false;
+    try { (void)flat.inverse(); }
+    catch (const std::domain_error&) { threw = true; }
+    assert(threw);
+}
+
 static void test_singular_throws() {
     Matrix<int,2,2> Z{}; // zero matrix
     bool threw = false;
@@ -175,6 +202,7 @@ int main() {
     test_det_inverse_2x2();
     test_det_inverse_3x3();
     test_det_inverse_4x4();
+    test_affine_inverse_4x4();
     test_det_inverse_5x5();
     test_singular_throws();
     test_singular_5x5_throws();
@@ -0,0 +1,172 @@
+import glimmer.mesh_cache;
+import glimmer.mesh;
+import glimmer.bvh;
+import glimmer.obj;
+import glimmer.vector;
+import glimmer.ray;
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+using glimmer::Mesh;
+using glimmer::Ray;
+using glimmer::Vector;
+
+static Mesh<double> make_grid(int n){
+    // n x n quads in the z = 0 plane with normals and texcoords on every other triangle
+    std::string text;
+    for (int y = 0; y <= n; ++y)
+        for (int x = 0; x <= n; ++x)
+            text += "v " + std::to_string(x) + " " + std::to_string(y) + " 0\n";
+    text += "vn 0 0 1\nvt 0 0\nvt 1 0\nvt 0 1\n";
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < n; ++x) {
+            const int i = y * (n + 1) + x + 1;
+            text += "f " + std::to_string(i) + "/1/1 " + std::to_string(i + 1) + "/2/1 " + std::to_string(i + n + 1) + "/3/1\n";
+            text += "f " + std::to_string(i + 1) + " " + std::to_string(i + n + 2) + " " + std::to_string(i + n + 1) + "\n";
+        }
+    return glimmer::parse_obj<double>(text);
+}
+
+static void test_round_trip(){
+    const std::string path = "mesh_cache_test.glmesh";
+    const auto mesh = make_grid(16);
+    assert(glimmer::save_mesh_cache(mesh, path));
+
+    auto loaded = glimmer::load_mesh_cache<double>(path);
+    assert(loaded);
+    assert(loaded->borrowed());
+    assert(loaded->bvh().borrowed());
+    assert(loaded->has_bvh());
+    assert(loaded->vertex_count() == mesh.vertex_count());
+    assert(loaded->triangle_count() == mesh.triangle_count());
+    assert(loaded->normal_count() == 1 && loaded->texcoord_count() == 3);
+    for (std::size_t i = 0; i < mesh.triangle_count(); ++i) {
+        assert(loaded->triangle(i).i0 == mesh.triangle(i).i0);
+        assert(loaded->triangle(i).i2 == mesh.triangle(i).i2);
+        assert(loaded->triangle_attributes(i).texcoord == mesh.triangle_attributes(i).texcoord);
+    }
+
+    // Queries agree with the original mesh
+    for (int k = 0; k < 64; ++k) {
+        const double x = 0.37 + 0.23 * k, y = 15.6 - 0.21 * k;
+        const Ray<double> r{Vector<double,3>{x, y, 5.0}, Vector<double,3>{0.0, 0.0, -1.0}};
+        const auto a = mesh.intersect(r);
+        const auto b = loaded->intersect(r);
+        assert(a && b);
+        assert(a->t == b->t && a->uv == b->uv && a->normal == b->normal);
+    }
+
+    // Copies share the mapping; modifying one copies its data out of the mapping
+    auto copy = *loaded;
+    loaded.reset();
+    assert(copy.borrowed() && copy.vertex_count() == mesh.vertex_count());
+    copy.add_vertex(Vector<double,3>{0.0, 0.0, 1.0});
+    assert(!copy.borrowed() && copy.vertex_count() == mesh.vertex_count() + 1);
+    std::filesystem::remove(path);
+}
+
+static void test_rejects_bad_files(){
+    const std::string path = "mesh_cache_bad.glmesh";
+    const auto mesh = make_grid(2);
+    assert(glimmer::save_mesh_cache(mesh, path));
+    // Wrong scalar type
+    assert(!glimmer::load_mesh_cache<float>(path));
+
+    // Corrupt an index in the first triangle; validation must catch it
+    auto bytes = [&] {
+        std::ifstream in(path, std::ios::binary);
+        return std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    }();
+    std::uint64_t tri_offset = 0;
+    for (std::size_t s = 0; s < 8; ++s) {
+        const char* e = bytes.data() + 64 + 32 * s;
+        std::uint32_t kind;
+        std::memcpy(&kind, e, 4);
+        if (kind == 2) { std::memcpy(&tri_offset, e + 8, 8); break; }
+    }
+    assert(tri_offset != 0);
+    const std::uint32_t huge = 1u << 30;
+    std::memcpy(bytes.data() + tri_offset, &huge, sizeof(huge));
+    { std::ofstream out(path, std::ios::binary | std::ios::trunc); out << bytes; }
+    assert(!glimmer::load_mesh_cache<double>(path));
+
+    // Truncated file and wrong magic
+    { std::ofstream out(path, std::ios::binary | std::ios::trunc); out << bytes.substr(0, bytes.size() / 2); }
+    assert(!glimmer::load_mesh_cache<double>(path));
+    { std::ofstream out(path, std::ios::binary | std::ios::trunc); out << "not a mesh cache file at all"; }
+    assert(!glimmer::load_mesh_cache<double>(path));
+    std::filesystem::remove(path);
+    assert(!glimmer::load_mesh_cache<double>(path));
+}
+
+static void test_load_mesh_uses_and_refreshes_cache(){
+    namespace fs = std::filesystem;
+    const std::string obj = "mesh_cache_test.obj";
+    const std::string cache = obj + ".glmesh";
+    { std::ofstream f(obj); f << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n"; }
+    fs::remove(cache);
+
+    auto first = glimmer::load_mesh<double>(obj);
+    assert(first.triangle_count() == 1 && !first.borrowed());
+    assert(fs::exists(cache));
+
+    auto second = glimmer::load_mesh<double>(obj);
+    assert(second.triangle_count() == 1 && second.borrowed() && second.has_bvh());
+
+    // A newer OBJ invalidates the cache
+    { std::ofstream f(obj); f << "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nf 1 2 3\nf 2 4 3\n"; }
+    fs::last_write_time(cache, fs::last_write_time(obj) - std::chrono::seconds{2});
+    auto third = glimmer::load_mesh<double>(obj);
+    assert(third.triangle_count() == 2 && !third.borrowed());
+    auto fourth = glimmer::load_mesh<double>(obj);
+    assert(fourth.triangle_count() == 2 && fourth.borrowed());
+    fs::remove(obj);
+    fs::remove(cache);
+}
+
+static void test_rejects_shared_bvh_children(){
+    // A node list whose "tree" shares a subtree (a DAG) passes the per-node ordering checks but must be
+    // rejected: traversal could revisit nodes without bound and overrun its fixed-size stack
+    const std::string path = "mesh_cache_dag.glmesh";
+    const auto mesh = make_grid(4);
+    assert(glimmer::save_mesh_cache(mesh, path));
+    const auto nodes = mesh.arrays().bvh_nodes;
+    assert(nodes.size() > 4 && !nodes[0].is_leaf() && !nodes[1].is_leaf());
+    const std::uint32_t shared = nodes[0].first; // right child of the root, also made the right child of node 1
+    assert(shared > 2);
+
+    auto bytes = [&] {
+        std::ifstream in(path, std::ios::binary);
+        return std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    }();
+    std::uint64_t node_offset = 0;
+    for (std::size_t s = 0; s < 8; ++s) {
+        const char* e = bytes.data() + 64 + 32 * s;
+        std::uint32_t kind;
+        std::memcpy(&kind, e, 4);
+        if (kind == 6) { std::memcpy(&node_offset, e + 8, 8); break; }
+    }
+    assert(node_offset != 0);
+    using Node = glimmer::BvhNode<double>;
+    std::memcpy(bytes.data() + node_offset + sizeof(Node) + offsetof(Node, first), &shared, sizeof(shared));
+    { std::ofstream out(path, std::ios::binary | std::ios::trunc); out << bytes; }
+    assert(!glimmer::load_mesh_cache<double>(path));
+    std::filesystem::remove(path);
+}
+
+int main(){
+    test_round_trip();
+    test_rejects_bad_files();
+    test_rejects_shared_bvh_children();
+    test_load_mesh_uses_and_refreshes_cache();
+    std::cout << "All mesh_cache tests passed.\n";
+    return 0;
+}
@@ -4,13 +4,19 @@ import glimmer.vector;
 import glimmer.aabb;
 #include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <optional>
+#include <stdexcept>
 
 using glimmer::Mesh;
 using glimmer::Ray;
 using glimmer::Vector;
 using glimmer::intersect_triangle;
+using glimmer::MeshLayout;
+
+static_assert(sizeof(Mesh<float>::Triangle) == 12);
 
 static void test_intersect_triangle_standalone() {
     Vector<double,3> p0{0,0,0};
@@ -56,10 +62,169 @@ static void test_aabb_empty_mesh() {
     assert(box.empty());
 }
 
+// Triangulated height field on [0,n]x[0,n] with z = 0.1 * sin-like bumps
+static Mesh<double> make_grid(std::size_t n) {
+    Mesh<double> m;
+    for (std::size_t j = 0; j <= n; ++j)
+        for (std::size_t i = 0; i <= n; ++i)
+            m.add_vertex(Vector<double,3>{double(i), double(j), 0.1 * double((i * 7 + j * 3) % 5)});
+    auto id = [n](std::size_t i, std::size_t j) { return j * (n + 1) + i; };
+    for (std::size_t j = 0; j < n; ++j) {
+        for (std::size_t i = 0; i < n; ++i) {
+            m.add_triangle(id(i,j), id(i+1,j), id(i+1,j+1));
+            m.add_triangle(id(i,j), id(i+1,j+1), id(i,j+1));
+        }
+    }
+    return m;
+}
+
+static void test_bvh_matches_brute_force() {
+    Mesh<double> brute = make_grid(24);
+    Mesh<double> accel = make_grid(24);
+    accel.build_bvh();
+    assert(!brute.has_bvh());
+    assert(accel.has_bvh());
+    assert(accel.bvh().primitive_count() == accel.triangle_count());
+    for (int k = 0; k < 200; ++k) {
+        const double x = 0.137 + 0.119 * k;
+        const double y = 0.071 + 0.113 * ((k * 37) % 200);
+        // Slanted rays from above so several triangles overlap in projection
+        Ray<double> r{Vector<double,3>{x, y, 5}, Vector<double,3>{0.3, -0.2, -1}, 0.0, 100.0};
+        auto hb = brute.intersect(r);
+        auto ha = accel.intersect(r);
+        assert(hb.has_value() == ha.has_value());
+        if (hb) {
+            assert(std::abs(hb->t - ha->t) < 1e-12);
+            assert(std::abs(hb->normal[2] - ha->normal[2]) < 1e-12);
+        }
+    }
+    // Range shorter than the distance to the surface yields no hit
+    Ray<double> short_ray{Vector<double,3>{3.3, 3.3, 5}, Vector<double,3>{0,0,-1}, 0.0, 1.0};
+    assert(!accel.intersect(short_ray).has_value());
+}
+
+static void test_add_triangle_invalidates_bvh() {
+    Mesh<double> m = make_grid(2);
+    m.build_bvh();
+    assert(m.has_bvh());
+    auto a = m.add_vertex(Vector<double,3>{10,10,0});
+    auto b = m.add_vertex(Vector<double,3>{11,10,0});
+    auto c = m.add_vertex(Vector<double,3>{10,11,0});
+    m.add_triangle(a, b, c);
+    assert(!m.has_bvh());
+    // New triangle is still found through the brute-force fallback
+    Ray<double> r{Vector<double,3>{10.2,10.2,1}, Vector<double,3>{0,0,-1}, 0.0, 100.0};
+    assert(m.intersect(r).has_value());
+    m.build_bvh();
+    assert(m.has_bvh() && m.intersect(r).has_value());
+}
+
+static void test_add_triangle_rejects_wide_indices() {
+    // Triangles store 32-bit indices; larger indices are rejected instead of wrapping around
+    Mesh<double> m = make_grid(2);
+    const std::size_t before = m.triangle_count();
+    if constexpr (sizeof(std::size_t) > sizeof(std::uint32_t)) {
+        bool threw = false;
+        try {
+            m.add_triangle(0, 1, std::size_t{1} << 32);
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        assert(threw && m.triangle_count() == before);
+    }
+    bool threw = false;
+    try {
+        m.add_triangle(0, Mesh<double>::max_elements, 1);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw && m.triangle_count() == before);
+    m.add_triangle(0, 1, 2);
+    assert(m.triangle_count() == before + 1);
+}
+
+static void test_occluded_matches_intersect() {
+    Mesh<double> brute = make_grid(12);
+    Mesh<double> accel = make_grid(12);
+    accel.build_bvh();
+    for (int k = 0; k < 100; ++k) {
+        const double x = -1.0 + 0.141 * k;
+        Ray<double> r{Vector<double,3>{x, 0.37 * (k % 40), 3}, Vector<double,3>{0.1, 0.2, -1}, 0.0, 100.0};
+        const bool expected = brute.intersect(r).has_value();
+        assert(brute.occluded(r) == expected);
+        assert(accel.occluded(r) == expected);
+    }
+    Ray<double> up{Vector<double,3>{3.5, 3.5, 1}, Vector<double,3>{0,0,1}, 0.0, 100.0};
+    assert(!accel.occluded(up));
+    // Standalone triangle test
+    Vector<double,3> p0{0,0,0}, p1{1,0,0}, p2{0,1,0};
+    assert(glimmer::occludes_triangle(p0,p1,p2, Ray<double>{Vector<double,3>{0.25,0.25,1}, Vector<double,3>{0,0,-1}, 0.0, 100.0}));
+    assert(!glimmer::occludes_triangle(p0,p1,p2, Ray<double>{Vector<double,3>{0.25,0.25,1}, Vector<double,3>{0,0,-1}, 0.0, 0.5}));
+}
+
+static void test_precomputed_layout_matches_compact() {
+    Mesh<double> compact = make_grid(16);
+    Mesh<double> fast = make_grid(16);
+    compact.build_bvh();
+    fast.set_layout(MeshLayout::precomputed);
+    assert(compact.layout() == MeshLayout::compact && !compact.has_precomputed());
+    assert(fast.has_precomputed());
+    fast.build_bvh();
+    assert(fast.has_precomputed() && fast.has_bvh());
+    assert(fast.memory_bytes() == compact.memory_bytes() + fast.triangle_count() * sizeof(glimmer::TriangleEdges<double>));
+    for (int k = 0; k < 200; ++k) {
+        const double x = 0.21 + 0.077 * k;
+        const double y = 0.05 + 0.079 * ((k * 53) % 200);
+        Ray<double> r{Vector<double,3>{x, y, 4}, Vector<double,3>{-0.2, 0.3, -1}, 0.0, 100.0};
+        const auto a = compact.intersect(r);
+        const auto b = fast.intersect(r);
+        assert(a.has_value() == b.has_value());
+        if (a) assert(a->t == b->t && a->normal == b->normal);
+        assert(compact.occluded(r) == fast.occluded(r));
+    }
+    // Adding a triangle drops the cached data until the next build_bvh()
+    auto v0 = fast.add_vertex(Vector<double,3>{20,20,0});
+    auto v1 = fast.add_vertex(Vector<double,3>{21,20,0});
+    auto v2 = fast.add_vertex(Vector<double,3>{20,21,0});
+    fast.add_triangle(v0, v1, v2);
+    assert(!fast.has_precomputed());
+    Ray<double> r{Vector<double,3>{20.2,20.2,1}, Vector<double,3>{0,0,-1}, 0.0, 100.0};
+    assert(fast.intersect(r).has_value());
+    fast.build_bvh();
+    assert(fast.has_precomputed() && fast.intersect(r).has_value());
+    fast.set_layout(MeshLayout::compact);
+    assert(!fast.has_precomputed() && fast.intersect(r).has_value());
+}
+
+static void test_uv_scale_from_texcoords() {
+    // 2x2 quad mapped to the unit UV square: half a UV unit per unit length
+    Mesh<double> m;
+    auto i0 = m.add_vertex(Vector<double,3>{0,0,0});
+    auto i1 = m.add_vertex(Vector<double,3>{2,0,0});
+    auto i2 = m.add_vertex(Vector<double,3>{2,2,0});
+    auto t0 = static_cast<std::uint32_t>(m.add_texcoord(Vector<double,2>{0,0}));
+    auto t1 = static_cast<std::uint32_t>(m.add_texcoord(Vector<double,2>{1,0}));
+    auto t2 = static_cast<std::uint32_t>(m.add_texcoord(Vector<double,2>{1,1}));
+    m.add_triangle(i0,i1,i2);
+    Mesh<double>::TriangleAttributes a{};
+    a.texcoord = {t0, t1, t2};
+    m.set_triangle_attributes(0, a);
+    auto h = m.intersect(Ray<double>{Vector<double,3>{1.5,0.5,1}, Vector<double,3>{0,0,-1}, 0.0, 100.0});
+    assert(h.has_value());
+    assert(std::abs(h->uv[0] - 0.75) < 1e-12 && std::abs(h->uv[1] - 0.25) < 1e-12);
+    assert(std::abs(h->uv_scale - 0.5) < 1e-12);
+}
+
 int main(){
     test_intersect_triangle_standalone();
     test_mesh_two_tris();
     test_aabb_empty_mesh();
+    test_bvh_matches_brute_force();
+    test_add_triangle_invalidates_bvh();
+    test_add_triangle_rejects_wide_indices();
+    test_occluded_matches_intersect();
+    test_precomputed_layout_matches_compact();
+    test_uv_scale_from_texcoords();
     std::cout << "All mesh tests passed.\n";
     return 0;
 }
@@ -2,9 +2,16 @@ import glimmer.obj;
 import glimmer.mesh;
 import glimmer.vector;
 import glimmer.aabb;
+import glimmer.ray;
+import glimmer.thread_pool;
 #include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <sstream>
+#include <string>
 #include <iostream>
+#include <stdexcept>
 
 using glimmer::Mesh;
 using glimmer::Vector;
@@ -26,6 +33,8 @@ f 1 2 3
     auto mn = box.min(); auto mx = box.max();
     assert(mn[0]==0 && mn[1]==0 && mn[2]==0);
     assert(mx[0]==1 && mx[1]==1 && mx[2]==0);
+    // Loader builds the triangle BVH
+    assert(m.has_bvh());
 }
 
 static void test_quads_and_negative_indices(){
@@ -45,9 +54,105 @@ f -4 -3 -2 -1
     assert(m.triangle_count() == 4);
 }
 
+static void test_texcoords_and_normals(){
+    const char* obj = R"OBJ(
+v 0 0 0
+v 1 0 0
+v 0 1 0   # trailing comment
+vt 0 0
+vt 1 0
+vt 0 1
+vn 0 0 1
+vn 0 0 1
+vn 1 0 0
+f 1/1/1 2/2/2 3/3/3
+f 1//1 2//2 3//3
+f 1/1 2/2 3/3
+)OBJ";
+    auto m = glimmer::parse_obj<double>(obj);
+    assert(m.vertex_count() == 3 && m.triangle_count() == 3);
+    assert(m.texcoord_count() == 3 && m.normal_count() == 3);
+    auto a0 = m.triangle_attributes(0);
+    assert(a0.normal[2] == 2 && a0.texcoord[1] == 1);
+    auto a1 = m.triangle_attributes(1);
+    assert(a1.texcoord[0] == Mesh<double>::no_attribute && a1.normal[0] == 0);
+    auto a2 = m.triangle_attributes(2);
+    assert(a2.normal[0] == Mesh<double>::no_attribute && a2.texcoord[2] == 2);
+
+    // Hits interpolate the shading normal and texture coordinates
+    const char* tri = "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvt 1 0\nvt 0 1\nvn 0 0 1\nvn 0 0 1\nvn 1 0 0\nf 1/1/1 2/2/2 3/3/3\n";
+    auto single = glimmer::parse_obj<double>(tri);
+    glimmer::Ray<double> r{Vector<double,3>{0.25, 0.5, 1}, Vector<double,3>{0,0,-1}};
+    auto h = single.intersect(r);
+    assert(h.has_value());
+    assert(std::abs(h->uv[0] - 0.25) < 1e-12 && std::abs(h->uv[1] - 0.5) < 1e-12);
+    // normal interpolates (0,0,1),(0,0,1),(1,0,0) with weights (0.25,0.25,0.5)
+    assert(std::abs(h->normal.norm() - 1.0) < 1e-12);
+    assert(h->normal[0] > 0.5 && h->normal[2] > 0.5);
+}
+
+static void test_number_formats_and_bad_records(){
+    const char* obj =
+        "v 1e-1 +2.5 -3\r\n"
+        "v 4 5\t6\n"
+        "v 7 8\n"          // missing z reads as 0
+        "vx 1 2 3\n"       // unknown tag
+        "f 1 2 9\n"        // index 9 invalid: corner dropped, face degenerates
+        "f 1 2 3 0\n"      // index 0 invalid: triangle 1 2 3 remains
+        "usemtl foo\n"
+        "f 1 2 3";          // no trailing newline
+    auto m = glimmer::parse_obj<float>(obj);
+    assert(m.vertex_count() == 3);
+    assert(std::abs(m.vertex(0)[0] - 0.1f) < 1e-7f && m.vertex(0)[1] == 2.5f && m.vertex(0)[2] == -3.0f);
+    assert(m.vertex(1)[2] == 6.0f);
+    assert(m.vertex(2)[2] == 0.0f);
+    assert(m.triangle_count() == 2);
+}
+
+static void test_parallel_chunks_match_serial(){
+    // Large enough for several chunks; relative indices must resolve across chunk boundaries
+    std::string text;
+    const std::size_t n = 40000;
+    for (std::size_t i = 0; i < n; ++i) {
+        text += "v " + std::to_string(i) + " 0.5 " + std::to_string(i % 7) + "\n";
+        text += "v " + std::to_string(i) + " 1.5 0\n";
+        text += "v " + std::to_string(i + 1) + " 1.5 0\n";
+        if (i % 2) text += "f -3 -2 -1\n";
+        else text += "f " + std::to_string(3 * i + 1) + " " + std::to_string(3 * i + 2) + " " + std::to_string(3 * i + 3) + "\n";
+    }
+    assert(text.size() > 2 * (std::size_t{1} << 20));
+    glimmer::ThreadPool single{1}, pool{4};
+    auto a = glimmer::parse_obj<double>(text, single);
+    auto b = glimmer::parse_obj<double>(text, pool);
+    assert(a.vertex_count() == 3 * n && b.vertex_count() == 3 * n);
+    assert(a.triangle_count() == n && b.triangle_count() == n);
+    for (std::size_t t = 0; t < n; ++t) {
+        const auto& ta = a.triangle(t);
+        const auto& tb = b.triangle(t);
+        assert(ta.i0 == 3 * t && ta.i1 == 3 * t + 1 && ta.i2 == 3 * t + 2);
+        assert(ta.i0 == tb.i0 && ta.i1 == tb.i1 && ta.i2 == tb.i2);
+    }
+    for (std::size_t v = 0; v < 3 * n; v += 997) assert(a.vertex(v) == b.vertex(v));
+}
+
+static void test_load_from_file(){
+    const std::string path = "obj_test_file.obj";
+    { std::ofstream f(path); f << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n"; }
+    auto m = load_obj<double>(path);
+    assert(m.vertex_count() == 3 && m.triangle_count() == 1 && m.has_bvh());
+    std::filesystem::remove(path);
+    bool threw = false;
+    try { (void)load_obj<double>(std::string{"no_such_file.obj"}); } catch (const std::runtime_error&) { threw = true; }
+    assert(threw);
+}
+
 int main(){
     test_load_simple_triangle();
     test_quads_and_negative_indices();
+    test_texcoords_and_normals();
+    test_number_formats_and_bad_records();
+    test_parallel_chunks_match_serial();
+    test_load_from_file();
     std::cout << "All obj tests passed.\n";
     return 0;
 }
@@ -0,0 +1,186 @@
+import glimmer.partial_frame;
+import glimmer.renderer_path_tracer;
+import glimmer.accumulation;
+import glimmer.thread_pool;
+import glimmer.scene;
+import glimmer.scene_object;
+import glimmer.sphere;
+import glimmer.camera;
+import glimmer.transform;
+import glimmer.vector;
+import glimmer.color;
+import glimmer.image;
+import glimmer.material;
+import glimmer.sampler;
+import glimmer.tile;
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using glimmer::Scene;
+using glimmer::SceneObject;
+using glimmer::Sphere;
+using glimmer::Camera;
+using glimmer::Vector;
+using glimmer::Color;
+using glimmer::Image;
+using glimmer::Material;
+using glimmer::FrameRange;
+using glimmer::FrameMerger;
+using glimmer::PartialFrame;
+
+template <class T>
+static Scene<T> make_scene() {
+    auto cam = Camera<T>::from_look_at(Vector<T,3>{0,0,5}, Vector<T,3>{0,0,0}, Vector<T,3>{0,1,0},
+                                       static_cast<T>(M_PI/3), T{1}, static_cast<T>(0.1), T{100});
+    Scene<T> scene{cam, Color<T,3>{0.2,0.3,0.4}};
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{-0.6,0,0}, T{0.5}),
+                                    Material<T>::lambertian(Color<T,3>{0.8, 0.5, 0.3}), glimmer::Transform<T>{}});
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0.6,0,0}, T{0.5}),
+                                    Material<T>::glass(Color<T,3>{1,1,1}, 0.0, 1.0), glimmer::Transform<T>{}});
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0,3,2}, T{1}),
+                                    Material<T>::emissive(Color<T,3>{1, 1, 1}, 5.0), glimmer::Transform<T>{}});
+    scene.build_bvh();
+    return scene;
+}
+
+static void test_create_resolves_range() {
+    // 10x9 frame in 4x4 tiles: 3x3 grid
+    auto p = PartialFrame<double>::create(10, 9, 4, 7, glimmer::SamplerKind::halton, FrameRange{4, 3, 2}, 8);
+    assert(p.range == (FrameRange{4, 3, 2, 6}));
+    // Tiles 4..6 touch rows 4..8 (tile 6 starts the last, clipped tile row)
+    assert(p.y0 == 4 && p.pixels.width() == 10 && p.pixels.height() == 5);
+    assert(!p.has_tile(3) && p.has_tile(4) && p.has_tile(6) && !p.has_tile(7));
+
+    auto clipped = PartialFrame<double>::create(10, 9, 4, 7, glimmer::SamplerKind::independent,
+                                                FrameRange{8, 100, 9, FrameRange::all}, 8);
+    assert(clipped.range == (FrameRange{8, 1, 9, 0}));
+    auto empty = PartialFrame<double>::create(10, 9, 4, 7, glimmer::SamplerKind::independent,
+                                              FrameRange{20, 1}, 8);
+    assert(empty.range.tile_count == 0 && empty.pixels.empty());
+}
+
+static void test_split_render_merges_to_full_render() {
+    using T = double;
+    const Scene<T> scene = make_scene<T>();
+    const std::size_t W = 19, H = 13, spp = 6;
+    glimmer::RendererPathTracer<T> renderer{spp, 4, 42};
+    renderer.set_tile_size(4);
+    Image<T,3> full{W,H};
+    renderer.render(scene, full, W, H);
+
+    // Three uneven tile ranges times two sample ranges, as six nodes would render them, merged out of order
+    const std::size_t tiles = glimmer::TileGrid{W, H, 4}.count();
+    const FrameRange ranges[] = {
+        {0, 5, 0, 4}, {5, 9, 0, 4}, {14, FrameRange::all, 0, 4},
+        {0, 5, 4, FrameRange::all}, {5, 9, 4, FrameRange::all}, {14, FrameRange::all, 4, FrameRange::all},
+    };
+    FrameMerger<T> merger;
+    for (const std::size_t i : {4, 1, 5, 0, 3, 2}) {
+        renderer.set_thread_pool(std::make_shared<glimmer::ThreadPool>(1 + i % 3));
+        merger.add(renderer.render_partial(scene, W, H, ranges[i]));
+    }
+    assert(merger.part_count() == 6 && merger.ranges()[2] == (FrameRange{14, tiles - 14, 4, 2}));
+    assert(merger.buffer().total_samples() == W * H * spp);
+    Image<T,3> merged;
+    merger.resolve(merged);
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x) {
+            assert(merger.buffer().samples(x, y) == spp);
+            for (int c = 0; c < 3; ++c) assert(std::abs(merged(x,y)[c] - full(x,y)[c]) < 1e-12);
+        }
+
+    // A single part covering the whole frame is exactly the full render
+    FrameMerger<T> one;
+    one.add(renderer.render_partial(scene, W, H));
+    Image<T,3> single;
+    one.resolve(single);
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x)
+            for (int c = 0; c < 3; ++c) assert(single(x,y)[c] == full(x,y)[c]);
+}
+
+static void test_merger_rejects_bad_parts() {
+    using T = float;
+    auto part = [](std::size_t w, std::uint64_t seed, FrameRange r) {
+        return PartialFrame<T>::create(w, 8, 4, seed, glimmer::SamplerKind::independent, r, 16);
+    };
+    FrameMerger<T> merger;
+    merger.add(part(8, 1, FrameRange{0, 2, 0, 8}));
+    merger.add(part(8, 1, FrameRange{2, 2, 0, 8}));  // other tiles
+    merger.add(part(8, 1, FrameRange{0, 2, 8, 8}));  // other samples
+    auto throws = [&](const PartialFrame<T>& p) {
+        try { merger.add(p); } catch (const std::invalid_argument&) { return true; }
+        return false;
+    };
+    assert(throws(part(8, 1, FrameRange{1, 1, 4, 1})));   // samples 4 of tile 1 were already merged
+    assert(throws(part(12, 1, FrameRange{3, 1, 0, 8})));  // different frame size
+    assert(throws(part(8, 2, FrameRange{3, 1, 8, 8})));   // different seed
+    assert(merger.part_count() == 3);
+}
+
+static void test_save_load_round_trip() {
+    using T = float;
+    const Scene<T> scene = make_scene<T>();
+    glimmer::RendererPathTracer<T> renderer{4, 3, 5};
+    renderer.set_tile_size(8);
+    renderer.set_sampler(glimmer::SamplerKind::halton);
+    const auto part = renderer.render_partial(scene, 20, 17, FrameRange{2, 3, 1, 2});
+    const std::string path = "partial_frame_rt.part";
+    assert(glimmer::save_partial_frame(part, path));
+    assert(glimmer::partial_frame_scalar_size(path) == sizeof(float));
+    assert(!glimmer::load_partial_frame<double>(path));
+
+    const auto loaded = glimmer::load_partial_frame<T>(path);
+    assert(loaded && loaded->width == 20 && loaded->height == 17 && loaded->tile_size == 8);
+    assert(loaded->seed == 5 && loaded->sampler == glimmer::SamplerKind::halton);
+    assert(loaded->range == part.range && loaded->y0 == part.y0);
+    assert(loaded->pixels.width() == part.pixels.width() && loaded->pixels.height() == part.pixels.height());
+    for (std::size_t y = 0; y < part.pixels.height(); ++y)
+        for (std::size_t x = 0; x < part.pixels.width(); ++x) {
+            const auto a = part.pixels.pixel_sums(x, y);
+            const auto b = loaded->pixels.pixel_sums(x, y);
+            assert(a.count == b.count && a.lum_sum == b.lum_sum && a.lum_sq_sum == b.lum_sq_sum);
+            for (int c = 0; c < 3; ++c) assert(a.sum[c] == b.sum[c]);
+        }
+
+    // A header whose tile range spans far more rows than the file stores is rejected without allocating them
+    {
+        const auto intact = std::filesystem::file_size(path);
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        auto patch = [&](std::streamoff offset, std::uint64_t v) {
+            f.seekp(offset);
+            f.write(reinterpret_cast<const char*>(&v), sizeof(v));
+        };
+        patch(32, std::uint64_t{1} << 40);           // height
+        patch(40, 1);                                // tile size
+        patch(56, 0);                                // first tile
+        patch(64, std::uint64_t{1} << 62);           // tile count
+        f.close();
+        assert(std::filesystem::file_size(path) == intact);
+        assert(!glimmer::load_partial_frame<T>(path));
+        assert(glimmer::save_partial_frame(part, path));
+    }
+
+    // Truncated files are rejected
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+    assert(!glimmer::load_partial_frame<T>(path));
+    std::filesystem::remove(path);
+    assert(!glimmer::load_partial_frame<T>("this_file_does_not_exist.part"));
+    assert(!glimmer::partial_frame_scalar_size("this_file_does_not_exist.part"));
+}
+
+int main() {
+    test_create_resolves_range();
+    test_split_render_merges_to_full_render();
+    test_merger_rejects_bad_parts();
+    test_save_load_round_trip();
+    std::cout << "All partial frame tests passed." << std::endl;
+    return 0;
+}
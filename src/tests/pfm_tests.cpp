@@ -0,0 +1,128 @@
+import glimmer.pfm;
+import glimmer.image;
+import glimmer.image_sink;
+import glimmer.color;
+import glimmer.tile;
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+using glimmer::Image;
+using glimmer::CompactImage;
+using glimmer::PixelFormat;
+using glimmer::Color3f;
+using Color3d = glimmer::Color<double,3>;
+
+static std::string read_file(const char* path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+static Image<double,3> hdr_pattern(std::size_t w, std::size_t h) {
+    Image<double,3> img{w, h};
+    for (std::size_t y = 0; y < h; ++y)
+        for (std::size_t x = 0; x < w; ++x)
+            img(x, y) = Color3d{double(x) * 17.5, double(y) / 8.0, double(x * y % 5) - 2.0};
+    return img;
+}
+
+static void test_round_trip() {
+    // Values above 1 and negatives survive; rows come back top first
+    const auto img = hdr_pattern(7, 5);
+    assert(glimmer::save_pfm(img, "pfm_rt.pfm"));
+    const std::string bytes = read_file("pfm_rt.pfm");
+    assert(bytes.substr(0, 9) == "PF\n7 5\n-1" || bytes.substr(0, 8) == "PF\n7 5\n1");
+    const auto loaded = glimmer::load_pfm<double>("pfm_rt.pfm");
+    assert(loaded && loaded->width() == 7 && loaded->height() == 5);
+    for (std::size_t y = 0; y < 5; ++y)
+        for (std::size_t x = 0; x < 7; ++x)
+            for (int c = 0; c < 3; ++c) assert((*loaded)(x, y)[c] == double(float(img(x, y)[c])));
+
+    // Compact images write the same file; f16 values are exact in float
+    assert(glimmer::save_pfm(CompactImage<double,3>{img}, "pfm_f32.pfm"));
+    assert(read_file("pfm_f32.pfm") == bytes);
+    const CompactImage<double,3,PixelFormat::f16> half{img};
+    assert(glimmer::save_pfm(half, "pfm_f16.pfm"));
+    const auto from_half = glimmer::load_pfm<double>("pfm_f16.pfm");
+    assert(from_half && (*from_half)(6, 4) == half.get(6, 4) && (*from_half)(3, 1) == half.get(3, 1));
+    for (const char* p : {"pfm_rt.pfm", "pfm_f32.pfm", "pfm_f16.pfm"}) std::filesystem::remove(p);
+}
+
+static void test_load_other_byte_order_and_greyscale() {
+    // Greyscale map in the opposite byte order: two pixels per row, bottom row first
+    const bool little = std::endian::native == std::endian::little;
+    {
+        std::ofstream f("pfm_grey.pfm", std::ios::binary);
+        f << "Pf\n2 2\n" << (little ? "1.0" : "-1.0") << "\n";
+        for (const float v : {1.0f, 2.0f, 0.5f, -4.0f}) {
+            std::uint32_t bits = std::byteswap(std::bit_cast<std::uint32_t>(v));
+            f.write(reinterpret_cast<const char*>(&bits), sizeof(bits));
+        }
+    }
+    const auto grey = glimmer::load_pfm<float>("pfm_grey.pfm");
+    assert(grey && grey->width() == 2 && grey->height() == 2);
+    assert((*grey)(0, 1) == (Color3f{1, 1, 1}) && (*grey)(1, 1) == (Color3f{2, 2, 2}));
+    assert((*grey)(0, 0) == (Color3f{0.5f, 0.5f, 0.5f}) && (*grey)(1, 0) == (Color3f{-4, -4, -4}));
+
+    // Truncated payload, bad magic and missing files fail
+    { std::ofstream f("pfm_grey.pfm", std::ios::binary); f << "PF\n2 2\n-1.0\nabcd"; }
+    assert(!glimmer::load_pfm<float>("pfm_grey.pfm"));
+    // Dimensions whose product wraps to 0 in 64 bits
+    { std::ofstream f("pfm_grey.pfm", std::ios::binary); f << "PF\n8589934592 2147483648\n-1\nabcd"; }
+    assert(!glimmer::load_pfm<float>("pfm_grey.pfm"));
+    { std::ofstream f("pfm_grey.pfm", std::ios::binary); f << "P6\n2 2\n255\nabcdefghijkl"; }
+    assert(!glimmer::load_pfm<float>("pfm_grey.pfm"));
+    assert(!glimmer::load_pfm<float>("no_such_file.pfm"));
+    std::filesystem::remove("pfm_grey.pfm");
+}
+
+static void test_sinks() {
+    // Tiles delivered out of order produce the same file as save_pfm of the assembled image
+    const std::size_t w = 29, h = 19;
+    const auto img = hdr_pattern(w, h);
+    assert(glimmer::save_pfm(img, "pfm_whole.pfm"));
+    CompactImage<double,3,PixelFormat::f32> compact;
+    glimmer::CompactImageTarget<double, PixelFormat::f32> target{compact};
+    for (const bool async : {true, false}) {
+        glimmer::PfmStreamSink<double> sink{"pfm_stream.pfm", async};
+        const glimmer::TileGrid grid{w, h, 8};
+        sink.begin(w, h);
+        target.begin(w, h);
+        for (std::size_t k = 0; k < grid.count(); ++k) {
+            const auto t = grid.tile((k * 5) % grid.count()); // 5 is coprime to the tile count
+            std::vector<Color3d> px;
+            for (std::size_t y = t.y0; y < t.y1; ++y)
+                for (std::size_t x = t.x0; x < t.x1; ++x) px.push_back(img(x, y));
+            sink.write_tile(t, px);
+            target.write_tile(t, px);
+        }
+        sink.end();
+        assert(sink.good());
+        assert(read_file("pfm_stream.pfm") == read_file("pfm_whole.pfm"));
+    }
+    assert(compact.width() == w && compact.height() == h && compact.get(11, 7) == img(11, 7));
+    std::filesystem::remove("pfm_stream.pfm");
+    std::filesystem::remove("pfm_whole.pfm");
+
+    glimmer::PfmStreamSink<float> bad{"no_such_dir/x.pfm"};
+    bad.begin(2, 2);
+    bad.end();
+    assert(!bad.good());
+}
+
+int main() {
+    test_round_trip();
+    test_load_other_byte_order_and_greyscale();
+    test_sinks();
+    std::cout << "All pfm tests passed.\n";
+    return 0;
+}
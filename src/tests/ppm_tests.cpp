@@ -1,6 +1,14 @@
 import glimmer.ppm;
 import glimmer.image;
 import glimmer.color;
+import glimmer.tile;
+#include <bit>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <limits>
 #include <cassert>
 #include <cmath>
 #include <iostream>
@@ -45,9 +53,188 @@ static void test_load_nonexistent() {
     assert(!none.has_value());
 }
 
+static void test_stream_sink_matches_save_ppm() {
+    // Tiles delivered out of order produce the same file as save_ppm of the assembled image
+    const std::size_t w = 37, h = 23;
+    Image<float,3> img{w, h};
+    for (std::size_t y = 0; y < h; ++y)
+        for (std::size_t x = 0; x < w; ++x)
+            img(x, y) = Color3f{float(x) / float(w), float(y) / float(h), float((x * y) % 7) / 5.0f - 0.2f};
+    assert(save_ppm(img, "ppm_whole.ppm"));
+
+    for (const bool async : {true, false}) {
+        glimmer::PpmStreamSink<float> sink{"ppm_stream.ppm", async};
+        const glimmer::TileGrid grid{w, h, 8};
+        sink.begin(w, h);
+        for (std::size_t k = 0; k < grid.count(); ++k) {
+            const auto t = grid.tile((k * 7) % grid.count()); // 7 is coprime to the tile count
+            std::vector<Color3f> px;
+            for (std::size_t y = t.y0; y < t.y1; ++y)
+                for (std::size_t x = t.x0; x < t.x1; ++x) px.push_back(img(x, y));
+            sink.write_tile(t, px);
+        }
+        sink.end();
+        assert(sink.good());
+        auto read = [](const char* p) {
+            std::ifstream in(p, std::ios::binary);
+            return std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+        };
+        assert(read("ppm_stream.ppm") == read("ppm_whole.ppm"));
+    }
+    std::filesystem::remove("ppm_stream.ppm");
+    std::filesystem::remove("ppm_whole.ppm");
+
+    glimmer::PpmStreamSink<float> bad{"no_such_dir/x.ppm"};
+    bad.begin(2, 2);
+    bad.end();
+    assert(!bad.good());
+}
+
+static void test_u8_encoder() {
+    // Linear: matches rounding of the clamped value; NaN and negatives map to 0
+    const glimmer::U8Encoder<double> lin;
+    for (int i = -20; i <= 1040; ++i) {
+        const double v = i / 1000.0;
+        const double c = v < 0 ? 0 : (v > 1 ? 1 : v);
+        assert(lin(v) == static_cast<unsigned char>(std::lround(c * 255)));
+    }
+    assert(lin(std::numeric_limits<double>::quiet_NaN()) == 0);
+    assert(glimmer::U8Encoder<int>{}(300) == 255 && glimmer::U8Encoder<int>{}(-4) == 0);
+
+    // Gamma and sRGB: same codes as evaluating the curve directly
+    const glimmer::U8Encoder<double> gamma{glimmer::U8Encoding{2.2, false}};
+    const glimmer::U8Encoder<double> srgb{glimmer::U8Encoding{1.0, true}};
+    auto srgb_curve = [](double v) { return v <= 0.0031308 ? 12.92 * v : 1.055 * std::pow(v, 1 / 2.4) - 0.055; };
+    for (int i = 0; i <= 10000; ++i) {
+        const double v = (i + 0.37) / 10000.0;
+        assert(gamma(v) == static_cast<unsigned char>(std::lround(std::pow(std::min(v, 1.0), 1 / 2.2) * 255)));
+        assert(srgb(v) == static_cast<unsigned char>(std::lround(srgb_curve(std::min(v, 1.0)) * 255)));
+    }
+    assert(gamma(-1.0) == 0 && gamma(2.0) == 255 && gamma(std::numeric_limits<double>::quiet_NaN()) == 0);
+
+    // Bulk encode equals per-value conversion
+    std::vector<float> in;
+    for (int i = 0; i < 1000; ++i) in.push_back(static_cast<float>(i) / 900.0f - 0.05f);
+    std::vector<unsigned char> out(in.size());
+    const glimmer::U8Encoder<float> encf{glimmer::U8Encoding{2.2, false}};
+    encf.encode(in, out);
+    for (std::size_t i = 0; i < in.size(); ++i) assert(out[i] == encf(in[i]));
+}
+
+static void test_u8_encoder_curve_codes() {
+    // The approximate curve plus correction gives exactly the code of the precomputed boundaries, near every
+    // boundary and across the float range; gammas outside [0.1, 10] take the binary search instead
+    for (const double gamma : {0.05, 0.1, 0.45, 1.8, 2.2, 4.0, 10.0, 25.0, 0.0}) {
+        const bool srgb = gamma == 0.0;
+        const glimmer::U8Encoder<float> enc{glimmer::U8Encoding{srgb ? 1.0 : gamma, srgb}};
+        std::vector<float> bounds(256);
+        for (int k = 1; k < 256; ++k) {
+            const double e = (k - 0.5) / 255.0;
+            bounds[k] = static_cast<float>(srgb ? (e <= 0.04045 ? e / 12.92 : std::pow((e + 0.055) / 1.055, 2.4))
+                                                : std::pow(e, gamma));
+        }
+        auto expected = [&](float v) {
+            int code = 0;
+            for (int k = 1; k < 256; ++k) code += bounds[k] <= v;
+            return static_cast<unsigned char>(code);
+        };
+        std::vector<float> in;
+        for (int k = 1; k < 256; ++k) {
+            float v = bounds[k];
+            for (int step = 0; step < 3; ++step) v = std::nextafter(v, 0.0f);
+            for (int step = 0; step < 6; ++step, v = std::nextafter(v, 2.0f)) in.push_back(v);
+        }
+        for (std::uint32_t bits = 0; bits <= 0x3f800000u; bits += 40009u) in.push_back(std::bit_cast<float>(bits));
+        std::vector<unsigned char> out(in.size());
+        enc.encode(in, out);
+        for (std::size_t i = 0; i < in.size(); ++i) assert(out[i] == expected(in[i]) && enc(in[i]) == out[i]);
+        for (const float v : {-0.0f, std::numeric_limits<float>::denorm_min(), 1.0f, 2.0f, -1.0f}) assert(enc(v) == expected(v));
+        assert(enc(std::numeric_limits<float>::infinity()) == 255 && enc(-std::numeric_limits<float>::quiet_NaN()) == 0);
+    }
+}
+
+static void test_tonemap() {
+    // Exposure and tone curves are applied before the transfer curve; HDR values no longer clip
+    glimmer::U8Encoding reinhard{1.0, true, 2.0, glimmer::Tonemap::reinhard};
+    const glimmer::U8Encoder<double> enc{reinhard};
+    const glimmer::U8Encoder<double> srgb{glimmer::U8Encoding{1.0, true}};
+    for (const double v : {0.0, 0.01, 0.2, 1.0, 7.5, 300.0}) assert(enc(v) == srgb(2 * v / (1 + 2 * v)));
+    assert(enc(std::numeric_limits<double>::infinity()) == 255 && enc(std::numeric_limits<double>::quiet_NaN()) == 0);
+    assert(enc(-1.0) == 0 && enc(3.0) < enc(6.0));
+
+    const glimmer::U8Encoder<float> aces{glimmer::U8Encoding{1.0, false, 1.0, glimmer::Tonemap::aces}};
+    assert(aces(0.0f) == 0 && aces(100.0f) == 255 && aces(0.5f) < aces(1.0f) && aces(1.0f) < 255);
+
+    // Bulk encode equals per-value conversion for every curve, across block boundaries
+    std::vector<float> in;
+    for (int i = 0; i < 1000; ++i) in.push_back(static_cast<float>(i) / 90.0f - 0.5f);
+    std::vector<unsigned char> out(in.size());
+    for (const auto curve : {glimmer::Tonemap::clamp, glimmer::Tonemap::reinhard, glimmer::Tonemap::aces}) {
+        for (const bool srgb_out : {false, true}) {
+            const glimmer::U8Encoder<float> e{glimmer::U8Encoding{2.2, srgb_out, 0.7, curve}};
+            e.encode(in, out);
+            for (std::size_t i = 0; i < in.size(); ++i) assert(out[i] == e(in[i]));
+        }
+    }
+
+    // Compact images save to the same file as the image they were made from
+    Image<double,3> img{9, 4};
+    for (std::size_t y = 0; y < 4; ++y)
+        for (std::size_t x = 0; x < 9; ++x) img(x, y) = glimmer::Color<double,3>{double(x), 0.25 * double(y), 0.5};
+    assert(save_ppm(img, "ppm_image.ppm", reinhard));
+    assert(save_ppm(glimmer::CompactImage<double,3>{img}, "ppm_compact.ppm", reinhard));
+    auto a = load_ppm<unsigned char>("ppm_image.ppm");
+    auto b = load_ppm<unsigned char>("ppm_compact.ppm");
+    assert(a && b);
+    for (std::size_t y = 0; y < 4; ++y)
+        for (std::size_t x = 0; x < 9; ++x) assert((*a)(x, y) == (*b)(x, y));
+    std::filesystem::remove("ppm_image.ppm");
+    std::filesystem::remove("ppm_compact.ppm");
+}
+
+static void test_load_header_comments_and_bytes() {
+    const char* fname = "ppm_comments.ppm";
+    {
+        std::ofstream f(fname, std::ios::binary);
+        f << "P6\n# made by hand\n2 # width\n1\n255\n";
+        const unsigned char px[6] = {0, 128, 255, 10, 20, 30};
+        f.write(reinterpret_cast<const char*>(px), 6);
+    }
+    auto bytes = load_ppm<unsigned char>(fname);
+    assert(bytes && bytes->width() == 2 && bytes->height() == 1);
+    assert((*bytes)(0,0)[1] == 128 && (*bytes)(1,0)[2] == 30);
+    auto floats = load_ppm<float>(fname);
+    assert(floats && (*floats)(0,0)[2] == 1.0f && (*floats)(0,0)[0] == 0.0f);
+
+    // Truncated payload
+    { std::ofstream f(fname, std::ios::binary); f << "P6 2 2 255\n" << "abc"; }
+    assert(!load_ppm<float>(fname));
+    // Dimensions whose product wraps to 0 in 64 bits
+    { std::ofstream f(fname, std::ios::binary); f << "P6 4294967296 4294967296 255\n" << "abc"; }
+    assert(!load_ppm<float>(fname));
+    std::filesystem::remove(fname);
+}
+
+static void test_save_async() {
+    Image<float,3> img{16, 8, Color3f{0.25f, 0.5f, 1.0f}};
+    auto pending = glimmer::save_ppm_async(std::move(img), "ppm_async.ppm", glimmer::U8Encoding{2.2, false});
+    assert(pending.get());
+    auto loaded = load_ppm<unsigned char>("ppm_async.ppm");
+    assert(loaded && loaded->width() == 16 && loaded->height() == 8);
+    assert((*loaded)(3,5)[0] == static_cast<unsigned char>(std::lround(std::pow(0.25, 1 / 2.2) * 255)));
+    assert((*loaded)(3,5)[2] == 255);
+    std::filesystem::remove("ppm_async.ppm");
+}
+
 int main() {
     test_round_trip_float();
     test_load_nonexistent();
+    test_stream_sink_matches_save_ppm();
+    test_u8_encoder();
+    test_u8_encoder_curve_codes();
+    test_tonemap();
+    test_load_header_comments_and_bytes();
+    test_save_async();
     std::cout << "All ppm tests passed.\n";
     return 0;
 }
@@ -0,0 +1,145 @@
+import glimmer.primitive_list;
+import glimmer.scene;
+import glimmer.scene_object;
+import glimmer.sphere;
+import glimmer.plane;
+import glimmer.material;
+import glimmer.transform;
+import glimmer.ray;
+import glimmer.ray_packet;
+import glimmer.sampler;
+import glimmer.color;
+import glimmer.vector;
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <optional>
+
+using glimmer::PrimitiveList;
+using glimmer::Scene;
+using glimmer::SceneObject;
+using glimmer::Material;
+using glimmer::Transform;
+using V3 = glimmer::Vector<float,3>;
+using Color3 = glimmer::Color<float,3>;
+
+static V3 sphere_center(int i)
+{
+    return V3{static_cast<float>(i % 10) * 1.3f - 6.0f, 0.2f * static_cast<float>(i % 4),
+              static_cast<float>(i / 10) * -1.3f};
+}
+
+static float sphere_radius(int i) { return 0.3f + 0.05f * static_cast<float>(i % 5); }
+
+// The same spheres and planes built from SceneObjects and from the primitive list answer every query identically
+static void test_primitives_match_objects()
+{
+    Scene<float> objects, primitives;
+    const auto red = Material<float>::lambertian(Color3{1, 0, 0});
+    const auto blue = Material<float>::lambertian(Color3{0, 0, 1});
+    const auto red_id = primitives.add_material(red);
+    const auto blue_id = primitives.add_material(blue);
+    for (int i = 0; i < 70; ++i) {
+        objects.add_object(SceneObject<float>{std::make_shared<glimmer::Sphere<float>>(sphere_center(i), sphere_radius(i)),
+                                              i % 2 ? blue : red, Transform<float>{}});
+        assert(primitives.add_sphere(sphere_center(i), sphere_radius(i), i % 2 ? blue_id : red_id) ==
+               static_cast<std::uint32_t>(i));
+    }
+    objects.add_object(SceneObject<float>{std::make_shared<glimmer::Plane<float>>(V3{0, -1, 0}, V3{0, 1, 0}), red,
+                                          Transform<float>{}});
+    assert(primitives.add_plane(V3{0, -1, 0}, V3{0, 1, 0}, red_id) == 70);
+    assert(primitives.primitives().sphere_count() == 70 && primitives.primitives().plane_count() == 1);
+    assert(primitives.size() == 0 && primitives.primitive_count() == 71 && !primitives.empty());
+    objects.build_bvh();
+
+    glimmer::Pcg32 rng{11};
+    auto random_ray = [&] {
+        const V3 o{rng.uniform<float>() * 20.0f - 10.0f, 3.0f, 4.0f};
+        const V3 target{rng.uniform<float>() * 16.0f - 8.0f, rng.uniform<float>() * 2.0f - 1.5f, -rng.uniform<float>() * 11.0f};
+        return glimmer::Ray<float>{o, (target - o).normalized()};
+    };
+    for (int pass = 0; pass < 2; ++pass) { // linear scan, then BVH
+        glimmer::Pcg32 reset{11};
+        rng = reset;
+        int sphere_hits = 0;
+        for (int k = 0; k < 2000; ++k) {
+            const auto ray = random_ray();
+            const auto a = objects.intersect(ray);
+            const auto b = primitives.intersect(ray);
+            assert(a.has_value() == b.has_value());
+            assert(objects.occluded(ray) == primitives.occluded(ray));
+            if (!a) continue;
+            sphere_hits += a->object_index < 70;
+            assert(std::abs(a->t - b->t) < 1e-4f * a->t);
+            assert(b->object == nullptr && b->object_index == a->object_index);
+            assert(dot(a->normal.normalized(), b->normal) > 0.9999f);
+            assert(std::abs(a->uv[0] - b->uv[0]) < 1e-3f && std::abs(a->uv[1] - b->uv[1]) < 1e-3f);
+            assert(std::abs(a->uv_scale - b->uv_scale) <= 1e-4f * a->uv_scale);
+            assert(objects.surface(*a).albedo == primitives.surface(*b).albedo);
+        }
+        assert(sphere_hits > 300);
+        primitives.build_bvh();
+        assert(primitives.primitives().bvh_valid() && primitives.primitives().bvh().primitive_count() == 70);
+    }
+
+    // Packet queries agree with single-ray queries
+    glimmer::RayPacket<float, glimmer::default_packet_size> packet;
+    std::array<std::optional<Scene<float>::Hit>, glimmer::default_packet_size> hits;
+    for (std::size_t i = 0; i < glimmer::default_packet_size; ++i) packet.set(i, random_ray());
+    packet.count = glimmer::default_packet_size;
+    primitives.intersect_packet(packet, hits);
+    for (std::size_t i = 0; i < glimmer::default_packet_size; ++i) {
+        const auto single = primitives.intersect(packet.ray(i));
+        assert(single.has_value() == hits[i].has_value());
+        if (single) assert(single->t == hits[i]->t && single->object_index == hits[i]->object_index);
+    }
+}
+
+// Indices and answers survive the BVH's reordering; moved spheres are picked up by update()
+static void test_primitive_updates()
+{
+    PrimitiveList<float> list;
+    for (int i = 0; i < 20; ++i) list.add_sphere(sphere_center(i), sphere_radius(i), static_cast<glimmer::MaterialId>(i));
+    list.build_bvh();
+    for (int i = 0; i < 20; ++i) {
+        assert(list.sphere_center(i) == sphere_center(i) && list.sphere_radius(i) == sphere_radius(i));
+        assert(list.material(static_cast<std::uint32_t>(i)) == static_cast<glimmer::MaterialId>(i));
+    }
+    float t = 100.0f;
+    const glimmer::Ray<float> down{sphere_center(13) + V3{0, 5, 0}, V3{0, -1, 0}};
+    assert(list.intersect(down, t) == 13 && std::abs(t - (5.0f - sphere_radius(13))) < 1e-5f);
+    assert(list.materials_below(20) && !list.materials_below(19));
+
+    Scene<float> scene;
+    const auto mat = scene.add_material(Material<float>::lambertian(Color3{0.5f, 0.5f, 0.5f}));
+    scene.add_sphere(V3{0, 0, 0}, 1.0f, mat);
+    scene.add_sphere(V3{0, 0, -10}, 1.0f, mat);
+    assert(scene.update() == glimmer::SceneUpdate::rebuild);
+    const glimmer::Ray<float> ray{V3{5, 0, 0}, V3{-1, 0, 0}};
+    auto hit = scene.intersect(ray);
+    assert(hit && std::abs(hit->t - 4.0f) < 1e-5f && hit->object_index == 0);
+
+    scene.set_sphere(0, V3{2, 0, 0}, 1.0f);
+    assert(scene.dirty_count() == 1);
+    assert(scene.update() == glimmer::SceneUpdate::refit);
+    assert(scene.dirty_count() == 0 && scene.update() == glimmer::SceneUpdate::none);
+    hit = scene.intersect(ray);
+    assert(hit && std::abs(hit->t - 2.0f) < 1e-5f);
+    assert(scene.aabb().max()[0] == 3.0f);
+    assert(!scene.occluded(glimmer::Ray<float>{V3{5, 5, 0}, V3{-1, 0, 0}}));
+
+    scene.clear();
+    assert(scene.empty() && scene.primitives().empty());
+}
+
+int main()
+{
+    test_primitives_match_objects();
+    test_primitive_updates();
+    std::cout << "All primitive list tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,147 @@
+import glimmer.ray_packet;
+import glimmer.ray;
+import glimmer.vector;
+import glimmer.aabb;
+import glimmer.sphere;
+import glimmer.mesh;
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+using glimmer::AABB;
+using glimmer::PacketMask;
+using glimmer::Ray;
+using glimmer::RayPacket;
+using glimmer::Sphere;
+using glimmer::Vector;
+
+// Fan of rays from z = 5 towards the z = 0 plane, spread over [-2, 2] x [-2, 2]
+static std::vector<Ray<double>> make_fan(std::size_t count, double tmax = 100.0) {
+    std::vector<Ray<double>> rays;
+    for (std::size_t i = 0; i < count; ++i) {
+        const double a = -2.0 + 4.0 * static_cast<double>(i) / static_cast<double>(count - 1);
+        const double b = 1.7 - 0.45 * static_cast<double>(i % 7);
+        rays.emplace_back(Vector<double,3>{0, 0, 5}, Vector<double,3>{a, b, -5}.normalized(), 0.0, tmax);
+    }
+    return rays;
+}
+
+static void test_packet_layout() {
+    auto rays = make_fan(5);
+    auto p = RayPacket<double,8>::from_rays(rays);
+    assert(p.size() == 5);
+    assert(p.active() == 0b11111u);
+    for (std::size_t i = 0; i < 5; ++i) {
+        const Ray<double> r = p.ray(i);
+        for (std::size_t k = 0; k < 3; ++k) {
+            assert(r.origin()[k] == rays[i].origin()[k]);
+            assert(r.direction()[k] == rays[i].direction()[k]);
+        }
+        assert(std::abs(p.inv_dz[i] * p.dz[i] - 1.0) < 1e-12);
+    }
+    RayPacket<float,32> full;
+    full.count = 32;
+    assert(full.active() == ~PacketMask{0});
+}
+
+static void test_aabb_matches_scalar() {
+    auto rays = make_fan(8);
+    // Axis-aligned direction produces infinite reciprocals in two axes
+    rays[3] = Ray<double>{Vector<double,3>{0.25, 0.25, 5}, Vector<double,3>{0, 0, -1}, 0.0, 100.0};
+    auto p = RayPacket<double,8>::from_rays(rays);
+    AABB<double> box{Vector<double,3>{-1, -1, -1}, Vector<double,3>{1, 1, 1}};
+    std::array<double,8> t_entry{};
+    const PacketMask m = glimmer::intersect_aabb(box, p, p.tmax, t_entry, p.active());
+    for (std::size_t i = 0; i < 8; ++i) {
+        auto h = box.intersect(rays[i]);
+        assert(((m >> i) & 1u) == (h.has_value() ? 1u : 0u));
+        if (h) assert(std::abs(t_entry[i] - h->t_near) < 1e-12);
+    }
+    assert((m >> 3) & 1u);
+    // Inactive lanes are never reported
+    assert((glimmer::intersect_aabb(box, p, p.tmax, t_entry, 0b1000u) & ~0b1000u) == 0);
+}
+
+static void test_triangle_matches_scalar() {
+    const Vector<double,3> p0{-1.5, -1.5, 0}, p1{1.5, -1.5, 0}, p2{0, 1.5, 0.5};
+    auto rays = make_fan(16);
+    auto p = RayPacket<double,16>::from_rays(rays);
+    std::array<double,16> t = p.tmax, u{}, v{};
+    const PacketMask m = glimmer::intersect_triangle(p0, p1, p2, p, t, u, v, p.active());
+    std::size_t hits = 0;
+    for (std::size_t i = 0; i < 16; ++i) {
+        auto h = glimmer::intersect_triangle(p0, p1, p2, rays[i]);
+        assert(((m >> i) & 1u) == (h.has_value() ? 1u : 0u));
+        if (h) {
+            ++hits;
+            assert(std::abs(t[i] - h->t) < 1e-12);
+            assert(std::abs(u[i] - h->u) < 1e-12 && std::abs(v[i] - h->v) < 1e-12);
+        } else {
+            assert(t[i] == p.tmax[i]);
+        }
+    }
+    assert(hits > 0 && hits < 16);
+    // A closer bound rejects every hit
+    std::array<double,16> near{};
+    near.fill(1.0);
+    assert(glimmer::intersect_triangle(p0, p1, p2, p, near, u, v, p.active()) == 0);
+}
+
+static void test_sphere_matches_scalar() {
+    Sphere<double> s{Vector<double,3>{0.3, -0.2, 0}, 1.2};
+    auto rays = make_fan(8);
+    // Ray starting inside the sphere takes the far root
+    rays[5] = Ray<double>{Vector<double,3>{0.3, -0.2, 0}, Vector<double,3>{1, 0, 0}, 0.0, 100.0};
+    auto p = RayPacket<double,8>::from_rays(rays);
+    std::array<double,8> t = p.tmax;
+    const PacketMask m = glimmer::intersect_sphere(s.center(), s.radius(), p, t, p.active());
+    for (std::size_t i = 0; i < 8; ++i) {
+        auto h = s.intersect(rays[i]);
+        assert(((m >> i) & 1u) == (h.has_value() ? 1u : 0u));
+        if (h) assert(std::abs(t[i] - h->t) < 1e-9);
+    }
+    assert(std::abs(t[5] - 1.2) < 1e-12);
+}
+
+static void test_mesh_packet_matches_scalar() {
+    glimmer::Mesh<double> mesh;
+    for (int j = 0; j <= 8; ++j)
+        for (int i = 0; i <= 8; ++i)
+            mesh.add_vertex(Vector<double,3>{-2.0 + 0.5 * i, -2.0 + 0.5 * j, 0.05 * ((i * 3 + j) % 4)});
+    for (std::size_t j = 0; j < 8; ++j)
+        for (std::size_t i = 0; i < 8; ++i) {
+            const std::size_t a = j * 9 + i;
+            mesh.add_triangle(a, a + 1, a + 10);
+            mesh.add_triangle(a, a + 10, a + 9);
+        }
+    auto rays = make_fan(8);
+    rays[7] = Ray<double>{Vector<double,3>{0, 0, 5}, Vector<double,3>{0, 0, 1}, 0.0, 100.0}; // points away
+    for (int pass = 0; pass < 3; ++pass) {
+        if (pass == 1) mesh.build_bvh();
+        if (pass == 2) mesh.set_layout(glimmer::MeshLayout::precomputed);
+        auto p = RayPacket<double,8>::from_rays(rays);
+        std::array<double,8> t = p.tmax;
+        std::array<std::uint32_t,8> tri{};
+        const PacketMask m = mesh.intersect_packet(p, t, tri);
+        for (std::size_t i = 0; i < 8; ++i) {
+            auto h = mesh.intersect(rays[i]);
+            assert(((m >> i) & 1u) == (h.has_value() ? 1u : 0u));
+            if (h) assert(std::abs(t[i] - h->t) < 1e-12);
+        }
+        assert(!((m >> 7) & 1u));
+    }
+}
+
+int main() {
+    test_packet_layout();
+    test_aabb_matches_scalar();
+    test_triangle_matches_scalar();
+    test_sphere_matches_scalar();
+    test_mesh_packet_matches_scalar();
+    std::cout << "All ray packet tests passed.\n";
+    return 0;
+}
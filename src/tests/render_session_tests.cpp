@@ -0,0 +1,180 @@
+import glimmer.render_session;
+import glimmer.renderer_path_tracer;
+import glimmer.renderer_simple_rt;
+import glimmer.scene;
+import glimmer.scene_object;
+import glimmer.sphere;
+import glimmer.camera;
+import glimmer.transform;
+import glimmer.quaternion;
+import glimmer.vector;
+import glimmer.color;
+import glimmer.image;
+import glimmer.material;
+import glimmer.ppm;
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using glimmer::Scene;
+using glimmer::SceneObject;
+using glimmer::SceneUpdate;
+using glimmer::Sphere;
+using glimmer::Camera;
+using glimmer::Transform;
+using glimmer::Vector;
+using glimmer::Color;
+using glimmer::Image;
+using glimmer::Material;
+using glimmer::FrameUpdate;
+using glimmer::RenderSession;
+
+static Camera<double> camera_at(double x) {
+    return Camera<double>::from_look_at(Vector<double,3>{x,0,5}, Vector<double,3>{0,0,0}, Vector<double,3>{0,1,0},
+                                        M_PI/3, 1.0, 0.1, 100.0);
+}
+
+static Transform<double> moved_to(double x, double y) {
+    return Transform<double>::from_trs(Vector<double,3>{x, y, 0}, glimmer::Quaternion<double>{},
+                                       Vector<double,3>{1, 1, 1});
+}
+
+static Scene<double> make_scene() {
+    Scene<double> scene{camera_at(0), Color<double,3>{0.2,0.3,0.4}};
+    auto unit = std::make_shared<Sphere<double>>(Vector<double,3>{0,0,0}, 0.5);
+    scene.add_object(SceneObject<double>{unit, Material<double>::lambertian(Color<double,3>{0.8, 0.5, 0.3}),
+                                         moved_to(-0.6, 0)});
+    scene.add_object(SceneObject<double>{unit, Material<double>::metal(Color<double,3>{0.9, 0.9, 0.9}, 0.2),
+                                         moved_to(0.6, 0)});
+    scene.add_object(SceneObject<double>{std::make_shared<Sphere<double>>(Vector<double,3>{0,3,2}, 1.0),
+                                         Material<double>::emissive(Color<double,3>{1, 1, 1}, 5.0),
+                                         Transform<double>{}});
+    scene.build_bvh();
+    return scene;
+}
+
+static std::vector<FrameUpdate<double>> animation(std::size_t frames) {
+    std::vector<FrameUpdate<double>> updates(frames);
+    for (std::size_t f = 1; f < frames; ++f) {
+        const double t = static_cast<double>(f);
+        updates[f].camera = camera_at(0.2 * t);
+        updates[f].objects.emplace_back(0, moved_to(-0.6, 0.1 * t));
+    }
+    return updates;
+}
+
+static void test_frames_match_independent_renders() {
+    const std::size_t W = 16, H = 12, frames = 5;
+    const glimmer::RendererPathTracer<double> renderer{8, 3, 9};
+    Scene<double> scene = make_scene();
+    const auto updates = animation(frames);
+
+    std::vector<Image<double,3>> out;
+    std::vector<std::thread::id> threads;
+    RenderSession<double> session{scene, renderer, W, H, [&](std::size_t frame, const Image<double,3>& img) {
+        // Outputs run one at a time and in frame order
+        assert(frame == out.size());
+        out.push_back(img);
+        threads.push_back(std::this_thread::get_id());
+        return true;
+    }};
+    for (std::size_t f = 0; f < frames; ++f) {
+        const SceneUpdate u = session.render_frame(updates[f]);
+        // The scene was built up front; later frames only refit the moved sphere
+        assert(u == (f == 0 ? SceneUpdate::none : SceneUpdate::refit));
+    }
+    assert(session.finish());
+    assert(session.frame_count() == frames && out.size() == frames);
+    for (const auto id : threads) assert(id != std::this_thread::get_id());
+
+    // Each frame equals a fresh render of the scene in that frame's state
+    Scene<double> fresh = make_scene();
+    for (std::size_t f = 0; f < frames; ++f) {
+        if (updates[f].camera) fresh.set_camera(*updates[f].camera);
+        for (const auto& [i, xf] : updates[f].objects) fresh.set_object_transform(i, xf);
+        fresh.build_bvh();
+        Image<double,3> ref;
+        renderer.render(fresh, ref, W, H);
+        for (std::size_t y = 0; y < H; ++y)
+            for (std::size_t x = 0; x < W; ++x)
+                for (int c = 0; c < 3; ++c) assert(std::abs(out[f](x,y)[c] - ref(x,y)[c]) < 1e-9);
+    }
+    // The last frame stays readable from the session
+    assert(session.frame()(W/2, H/2)[0] == out.back()(W/2, H/2)[0]);
+}
+
+static void test_output_errors_are_reported() {
+    const glimmer::RendererSimpleRT<double> renderer;
+    Scene<double> scene = make_scene();
+    {
+        RenderSession<double> session{scene, renderer, 8, 8, [](std::size_t frame, const Image<double,3>&) {
+            return frame != 1;
+        }};
+        session.render_frame();
+        session.render_frame();
+        session.render_frame();
+        assert(!session.finish());
+    }
+    {
+        RenderSession<double> session{scene, renderer, 8, 8, [](std::size_t frame, const Image<double,3>&) -> bool {
+            if (frame == 0) throw std::runtime_error("disk full");
+            return true;
+        }};
+        session.render_frame();
+        bool threw = false;
+        try { session.render_frame(); (void)session.finish(); } catch (const std::runtime_error&) { threw = true; }
+        assert(threw);
+        assert(!session.finish());
+    }
+    {
+        // Bad indices are rejected before anything changes
+        RenderSession<double> session{scene, renderer, 8, 8};
+        FrameUpdate<double> bad;
+        bad.camera = camera_at(3);
+        bad.objects.emplace_back(7, moved_to(0, 0));
+        bool threw = false;
+        try { session.render_frame(bad); } catch (const std::out_of_range&) { threw = true; }
+        assert(threw && session.frame_count() == 0);
+        assert(session.scene().camera().cam_to_world().apply_point(Vector<double,3>{0,0,0})[0] == 0.0);
+        // Sessions without an output just keep the latest frame
+        session.render_frame();
+        assert(session.finish() && session.frame().width() == 8);
+    }
+}
+
+static void test_ppm_sequence_output() {
+    assert(glimmer::frame_path("frame_####.ppm", 7) == "frame_0007.ppm");
+    assert(glimmer::frame_path("f#.ppm", 123) == "f123.ppm");
+    assert(glimmer::frame_path("out_", 4) == "out_4");
+
+    const glimmer::RendererSimpleRT<double> renderer;
+    Scene<double> scene = make_scene();
+    const std::string pattern = "render_session_##.ppm";
+    {
+        RenderSession<double> session{scene, renderer, 10, 6, glimmer::ppm_sequence_output<double>(pattern)};
+        const auto updates = animation(3);
+        assert(session.render_frames(updates) == 3);
+        assert(session.finish());
+    }
+    for (std::size_t f = 0; f < 3; ++f) {
+        const auto path = glimmer::frame_path(pattern, f);
+        const auto img = glimmer::load_ppm<double>(path);
+        assert(img && img->width() == 10 && img->height() == 6);
+        std::filesystem::remove(path);
+    }
+}
+
+int main() {
+    test_frames_match_independent_renders();
+    test_output_errors_are_reported();
+    test_ppm_sequence_output();
+    std::cout << "All render session tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,197 @@
+import glimmer.render_stats;
+import glimmer.renderer_path_tracer;
+import glimmer.renderer_wavefront;
+import glimmer.renderer_simple_rt;
+import glimmer.thread_pool;
+import glimmer.accumulation;
+import glimmer.scene;
+import glimmer.scene_object;
+import glimmer.sphere;
+import glimmer.camera;
+import glimmer.transform;
+import glimmer.vector;
+import glimmer.color;
+import glimmer.image;
+import glimmer.material;
+import glimmer.tile;
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using glimmer::Scene;
+using glimmer::SceneObject;
+using glimmer::Sphere;
+using glimmer::Camera;
+using glimmer::Vector;
+using glimmer::Color;
+using glimmer::Image;
+using glimmer::Material;
+using glimmer::RenderCounters;
+using glimmer::RenderStats;
+using glimmer::StatCounter;
+
+static Scene<double> make_scene() {
+    using T = double;
+    auto cam = Camera<T>::from_look_at(Vector<T,3>{0,0,5}, Vector<T,3>{0,0,0}, Vector<T,3>{0,1,0},
+                                       M_PI/3, 1.0, 0.1, 100.0);
+    Scene<T> scene{cam, Color<T,3>{0.2,0.3,0.4}};
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{-0.6,0,0}, 0.5),
+                                    Material<T>::lambertian(Color<T,3>{0.8, 0.5, 0.3}), glimmer::Transform<T>{}});
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0.6,0,0}, 0.5),
+                                    Material<T>::lambertian(Color<T,3>{0.3, 0.5, 0.8}), glimmer::Transform<T>{}});
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0,3,2}, 1.0),
+                                    Material<T>::emissive(Color<T,3>{1, 1, 1}, 5.0), glimmer::Transform<T>{}});
+    scene.build_bvh();
+    return scene;
+}
+
+static double heatmap_sum(const RenderStats& stats) {
+    double sum = 0;
+    for (std::size_t y = 0; y < stats.heatmap.height(); ++y)
+        for (std::size_t x = 0; x < stats.heatmap.width(); ++x) sum += stats.heatmap(x, y)[0];
+    return sum;
+}
+
+static void test_counters_arithmetic() {
+    RenderCounters a{};
+    a[StatCounter::rays] = 5;
+    a[StatCounter::aabb_tests] = 7;
+    a[StatCounter::primitive_tests] = 3;
+    RenderCounters b = a;
+    b += a;
+    assert(b[StatCounter::rays] == 10 && b.cost() == 20);
+    assert(b - a == a);
+    assert((a - a) == RenderCounters{});
+}
+
+static void test_record_and_tally() {
+    const RenderCounters before = glimmer::thread_render_counters();
+    glimmer::record_stat(StatCounter::bounces, 3);
+    {
+        glimmer::StatTally tally{StatCounter::aabb_tests};
+        tally.add();
+        tally.add(4);
+        // Nothing is published until the tally goes out of scope
+        assert(glimmer::thread_render_counters()[StatCounter::aabb_tests] == before[StatCounter::aabb_tests]);
+    }
+    const RenderCounters delta = glimmer::thread_render_counters() - before;
+    if constexpr (glimmer::render_stats_enabled) {
+        assert(delta[StatCounter::bounces] == 3 && delta[StatCounter::aabb_tests] == 5);
+    } else {
+        assert(delta == RenderCounters{});
+    }
+    // Other threads count separately
+    std::thread([] { glimmer::record_stat(StatCounter::rays, 100); }).join();
+    assert((glimmer::thread_render_counters() - before)[StatCounter::rays] == 0);
+}
+
+static void test_path_tracer_stats() {
+    using T = double;
+    const Scene<T> scene = make_scene();
+    const std::size_t W = 19, H = 13, spp = 4;
+    glimmer::RendererPathTracer<T> renderer{spp, 5, 42};
+    renderer.set_tile_size(4);
+    renderer.set_thread_pool(std::make_shared<glimmer::ThreadPool>(3));
+    renderer.set_stats_heatmap(true);
+    Image<T,3> img{W,H};
+    renderer.render(scene, img, W, H);
+
+    const RenderStats& stats = renderer.stats();
+    assert(stats.width == W && stats.height == H && stats.seconds > 0);
+    if constexpr (!glimmer::render_stats_enabled) {
+        assert(stats.tiles.empty() && stats.heatmap.empty() && stats.counters == RenderCounters{});
+        return;
+    }
+    const glimmer::TileGrid grid{W, H, 4};
+    assert(stats.tiles.size() == grid.count());
+    RenderCounters sum{};
+    for (std::size_t i = 0; i < stats.tiles.size(); ++i) {
+        assert(stats.tiles[i].tile.index == i && stats.tiles[i].seconds >= 0);
+        assert(stats.tiles[i].counters[StatCounter::rays] >= stats.tiles[i].tile.width() * stats.tiles[i].tile.height() * spp);
+        sum += stats.tiles[i].counters;
+    }
+    assert(sum == stats.counters);
+    // One camera ray per sample plus continuation rays; NEE adds shadow rays at diffuse hits
+    assert(stats.counters[StatCounter::rays] > W * H * spp);
+    assert(stats.counters[StatCounter::shadow_rays] > 0);
+    assert(stats.counters[StatCounter::bounces] > 0 && stats.counters[StatCounter::aabb_tests] > 0);
+    assert(stats.counters[StatCounter::primitive_tests] > 0);
+    assert(stats.rays_per_second() > 0 && stats.max_tile_seconds() <= stats.seconds);
+
+    // The heatmap is measured per pixel and accounts for all traversal work of the tiles
+    assert(stats.heatmap.width() == W && stats.heatmap.height() == H);
+    assert(std::abs(heatmap_sum(stats) - static_cast<double>(stats.counters.cost())) < 1e-6 * stats.counters.cost());
+    // Pixels covering a sphere cost more than background pixels
+    assert(stats.heatmap(W/2 - 3, H/2)[0] > stats.heatmap(0, 0)[0]);
+
+    // The counts do not depend on the thread count, and a second render replaces the first one's stats
+    const RenderCounters first = stats.counters;
+    renderer.set_thread_pool(std::make_shared<glimmer::ThreadPool>(1));
+    renderer.set_stats_heatmap(false);
+    renderer.render(scene, img, W, H);
+    assert(renderer.stats().counters == first);
+    assert(renderer.stats().heatmap.empty());
+}
+
+static void test_wavefront_and_simple_tile_heatmap() {
+    using T = double;
+    const Scene<T> scene = make_scene();
+    const std::size_t W = 16, H = 12;
+    glimmer::RendererWavefront<T> wavefront{4, 4, 9};
+    glimmer::RendererSimpleRT<T> simple;
+    wavefront.set_stats_heatmap(true);
+    simple.set_stats_heatmap(true);
+    wavefront.set_tile_size(8);
+    simple.set_tile_size(8);
+    Image<T,3> img{W,H};
+    wavefront.render(scene, img, W, H);
+    simple.render(scene, img, W, H);
+    if constexpr (!glimmer::render_stats_enabled) {
+        assert(wavefront.stats().heatmap.empty() && simple.stats().tiles.empty());
+        return;
+    }
+    const RenderStats& ws = wavefront.stats();
+    assert(ws.counters[StatCounter::bounces] > 0 && ws.counters[StatCounter::rays] >= W * H * 4);
+    // Tile costs are spread evenly over their pixels
+    assert(std::abs(heatmap_sum(ws) - static_cast<double>(ws.counters.cost())) < 1e-4 * ws.counters.cost());
+    assert(ws.heatmap(0, 0)[0] == ws.heatmap(7, 7)[0]);
+    // The simple renderer traces exactly one camera ray per pixel and never bounces
+    const RenderStats& ss = simple.stats();
+    assert(ss.counters[StatCounter::rays] == W * H);
+    assert(ss.counters[StatCounter::bounces] == 0 && ss.counters[StatCounter::shadow_rays] == 0);
+}
+
+static void test_progressive_accumulates_passes() {
+    using T = double;
+    const Scene<T> scene = make_scene();
+    const std::size_t W = 12, H = 8;
+    glimmer::RendererPathTracer<T> renderer{16, 4, 3};
+    renderer.set_tile_size(4);
+    renderer.set_stats_heatmap(true);
+    glimmer::AccumulationBuffer<T> acc;
+    decltype(renderer)::ProgressiveOptions opt{};
+    opt.samples_per_pass = 4;
+    opt.noise_threshold = 0;
+    const auto result = renderer.render_progressive(scene, acc, W, H, opt);
+    assert(result.passes == 4);
+    const RenderStats& stats = renderer.stats();
+    assert(stats.width == W && stats.height == H);
+    if constexpr (glimmer::render_stats_enabled) {
+        // Every pass traced all pixels, so each tile saw at least one camera ray per sample
+        for (const auto& t : stats.tiles) assert(t.counters[StatCounter::rays] >= t.tile.width() * t.tile.height() * 16);
+        assert(std::abs(heatmap_sum(stats) - static_cast<double>(stats.counters.cost())) < 1e-6 * stats.counters.cost());
+    }
+}
+
+int main() {
+    test_counters_arithmetic();
+    test_record_and_tally();
+    test_path_tracer_stats();
+    test_wavefront_and_simple_tile_heatmap();
+    test_progressive_accumulates_passes();
+    std::cout << "All render stats tests passed." << std::endl;
+    return 0;
+}
@@ -1,5 +1,9 @@
 import glimmer.renderer;
 import glimmer.renderer_simple_rt;
+import glimmer.renderer_path_tracer;
+import glimmer.renderer_wavefront;
+import glimmer.thread_pool;
+import glimmer.accumulation;
 import glimmer.scene;
 import glimmer.scene_object;
 import glimmer.sphere;
@@ -9,9 +13,18 @@ import glimmer.vector;
 import glimmer.color;
 import glimmer.image;
 import glimmer.material;
+import glimmer.sampler;
+import glimmer.ppm;
+import glimmer.aov;
+import glimmer.bsdf;
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <memory>
 
 using glimmer::Scene;
@@ -76,9 +89,419 @@ static void test_render_diffuse_lambert() {
     assert(c[0] > 0.0 && c[1] > 0.0 && c[2] > 0.0);
 }
 
+static void test_path_tracer_deterministic_across_thread_counts() {
+    using T = double;
+    auto cam = Camera<T>::from_look_at(Vector<T,3>{0,0,5}, Vector<T,3>{0,0,0}, Vector<T,3>{0,1,0},
+                                       M_PI/3, 1.0, 0.1, 100.0);
+    Scene<T> scene{cam, Color<T,3>{0.2,0.3,0.4}};
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{-0.6,0,0}, 0.5),
+                                    Material<T>::lambertian(Color<T,3>{0.8, 0.5, 0.3}), glimmer::Transform<T>{}});
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0.6,0,0}, 0.5),
+                                    Material<T>::glass(Color<T,3>{1,1,1}, 0.0, 1.0), glimmer::Transform<T>{}});
+    scene.build_bvh();
+
+    const std::size_t W = 21, H = 13;
+    glimmer::RendererPathTracer<T> renderer{4, 4, 42};
+    renderer.set_tile_size(4);
+    Image<T,3> single{W,H}, multi{W,H};
+    renderer.set_thread_pool(std::make_shared<glimmer::ThreadPool>(1));
+    renderer.render(scene, single, W, H);
+    renderer.set_thread_pool(std::make_shared<glimmer::ThreadPool>(4));
+    renderer.render(scene, multi, W, H);
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x)
+            for (int c = 0; c < 3; ++c) assert(single(x,y)[c] == multi(x,y)[c]);
+    // Rendering again on the same pool reproduces the image
+    Image<T,3> again{W,H};
+    renderer.render(scene, again, W, H);
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x)
+            for (int c = 0; c < 3; ++c) assert(again(x,y)[c] == multi(x,y)[c]);
+}
+
+static void test_progressive_stops_converged_pixels() {
+    using T = double;
+    auto cam = Camera<T>::from_look_at(Vector<T,3>{0,0,5}, Vector<T,3>{0,0,0}, Vector<T,3>{0,1,0},
+                                       M_PI/3, 1.0, 0.1, 100.0);
+    Scene<T> scene{cam, Color<T,3>{0.5,0.5,0.5}};
+    // Small diffuse sphere in the middle of a flat background, lit by an emitter outside the view
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0,0,0}, 0.4),
+                                    Material<T>::lambertian(Color<T,3>{0.8, 0.8, 0.8}), glimmer::Transform<T>{}});
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{4,0,3}, 1.5),
+                                    Material<T>::emissive(Color<T,3>{1, 1, 1}, 10.0), glimmer::Transform<T>{}});
+    scene.build_bvh();
+
+    const std::size_t W = 32, H = 32;
+    glimmer::RendererPathTracer<T> renderer{256, 4, 7};
+    renderer.set_tile_size(8);
+    glimmer::AccumulationBuffer<T> acc;
+    decltype(renderer)::ProgressiveOptions opt{};
+    opt.samples_per_pass = 4;
+    opt.min_samples = 8;
+    opt.noise_threshold = 0.02;
+    std::size_t callbacks = 0;
+    auto stats = renderer.render_progressive(scene, acc, W, H, opt,
+                                             [&](const glimmer::AccumulationBuffer<T>&, std::size_t pass) {
+                                                 assert(pass == callbacks);
+                                                 ++callbacks;
+                                                 return true;
+                                             });
+    assert(stats.converged && !stats.cancelled && !stats.out_of_time);
+    assert(callbacks == stats.passes);
+    // Background pixels have no variance and stop at min_samples; the sphere keeps sampling
+    assert(acc.samples(0, 0) == opt.min_samples);
+    std::uint32_t max_center = 0;
+    for (std::size_t y = H/2 - 2; y <= H/2 + 2; ++y)
+        for (std::size_t x = W/2 - 2; x <= W/2 + 2; ++x) max_center = std::max(max_center, acc.samples(x, y));
+    assert(max_center > opt.min_samples && max_center <= 256);
+    assert(stats.samples < static_cast<std::uint64_t>(W * H) * 256);
+    auto bg = acc.mean(0, 0);
+    assert(std::abs(bg[0] - 0.5) < 1e-12);
+}
+
+static void test_progressive_cancel_and_determinism() {
+    using T = double;
+    auto cam = Camera<T>::from_look_at(Vector<T,3>{0,0,5}, Vector<T,3>{0,0,0}, Vector<T,3>{0,1,0},
+                                       M_PI/3, 1.0, 0.1, 100.0);
+    Scene<T> scene{cam, Color<T,3>{0.2,0.3,0.4}};
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0,0,0}, 1.0),
+                                    Material<T>::lambertian(Color<T,3>{0.8, 0.5, 0.3}), glimmer::Transform<T>{}});
+    const std::size_t W = 16, H = 12;
+    glimmer::RendererPathTracer<T> renderer{64, 3, 3};
+    renderer.set_tile_size(4);
+    decltype(renderer)::ProgressiveOptions opt{};
+    opt.samples_per_pass = 2;
+
+    // Cancelling from the callback stops after the first pass
+    glimmer::AccumulationBuffer<T> acc;
+    auto stats = renderer.render_progressive(scene, acc, W, H, opt,
+                                             [](const glimmer::AccumulationBuffer<T>&, std::size_t) { return false; });
+    assert(stats.cancelled && stats.passes == 1);
+    assert(acc.samples(W/2, H/2) == 2);
+
+    // Same result on one and four threads
+    glimmer::AccumulationBuffer<T> a, b;
+    renderer.set_thread_pool(std::make_shared<glimmer::ThreadPool>(1));
+    renderer.render_progressive(scene, a, W, H, opt);
+    renderer.set_thread_pool(std::make_shared<glimmer::ThreadPool>(4));
+    renderer.render_progressive(scene, b, W, H, opt);
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x) {
+            assert(a.samples(x, y) == b.samples(x, y));
+            auto ca = a.mean(x, y), cb = b.mean(x, y);
+            for (int c = 0; c < 3; ++c) assert(ca[c] == cb[c]);
+        }
+}
+
+template <class T = double>
+static Scene<T> make_mixed_scene() {
+    auto cam = Camera<T>::from_look_at(Vector<T,3>{0,0,5}, Vector<T,3>{0,0,0}, Vector<T,3>{0,1,0},
+                                       M_PI/4, 1.0, 0.1, 100.0);
+    Scene<T> scene{cam, Color<T,3>{0.6,0.7,0.9}};
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{-0.7,0,0}, 0.6),
+                                    Material<T>::lambertian(Color<T,3>{0.8, 0.4, 0.2}), glimmer::Transform<T>{}});
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0.7,0,0}, 0.6),
+                                    Material<T>::glass(Color<T,3>{1,1,1}, 0.0, 1.0), glimmer::Transform<T>{}});
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0,-100.6,0}, 100.0),
+                                    Material<T>::metal(Color<T,3>{0.7, 0.7, 0.7}, 0.6), glimmer::Transform<T>{}});
+    scene.build_bvh();
+    return scene;
+}
+
+static void test_wavefront_matches_path_tracer() {
+    using T = double;
+    const Scene<T> scene = make_mixed_scene();
+    const std::size_t W = 10, H = 10, spp = 1024;
+    Image<T,3> reference{W,H}, wave{W,H};
+    glimmer::RendererPathTracer<T>{spp, 5, 11}.render(scene, reference, W, H);
+    glimmer::RendererWavefront<T>{spp, 5, 23}.render(scene, wave, W, H);
+    double sum_ref = 0, sum_wave = 0, abs_diff = 0;
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x) {
+            sum_ref += glimmer::luminance(reference(x,y));
+            sum_wave += glimmer::luminance(wave(x,y));
+            abs_diff += std::abs(glimmer::luminance(reference(x,y)) - glimmer::luminance(wave(x,y)));
+        }
+    // Same estimator with independent random streams: images agree up to Monte Carlo noise
+    assert(std::abs(sum_ref - sum_wave) / sum_ref < 0.02);
+    assert(abs_diff / static_cast<double>(W * H) < 0.05);
+}
+
+static void test_wavefront_deterministic_across_thread_counts() {
+    using T = double;
+    const Scene<T> scene = make_mixed_scene();
+    const std::size_t W = 13, H = 9;
+    glimmer::RendererWavefront<T> renderer{6, 4, 5, 4};
+    Image<T,3> single{W,H}, multi{W,H};
+    renderer.set_thread_pool(std::make_shared<glimmer::ThreadPool>(1));
+    renderer.set_tile_size(16);
+    renderer.render(scene, single, W, H);
+    renderer.set_thread_pool(std::make_shared<glimmer::ThreadPool>(4));
+    renderer.set_tile_size(3); // per-path seeding also makes the tile size irrelevant
+    renderer.render(scene, multi, W, H);
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x)
+            for (int c = 0; c < 3; ++c) assert(single(x,y)[c] == multi(x,y)[c]);
+}
+
+static void test_halton_sampler_matches_independent() {
+    using T = double;
+    const Scene<T> scene = make_mixed_scene();
+    const std::size_t W = 10, H = 10;
+    Image<T,3> independent{W,H}, halton{W,H}, halton_mt{W,H}, wave{W,H};
+    glimmer::RendererPathTracer<T> renderer{512, 5, 9};
+    renderer.render(scene, independent, W, H);
+    renderer.set_sampler(glimmer::SamplerKind::halton);
+    assert(renderer.sampler() == glimmer::SamplerKind::halton);
+    renderer.set_thread_pool(std::make_shared<glimmer::ThreadPool>(1));
+    renderer.render(scene, halton, W, H);
+    renderer.set_thread_pool(std::make_shared<glimmer::ThreadPool>(4));
+    renderer.set_tile_size(4);
+    renderer.render(scene, halton_mt, W, H);
+    glimmer::RendererWavefront<T> wavefront{512, 5, 9};
+    wavefront.set_sampler(glimmer::SamplerKind::halton);
+    wavefront.render(scene, wave, W, H);
+    double sum_ind = 0, sum_hal = 0, sum_wave = 0;
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x) {
+            for (int c = 0; c < 3; ++c) assert(halton(x,y)[c] == halton_mt(x,y)[c]);
+            sum_ind += glimmer::luminance(independent(x,y));
+            sum_hal += glimmer::luminance(halton(x,y));
+            sum_wave += glimmer::luminance(wave(x,y));
+        }
+    assert(std::abs(sum_ind - sum_hal) / sum_ind < 0.03);
+    assert(std::abs(sum_ind - sum_wave) / sum_ind < 0.03);
+}
+
+static void test_float_matches_double() {
+    const Scene<double> sd = make_mixed_scene<double>();
+    const Scene<float> sf = make_mixed_scene<float>();
+    const std::size_t W = 10, H = 10;
+
+    // Whitted shading is deterministic: float and double agree up to rounding
+    Image<double,3> rd{W,H};
+    Image<float,3> rf{W,H};
+    glimmer::RendererSimpleRT<double>{}.render(sd, rd, W, H);
+    glimmer::RendererSimpleRT<float>{}.render(sf, rf, W, H);
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x)
+            for (int c = 0; c < 3; ++c) assert(std::abs(rd(x,y)[c] - static_cast<double>(rf(x,y)[c])) < 1e-3);
+
+    // Monte Carlo renderers in float converge to the double estimate
+    Image<double,3> pd{W,H};
+    Image<float,3> pf{W,H}, wf{W,H};
+    glimmer::RendererPathTracer<double>{512, 5, 3}.render(sd, pd, W, H);
+    glimmer::RendererPathTracer<float>{512, 5, 3}.render(sf, pf, W, H);
+    glimmer::RendererWavefront<float>{512, 5, 3}.render(sf, wf, W, H);
+    double sum_d = 0, sum_pf = 0, sum_wf = 0;
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x) {
+            sum_d += glimmer::luminance(pd(x,y));
+            sum_pf += glimmer::luminance(pf(x,y));
+            sum_wf += glimmer::luminance(wf(x,y));
+            assert(std::isfinite(pf(x,y)[0]) && std::isfinite(wf(x,y)[0]));
+        }
+    assert(std::abs(sum_d - sum_pf) / sum_d < 0.03);
+    assert(std::abs(sum_d - sum_wf) / sum_d < 0.03);
+}
+
+static void test_light_sampling_reduces_noise() {
+    using T = double;
+    auto cam = Camera<T>::from_look_at(Vector<T,3>{0,1,4}, Vector<T,3>{0,0,0}, Vector<T,3>{0,1,0},
+                                       M_PI/4, 1.0, 0.1, 100.0);
+    Scene<T> scene{cam, Color<T,3>{0,0,0}};
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0,-100.5,0}, 100.0),
+                                    Material<T>::lambertian(Color<T,3>{0.7, 0.7, 0.7}), glimmer::Transform<T>{}});
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0,0,0}, 0.5),
+                                    Material<T>::lambertian(Color<T,3>{0.8, 0.4, 0.2}), glimmer::Transform<T>{}});
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{1.5,2,1}, 0.4),
+                                    Material<T>::emissive(Color<T,3>{1, 1, 1}, 20.0), glimmer::Transform<T>{}});
+    scene.build_bvh();
+    assert(scene.lights().size() == 1);
+
+    const std::size_t W = 12, H = 12;
+    auto render = [&](bool nee, std::size_t spp, std::uint64_t seed) {
+        glimmer::RendererPathTracer<T> renderer{spp, 4, seed};
+        renderer.set_light_sampling(nee);
+        assert(renderer.light_sampling() == nee);
+        Image<T,3> img{W,H};
+        renderer.render(scene, img, W, H);
+        return img;
+    };
+    auto sum = [&](const Image<T,3>& img) {
+        double s = 0;
+        for (std::size_t y = 0; y < H; ++y)
+            for (std::size_t x = 0; x < W; ++x) s += glimmer::luminance(img(x,y));
+        return s;
+    };
+    auto noise = [&](const Image<T,3>& a, const Image<T,3>& b) {
+        double d = 0;
+        for (std::size_t y = 0; y < H; ++y)
+            for (std::size_t x = 0; x < W; ++x) d += std::abs(glimmer::luminance(a(x,y)) - glimmer::luminance(b(x,y)));
+        return d;
+    };
+    // Both estimators converge to the same image
+    const double with_nee = sum(render(true, 1024, 1));
+    const double without = sum(render(false, 1024, 2));
+    assert(with_nee > 0.0);
+    assert(std::abs(with_nee - without) / with_nee < 0.03);
+    // Light sampling is much less noisy at equal sample counts
+    const double noise_nee = noise(render(true, 16, 3), render(true, 16, 4));
+    const double noise_bsdf = noise(render(false, 16, 3), render(false, 16, 4));
+    assert(noise_nee < 0.5 * noise_bsdf);
+}
+
+static void test_streaming_sink_matches_image() {
+    using T = double;
+    const Scene<T> scene = make_mixed_scene();
+    const std::size_t W = 45, H = 21;
+    auto read = [](const char* p) {
+        std::ifstream in(p, std::ios::binary);
+        return std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    };
+    glimmer::RendererPathTracer<T> pt{4, 4, 3};
+    glimmer::RendererWavefront<T> wf{4, 4, 3};
+    glimmer::RendererSimpleRT<T> rt;
+    const glimmer::Renderer<T>* renderers[] = {&pt, &wf, &rt};
+    for (const auto* r : renderers) {
+        Image<T,3> img;
+        r->render(scene, img, W, H);
+        assert(glimmer::save_ppm(img, "render_image.ppm"));
+        glimmer::PpmStreamSink<T> sink{"render_stream.ppm"};
+        r->render(scene, sink, W, H);
+        assert(sink.good());
+        assert(read("render_stream.ppm") == read("render_image.ppm"));
+    }
+    std::filesystem::remove("render_image.ppm");
+    std::filesystem::remove("render_stream.ppm");
+}
+
+static void test_path_tracer_aovs() {
+    using T = double;
+    auto cam = Camera<T>::from_look_at(Vector<T,3>{0,0,5}, Vector<T,3>{0,0,0}, Vector<T,3>{0,1,0},
+                                       M_PI/3, 1.0, 0.1, 100.0);
+    Scene<T> scene{cam, Color<T,3>{0.2,0.3,0.4}};
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0,0,0}, 1.0),
+                                    Material<T>::lambertian(Color<T,3>{0.8, 0.5, 0.3}), glimmer::Transform<T>{}});
+    scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{3,3,3}, 0.5),
+                                    Material<T>::emissive(Color<T,3>{1, 1, 1}, 10.0), glimmer::Transform<T>{}});
+    scene.build_bvh();
+
+    const std::size_t W = 15, H = 15;
+    glimmer::RendererPathTracer<T> renderer{4, 4, 11};
+    Image<T,3> plain, beauty;
+    glimmer::AovImages<T> aovs;
+    renderer.render(scene, plain, W, H);
+    renderer.render(scene, beauty, aovs, W, H);
+    assert(aovs.width() == W && aovs.height() == H);
+    // The AOVs do not change the beauty image
+    for (std::size_t y = 0; y < H; ++y)
+        for (std::size_t x = 0; x < W; ++x)
+            for (int c = 0; c < 3; ++c) assert(plain(x,y)[c] == beauty(x,y)[c]);
+    // The center pixel sees the sphere's front: its albedo, a normal towards the camera, and depth 4
+    const auto a = aovs.albedo(W/2, H/2);
+    const auto n = aovs.normal(W/2, H/2);
+    assert(std::abs(a[0] - 0.8) < 1e-9 && std::abs(a[1] - 0.5) < 1e-9 && std::abs(a[2] - 0.3) < 1e-9);
+    assert(n[2] > 0.9 && std::abs(aovs.depth(W/2, H/2)[0] - 4.0) < 0.1);
+    // Corners miss the scene
+    assert(aovs.depth(0, 0)[0] == 0 && aovs.normal(0, 0)[2] == 0 && aovs.albedo(0, 0)[0] == 0);
+}
+
+static void test_thin_lens_depth_of_field() {
+    using T = double;
+    auto make = [](T aperture, T focus) {
+        auto cam = Camera<T>::from_look_at(Vector<T,3>{0,0,5}, Vector<T,3>{0,0,0}, Vector<T,3>{0,1,0},
+                                           M_PI/4, 1.0, 0.1, 100.0);
+        if (aperture > 0) cam.set_lens(aperture, focus);
+        Scene<T> scene{cam, Color<T,3>{0,0,0}};
+        scene.add_object(SceneObject<T>{std::make_shared<Sphere<T>>(Vector<T,3>{0,0,0}, 1.0),
+                                        Material<T>::emissive(Color<T,3>{1, 1, 1}, 1.0), glimmer::Transform<T>{}});
+        scene.build_bvh();
+        return scene;
+    };
+    // Pixels partly covered by the disk of the sphere; defocus spreads its edge over more of them
+    auto blurred_pixels = [](const Image<T,3>& img) {
+        const T full = glimmer::luminance(img(img.width() / 2, img.height() / 2));
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < img.size(); ++i) {
+            const T l = glimmer::luminance(img.data()[i]);
+            n += l > 0.02 * full && l < 0.98 * full;
+        }
+        return n;
+    };
+    const std::size_t W = 24, H = 24, spp = 64;
+    Image<T,3> pinhole, focused, defocused, wave;
+    glimmer::RendererPathTracer<T>{spp, 2, 3}.render(make(0, 1), pinhole, W, H);
+    glimmer::RendererPathTracer<T>{spp, 2, 3}.render(make(0.3, 4), focused, W, H);
+    glimmer::RendererPathTracer<T>{spp, 2, 3}.render(make(0.3, 1.5), defocused, W, H);
+    glimmer::RendererWavefront<T>{spp, 2, 3}.render(make(0.3, 1.5), wave, W, H);
+    // Focused on the sphere's silhouette distance, the lens barely changes the edge
+    assert(blurred_pixels(focused) <= blurred_pixels(pinhole) + 8);
+    assert(blurred_pixels(defocused) > 2 * blurred_pixels(pinhole));
+    // Both integrators use the same lens model
+    double sum_pt = 0, sum_wf = 0;
+    for (std::size_t i = 0; i < defocused.size(); ++i) {
+        sum_pt += glimmer::luminance(defocused.data()[i]);
+        sum_wf += glimmer::luminance(wave.data()[i]);
+    }
+    assert(std::abs(sum_pt - sum_wf) / sum_pt < 0.03);
+    assert(blurred_pixels(wave) > 2 * blurred_pixels(pinhole));
+}
+
+static void test_specialized_kernels_match_general() {
+    using T = double;
+    auto cam = Camera<T>::from_look_at(Vector<T,3>{0,1,4}, Vector<T,3>{0,0,0}, Vector<T,3>{0,1,0},
+                                       M_PI/4, 1.0, 0.1, 100.0);
+    auto sphere = [](Vector<T,3> c, T r) { return std::make_shared<Sphere<T>>(c, r); };
+    Scene<T> diffuse{cam, Color<T,3>{0.6,0.7,0.9}};
+    diffuse.add_object(SceneObject<T>{sphere({0,-100.5,0}, 100), Material<T>::lambertian(Color<T,3>{0.7, 0.7, 0.7}),
+                                      glimmer::Transform<T>{}});
+    diffuse.add_object(SceneObject<T>{sphere({0,0,0}, 0.5), Material<T>::lambertian(Color<T,3>{0.8, 0.4, 0.2}),
+                                      glimmer::Transform<T>{}});
+    diffuse.build_bvh();
+    Scene<T> lit = diffuse;
+    lit.add_object(SceneObject<T>{sphere({1.5,2,1}, 0.4), Material<T>::emissive(Color<T,3>{1, 1, 1}, 20.0),
+                                  glimmer::Transform<T>{}});
+    lit.add_object(SceneObject<T>{sphere({-1,0,0}, 0.4), Material<T>::metal(Color<T,3>{0.9, 0.9, 0.9}, 0.3),
+                                  glimmer::Transform<T>{}});
+    lit.build_bvh();
+
+    const std::size_t W = 10, H = 8;
+    for (const std::size_t depth : {std::size_t{3}, std::size_t{5}}) {
+        glimmer::RendererPathTracer<T> renderer{8, depth, 5};
+        const glimmer::PathFeatures f = renderer.path_features(diffuse);
+        assert(f.shading == glimmer::ShadingFeatures::none() && f.roulette == (depth > 3));
+        const auto g = renderer.path_features(lit);
+        assert(g.shading.emission && g.shading.specular && !g.shading.dielectric && !g.shading.textured);
+        for (const Scene<T>* scene : {&diffuse, &lit}) {
+            Image<T,3> specialized{W,H}, general{W,H};
+            renderer.render(*scene, specialized, W, H);
+            renderer.set_kernel_specialization(false);
+            assert(renderer.path_features(*scene) == glimmer::PathFeatures{});
+            renderer.render(*scene, general, W, H);
+            renderer.set_kernel_specialization(true);
+            for (std::size_t y = 0; y < H; ++y)
+                for (std::size_t x = 0; x < W; ++x)
+                    for (int c = 0; c < 3; ++c) assert(specialized(x,y)[c] == general(x,y)[c]);
+        }
+    }
+}
+
 int main() {
     test_render_emissive_center();
     test_render_diffuse_lambert();
+    test_path_tracer_deterministic_across_thread_counts();
+    test_progressive_stops_converged_pixels();
+    test_progressive_cancel_and_determinism();
+    test_wavefront_matches_path_tracer();
+    test_wavefront_deterministic_across_thread_counts();
+    test_halton_sampler_matches_independent();
+    test_float_matches_double();
+    test_light_sampling_reduces_noise();
+    test_streaming_sink_matches_image();
+    test_path_tracer_aovs();
+    test_thin_lens_depth_of_field();
+    test_specialized_kernels_match_general();
     std::cout << "All renderer tests passed.\n";
     return 0;
 }
@@ -0,0 +1,133 @@
+import glimmer.sampler;
+import glimmer.vector;
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+
+using glimmer::Pcg32;
+using glimmer::IndependentSampler;
+using glimmer::HaltonSampler;
+using glimmer::SamplerKind;
+
+static_assert(glimmer::PixelSampler<IndependentSampler<double>, double>);
+static_assert(glimmer::PixelSampler<HaltonSampler<float>, float>);
+static_assert(sizeof(Pcg32) == 16);
+
+static void test_pcg32_reference_stream() {
+    // Reference output of the PCG32 demo for seed 42, sequence 54
+    Pcg32 rng{42u, 54u};
+    const std::array<std::uint32_t, 6> expected{0xa15c02b7u, 0x7b47f409u, 0xba1d3330u,
+                                                 0x83d2f293u, 0xbfa4784bu, 0xcbed606eu};
+    for (const auto e : expected) assert(rng.next_u32() == e);
+}
+
+static void test_pcg32_advance_and_uniform() {
+    Pcg32 a{7u, 3u}, b{7u, 3u};
+    for (int i = 0; i < 37; ++i) (void)a.next_u32();
+    b.advance(37);
+    assert(a == b);
+    assert(a.next_u32() == b.next_u32());
+
+    Pcg32 rng{1u};
+    double mean = 0.0;
+    for (int i = 0; i < 10000; ++i) {
+        const float f = rng.uniform<float>();
+        const double d = rng.uniform<double>();
+        assert(f >= 0.0f && f < 1.0f);
+        assert(d >= 0.0 && d < 1.0);
+        mean += d;
+    }
+    assert(std::abs(mean / 10000.0 - 0.5) < 0.02);
+}
+
+template <class Sampler>
+static void check_order_independent() {
+    // A value depends only on (pixel, index, dimension), not on how the caller got there
+    Sampler s{99u};
+    s.start_pixel_sample(4, 9, 17);
+    std::array<double, 6> seq{};
+    for (auto& v : seq) v = static_cast<double>(s.next_1d());
+    for (std::uint32_t d = 0; d < seq.size(); ++d) {
+        Sampler t{99u};
+        t.start_pixel_sample(1, 1, 3); // unrelated state first
+        (void)t.next_2d();
+        t.start_pixel_sample(4, 9, 17);
+        t.set_dimension(d);
+        assert(static_cast<double>(t.next_1d()) == seq[d]);
+    }
+    // Different pixels and samples see different values
+    Sampler u{99u};
+    u.start_pixel_sample(5, 9, 17);
+    assert(static_cast<double>(u.next_1d()) != seq[0]);
+    u.start_pixel_sample(4, 9, 18);
+    assert(static_cast<double>(u.next_1d()) != seq[0]);
+}
+
+static void test_halton_is_stratified_per_pixel() {
+    HaltonSampler<double> s{5u};
+    for (std::uint32_t dim = 0; dim < 2; ++dim) {
+        std::array<int, 16> bins{};
+        for (std::uint64_t i = 0; i < 16; ++i) {
+            s.start_pixel_sample(3, 7, i);
+            s.set_dimension(dim);
+            const double u = s.next_1d();
+            assert(u >= 0.0 && u < 1.0);
+            if (dim == 0) ++bins[static_cast<std::size_t>(u * 16.0)];
+        }
+        if (dim == 0) for (const int b : bins) assert(b == 1); // base 2: one sample per 1/16 stratum
+    }
+    // Past the prime table values are still valid uniforms
+    s.start_pixel_sample(0, 0, 1);
+    s.set_dimension(HaltonSampler<double>::max_dimensions + 3);
+    const double u = s.next_1d();
+    assert(u >= 0.0 && u < 1.0);
+}
+
+template <class Sampler>
+static double integration_error(std::uint64_t samples) {
+    // Mean absolute error of estimating the integral of u*v over [0,1)^2 (= 1/4) in 64 pixels
+    Sampler s{11u};
+    double err = 0.0;
+    for (std::uint32_t p = 0; p < 64; ++p) {
+        double sum = 0.0;
+        for (std::uint64_t i = 0; i < samples; ++i) {
+            s.start_pixel_sample(p, 0, i);
+            const auto uv = s.next_2d();
+            sum += uv[0] * uv[1];
+        }
+        err += std::abs(sum / static_cast<double>(samples) - 0.25);
+    }
+    return err / 64.0;
+}
+
+static void test_halton_converges_faster() {
+    const double independent = integration_error<IndependentSampler<double>>(64);
+    const double halton = integration_error<HaltonSampler<double>>(64);
+    assert(halton < 0.5 * independent);
+}
+
+static void test_visit_sampler() {
+    auto kind_of = [](SamplerKind k) {
+        return glimmer::visit_sampler<float>(k, 1u, [](const auto& s) {
+            return std::is_same_v<std::decay_t<decltype(s)>, HaltonSampler<float>> ? 1 : 0;
+        });
+    };
+    assert(kind_of(SamplerKind::halton) == 1);
+    assert(kind_of(SamplerKind::independent) == 0);
+}
+
+int main() {
+    test_pcg32_reference_stream();
+    test_pcg32_advance_and_uniform();
+    check_order_independent<IndependentSampler<double>>();
+    check_order_independent<IndependentSampler<float>>();
+    check_order_independent<HaltonSampler<double>>();
+    test_halton_is_stratified_per_pixel();
+    test_halton_converges_faster();
+    test_visit_sampler();
+    std::cout << "All sampler tests passed.\n";
+    return 0;
+}
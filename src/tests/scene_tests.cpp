@@ -8,10 +8,16 @@ import glimmer.camera;
 import glimmer.material;
 import glimmer.aabb;
 import glimmer.quaternion;
+import glimmer.ray;
+import glimmer.ray_packet;
+#include <array>
 #include <cassert>
 #include <iostream>
 #include <memory>
 #include <cmath>
+#include <cstdint>
+#include <optional>
+#include <vector>
 
 using glimmer::Scene;
 using glimmer::SceneObject;
@@ -22,6 +28,7 @@ using glimmer::Transform;
 using glimmer::Camera;
 using glimmer::Material;
 using glimmer::AABB;
+using glimmer::Ray;
 
 static void test_construct_and_props() {
     // Camera looking at -Z from origin
@@ -62,9 +69,214 @@ static void test_add_objects_and_aabb() {
     assert(std::abs(mx[0] - (6.0)) < 1e-9);
 }
 
+static void test_bvh_matches_linear_scan_and_refit() {
+    auto cam = Camera<double>::from_look_at(Vector<double,3>{0,0,0}, Vector<double,3>{0,0,-1}, Vector<double,3>{0,1,0},
+                                            M_PI/3, 1.0, 0.1, 100.0);
+    Scene<double> scene{cam, Vector<double,3>{0,0,0}};
+    auto geom = std::make_shared<Sphere<double>>(Vector<double,3>{0,0,0}, 0.4);
+    auto mat = Material<double>::lambertian(Vector<double,3>{1,1,1});
+    // 10x10 grid of spheres in the z=-5 plane
+    for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j < 10; ++j) {
+            auto xf = Transform<double>::from_trs(Vector<double,3>{double(i), double(j), -5.0},
+                                                  glimmer::Quaternion<double>{}, Vector<double,3>{1,1,1});
+            scene.add_object(SceneObject<double>{geom, mat, xf});
+        }
+    }
+    assert(!scene.bvh_valid());
+    // Reference hits through the linear fallback
+    std::vector<std::optional<std::size_t>> ref;
+    for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j < 10; ++j) {
+            Ray<double> r{Vector<double,3>{double(i), double(j), 0}, Vector<double,3>{0,0,-1}};
+            auto h = scene.intersect(r);
+            assert(h.has_value());
+            ref.push_back(h->object_index);
+        }
+    }
+    scene.build_bvh();
+    assert(scene.bvh_valid());
+    std::size_t k = 0;
+    for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j < 10; ++j) {
+            Ray<double> r{Vector<double,3>{double(i), double(j), 0}, Vector<double,3>{0,0,-1}};
+            auto h = scene.intersect(r);
+            assert(h.has_value() && h->object_index == *ref[k]);
+            assert(std::abs(h->t - 4.6) < 1e-9);
+            assert(h->object == &scene.objects()[h->object_index]);
+            ++k;
+        }
+    }
+    // Ray between spheres misses
+    assert(!scene.intersect(Ray<double>{Vector<double,3>{0.5, 0.5, 0}, Vector<double,3>{0,0,-1}}).has_value());
+
+    // Move object 0 far away and refit: old location is empty, new location hits
+    scene.objects()[0].set_transform(Transform<double>::from_trs(Vector<double,3>{50, 50, -5},
+                                                                 glimmer::Quaternion<double>{}, Vector<double,3>{1,1,1}));
+    scene.refit_bvh();
+    assert(scene.bvh_valid());
+    assert(!scene.intersect(Ray<double>{Vector<double,3>{0, 0, 0}, Vector<double,3>{0,0,-1}}).has_value());
+    auto moved = scene.intersect(Ray<double>{Vector<double,3>{50, 50, 0}, Vector<double,3>{0,0,-1}});
+    assert(moved.has_value() && moved->object_index == 0);
+
+    // Any-hit queries agree with closest-hit queries
+    assert(scene.occluded(Ray<double>{Vector<double,3>{50, 50, 0}, Vector<double,3>{0,0,-1}}));
+    assert(!scene.occluded(Ray<double>{Vector<double,3>{0.5, 0.5, 0}, Vector<double,3>{0,0,-1}}));
+    assert(!scene.occluded(Ray<double>{Vector<double,3>{1, 1, 0}, Vector<double,3>{0,0,-1}, 0.0, 4.5}));
+    assert(scene.occluded(Ray<double>{Vector<double,3>{1, 1, 0}, Vector<double,3>{0,0,-1}, 0.0, 4.7}));
+
+    // Adding an object invalidates the BVH
+    scene.add_object(SceneObject<double>{geom, mat, Transform<double>{}});
+    assert(!scene.bvh_valid());
+    // Linear fallback answers the same occlusion queries
+    assert(scene.occluded(Ray<double>{Vector<double,3>{50, 50, 0}, Vector<double,3>{0,0,-1}}));
+    assert(!scene.occluded(Ray<double>{Vector<double,3>{0.5, 0.5, 0}, Vector<double,3>{0,0,-1}}));
+}
+
+static void test_packet_matches_scalar() {
+    auto cam = Camera<double>::from_look_at(Vector<double,3>{0,0,0}, Vector<double,3>{0,0,-1}, Vector<double,3>{0,1,0},
+                                            M_PI/3, 1.0, 0.1, 100.0);
+    Scene<double> scene{cam, Vector<double,3>{0,0,0}};
+    auto geom = std::make_shared<Sphere<double>>(Vector<double,3>{0,0,0}, 0.4);
+    auto mat = Material<double>::lambertian(Vector<double,3>{1,1,1});
+    for (int i = 0; i < 6; ++i) {
+        auto xf = Transform<double>::from_trs(Vector<double,3>{double(i), 0.0, -5.0 - 0.5 * i},
+                                              glimmer::Quaternion<double>{}, Vector<double,3>{1,1,1});
+        scene.add_object(SceneObject<double>{geom, mat, xf});
+    }
+    std::vector<Ray<double>> rays;
+    for (int k = 0; k < 8; ++k) rays.emplace_back(Vector<double,3>{0.75 * k, 0.1, 0}, Vector<double,3>{0,0,-1});
+    auto packet = glimmer::RayPacket<double,8>::from_rays(rays);
+    std::array<std::optional<Scene<double>::Hit>,8> hits;
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) scene.build_bvh();
+        const glimmer::PacketMask mask = scene.intersect_packet(packet, hits);
+        for (std::size_t i = 0; i < 8; ++i) {
+            auto ref = scene.intersect(rays[i]);
+            assert(hits[i].has_value() == ref.has_value());
+            assert(((mask >> i) & 1u) == (ref.has_value() ? 1u : 0u));
+            if (ref) {
+                assert(hits[i]->object_index == ref->object_index);
+                assert(std::abs(hits[i]->t - ref->t) < 1e-12);
+            }
+        }
+    }
+}
+
+// Transformed meshes and spheres go through the packet kernels and must still agree with single-ray queries
+static void test_packet_kernels_match_scalar() {
+    auto grid = std::make_shared<Mesh<double>>();
+    for (int y = 0; y <= 4; ++y)
+        for (int x = 0; x <= 4; ++x) {
+            grid->add_vertex(Vector<double,3>{x - 2.0, y - 2.0, 0.1 * ((x * y) % 3)});
+            grid->add_texcoord(Vector<double,2>{x / 4.0, y / 4.0});
+        }
+    grid->add_normal(Vector<double,3>{0, 0, 1});
+    grid->add_normal(Vector<double,3>{0.6, 0, 0.8});
+    for (std::uint32_t y = 0; y < 4; ++y)
+        for (std::uint32_t x = 0; x < 4; ++x) {
+            const std::uint32_t v = y * 5 + x;
+            for (const auto& c : {std::array<std::uint32_t,3>{v, v + 1, v + 6}, std::array<std::uint32_t,3>{v, v + 6, v + 5}}) {
+                grid->add_triangle(c[0], c[1], c[2]);
+                Mesh<double>::TriangleAttributes a;
+                a.texcoord = c;
+                if (x % 2) a.normal = {0, 1, 0};
+                grid->set_triangle_attributes(grid->triangle_count() - 1, a);
+            }
+        }
+    Scene<double> scene;
+    auto mat = Material<double>::lambertian(Vector<double,3>{1,1,1});
+    const auto spin = glimmer::Quaternion<double>::from_axis_angle(Vector<double,3>{1, 1, 0}.normalized(), 0.4);
+    scene.add_object(SceneObject<double>{grid, mat, Transform<double>::from_trs(Vector<double,3>{-1, 0, -6}, spin,
+                                                                                Vector<double,3>{1.5, 0.7, 1})});
+    scene.add_object(SceneObject<double>{std::make_shared<Sphere<double>>(Vector<double,3>{0.2, 0, 0}, 0.8), mat,
+                                         Transform<double>::from_trs(Vector<double,3>{1.5, 0.5, -4}, spin,
+                                                                     Vector<double,3>{2, 1, 0.5})});
+    for (int pass = 0; pass < 3; ++pass) {
+        if (pass == 1) grid->build_bvh();
+        if (pass == 2) scene.build_bvh();
+        for (int row = 0; row < 8; ++row) {
+            std::array<Ray<double>,8> rays;
+            for (int k = 0; k < 8; ++k) {
+                const Vector<double,3> target{0.55 * k - 2.5, 0.5 * row - 2.0, -5.0};
+                rays[k] = Ray<double>{Vector<double,3>{0, 0, 1}, (target - Vector<double,3>{0, 0, 1}).normalized(), 0.0, 9.0};
+            }
+            auto packet = glimmer::RayPacket<double,8>::from_rays(rays);
+            packet.count = 7; // the last lane is not traced
+            std::array<std::optional<Scene<double>::Hit>,8> hits;
+            const glimmer::PacketMask mask = scene.intersect_packet(packet, hits);
+            assert(!((mask >> 7) & 1u) && !hits[7]);
+            for (std::size_t i = 0; i < 7; ++i) {
+                const auto ref = scene.intersect(rays[i]);
+                assert(hits[i].has_value() == ref.has_value());
+                assert(((mask >> i) & 1u) == (ref.has_value() ? 1u : 0u));
+                if (!ref) continue;
+                assert(hits[i]->object_index == ref->object_index);
+                assert(std::abs(hits[i]->t - ref->t) < 1e-9 * ref->t);
+                assert((hits[i]->normal - ref->normal).norm() < 1e-9 * ref->normal.norm());
+                assert(std::abs(hits[i]->uv[0] - ref->uv[0]) < 1e-9 && std::abs(hits[i]->uv[1] - ref->uv[1]) < 1e-9);
+                assert(std::abs(hits[i]->uv_scale - ref->uv_scale) <= 1e-9 * ref->uv_scale);
+            }
+        }
+    }
+}
+
+static void test_incremental_update() {
+    Scene<double> scene;
+    auto geom = std::make_shared<Sphere<double>>(Vector<double,3>{0,0,0}, 0.4);
+    auto mat = Material<double>::lambertian(Vector<double,3>{1,1,1});
+    auto at = [](double x, double y) {
+        return Transform<double>::from_trs(Vector<double,3>{x, y, -5.0}, glimmer::Quaternion<double>{},
+                                           Vector<double,3>{1,1,1});
+    };
+    for (int i = 0; i < 20; ++i)
+        for (int j = 0; j < 20; ++j) scene.add_object(SceneObject<double>{geom, mat, at(i, j)});
+    assert(scene.update() == glimmer::SceneUpdate::rebuild); // first call builds
+    assert(scene.bvh_valid());
+    assert(scene.update() == glimmer::SceneUpdate::none);
+
+    // Small motions are refitted; queries follow the moved object
+    scene.set_object_transform(21, at(1.2, 1.0));
+    scene.set_object_transform(21, at(1.3, 1.0)); // marked once
+    assert(scene.dirty_count() == 1);
+    assert(scene.update() == glimmer::SceneUpdate::refit);
+    assert(scene.dirty_count() == 0);
+    auto h = scene.intersect(Ray<double>{Vector<double,3>{1.3, 1.0, 0}, Vector<double,3>{0,0,-1}});
+    assert(h && h->object_index == 21);
+    assert(scene.update() == glimmer::SceneUpdate::none);
+
+    // Edits through objects() are picked up once marked
+    scene.objects()[0].set_transform(at(-3.0, 0.0));
+    scene.mark_object_dirty(0);
+    assert(scene.update() == glimmer::SceneUpdate::refit);
+    h = scene.intersect(Ray<double>{Vector<double,3>{-3.0, 0.0, 0}, Vector<double,3>{0,0,-1}});
+    assert(h && h->object_index == 0);
+
+    // Scattering many objects far apart degrades the tree enough to trigger a rebuild
+    for (std::size_t i = 0; i < 400; i += 3) scene.set_object_transform(i, at(400.0 - double(i), double(i % 7) * 50.0));
+    assert(scene.update() == glimmer::SceneUpdate::rebuild);
+    const double rebuilt = scene.bvh().sah_cost();
+    h = scene.intersect(Ray<double>{Vector<double,3>{400.0 - 300.0, double(300 % 7) * 50.0, 0}, Vector<double,3>{0,0,-1}});
+    assert(h && h->object_index == 300);
+
+    // A very permissive threshold keeps refitting
+    scene.set_rebuild_threshold(1e9);
+    for (std::size_t i = 0; i < 400; i += 3) scene.set_object_transform(i, at(double(i % 20), double(i / 20)));
+    assert(scene.update() == glimmer::SceneUpdate::refit);
+    assert(scene.bvh().sah_cost() != rebuilt);
+
+    // Adding objects forces a rebuild
+    scene.add_object(SceneObject<double>{geom, mat, at(100, 100)});
+    assert(scene.update() == glimmer::SceneUpdate::rebuild);
+}
+
 int main(){
     test_construct_and_props();
     test_add_objects_and_aabb();
+    test_bvh_matches_linear_scan_and_refit();
+    test_packet_matches_scalar();
+    test_packet_kernels_match_scalar();
+    test_incremental_update();
     std::cout << "All scene tests passed.\n";
     return 0;
 }
@@ -1,6 +1,7 @@
 import glimmer.scene_object;
 import glimmer.sphere;
 import glimmer.mesh;
+import glimmer.plane;
 import glimmer.vector;
 import glimmer.transform;
 import glimmer.quaternion;
@@ -91,11 +92,45 @@ static void test_scaling_adjusts_ray_params() {
     assert(h->normal[2] > 0.0);
 }
 
+static void test_occluded_with_transform() {
+    auto geom = std::make_shared<Sphere<double>>(Vector<double,3>{0,0,0}, 1.0);
+    auto mat = Material<double>::lambertian(Vector<double,3>{1,1,1});
+    // Scaled by 0.5 and moved to z=5: world-space sphere of radius 0.5 spanning z in [4.5, 5.5]
+    auto xf = Transform<double>::from_trs(Vector<double,3>{0,0,5}, glimmer::Quaternion<double>{}, Vector<double,3>{0.5,0.5,0.5});
+    SceneObject<double> obj{geom, mat, xf};
+    assert(obj.occluded(Ray<double>{Vector<double,3>{0,0,0}, Vector<double,3>{0,0,1}, 0.0, 100.0}));
+    // tmax is interpreted in world units: the surface is 4.5 away
+    assert(!obj.occluded(Ray<double>{Vector<double,3>{0,0,0}, Vector<double,3>{0,0,1}, 0.0, 4.4}));
+    assert(obj.occluded(Ray<double>{Vector<double,3>{0,0,0}, Vector<double,3>{0,0,1}, 0.0, 4.6}));
+    // Lateral miss (outside the scaled radius)
+    assert(!obj.occluded(Ray<double>{Vector<double,3>{0.7,0,0}, Vector<double,3>{0,0,1}, 0.0, 100.0}));
+    // Empty object never occludes
+    SceneObject<double> empty;
+    assert(!empty.occluded(Ray<double>{Vector<double,3>{0,0,0}, Vector<double,3>{0,0,1}, 0.0, 100.0}));
+}
+
+static void test_uv_scale_follows_transform() {
+    // A plane has one UV unit per unit length; scaling the object by 2 halves the density in world space
+    auto geom = std::make_shared<glimmer::Plane<double>>();
+    auto mat = Material<double>::lambertian(Vector<double,3>{1,1,1});
+    SceneObject<double> unit{geom, mat, Transform<double>{}};
+    auto xf = Transform<double>::from_trs(Vector<double,3>{0,0,0}, glimmer::Quaternion<double>{}, Vector<double,3>{2,2,2});
+    SceneObject<double> scaled{geom, mat, xf};
+    const Ray<double> r{Vector<double,3>{0.3,0.2,4}, Vector<double,3>{0,0,-1}, 0.0, 100.0};
+    auto h1 = unit.intersect(r);
+    auto h2 = scaled.intersect(r);
+    assert(h1 && h2);
+    assert(std::abs(h1->uv_scale - 1.0) < 1e-12);
+    assert(std::abs(h2->uv_scale - 0.5) < 1e-9);
+}
+
 int main(){
     test_identity_equals_direct_sphere();
     test_translated_transform_hit();
     test_aabb_with_scale();
     test_scaling_adjusts_ray_params();
+    test_occluded_with_transform();
+    test_uv_scale_follows_transform();
     std::cout << "All scene object tests passed.\n";
     return 0;
 }
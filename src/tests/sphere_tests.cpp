@@ -58,12 +58,25 @@ static void test_tangent() {
     assert(std::abs(hit->normal[0] - 1.0) < 1e-12);
 }
 
+static void test_occluded() {
+    Sphere<double> s{Vector<double,3>{0,0,0}, 1.0};
+    // Hit in range, including from inside
+    assert(s.occluded(Ray<double>{Vector<double,3>{0,0,5}, Vector<double,3>{0,0,-1}, 0.0, 100.0}));
+    assert(s.occluded(Ray<double>{Vector<double,3>{0,0,0}, Vector<double,3>{0,0,1}, 0.0, 100.0}));
+    // Miss, and hit beyond tmax
+    assert(!s.occluded(Ray<double>{Vector<double,3>{0,2,5}, Vector<double,3>{0,0,-1}, 0.0, 100.0}));
+    assert(!s.occluded(Ray<double>{Vector<double,3>{0,0,5}, Vector<double,3>{0,0,-1}, 0.0, 3.9}));
+    // Sphere behind the origin
+    assert(!s.occluded(Ray<double>{Vector<double,3>{0,0,5}, Vector<double,3>{0,0,1}, 0.0, 100.0}));
+}
+
 int main() {
     test_aabb();
     test_basic_hit();
     test_miss();
     test_inside();
     test_tangent();
+    test_occluded();
     std::cout << "All sphere tests passed.\n";
     return 0;
 }
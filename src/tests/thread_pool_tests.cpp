@@ -0,0 +1,90 @@
+import glimmer.thread_pool;
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+using glimmer::ThreadPool;
+
+static void test_every_index_runs_once() {
+    ThreadPool pool{4};
+    assert(pool.concurrency() == 4);
+    std::vector<std::atomic<int>> hits(1000);
+    pool.parallel_for(hits.size(), [&](std::size_t i, std::size_t participant) {
+        assert(participant < pool.concurrency());
+        hits[i].fetch_add(1);
+    });
+    for (const auto& h : hits) assert(h.load() == 1);
+}
+
+static void test_pool_is_reused() {
+    ThreadPool pool{3};
+    std::atomic<std::size_t> total{0};
+    for (int round = 0; round < 50; ++round) {
+        pool.parallel_for(17, [&](std::size_t i, std::size_t) { total += i; });
+    }
+    assert(total.load() == 50 * (16 * 17 / 2));
+}
+
+static void test_single_thread_pool_runs_inline() {
+    ThreadPool pool{1};
+    assert(pool.concurrency() == 1);
+    std::vector<std::size_t> order;
+    pool.parallel_for(5, [&](std::size_t i, std::size_t participant) {
+        assert(participant == 0);
+        order.push_back(i);
+    });
+    assert((order == std::vector<std::size_t>{0, 1, 2, 3, 4}));
+}
+
+static void test_nested_call_runs_inline() {
+    ThreadPool pool{4};
+    std::atomic<int> inner{0};
+    pool.parallel_for(8, [&](std::size_t, std::size_t outer_participant) {
+        pool.parallel_for(4, [&](std::size_t, std::size_t p) {
+            assert(p == outer_participant);
+            ++inner;
+        });
+    });
+    assert(inner.load() == 32);
+}
+
+static void test_exception_is_rethrown() {
+    ThreadPool pool{4};
+    std::atomic<int> ran{0};
+    bool caught = false;
+    try {
+        pool.parallel_for(64, [&](std::size_t i, std::size_t) {
+            ++ran;
+            if (i == 10) throw std::runtime_error("boom");
+        });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    assert(caught);
+    assert(ran.load() == 64);
+    // Pool remains usable afterwards
+    std::atomic<int> after{0};
+    pool.parallel_for(8, [&](std::size_t, std::size_t) { ++after; });
+    assert(after.load() == 8);
+}
+
+static void test_shared_pool() {
+    const auto& a = ThreadPool::shared();
+    const auto& b = ThreadPool::shared();
+    assert(a && a.get() == b.get());
+    assert(a->concurrency() >= 1);
+}
+
+int main() {
+    test_every_index_runs_once();
+    test_pool_is_reused();
+    test_single_thread_pool_runs_inline();
+    test_nested_call_runs_inline();
+    test_exception_is_rethrown();
+    test_shared_pool();
+    std::cout << "All thread pool tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,53 @@
+import glimmer.tile;
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+using glimmer::Tile;
+using glimmer::TileGrid;
+
+static void test_grid_dimensions() {
+    TileGrid grid{100, 50, 32};
+    assert(grid.tiles_x() == 4 && grid.tiles_y() == 2);
+    assert(grid.count() == 8);
+    TileGrid exact{64, 64, 32};
+    assert(exact.count() == 4);
+    TileGrid empty{0, 10, 16};
+    assert(empty.count() == 0);
+}
+
+static void test_border_tiles_are_clipped() {
+    TileGrid grid{100, 50, 32};
+    Tile last = grid.tile(grid.count() - 1);
+    assert(last.x0 == 96 && last.x1 == 100 && last.y0 == 32 && last.y1 == 50);
+    assert(last.width() == 4 && last.height() == 18);
+    assert(last.index == grid.count() - 1);
+}
+
+static void test_tiles_cover_image_once() {
+    const std::size_t W = 37, H = 23;
+    TileGrid grid{W, H, 8};
+    std::vector<int> cover(W * H, 0);
+    for (std::size_t i = 0; i < grid.count(); ++i) {
+        Tile t = grid.tile(i);
+        for (std::size_t y = t.y0; y < t.y1; ++y)
+            for (std::size_t x = t.x0; x < t.x1; ++x) ++cover[y * W + x];
+    }
+    for (int c : cover) assert(c == 1);
+}
+
+static void test_zero_tile_size() {
+    TileGrid grid{3, 2, 0};
+    assert(grid.tile_size() == 1);
+    assert(grid.count() == 6);
+}
+
+int main() {
+    test_grid_dimensions();
+    test_border_tiles_are_clipped();
+    test_tiles_cover_image_once();
+    test_zero_tile_size();
+    std::cout << "All tile tests passed.\n";
+    return 0;
+}
@@ -4,7 +4,9 @@ import glimmer.matrix;
 import glimmer.quaternion;
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <iostream>
+#include <vector>
 
 using glimmer::Transform;
 using glimmer::Vector;
@@ -95,12 +97,65 @@ static void test_projection_helpers() {
     assert(std::abs(O(3,3) - 1.0f) < 1e-6);
 }
 
+template <class T>
+static void check_batch_matches_scalar() {
+    const auto xf = Transform<T>::from_trs(Vector<T,3>{T(1.5), T(-2), T(0.25)},
+                                           Quaternion<T>::from_axis_angle(Vector<T,3>{T(0.6), T(0), T(0.8)}, T(0.9)),
+                                           Vector<T,3>{T(2), T(0.5), T(3)});
+    // Sizes around the 4-wide SIMD block, including the remainder paths
+    for (std::size_t n = 0; n < 14; ++n) {
+        std::vector<Vector<T,3>> in(n), out(n);
+        for (std::size_t i = 0; i < n; ++i) in[i] = Vector<T,3>{T(i) * T(0.5), T(1) - T(i), T(i % 3) - T(2)};
+        xf.apply_points(in, out);
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto ref = xf.apply_point(in[i]);
+            for (std::size_t k = 0; k < 3; ++k) assert(std::abs(out[i][k] - ref[k]) <= T(1e-5) * (T(1) + std::abs(ref[k])));
+        }
+        xf.apply_directions(in, out);
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto ref = xf.apply_direction(in[i]);
+            for (std::size_t k = 0; k < 3; ++k) assert(std::abs(out[i][k] - ref[k]) <= T(1e-5) * (T(1) + std::abs(ref[k])));
+        }
+        // In place
+        auto copy = in;
+        xf.apply_points(copy, copy);
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto ref = xf.apply_point(in[i]);
+            for (std::size_t k = 0; k < 3; ++k) assert(std::abs(copy[i][k] - ref[k]) <= T(1e-5) * (T(1) + std::abs(ref[k])));
+        }
+    }
+}
+
+static void test_batch_kernels() {
+    check_batch_matches_scalar<float>();
+    check_batch_matches_scalar<double>();
+}
+
+static void test_affine_views() {
+    const auto xf = Transform<double>::from_trs(Vector<double,3>{1,2,3}, Quaternion<double>::from_axis_angle(
+                                                    Vector<double,3>{0,1,0}, 0.4), Vector<double,3>{1,2,1});
+    const Vector<double,3> p{0.5, -1, 2};
+    const auto a = xf.affine().apply_point(p);
+    const auto b = xf.apply_point(p);
+    const auto back = xf.inverse_affine().apply_point(a);
+    for (std::size_t k = 0; k < 3; ++k) {
+        assert(std::abs(a[k] - b[k]) < 1e-12);
+        assert(std::abs(back[k] - p[k]) < 1e-12);
+    }
+    // A general affine matrix gets its inverse in closed form
+    const Transform<double> general{xf.matrix()};
+    for (std::size_t r = 0; r < 4; ++r)
+        for (std::size_t c = 0; c < 4; ++c) assert(std::abs(general.inverse_matrix()(r,c) - xf.inverse_matrix()(r,c)) < 1e-12);
+}
+
 int main() {
     test_identity_and_inverse();
     test_trs_point_dir_normal();
     test_compose();
     test_look_at();
     test_projection_helpers();
+    test_batch_kernels();
+    test_affine_views();
 
     std::cout << "All transform tests passed.\n";
     return 0;
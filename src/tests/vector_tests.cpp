@@ -79,6 +79,32 @@ static void test_dot_cross_norm() {
     assert(std::abs(u.norm() - 1.0) < 1e-9);
 }
 
+static void test_float_kernels() {
+    // Results must match the scalar definitions whether or not the SIMD kernels are compiled in
+    Vector<float, 3> a{1.5f, -2.0f, 0.25f};
+    Vector<float, 3> b{-0.5f, 4.0f, 3.0f};
+    constexpr Vector<float, 3> ca{1.5f, -2.0f, 0.25f};
+    constexpr Vector<float, 3> cb{-0.5f, 4.0f, 3.0f};
+    constexpr float cd = dot(ca, cb); // constant evaluation takes the scalar path
+    static_assert(cd == -0.75f - 8.0f + 0.75f);
+    assert(dot(a, b) == cd);
+
+    constexpr auto cc = cross(ca, cb);
+    auto c = cross(a, b);
+    for (std::size_t i = 0; i < 3; ++i) assert(c[i] == cc[i]);
+    assert(std::abs(dot(c, a)) < 1e-5f && std::abs(dot(c, b)) < 1e-5f);
+
+    Vector<float, 4> p{1.0f, 2.0f, 3.0f, 4.0f};
+    Vector<float, 4> q{0.5f, -1.0f, 2.0f, 0.25f};
+    assert(dot(p, q) == 0.5f - 2.0f + 6.0f + 1.0f);
+
+    Vector<float, 3> v{3.0f, 4.0f, 12.0f};
+    assert(v.norm() == 13.0f);
+    auto u = v.normalized();
+    assert(std::abs(u.norm() - 1.0f) < 1e-6f);
+    assert(std::abs(u[2] - 12.0f / 13.0f) < 1e-6f);
+}
+
 static void test_min_max_eq() {
     Vector<int, 3> a{1, 5, 3};
     Vector<int, 3> b{2, 1, 3};
@@ -152,6 +178,7 @@ int main() {
     test_element_access();
     test_arithmetic();
     test_dot_cross_norm();
+    test_float_kernels();
     test_min_max_eq();
     test_zero_normalization();
     test_lerp();
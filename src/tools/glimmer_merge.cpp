@@ -0,0 +1,81 @@
+import glimmer.partial_frame;
+import glimmer.accumulation;
+import glimmer.image;
+import glimmer.ppm;
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Combines partial frames (written by `glimmer --partial` or save_partial_frame) into one PPM image.
+//
+//   glimmer_merge [--srgb | --gamma G] -o out.ppm part1 part2 ...
+//
+// Parts may come from any number of machines and arrive in any order. Parts of different frames, or parts that
+// rendered the same samples of the same tiles, are rejected. Pixels no part covered are reported and left black.
+
+namespace {
+    void usage(const char* argv0) {
+        std::cerr << "usage: " << argv0 << " [--srgb | --gamma G] -o out.ppm part...\n";
+    }
+
+    // Loads and merges all parts with scalar type T; returns the process exit code
+    template <class T>
+    int merge(const std::vector<std::string>& parts, const std::string& out_path, const glimmer::U8Encoding& enc) {
+        glimmer::FrameMerger<T> merger;
+        for (const auto& path : parts) {
+            auto part = glimmer::load_partial_frame<T>(path);
+            if (!part) {
+                std::cerr << "cannot read partial frame " << path << "\n";
+                return 1;
+            }
+            try {
+                merger.add(*part);
+            } catch (const std::exception& e) {
+                std::cerr << path << ": " << e.what() << "\n";
+                return 1;
+            }
+        }
+
+        const auto& acc = merger.buffer();
+        std::size_t missing = 0;
+        for (std::size_t y = 0; y < acc.height(); ++y)
+            for (std::size_t x = 0; x < acc.width(); ++x) missing += acc.samples(x, y) == 0;
+        if (missing > 0) std::cerr << "warning: " << missing << " pixels have no samples\n";
+
+        glimmer::Image<T,3> img;
+        merger.resolve(img);
+        if (!glimmer::save_ppm(img, out_path, enc)) {
+            std::cerr << "cannot write " << out_path << "\n";
+            return 1;
+        }
+        std::cout << "Merged " << merger.part_count() << " parts (" << acc.total_samples() << " samples) into "
+                  << out_path << " (" << acc.width() << "x" << acc.height() << ")\n";
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string out_path;
+    glimmer::U8Encoding enc{};
+    std::vector<std::string> parts;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) out_path = argv[++i];
+        else if (arg == "--srgb") enc.srgb = true;
+        else if (arg == "--gamma" && i + 1 < argc) enc.gamma = std::strtod(argv[++i], nullptr);
+        else if (!arg.empty() && arg[0] == '-') { usage(argv[0]); return 2; }
+        else parts.push_back(arg);
+    }
+    if (out_path.empty() || parts.empty() || !(enc.gamma > 0)) {
+        usage(argv[0]);
+        return 2;
+    }
+    // The scalar type is fixed by the renders; the first part tells which one was used
+    const auto scalar = glimmer::partial_frame_scalar_size(parts.front());
+    if (scalar == sizeof(double)) return merge<double>(parts, out_path, enc);
+    return merge<float>(parts, out_path, enc);
+}